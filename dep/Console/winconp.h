@@ -95,6 +95,7 @@ GetConsoleKeyboardLayoutNameW(
 #define CONSOLE_REGISTRY_INTERCEPTCOPYPASTE             L"InterceptCopyPaste"
 
 #define CONSOLE_REGISTRY_COPYCOLOR                      L"CopyColor"
+#define CONSOLE_REGISTRY_PERSISTHISTORY                 L"PersistHistory"
 #define CONSOLE_REGISTRY_USEDX                          L"UseDx"
 
 #define CONSOLE_REGISTRY_DEFAULTFOREGROUND             L"DefaultForeground"
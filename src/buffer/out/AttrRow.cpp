@@ -16,6 +16,7 @@ ATTR_ROW::ATTR_ROW(const UINT cchRowWidth, const TextAttribute attr)
 {
     _list.push_back(TextAttributeRun(cchRowWidth, attr));
     _cchRowWidth = cchRowWidth;
+    _memoryUsageCounter = nullptr;
 }
 
 // Routine Description:
@@ -28,6 +29,51 @@ void ATTR_ROW::Reset(const TextAttribute attr)
     _list.push_back(TextAttributeRun(_cchRowWidth, attr));
 }
 
+// Routine Description:
+// - Gets how much memory the list of runs has been allocated.
+// Return Value:
+// - The size of the allocation, in bytes.
+size_t ATTR_ROW::GetMemoryUsage() const noexcept
+{
+    return _list.capacity() * sizeof(TextAttributeRun);
+}
+
+// Routine Description:
+// - Sets the count this row keeps up to date as the memory its list of runs
+//   has been allocated grows and shrinks. The count must already include what
+//   the row is using now.
+// Arguments:
+// - counter - the count of bytes to keep up to date, or nullptr for none
+void ATTR_ROW::SetMemoryUsageCounter(size_t* const counter) noexcept
+{
+    _memoryUsageCounter = counter;
+}
+
+// Routine Description:
+// - Brings the memory usage counter, if there is one, up to date after the
+//   list of runs may have been given a new allocation.
+// Arguments:
+// - before - how much memory the list of runs was using before
+void ATTR_ROW::_CountMemoryUsageChange(const size_t before) noexcept
+{
+    if (_memoryUsageCounter)
+    {
+        *_memoryUsageCounter = *_memoryUsageCounter - before + GetMemoryUsage();
+    }
+}
+
+// Routine Description:
+// - Gives back any memory the list of runs is holding on to but not using,
+//   e.g. after a row with many colors has been reset.
+// Return Value:
+// - <none>, throws exceptions on failures.
+void ATTR_ROW::Compact()
+{
+    const auto before = GetMemoryUsage();
+    _list.shrink_to_fit();
+    _CountMemoryUsageChange(before);
+}
+
 // Routine Description:
 // - Takes an existing row of attributes, and changes the length so that it fills the NewWidth.
 //     If the new size is bigger, then the last attr is extended to fill the NewWidth.
@@ -311,7 +357,9 @@ void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAtt
     if (iStart == 0 && iEnd == iLastBufferCol)
     {
         // Just dump what we're given over what we have and call it a day.
+        const auto before = GetMemoryUsage();
         _list.assign(newAttrs.cbegin(), newAttrs.cend());
+        _CountMemoryUsageChange(before);
 
         return S_OK;
     }
@@ -519,7 +567,9 @@ void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAtt
     // and update the count for the correct length of the new run now that we've filled it up.
 
     newRun.erase(pNewRunPos, newRun.end());
+    const auto before = GetMemoryUsage();
     _list.swap(newRun);
+    _CountMemoryUsageChange(before);
 
     return S_OK;
 }
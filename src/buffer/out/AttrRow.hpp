@@ -47,6 +47,10 @@ public:
 
     void Resize(const size_t newWidth);
 
+    size_t GetMemoryUsage() const noexcept;
+    void SetMemoryUsageCounter(size_t* const counter) noexcept;
+    void Compact();
+
     [[nodiscard]] HRESULT InsertAttrRuns(const std::basic_string_view<TextAttributeRun> newAttrs,
                                          const size_t iStart,
                                          const size_t iEnd,
@@ -66,6 +70,9 @@ public:
 private:
     std::vector<TextAttributeRun> _list;
     size_t _cchRowWidth;
+    size_t* _memoryUsageCounter;
+
+    void _CountMemoryUsageChange(const size_t before) noexcept;
 
 #ifdef UNIT_TESTING
     friend class AttrRowTests;
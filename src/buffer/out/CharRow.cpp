@@ -78,6 +78,15 @@ size_t CharRow::size() const noexcept
     return _data.size();
 }
 
+// Routine Description:
+// - gets how much memory the cells of the row have been allocated
+// Return Value:
+// - the size of the allocation, in bytes
+size_t CharRow::GetMemoryUsage() const noexcept
+{
+    return _data.capacity() * sizeof(value_type);
+}
+
 // Routine Description:
 // - Sets all properties of the CharRowBase to default values
 // Arguments:
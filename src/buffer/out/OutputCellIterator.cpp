@@ -6,9 +6,10 @@
 #include "OutputCellIterator.hpp"
 
 #include "../../types/inc/convert.hpp"
-#include "../../types/inc/Utf16Parser.hpp"
+#include "../../types/inc/GraphemeClusterIterator.hpp"
 #include "../../types/inc/GlyphWidth.hpp"
 #include "../../inc/conattrs.hpp"
+#include "../../inc/unicode.hpp"
 
 static constexpr TextAttribute InvalidTextAttribute{ INVALID_COLOR, INVALID_COLOR };
 
@@ -393,7 +394,7 @@ OutputCellView OutputCellIterator::s_GenerateView(const std::wstring_view view,
 //   variables (so OutputCellView doesn't need an empty default constructor)
 // - This will infer the width of the glyph and apply the appropriate attributes to the view.
 // Arguments:
-// - view - View representing characters corresponding to a single glyph
+// - view - View of the remaining text. The view will cover its first grapheme cluster.
 // - attr - Color attributes to apply to the text
 // - behavior - Behavior of the given text attribute (used when writing)
 // Return Value:
@@ -402,7 +403,23 @@ OutputCellView OutputCellIterator::s_GenerateView(const std::wstring_view view,
                                                   const TextAttribute attr,
                                                   const TextAttributeBehavior behavior)
 {
-    const auto glyph = Utf16Parser::ParseNext(view);
+    auto glyph = GraphemeClusterIterator::NextCluster(view);
+
+    // Every control gets a cell of its own, the way it did before clusters.
+    // CR + LF is the only cluster that has a control in it and is longer than
+    // one wchar_t, so it's split back apart.
+    if (glyph.size() > 1 && glyph.front() == UNICODE_CARRIAGERETURN)
+    {
+        glyph = glyph.substr(0, 1);
+    }
+
+    // An unpaired surrogate can't be displayed. Show a replacement character in
+    // its place instead, which still only steps over the one wchar_t.
+    if (glyph.empty() || (glyph.size() == 1 && (IS_HIGH_SURROGATE(glyph.front()) || IS_LOW_SURROGATE(glyph.front()))))
+    {
+        glyph = { &UNICODE_REPLACEMENT, 1 };
+    }
+
     DbcsAttribute dbcsAttr;
     if (IsGlyphFullWidth(glyph))
     {
@@ -81,6 +81,17 @@ bool ROW::Reset(const TextAttribute Attr)
     return true;
 }
 
+// Routine Description:
+// - gets how much memory the row is using, including what its cells and
+//   attribute runs have been allocated. Glyphs kept in the buffer's unicode
+//   storage aren't counted.
+// Return Value:
+// - the number of bytes
+size_t ROW::GetMemoryUsage() const noexcept
+{
+    return sizeof(ROW) + _charRow.GetMemoryUsage() + _attrRow.GetMemoryUsage();
+}
+
 // Routine Description:
 // - resizes ROW to new width
 // Arguments:
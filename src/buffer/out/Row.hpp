@@ -46,6 +46,7 @@ public:
     void SetId(const SHORT id) noexcept;
 
     bool Reset(const TextAttribute Attr);
+    size_t GetMemoryUsage() const noexcept;
     [[nodiscard]] HRESULT Resize(const size_t width);
 
     void ClearColumn(const size_t column);
@@ -0,0 +1,146 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "RowSearchIndex.hpp"
+
+// Routine Description:
+// - Constructs an index for a buffer with the given number of rows. Nothing
+//   is allocated for the signatures until the first one is stored.
+RowSearchIndex::RowSearchIndex(const size_t rowCount) :
+    _signatures{},
+    _valid(rowCount, false)
+{
+}
+
+// Routine Description:
+// - Works out the signature of some text: every trigram in it is hashed to
+//   one of the 256 bits. Case is folded first, so that the signature of a row
+//   can be used by case insensitive searches too.
+// Arguments:
+// - text - the text to work out the signature of
+// Return Value:
+// - The signature. It's empty if the text is shorter than a trigram.
+RowSearchIndex::Signature RowSearchIndex::s_Signature(const std::wstring_view text) noexcept
+{
+    Signature signature{};
+    if (text.size() < 3)
+    {
+        return signature;
+    }
+
+    uint32_t first = ::towlower(text[0]);
+    uint32_t second = ::towlower(text[1]);
+    for (size_t i = 2; i < text.size(); ++i)
+    {
+        const uint32_t third = ::towlower(text[i]);
+        const auto hash = (first * 0x9E3779B1u) ^ (second * 0x85EBCA77u) ^ (third * 0xC2B2AE3Du);
+        const auto bit = hash >> 24;
+        signature[bit / 64] |= 1ull << (bit % 64);
+
+        first = second;
+        second = third;
+    }
+    return signature;
+}
+
+// Routine Description:
+// - Checks if a signature has no trigrams in it. An empty needle signature
+//   can't rule any rows out.
+bool RowSearchIndex::s_IsEmpty(const Signature& signature) noexcept
+{
+    return std::all_of(signature.cbegin(), signature.cend(), [](const auto word) { return word == 0; });
+}
+
+// Routine Description:
+// - Checks if text with the given signature might contain text with another.
+// Arguments:
+// - haystack - the signature of the text being searched
+// - needle - the signature of the text being searched for
+// Return Value:
+// - False if the haystack can't contain the needle. True if it might.
+bool RowSearchIndex::s_MayContain(const Signature& haystack, const Signature& needle) noexcept
+{
+    for (size_t i = 0; i < needle.size(); ++i)
+    {
+        if ((haystack[i] & needle[i]) != needle[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Routine Description:
+// - Gets the signature stored for a row, if it's still valid.
+// Arguments:
+// - row - the storage position of the row
+// Return Value:
+// - The signature, or nullptr if it has to be worked out again.
+const RowSearchIndex::Signature* RowSearchIndex::TryGet(const size_t row) const noexcept
+{
+    if (row < _valid.size() && _valid[row])
+    {
+        return &_signatures[row];
+    }
+    return nullptr;
+}
+
+// Routine Description:
+// - Stores the signature of a row.
+// Arguments:
+// - row - the storage position of the row
+// - signature - its signature
+// Return Value:
+// - <none>
+// Note:
+// - will throw exception on error
+void RowSearchIndex::Set(const size_t row, const Signature& signature)
+{
+    if (_signatures.size() != _valid.size())
+    {
+        _signatures.resize(_valid.size());
+    }
+
+    _signatures.at(row) = signature;
+    _valid.at(row) = true;
+}
+
+// Routine Description:
+// - Throws away the signature of a row that might have been written to.
+// - A row's signature includes the trigrams that run on from its end into the
+//   start of the row after it, so the signature of the row before this one
+//   (wrapping around, like the buffer does) is thrown away too.
+// Arguments:
+// - row - the storage position of the row
+void RowSearchIndex::Invalidate(const size_t row) noexcept
+{
+    if (row >= _valid.size())
+    {
+        return;
+    }
+
+    _valid[row] = false;
+    _valid[row == 0 ? _valid.size() - 1 : row - 1] = false;
+}
+
+// Routine Description:
+// - Throws away every signature, for when rows have been moved around.
+void RowSearchIndex::InvalidateAll() noexcept
+{
+    std::fill(_valid.begin(), _valid.end(), false);
+}
+
+// Routine Description:
+// - Changes the number of rows in the index, throwing away every signature.
+// Arguments:
+// - rowCount - the new number of rows
+// Return Value:
+// - <none>
+// Note:
+// - will throw exception on error
+void RowSearchIndex::Resize(const size_t rowCount)
+{
+    _valid.assign(rowCount, false);
+    std::vector<Signature>{}.swap(_signatures);
+}
@@ -0,0 +1,50 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- RowSearchIndex.hpp
+
+Abstract:
+- A search index over the rows of a text buffer, so that a search can skip
+  rows that can't contain what it's looking for, without reading their text.
+- Each row has a signature: the trigrams (runs of three characters) of its
+  case folded text, hashed into a small bit set. A row can only contain some
+  text if its signature has every bit of the text's signature.
+- Signatures are worked out the first time they're needed, and thrown away
+  whenever their row might have been written to, or has circled out of the
+  buffer. They're kept by storage position, not by offset from the top of the
+  buffer, so circling the buffer doesn't move them.
+--*/
+
+#pragma once
+
+#include <array>
+
+class RowSearchIndex final
+{
+public:
+    // The trigrams of some text, hashed into 256 bits.
+    using Signature = std::array<uint64_t, 4>;
+
+    RowSearchIndex(const size_t rowCount);
+
+    static Signature s_Signature(const std::wstring_view text) noexcept;
+    static bool s_IsEmpty(const Signature& signature) noexcept;
+    static bool s_MayContain(const Signature& haystack, const Signature& needle) noexcept;
+
+    const Signature* TryGet(const size_t row) const noexcept;
+    void Set(const size_t row, const Signature& signature);
+
+    void Invalidate(const size_t row) noexcept;
+    void InvalidateAll() noexcept;
+    void Resize(const size_t rowCount);
+
+private:
+    std::vector<Signature> _signatures;
+    std::vector<bool> _valid;
+
+#ifdef UNIT_TESTING
+    friend class RowSearchIndexTests;
+#endif
+};
@@ -5,7 +5,8 @@
 #include "UnicodeStorage.hpp"
 
 UnicodeStorage::UnicodeStorage() :
-    _map{}
+    _map{},
+    _glyphsMemoryUsage{ 0 }
 {
 }
 
@@ -28,7 +29,14 @@ const UnicodeStorage::mapped_type& UnicodeStorage::GetText(const key_type key) c
 // - glyph - the glyph data to store
 void UnicodeStorage::StoreGlyph(const key_type key, const mapped_type& glyph)
 {
-    _map.insert_or_assign(key, glyph);
+    const auto existing = _map.find(key);
+    if (existing != _map.end())
+    {
+        _glyphsMemoryUsage -= s_GetEntryMemoryUsage(existing->second);
+    }
+
+    const auto stored = _map.insert_or_assign(key, glyph).first;
+    _glyphsMemoryUsage += s_GetEntryMemoryUsage(stored->second);
 }
 
 // Routine Description:
@@ -37,7 +45,35 @@ void UnicodeStorage::StoreGlyph(const key_type key, const mapped_type& glyph)
 // - key - the key to remove
 void UnicodeStorage::Erase(const key_type key) noexcept
 {
-    _map.erase(key);
+    const auto existing = _map.find(key);
+    if (existing != _map.end())
+    {
+        _glyphsMemoryUsage -= s_GetEntryMemoryUsage(existing->second);
+        _map.erase(existing);
+    }
+}
+
+// Routine Description:
+// - Estimates how much memory the storage is using: its table of buckets,
+//   plus every glyph stored in it. The glyphs are kept count of as they're
+//   stored and erased, so this doesn't walk the storage.
+// Return Value:
+// - the number of bytes
+size_t UnicodeStorage::GetMemoryUsage() const noexcept
+{
+    return _map.bucket_count() * sizeof(void*) + _glyphsMemoryUsage;
+}
+
+// Routine Description:
+// - Estimates how much memory one stored glyph is using: a node of the map,
+//   holding the key, the glyph and a link or two, and the glyph's own text.
+// Arguments:
+// - glyph - the glyph data
+// Return Value:
+// - the number of bytes
+size_t UnicodeStorage::s_GetEntryMemoryUsage(const mapped_type& glyph) noexcept
+{
+    return sizeof(std::pair<const key_type, mapped_type>) + 2 * sizeof(void*) + glyph.capacity() * sizeof(wchar_t);
 }
 
 // Routine Description:
@@ -51,6 +87,7 @@ void UnicodeStorage::Remap(const std::map<SHORT, SHORT>& rowMap, const std::opti
 {
     // Make a temporary map to hold all the new row positioning
     std::unordered_map<key_type, mapped_type> newMap;
+    size_t newGlyphsMemoryUsage = 0;
 
     // Walk through every stored item.
     for (const auto& pair : _map)
@@ -90,9 +127,11 @@ void UnicodeStorage::Remap(const std::map<SHORT, SHORT>& rowMap, const std::opti
         const auto newCoord = COORD{ oldCoord.X, newRowId };
 
         // Put the adjusted coordinate into the map with the original value.
-        newMap.emplace(newCoord, pair.second);
+        const auto stored = newMap.emplace(newCoord, pair.second).first;
+        newGlyphsMemoryUsage += s_GetEntryMemoryUsage(stored->second);
     }
 
     // Swap into the stored map, free the temporary when we exit.
     _map.swap(newMap);
+    _glyphsMemoryUsage = newGlyphsMemoryUsage;
 }
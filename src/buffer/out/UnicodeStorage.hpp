@@ -55,10 +55,14 @@ public:
 
     void Erase(const key_type key) noexcept;
 
+    size_t GetMemoryUsage() const noexcept;
+    static size_t s_GetEntryMemoryUsage(const mapped_type& glyph) noexcept;
+
     void Remap(const std::map<SHORT, SHORT>& rowMap, const std::optional<SHORT> width);
 
 private:
     std::unordered_map<key_type, mapped_type> _map;
+    size_t _glyphsMemoryUsage;
 
 #ifdef UNIT_TESTING
     friend class UnicodeStorageTests;
@@ -33,6 +33,8 @@ TextBuffer::TextBuffer(const COORD screenBufferSize,
     _cursor{ cursorSize, *this },
     _storage{},
     _unicodeStorage{},
+    _rowsMemoryUsage{ 0 },
+    _searchIndex{ static_cast<size_t>(screenBufferSize.Y) },
     _renderTarget{ renderTarget }
 {
     // initialize ROWs
@@ -40,6 +42,8 @@ TextBuffer::TextBuffer(const COORD screenBufferSize,
     {
         _storage.emplace_back(static_cast<SHORT>(i), screenBufferSize.X, _currentAttributes, this);
     }
+
+    _MeasureRowsMemoryUsage();
 }
 
 // Routine Description:
@@ -88,9 +92,54 @@ const ROW& TextBuffer::GetRowByOffset(const size_t index) const
 // - Number of rows down from the first row of the buffer.
 // Return Value:
 // - reference to the requested row. Asserts if out of bounds.
+// Note:
+// - Any row handed out for writing is assumed to be written to, so its search
+//   index signature is thrown away.
 ROW& TextBuffer::GetRowByOffset(const size_t index)
 {
-    return const_cast<ROW&>(static_cast<const TextBuffer*>(this)->GetRowByOffset(index));
+    auto& row = const_cast<ROW&>(static_cast<const TextBuffer*>(this)->GetRowByOffset(index));
+    _searchIndex.Invalidate(gsl::narrow_cast<size_t>(row.GetId()));
+    return row;
+}
+
+// Routine Description:
+// - Gets the search index signature of a row: the trigrams of its text, along
+//   with the ones that run on into the first couple of characters of the row
+//   below it (wrapping around at the bottom of the buffer, like searches do).
+// - The signature is only worked out again after the row (or the start of the
+//   one below it) might have been written to.
+// Arguments:
+// - index - Number of rows down from the first row of the buffer.
+// Return Value:
+// - The signature of the row.
+RowSearchIndex::Signature TextBuffer::GetRowSearchSignature(const size_t index) const
+{
+    const auto& row = GetRowByOffset(index);
+    const auto storageIndex = gsl::narrow_cast<size_t>(row.GetId());
+    if (const auto signature = _searchIndex.TryGet(storageIndex))
+    {
+        return *signature;
+    }
+
+    std::wstring text;
+    const auto& charRow = row.GetCharRow();
+    for (size_t column = 0; column < charRow.size(); ++column)
+    {
+        const std::wstring_view glyph = charRow.GlyphAt(column);
+        text.append(glyph);
+    }
+
+    const auto& nextCharRow = GetRowByOffset(index + 1).GetCharRow();
+    const auto runOnLength = text.size() + 2;
+    for (size_t column = 0; column < nextCharRow.size() && text.size() < runOnLength; ++column)
+    {
+        const std::wstring_view glyph = nextCharRow.GlyphAt(column);
+        text.append(glyph.substr(0, runOnLength - text.size()));
+    }
+
+    const auto signature = RowSearchIndex::s_Signature(text);
+    _searchIndex.Set(storageIndex, signature);
+    return signature;
 }
 
 // Routine Description:
@@ -543,6 +592,7 @@ bool TextBuffer::IncrementCircularBuffer()
 
     // First, clean out the old "first row" as it will become the "last row" of the buffer after the circle is performed.
     bool fSuccess = _storage.at(_firstRow).Reset(_currentAttributes);
+    _searchIndex.Invalidate(_firstRow);
     if (fSuccess)
     {
         // Now proceed to increment.
@@ -558,6 +608,138 @@ bool TextBuffer::IncrementCircularBuffer()
     return fSuccess;
 }
 
+// Routine Description:
+// - Gets how much memory the buffer is using: every row, and the glyphs kept
+//   in the unicode storage. Both are kept count of as rows are written to, so
+//   this doesn't walk the buffer.
+// Return Value:
+// - the number of bytes
+size_t TextBuffer::GetMemoryUsage() const noexcept
+{
+    return _rowsMemoryUsage + _unicodeStorage.GetMemoryUsage();
+}
+
+// Routine Description:
+// - Measures how much memory every row is using, and has each row keep that
+//   count up to date from then on as its attribute runs grow and shrink.
+//   Needed whenever rows are created or resized.
+void TextBuffer::_MeasureRowsMemoryUsage() noexcept
+{
+    _rowsMemoryUsage = 0;
+    for (auto& row : _storage)
+    {
+        _rowsMemoryUsage += row.GetMemoryUsage();
+        row.GetAttrRow().SetMemoryUsageCounter(&_rowsMemoryUsage);
+    }
+}
+
+// Routine Description:
+// - Gets the least memory a row of the given width can use: its cells, and a
+//   single run of attributes. A row can't be made any smaller than this.
+// Arguments:
+// - width - the width of the row, in cells
+// Return Value:
+// - the number of bytes
+size_t TextBuffer::s_GetLeastRowMemoryUsage(const size_t width) noexcept
+{
+    return sizeof(ROW) + width * sizeof(CharRowCell) + sizeof(TextAttributeRun);
+}
+
+// Routine Description:
+// - Brings the memory the buffer is using down towards a limit without losing
+//   anything: the oldest rows first give back the room their attribute runs
+//   were allocated but aren't using.
+// Arguments:
+// - limit - how many bytes the buffer may use
+// - firstKeptRow - rows from this one down are never touched
+// Return Value:
+// - The number of bytes the buffer is using afterwards. It can still be over
+//   the limit.
+// Note:
+// - will throw exception on error
+size_t TextBuffer::CompactMemoryUsage(const size_t limit, const SHORT firstKeptRow)
+{
+    const auto rowCount = std::min(gsl::narrow_cast<size_t>(std::max<SHORT>(firstKeptRow, 0)), _storage.size());
+
+    // Compacting doesn't change the text, so the search index can stay.
+    for (size_t y = 0; y < rowCount && GetMemoryUsage() > limit; ++y)
+    {
+        _storage.at((_firstRow + y) % _storage.size()).GetAttrRow().Compact();
+    }
+
+    return GetMemoryUsage();
+}
+
+// Routine Description:
+// - Brings the memory the buffer is using down under a limit, if it's over it,
+//   taking it from the oldest rows first. First, rows are compacted (see
+//   CompactMemoryUsage). If that isn't enough, the oldest rows that are using
+//   more than the least they can are stripped of their colors and of the
+//   glyphs they keep in the unicode storage. Their text stays.
+// Arguments:
+// - limit - how many bytes the buffer may use
+// - firstKeptRow - rows from this one down are never touched
+// Return Value:
+// - The number of bytes the buffer is using afterwards. It can still be over
+//   the limit, if the rows that may be touched had nothing left to give.
+// Note:
+// - will throw exception on error
+size_t TextBuffer::TrimMemoryUsage(const size_t limit, const SHORT firstKeptRow)
+{
+    if (CompactMemoryUsage(limit, firstKeptRow) <= limit)
+    {
+        return GetMemoryUsage();
+    }
+
+    const auto rowCount = std::min(gsl::narrow_cast<size_t>(std::max<SHORT>(firstKeptRow, 0)), _storage.size());
+    for (size_t y = 0; y < rowCount && GetMemoryUsage() > limit; ++y)
+    {
+        _StripRowForMemory(_storage.at((_firstRow + y) % _storage.size()));
+    }
+
+    return GetMemoryUsage();
+}
+
+// Routine Description:
+// - Strips a row down to the least memory it can use, keeping its text: its
+//   colors go back to the defaults, and each glyph it has in the unicode
+//   storage is replaced by the first character of the glyph (or by U+FFFD,
+//   if that's half of a surrogate pair). A row that's already as small as it
+//   can be is left alone.
+// Arguments:
+// - row - the row to strip
+// Note:
+// - will throw exception on error
+void TextBuffer::_StripRowForMemory(ROW& row)
+{
+    auto& charRow = row.GetCharRow();
+    bool textChanged = false;
+    for (size_t column = 0; column < charRow.size(); ++column)
+    {
+        if (charRow.DbcsAttrAt(column).IsGlyphStored())
+        {
+            const auto key = charRow.GetStorageKey(column);
+            const auto first = _unicodeStorage.GetText(key).front();
+            const auto base = IS_HIGH_SURROGATE(first) || IS_LOW_SURROGATE(first) ? UNICODE_REPLACEMENT : first;
+            _unicodeStorage.Erase(key);
+            charRow.GlyphAt(column) = std::wstring_view{ &base, 1 };
+            textChanged = true;
+        }
+    }
+
+    if (textChanged)
+    {
+        _searchIndex.Invalidate(gsl::narrow_cast<size_t>(row.GetId()));
+    }
+
+    auto& attrRow = row.GetAttrRow();
+    if (attrRow.GetNumberOfRuns() > 1 || attrRow.GetMemoryUsage() > sizeof(TextAttributeRun))
+    {
+        attrRow.Reset(TextAttribute{});
+        attrRow.Compact();
+    }
+}
+
 //Routine Description:
 // - Retrieves the position of the last non-space character on the final line of the text buffer.
 // - By default, we search the entire buffer to find the last non-space character
@@ -753,6 +935,9 @@ void TextBuffer::ScrollRows(const SHORT firstRow, const SHORT size, const SHORT
     // Renumber the IDs now that we've rearranged where the rows sit within the buffer.
     // Refreshing should also delegate to the UnicodeStorage to re-key all the stored unicode sequences (where applicable).
     _RefreshRowIDs(std::nullopt);
+
+    // The search index is kept by storage position, so it's stale now too.
+    _searchIndex.InvalidateAll();
 }
 
 Cursor& TextBuffer::GetCursor()
@@ -787,6 +972,7 @@ void TextBuffer::Reset()
         row.GetCharRow().Reset();
         row.GetAttrRow().Reset(attr);
     }
+    _searchIndex.InvalidateAll();
 }
 
 // Routine Description:
@@ -799,50 +985,91 @@ void TextBuffer::Reset()
 {
     RETURN_HR_IF(E_INVALIDARG, newSize.X < 0 || newSize.Y < 0);
 
-    const auto currentSize = GetSize().Dimensions();
-    const auto attributes = GetCurrentAttributes();
-
     SHORT TopRow = 0; // new top row of the screen buffer
     if (newSize.Y <= GetCursor().GetPosition().Y)
     {
         TopRow = GetCursor().GetPosition().Y - newSize.Y + 1;
     }
-    const SHORT TopRowIndex = (GetFirstRowIndex() + TopRow) % currentSize.Y;
 
-    // rotate rows until the top row is at index 0
     try
     {
-        const ROW& newTopRow = _storage[TopRowIndex];
-        while (&newTopRow != &_storage.front())
-        {
-            _storage.push_back(std::move(_storage.front()));
-            _storage.pop_front();
-        }
+        _ResizeFromRow(newSize, TopRow);
+    }
+    CATCH_RETURN();
 
-        _SetFirstRowIndex(0);
+    return S_OK;
+}
 
-        // realloc in the Y direction
-        // remove rows if we're shrinking
-        while (_storage.size() > static_cast<size_t>(newSize.Y))
-        {
-            _storage.pop_back();
-        }
-        // add rows if we're growing
-        while (_storage.size() < static_cast<size_t>(newSize.Y))
-        {
-            _storage.emplace_back(static_cast<short>(_storage.size()), newSize.X, attributes, this);
-        }
+// Routine Description:
+// - Makes the buffer shorter by dropping its oldest rows, and then the rows
+//   at the bottom that don't fit any more. The cursor moves up with the text
+//   it's in.
+// Arguments:
+// - count - how many rows to drop from the top
+// - newHeight - the number of rows the buffer has afterwards
+// Return Value:
+// - S_OK, or E_INVALIDARG if the rows left over wouldn't hold the cursor.
+[[nodiscard]] HRESULT TextBuffer::DropOldestRows(const SHORT count, const SHORT newHeight) noexcept
+{
+    const auto cursorPosition = GetCursor().GetPosition();
+    RETURN_HR_IF(E_INVALIDARG, count < 0 || count > cursorPosition.Y || cursorPosition.Y - count >= newHeight);
 
-        // Now that we've tampered with the row placement, refresh all the row IDs.
-        // Also take advantage of the row ID refresh loop to resize the rows in the X dimension
-        // and cleanup the UnicodeStorage characters that might fall outside the resized buffer.
-        _RefreshRowIDs(newSize.X);
+    try
+    {
+        _ResizeFromRow({ GetSize().Width(), newHeight }, count);
+        GetCursor().SetPosition({ cursorPosition.X, gsl::narrow_cast<SHORT>(cursorPosition.Y - count) });
     }
     CATCH_RETURN();
 
     return S_OK;
 }
 
+// Routine Description:
+// - Resizes the buffer, making the given row the new top row. The rows above
+//   it are dropped, as are those past the new height.
+// Arguments:
+// - newSize - new size of screen
+// - topRow - the row that becomes the top of the buffer
+// Note:
+// - will throw exception on error
+void TextBuffer::_ResizeFromRow(const COORD newSize, const SHORT topRow)
+{
+    const auto currentSize = GetSize().Dimensions();
+    const auto attributes = GetCurrentAttributes();
+
+    const SHORT TopRowIndex = (GetFirstRowIndex() + topRow) % currentSize.Y;
+
+    // rotate rows until the top row is at index 0
+    const ROW& newTopRow = _storage[TopRowIndex];
+    while (&newTopRow != &_storage.front())
+    {
+        _storage.push_back(std::move(_storage.front()));
+        _storage.pop_front();
+    }
+
+    _SetFirstRowIndex(0);
+
+    // realloc in the Y direction
+    // remove rows if we're shrinking
+    while (_storage.size() > static_cast<size_t>(newSize.Y))
+    {
+        _storage.pop_back();
+    }
+    // add rows if we're growing
+    while (_storage.size() < static_cast<size_t>(newSize.Y))
+    {
+        _storage.emplace_back(static_cast<short>(_storage.size()), newSize.X, attributes, this);
+    }
+
+    // Now that we've tampered with the row placement, refresh all the row IDs.
+    // Also take advantage of the row ID refresh loop to resize the rows in the X dimension
+    // and cleanup the UnicodeStorage characters that might fall outside the resized buffer.
+    _RefreshRowIDs(newSize.X);
+    _MeasureRowsMemoryUsage();
+
+    _searchIndex.Resize(_storage.size());
+}
+
 const UnicodeStorage& TextBuffer::GetUnicodeStorage() const
 {
     return _unicodeStorage;
@@ -938,267 +1165,238 @@ Microsoft::Console::Render::IRenderTarget& TextBuffer::GetRenderTarget()
 }
 
 // Routine Description:
-// - Retrieves the text data from the selected region and presents it in a clipboard-ready format (given little post-processing).
+// - Copies the text in the selection out of the buffer, along with its colors,
+//   a run at a time, ready for the clipboard. The cells of each row are read
+//   straight out of it, skipping the trailing halves of wide glyphs, and its
+//   colors only have to be worked out once for every run of its attributes.
 // Arguments:
-// - lineSelection - true if entire line is being selected. False otherwise (box selection)
-// - trimTrailingWhitespace - setting flag removes trailing whitespace at the end of each row in selection
-// - selectionRects - the selection regions from which the data will be extracted from the buffer
-// - GetForegroundColor - function used to map TextAttribute to RGB COLORREF for foreground color
-// - GetBackgroundColor - function used to map TextAttribute to RGB COLORREF for foreground color
+// - lineSelection - true if the selection is a line selection, false if it's a box selection
+// - trimTrailingWhitespace - remove the spaces at the end of each row, and add CR/LF between them
+// - selectionRects - the rectangle of each row of the selection
+// - GetForegroundColor - works out the foreground color of an attribute
+// - GetBackgroundColor - works out the background color of an attribute
 // Return Value:
-// - The text, background color, and foreground color data of the selected region of the text buffer.
-const TextBuffer::TextAndColor TextBuffer::GetTextForClipboard(const bool lineSelection,
-                                                               const bool trimTrailingWhitespace,
-                                                               const std::vector<SMALL_RECT>& selectionRects,
-                                                               std::function<COLORREF(TextAttribute&)> GetForegroundColor,
-                                                               std::function<COLORREF(TextAttribute&)> GetBackgroundColor) const
+// - The text of the selection, and the runs of its colors.
+// Note:
+// - will throw exception on error
+const TextBuffer::TextAndColorRuns TextBuffer::GetTextRunsForClipboard(const bool lineSelection,
+                                                                       const bool trimTrailingWhitespace,
+                                                                       const std::vector<SMALL_RECT>& selectionRects,
+                                                                       std::function<COLORREF(TextAttribute&)> GetForegroundColor,
+                                                                       std::function<COLORREF(TextAttribute&)> GetBackgroundColor) const
 {
-    TextAndColor data;
+    TextAndColorRuns data;
+    data.rowEnds.reserve(selectionRects.size());
 
-    // preallocate our vectors to reduce reallocs
-    size_t const rows = selectionRects.size();
-    data.text.reserve(rows);
-    data.FgAttr.reserve(rows);
-    data.BkAttr.reserve(rows);
-
-    // for each row in the selection
-    for (UINT i = 0; i < rows; i++)
+    const auto bufferSize = GetSize();
+    for (size_t i = 0; i < selectionRects.size(); ++i)
     {
-        const UINT iRow = selectionRects.at(i).Top;
-
-        const Viewport highlight = Viewport::FromInclusive(selectionRects.at(i));
-
-        // retrieve the data from the screen buffer
-        auto it = GetCellDataAt(highlight.Origin(), highlight);
-
-        // allocate a string buffer
-        std::wstring selectionText;
-        std::vector<COLORREF> selectionFgAttr;
-        std::vector<COLORREF> selectionBkAttr;
-
-        // preallocate to avoid reallocs
-        selectionText.reserve(highlight.Width() + 2); // + 2 for \r\n if we munged it
-        selectionFgAttr.reserve(highlight.Width() + 2);
-        selectionBkAttr.reserve(highlight.Width() + 2);
-
-        // copy char data into the string buffer, skipping trailing bytes
-        while (it)
+        const auto& rect = selectionRects.at(i);
+        const ROW& row = GetRowByOffset(rect.Top);
+        const auto& charRow = row.GetCharRow();
+        const auto& attrRow = row.GetAttrRow();
+        const auto firstRun = data.runs.size();
+
+        auto column = gsl::narrow_cast<size_t>(std::clamp(rect.Left, bufferSize.Left(), bufferSize.RightInclusive()));
+        const auto end = gsl::narrow_cast<size_t>(std::clamp(rect.Right, bufferSize.Left(), bufferSize.RightInclusive())) + 1;
+        while (column < end)
         {
-            const auto& cell = *it;
-            auto cellData = cell.TextAttr();
-            COLORREF const CellFgAttr = GetForegroundColor(cellData);
-            COLORREF const CellBkAttr = GetBackgroundColor(cellData);
+            size_t applies = 0;
+            auto attr = attrRow.GetAttrByColumn(column, &applies);
+            const auto runEnd = std::min(column + std::max<size_t>(applies, 1), end);
 
-            if (!cell.DbcsAttr().IsTrailing())
+            // copy char data into the string buffer, skipping trailing bytes
+            const auto runStart = data.text.size();
+            for (; column < runEnd; ++column)
             {
-                selectionText.append(cell.Chars());
-                for (const wchar_t wch : cell.Chars())
+                const auto& cell = *(charRow.cbegin() + column);
+                if (cell.DbcsAttr().IsTrailing())
                 {
-                    selectionFgAttr.push_back(CellFgAttr);
-                    selectionBkAttr.push_back(CellBkAttr);
+                    continue;
                 }
+
+                if (cell.DbcsAttr().IsGlyphStored())
+                {
+                    data.text.append(std::wstring_view{ charRow.GlyphAt(column) });
+                }
+                else
+                {
+                    data.text.push_back(cell.Char());
+                }
+            }
+
+            const auto length = data.text.size() - runStart;
+            if (length == 0)
+            {
+                continue;
+            }
+
+            const auto foreground = GetForegroundColor(attr);
+            const auto background = GetBackgroundColor(attr);
+            if (data.runs.size() > firstRun &&
+                data.runs.back().foreground == foreground &&
+                data.runs.back().background == background)
+            {
+                data.runs.back().length += length;
+            }
+            else
+            {
+                data.runs.push_back({ length, foreground, background });
             }
-            it++;
         }
 
         // trim trailing spaces if SHIFT key not held
         if (trimTrailingWhitespace)
         {
-            const ROW& Row = GetRowByOffset(iRow);
-
             // FOR LINE SELECTION ONLY: if the row was wrapped, don't remove the spaces at the end.
-            if (!lineSelection || !Row.GetCharRow().WasWrapForced())
+            if (!lineSelection || !charRow.WasWrapForced())
             {
-                while (!selectionText.empty() && selectionText.back() == UNICODE_SPACE)
+                while (data.runs.size() > firstRun && data.text.back() == UNICODE_SPACE)
                 {
-                    selectionText.pop_back();
-                    selectionFgAttr.pop_back();
-                    selectionBkAttr.pop_back();
+                    data.text.pop_back();
+                    if (--data.runs.back().length == 0)
+                    {
+                        data.runs.pop_back();
+                    }
                 }
             }
 
             // apply CR/LF to the end of the final string, unless we're the last line.
-            // a.k.a if we're earlier than the bottom, then apply CR/LF.
-            if (i < selectionRects.size() - 1)
+            // FOR LINE SELECTION ONLY: if the row was wrapped, do not apply CR/LF.
+            if (i < selectionRects.size() - 1 && (!lineSelection || !charRow.WasWrapForced()))
             {
-                // FOR LINE SELECTION ONLY: if the row was wrapped, do not apply CR/LF.
-                // a.k.a. if the row was NOT wrapped, then we can assume a CR/LF is proper
-                // always apply \r\n for box selection
-                if (!lineSelection || !GetRowByOffset(iRow).GetCharRow().WasWrapForced())
-                {
-                    COLORREF const Blackness = RGB(0x00, 0x00, 0x00); // cant see CR/LF so just use black FG & BK
-
-                    selectionText.push_back(UNICODE_CARRIAGERETURN);
-                    selectionText.push_back(UNICODE_LINEFEED);
-                    selectionFgAttr.push_back(Blackness);
-                    selectionFgAttr.push_back(Blackness);
-                    selectionBkAttr.push_back(Blackness);
-                    selectionBkAttr.push_back(Blackness);
-                }
+                data.text.push_back(UNICODE_CARRIAGERETURN);
+                data.text.push_back(UNICODE_LINEFEED);
             }
         }
 
-        data.text.emplace_back(std::move(selectionText));
-        data.FgAttr.emplace_back(std::move(selectionFgAttr));
-        data.BkAttr.emplace_back(std::move(selectionBkAttr));
+        data.rowEnds.push_back(data.text.size());
     }
 
     return data;
 }
 
 // Routine Description:
-// - Generates a CF_HTML compliant structure based on the passed in text and color data
+// - Generates a CF_HTML compliant structure from the text of a selection and
+//   the runs of its colors.
 // Arguments:
-// - rows - the text and color data we will format & encapsulate
+// - rows - the text and color runs we will format & encapsulate
 // - fontHeightPoints - the unscaled font height
 // - fontFaceName - the name of the font used
 // - htmlTitle - value used in title tag of html header. Used to name the application
 // Return Value:
 // - string containing the generated HTML
-std::string TextBuffer::GenHTML(const TextAndColor& rows, const int fontHeightPoints, const PCWCHAR fontFaceName, const std::string& htmlTitle)
+std::string TextBuffer::GenHTML(const TextAndColorRuns& rows, const int fontHeightPoints, const std::wstring_view fontFaceName, const std::string& htmlTitle)
 {
     try
     {
-        std::ostringstream htmlBuilder;
+        std::string html;
+        html.reserve(rows.text.size() + rows.runs.size() * 64 + 512);
 
         // First we have to add some standard
         // HTML boiler plate required for CF_HTML
         // as part of the HTML Clipboard format
         const std::string htmlHeader =
             "<!DOCTYPE><HTML><HEAD><TITLE>" + htmlTitle + "</TITLE></HEAD><BODY>";
-        htmlBuilder << htmlHeader;
-
-        htmlBuilder << "<!--StartFragment -->";
+        html += htmlHeader;
+        html += "<!--StartFragment -->";
 
         // apply global style in div element
-        {
-            htmlBuilder << "<DIV STYLE=\"";
-            htmlBuilder << "display:inline-block;";
-            htmlBuilder << "white-space:pre;";
-
-            // fixme: this is only walkaround for filling background after last char of row.
-            // It is based on first char of first row, not the actual char at correct position.
-            htmlBuilder << "background-color:";
-            const COLORREF globalBgColor = rows.BkAttr.at(0).at(0);
-            htmlBuilder << Utils::ColorToHexString(globalBgColor);
-            htmlBuilder << ";";
-
-            htmlBuilder << "font-family:";
-            if (fontFaceName[0] != '\0')
-            {
-                htmlBuilder << "'";
-                htmlBuilder << ConvertToA(CP_UTF8, fontFaceName);
-                htmlBuilder << "',";
-            }
-            // even with different font, add monospace as fallback
-            htmlBuilder << "monospace;";
-
-            htmlBuilder << "font-size:";
-            htmlBuilder << fontHeightPoints;
-            htmlBuilder << "pt;";
+        html += "<DIV STYLE=\"display:inline-block;white-space:pre;";
 
-            // note: MS Word doesn't support padding (in this way at least)
-            htmlBuilder << "padding:";
-            htmlBuilder << 4; // todo: customizable padding
-            htmlBuilder << "px;";
+        // fixme: this is only walkaround for filling background after last char of row.
+        // It is based on the first run, not the actual char at correct position.
+        html += "background-color:";
+        html += Utils::ColorToHexString(rows.runs.empty() ? RGB(0x00, 0x00, 0x00) : rows.runs.front().background);
+        html += ";";
 
-            htmlBuilder << "\">";
+        html += "font-family:";
+        if (!fontFaceName.empty())
+        {
+            html += "'";
+            html += ConvertToA(CP_UTF8, fontFaceName);
+            html += "',";
         }
+        // even with different font, add monospace as fallback
+        html += "monospace;";
+
+        html += "font-size:";
+        html += std::to_string(fontHeightPoints);
+        html += "pt;";
+
+        // note: MS Word doesn't support padding (in this way at least)
+        html += "padding:4px;"; // todo: customizable padding
+        html += "\">";
 
         // copy text and info color from buffer
         bool hasWrittenAnyText = false;
         std::optional<COLORREF> fgColor = std::nullopt;
         std::optional<COLORREF> bkColor = std::nullopt;
-        for (UINT row = 0; row < rows.text.size(); row++)
+        size_t textPos = 0;
+        auto run = rows.runs.cbegin();
+        for (size_t row = 0; row < rows.rowEnds.size(); ++row)
         {
-            size_t startOffset = 0;
-
             if (row != 0)
             {
-                htmlBuilder << "<BR>";
+                html += "<BR>";
             }
 
-            for (UINT col = 0; col < rows.text[row].length(); col++)
+            // do not include \r nor \n as they don't have attributes
+            // and are not HTML friendly. For line break use '<BR>' instead.
+            const auto rowEnd = rows.rowEnds[row];
+            auto contentEnd = rowEnd;
+            while (contentEnd > textPos && (rows.text[contentEnd - 1] == UNICODE_CARRIAGERETURN || rows.text[contentEnd - 1] == UNICODE_LINEFEED))
             {
-                // do not include \r nor \n as they don't have attributes
-                // and are not HTML friendly. For line break use '<BR>' instead.
-                bool isLastCharInRow =
-                    col == rows.text[row].length() - 1 ||
-                    rows.text[row][col + 1] == '\r' ||
-                    rows.text[row][col + 1] == '\n';
-
-                bool colorChanged = false;
-                if (!fgColor.has_value() || rows.FgAttr[row][col] != fgColor.value())
-                {
-                    fgColor = rows.FgAttr[row][col];
-                    colorChanged = true;
-                }
-
-                if (!bkColor.has_value() || rows.BkAttr[row][col] != bkColor.value())
-                {
-                    bkColor = rows.BkAttr[row][col];
-                    colorChanged = true;
-                }
-
-                const auto writeAccumulatedChars = [&](bool includeCurrent) {
-                    if (col > startOffset)
-                    {
-                        // note: this should be escaped (for '<', '>', and '&'),
-                        // however MS Word doesn't appear to support HTML entities
-                        htmlBuilder << ConvertToA(CP_UTF8, std::wstring_view(rows.text[row].data() + startOffset, col - startOffset + includeCurrent));
-                        startOffset = col;
-                    }
-                };
+                --contentEnd;
+            }
 
-                if (colorChanged)
+            for (; textPos < contentEnd && run != rows.runs.cend(); ++run)
+            {
+                if (fgColor != run->foreground || bkColor != run->background)
                 {
-                    writeAccumulatedChars(false);
+                    fgColor = run->foreground;
+                    bkColor = run->background;
 
                     if (hasWrittenAnyText)
                     {
-                        htmlBuilder << "</SPAN>";
+                        html += "</SPAN>";
                     }
 
-                    htmlBuilder << "<SPAN STYLE=\"";
-                    htmlBuilder << "color:";
-                    htmlBuilder << Utils::ColorToHexString(fgColor.value());
-                    htmlBuilder << ";";
-                    htmlBuilder << "background-color:";
-                    htmlBuilder << Utils::ColorToHexString(bkColor.value());
-                    htmlBuilder << ";";
-                    htmlBuilder << "\">";
+                    html += "<SPAN STYLE=\"color:";
+                    html += Utils::ColorToHexString(fgColor.value());
+                    html += ";background-color:";
+                    html += Utils::ColorToHexString(bkColor.value());
+                    html += ";\">";
                 }
 
+                // note: this should be escaped (for '<', '>', and '&'),
+                // however MS Word doesn't appear to support HTML entities
+                html += ConvertToA(CP_UTF8, std::wstring_view{ rows.text }.substr(textPos, run->length));
+                textPos += run->length;
                 hasWrittenAnyText = true;
-
-                if (isLastCharInRow)
-                {
-                    writeAccumulatedChars(true);
-                    break;
-                }
             }
+            textPos = rowEnd;
         }
 
         if (hasWrittenAnyText)
         {
             // last opened span wasn't closed in loop above, so close it now
-            htmlBuilder << "</SPAN>";
+            html += "</SPAN>";
         }
 
-        htmlBuilder << "</DIV>";
-
-        htmlBuilder << "<!--EndFragment -->";
+        html += "</DIV>";
+        html += "<!--EndFragment -->";
 
         constexpr std::string_view HtmlFooter = "</BODY></HTML>";
-        htmlBuilder << HtmlFooter;
+        html += HtmlFooter;
 
         // once filled with values, there will be exactly 157 bytes in the clipboard header
         constexpr size_t ClipboardHeaderSize = 157;
 
         // these values are byte offsets from start of clipboard
         const size_t htmlStartPos = ClipboardHeaderSize;
-        const size_t htmlEndPos = ClipboardHeaderSize + gsl::narrow<size_t>(htmlBuilder.tellp());
-        const size_t fragStartPos = ClipboardHeaderSize + gsl::narrow<size_t>(htmlHeader.length());
+        const size_t htmlEndPos = ClipboardHeaderSize + html.size();
+        const size_t fragStartPos = ClipboardHeaderSize + htmlHeader.length();
         const size_t fragEndPos = htmlEndPos - HtmlFooter.length();
 
         // header required by HTML 0.9 format
@@ -1212,7 +1410,114 @@ std::string TextBuffer::GenHTML(const TextAndColor& rows, const int fontHeightPo
         clipHeaderBuilder << "StartSelection:" << std::setw(10) << fragStartPos << "\r\n";
         clipHeaderBuilder << "EndSelection:" << std::setw(10) << fragEndPos << "\r\n";
 
-        return clipHeaderBuilder.str() + htmlBuilder.str();
+        return clipHeaderBuilder.str() + html;
+    }
+    catch (...)
+    {
+        LOG_HR(wil::ResultFromCaughtException());
+        return {};
+    }
+}
+
+// Routine Description:
+// - Appends text to RTF, escaping what has to be. Anything outside of ASCII
+//   is written as the UTF-16 code unit it is, with a '?' for readers that
+//   can't show it.
+static void _AppendRtfText(std::string& rtf, const std::wstring_view text)
+{
+    for (const auto wch : text)
+    {
+        if (wch == L'\\' || wch == L'{' || wch == L'}')
+        {
+            rtf += '\\';
+            rtf += static_cast<char>(wch);
+        }
+        else if (wch < 0x80)
+        {
+            rtf += static_cast<char>(wch);
+        }
+        else
+        {
+            rtf += "\\u";
+            rtf += std::to_string(static_cast<short>(wch));
+            rtf += '?';
+        }
+    }
+}
+
+// Routine Description:
+// - Generates RTF from the text of a selection and the runs of its colors, so
+//   that it keeps its colors when it's pasted into apps that don't take HTML.
+// Arguments:
+// - rows - the text and color runs we will format
+// - fontHeightPoints - the unscaled font height
+// - fontFaceName - the name of the font used
+// Return Value:
+// - string containing the generated RTF
+std::string TextBuffer::GenRTF(const TextAndColorRuns& rows, const int fontHeightPoints, const std::wstring_view fontFaceName)
+{
+    try
+    {
+        // RTF needs every color up front, in its color table. Index 0 is
+        // the reader's default, so the table starts at 1.
+        std::unordered_map<COLORREF, size_t> colorIndexes;
+        std::string colorTable;
+        const auto addColor = [&](const COLORREF color) {
+            if (colorIndexes.emplace(color, colorIndexes.size() + 1).second)
+            {
+                colorTable += "\\red" + std::to_string(GetRValue(color));
+                colorTable += "\\green" + std::to_string(GetGValue(color));
+                colorTable += "\\blue" + std::to_string(GetBValue(color)) + ";";
+            }
+        };
+        for (const auto& run : rows.runs)
+        {
+            addColor(run.foreground);
+            addColor(run.background);
+        }
+
+        std::string rtf;
+        rtf.reserve(rows.text.size() + rows.runs.size() * 48 + colorTable.size() + 256);
+
+        rtf += "{\\rtf1\\ansi\\ansicpg65001\\deff0\\uc1";
+        rtf += "{\\fonttbl{\\f0\\fmodern\\fprq1 ";
+        _AppendRtfText(rtf, fontFaceName.empty() ? std::wstring_view{ L"Consolas" } : fontFaceName);
+        rtf += ";}}";
+        rtf += "{\\colortbl ;" + colorTable + "}";
+
+        // font sizes are in half points
+        rtf += "\\f0\\fs" + std::to_string(fontHeightPoints * 2) + " ";
+
+        size_t textPos = 0;
+        auto run = rows.runs.cbegin();
+        for (size_t row = 0; row < rows.rowEnds.size(); ++row)
+        {
+            if (row != 0)
+            {
+                rtf += "\\line ";
+            }
+
+            const auto rowEnd = rows.rowEnds[row];
+            auto contentEnd = rowEnd;
+            while (contentEnd > textPos && (rows.text[contentEnd - 1] == UNICODE_CARRIAGERETURN || rows.text[contentEnd - 1] == UNICODE_LINEFEED))
+            {
+                --contentEnd;
+            }
+
+            for (; textPos < contentEnd && run != rows.runs.cend(); ++run)
+            {
+                const auto foreground = std::to_string(colorIndexes.at(run->foreground));
+                const auto background = std::to_string(colorIndexes.at(run->background));
+                rtf += "\\cf" + foreground + "\\chshdng0\\chcbpat" + background + "\\cb" + background + " ";
+
+                _AppendRtfText(rtf, std::wstring_view{ rows.text }.substr(textPos, run->length));
+                textPos += run->length;
+            }
+            textPos = rowEnd;
+        }
+
+        rtf += "}";
+        return rtf;
     }
     catch (...)
     {
@@ -51,6 +51,7 @@ filling in the last row, and updating the screen.
 
 #include "cursor.h"
 #include "Row.hpp"
+#include "RowSearchIndex.hpp"
 #include "TextAttribute.hpp"
 #include "UnicodeStorage.hpp"
 #include "../types/inc/Viewport.hpp"
@@ -85,6 +86,8 @@ public:
     TextBufferTextIterator GetTextLineDataAt(const COORD at) const;
     TextBufferTextIterator GetTextDataAt(const COORD at, const Microsoft::Console::Types::Viewport limit) const;
 
+    RowSearchIndex::Signature GetRowSearchSignature(const size_t index) const;
+
     // Text insertion functions
     OutputCellIterator Write(const OutputCellIterator givenIt);
 
@@ -104,6 +107,12 @@ public:
     // Scroll needs access to this to quickly rotate around the buffer.
     bool IncrementCircularBuffer();
 
+    size_t GetMemoryUsage() const noexcept;
+    size_t CompactMemoryUsage(const size_t limit, const SHORT firstKeptRow);
+    size_t TrimMemoryUsage(const size_t limit, const SHORT firstKeptRow);
+    [[nodiscard]] HRESULT DropOldestRows(const SHORT count, const SHORT newHeight) noexcept;
+    static size_t s_GetLeastRowMemoryUsage(const size_t width) noexcept;
+
     COORD GetLastNonSpaceCharacter() const;
     COORD GetLastNonSpaceCharacter(const Microsoft::Console::Types::Viewport viewport) const;
 
@@ -131,25 +140,42 @@ public:
 
     Microsoft::Console::Render::IRenderTarget& GetRenderTarget();
 
-    class TextAndColor
+    // The text of a selection, with its colors kept a run at a time. It's a
+    // copy of the buffer's text, so it can be turned into the clipboard's
+    // formats without holding its lock.
+    class TextAndColorRuns
     {
     public:
-        std::vector<std::wstring> text;
-        std::vector<std::vector<COLORREF>> FgAttr;
-        std::vector<std::vector<COLORREF>> BkAttr;
+        struct Run
+        {
+            size_t length; // in characters of text
+            COLORREF foreground;
+            COLORREF background;
+        };
+
+        // All the rows, one after another, each with its CR/LF (if it gets one).
+        std::wstring text;
+        // Cover the text of each row, but not its CR/LF.
+        std::vector<Run> runs;
+        // Where the text of each row ends, after its CR/LF.
+        std::vector<size_t> rowEnds;
     };
 
-    const TextAndColor GetTextForClipboard(const bool lineSelection,
-                                           const bool trimTrailingWhitespace,
-                                           const std::vector<SMALL_RECT>& selectionRects,
-                                           std::function<COLORREF(TextAttribute&)> GetForegroundColor,
-                                           std::function<COLORREF(TextAttribute&)> GetBackgroundColor) const;
+    const TextAndColorRuns GetTextRunsForClipboard(const bool lineSelection,
+                                                   const bool trimTrailingWhitespace,
+                                                   const std::vector<SMALL_RECT>& selectionRects,
+                                                   std::function<COLORREF(TextAttribute&)> GetForegroundColor,
+                                                   std::function<COLORREF(TextAttribute&)> GetBackgroundColor) const;
 
-    static std::string GenHTML(const TextAndColor& rows,
+    static std::string GenHTML(const TextAndColorRuns& rows,
                                const int fontHeightPoints,
-                               const PCWCHAR fontFaceName,
+                               const std::wstring_view fontFaceName,
                                const std::string& htmlTitle);
 
+    static std::string GenRTF(const TextAndColorRuns& rows,
+                              const int fontHeightPoints,
+                              const std::wstring_view fontFaceName);
+
 private:
     std::deque<ROW> _storage;
     Cursor _cursor;
@@ -161,7 +187,14 @@ private:
     // storage location for glyphs that can't fit into the buffer normally
     UnicodeStorage _unicodeStorage;
 
+    // how much memory the rows are using, kept up to date by the rows
+    size_t _rowsMemoryUsage;
+
+    // filled in as rows are searched, and emptied as they're written to
+    mutable RowSearchIndex _searchIndex;
+
     void _RefreshRowIDs(std::optional<SHORT> newRowWidth);
+    void _ResizeFromRow(const COORD newSize, const SHORT topRow);
 
     Microsoft::Console::Render::IRenderTarget& _renderTarget;
 
@@ -181,6 +214,9 @@ private:
     ROW& _GetFirstRow();
     ROW& _GetPrevRowNoWrap(const ROW& row);
 
+    void _MeasureRowsMemoryUsage() noexcept;
+    void _StripRowForMemory(ROW& row);
+
 #ifdef UNIT_TESTING
     friend class TextBufferTests;
     friend class UiaTextRangeTests;
@@ -0,0 +1,77 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "../RowSearchIndex.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+class RowSearchIndexTests
+{
+    TEST_CLASS(RowSearchIndexTests);
+
+    TEST_METHOD(SignatureOfTextContainsItsSubstrings)
+    {
+        const auto row = RowSearchIndex::s_Signature(L"error C2065: 'foo': undeclared identifier");
+
+        VERIFY_IS_TRUE(RowSearchIndex::s_MayContain(row, RowSearchIndex::s_Signature(L"undeclared")));
+        VERIFY_IS_TRUE(RowSearchIndex::s_MayContain(row, RowSearchIndex::s_Signature(L"C2065")));
+
+        Log::Comment(L"Case is folded, so the signature works for case insensitive searches.");
+        VERIFY_IS_TRUE(RowSearchIndex::s_MayContain(row, RowSearchIndex::s_Signature(L"ERROR")));
+
+        VERIFY_IS_FALSE(RowSearchIndex::s_MayContain(row, RowSearchIndex::s_Signature(L"warning")));
+    }
+
+    TEST_METHOD(ShortTextHasEmptySignature)
+    {
+        VERIFY_IS_TRUE(RowSearchIndex::s_IsEmpty(RowSearchIndex::s_Signature(L"")));
+        VERIFY_IS_TRUE(RowSearchIndex::s_IsEmpty(RowSearchIndex::s_Signature(L"ab")));
+        VERIFY_IS_FALSE(RowSearchIndex::s_IsEmpty(RowSearchIndex::s_Signature(L"abc")));
+    }
+
+    TEST_METHOD(InvalidateThrowsAwayRowAndRowAbove)
+    {
+        RowSearchIndex index{ 4 };
+        VERIFY_IS_NULL(index.TryGet(0));
+
+        const auto signature = RowSearchIndex::s_Signature(L"hello");
+        for (size_t row = 0; row < 4; ++row)
+        {
+            index.Set(row, signature);
+        }
+        VERIFY_IS_NOT_NULL(index.TryGet(0));
+
+        index.Invalidate(2);
+        VERIFY_IS_NOT_NULL(index.TryGet(0));
+        VERIFY_IS_NULL(index.TryGet(1));
+        VERIFY_IS_NULL(index.TryGet(2));
+        VERIFY_IS_NOT_NULL(index.TryGet(3));
+
+        Log::Comment(L"The row above the first one is the last one, like in the buffer.");
+        index.Invalidate(0);
+        VERIFY_IS_NULL(index.TryGet(0));
+        VERIFY_IS_NULL(index.TryGet(3));
+
+        index.Set(3, signature);
+        index.InvalidateAll();
+        VERIFY_IS_NULL(index.TryGet(3));
+    }
+
+    TEST_METHOD(ResizeThrowsAwayEverything)
+    {
+        RowSearchIndex index{ 2 };
+        index.Set(1, RowSearchIndex::s_Signature(L"hello"));
+
+        index.Resize(8);
+        VERIFY_IS_NULL(index.TryGet(1));
+
+        index.Set(7, RowSearchIndex::s_Signature(L"world"));
+        VERIFY_IS_NOT_NULL(index.TryGet(7));
+    }
+};
@@ -25,6 +25,7 @@ static constexpr std::string_view RequestedThemeKey{ "requestedTheme" };
 static constexpr std::string_view ShowTabsInTitlebarKey{ "showTabsInTitlebar" };
 static constexpr std::string_view WordDelimitersKey{ "wordDelimiters" };
 static constexpr std::string_view CopyOnSelectKey{ "copyOnSelect" };
+static constexpr std::string_view SharedHistoryMemoryLimitKey{ "sharedHistoryMemoryLimit" };
 
 static constexpr std::wstring_view LightThemeValue{ L"light" };
 static constexpr std::wstring_view DarkThemeValue{ L"dark" };
@@ -41,7 +42,8 @@ GlobalAppSettings::GlobalAppSettings() :
     _showTabsInTitlebar{ true },
     _requestedTheme{ ElementTheme::Default },
     _wordDelimiters{ DEFAULT_WORD_DELIMITERS },
-    _copyOnSelect{ false }
+    _copyOnSelect{ false },
+    _sharedHistoryMemoryLimit{ 0 }
 {
 }
 
@@ -129,6 +131,16 @@ void GlobalAppSettings::SetCopyOnSelect(const bool copyOnSelect) noexcept
     _copyOnSelect = copyOnSelect;
 }
 
+int32_t GlobalAppSettings::GetSharedHistoryMemoryLimit() const noexcept
+{
+    return _sharedHistoryMemoryLimit;
+}
+
+void GlobalAppSettings::SetSharedHistoryMemoryLimit(const int32_t sharedHistoryMemoryLimit) noexcept
+{
+    _sharedHistoryMemoryLimit = sharedHistoryMemoryLimit;
+}
+
 #pragma region ExperimentalSettings
 bool GlobalAppSettings::GetShowTabsInTitlebar() const noexcept
 {
@@ -154,6 +166,7 @@ void GlobalAppSettings::ApplyToSettings(TerminalSettings& settings) const noexce
     settings.InitialCols(_initialCols);
     settings.WordDelimiters(_wordDelimiters);
     settings.CopyOnSelect(_copyOnSelect);
+    settings.SharedHistoryMemoryLimit(_sharedHistoryMemoryLimit);
 }
 
 // Method Description:
@@ -174,6 +187,7 @@ Json::Value GlobalAppSettings::ToJson() const
     jsonObject[JsonKey(ShowTabsInTitlebarKey)] = _showTabsInTitlebar;
     jsonObject[JsonKey(WordDelimitersKey)] = winrt::to_string(_wordDelimiters);
     jsonObject[JsonKey(CopyOnSelectKey)] = _copyOnSelect;
+    jsonObject[JsonKey(SharedHistoryMemoryLimitKey)] = _sharedHistoryMemoryLimit;
     jsonObject[JsonKey(RequestedThemeKey)] = winrt::to_string(_SerializeTheme(_requestedTheme));
     jsonObject[JsonKey(KeybindingsKey)] = AppKeyBindingsSerialization::ToJson(_keybindings);
 
@@ -229,6 +243,11 @@ GlobalAppSettings GlobalAppSettings::FromJson(const Json::Value& json)
         result._copyOnSelect = copyOnSelect.asBool();
     }
 
+    if (auto sharedHistoryMemoryLimit{ json[JsonKey(SharedHistoryMemoryLimitKey)] })
+    {
+        result._sharedHistoryMemoryLimit = sharedHistoryMemoryLimit.asInt();
+    }
+
     if (auto requestedTheme{ json[JsonKey(RequestedThemeKey)] })
     {
         result._requestedTheme = _ParseTheme(GetWstringFromJson(requestedTheme));
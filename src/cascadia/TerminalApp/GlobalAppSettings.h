@@ -53,6 +53,9 @@ public:
     bool GetCopyOnSelect() const noexcept;
     void SetCopyOnSelect(const bool copyOnSelect) noexcept;
 
+    int32_t GetSharedHistoryMemoryLimit() const noexcept;
+    void SetSharedHistoryMemoryLimit(const int32_t sharedHistoryMemoryLimit) noexcept;
+
     winrt::Windows::UI::Xaml::ElementTheme GetRequestedTheme() const noexcept;
 
     Json::Value ToJson() const;
@@ -76,6 +79,7 @@ private:
     bool _showTabsInTitlebar;
     std::wstring _wordDelimiters;
     bool _copyOnSelect;
+    int32_t _sharedHistoryMemoryLimit;
     winrt::Windows::UI::Xaml::ElementTheme _requestedTheme;
 
     static winrt::Windows::UI::Xaml::ElementTheme _ParseTheme(const std::wstring& themeString) noexcept;
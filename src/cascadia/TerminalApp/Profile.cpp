@@ -21,6 +21,7 @@ static constexpr std::string_view BackgroundKey{ "background" };
 static constexpr std::string_view ColorTableKey{ "colorTable" };
 static constexpr std::string_view TabTitleKey{ "tabTitle" };
 static constexpr std::string_view HistorySizeKey{ "historySize" };
+static constexpr std::string_view HistoryMemoryLimitKey{ "historyMemoryLimit" };
 static constexpr std::string_view SnapOnInputKey{ "snapOnInput" };
 static constexpr std::string_view CursorColorKey{ "cursorColor" };
 static constexpr std::string_view CursorShapeKey{ "cursorShape" };
@@ -85,6 +86,7 @@ Profile::Profile(const winrt::guid& guid) :
     _colorTable{},
     _tabTitle{},
     _historySize{ DEFAULT_HISTORY_SIZE },
+    _historyMemoryLimit{},
     _snapOnInput{ true },
     _cursorColor{ DEFAULT_CURSOR_COLOR },
     _cursorShape{ CursorStyle::Bar },
@@ -156,6 +158,10 @@ TerminalSettings Profile::CreateTerminalSettings(const std::vector<ColorScheme>&
         terminalSettings.SetColorTableEntry(i, _colorTable[i]);
     }
     terminalSettings.HistorySize(_historySize);
+    if (_historyMemoryLimit)
+    {
+        terminalSettings.HistoryMemoryLimit(_historyMemoryLimit.value());
+    }
     terminalSettings.SnapOnInput(_snapOnInput);
     terminalSettings.CursorColor(_cursorColor);
     terminalSettings.CursorHeight(_cursorHeight);
@@ -269,6 +275,10 @@ Json::Value Profile::ToJson() const
         root[JsonKey(ColorTableKey)] = tableArray;
     }
     root[JsonKey(HistorySizeKey)] = _historySize;
+    if (_historyMemoryLimit)
+    {
+        root[JsonKey(HistoryMemoryLimitKey)] = _historyMemoryLimit.value();
+    }
     root[JsonKey(SnapOnInputKey)] = _snapOnInput;
     root[JsonKey(CursorColorKey)] = Utils::ColorToHexString(_cursorColor);
     // Only add the cursor height property if we're a legacy-style cursor.
@@ -408,6 +418,10 @@ Profile Profile::FromJson(const Json::Value& json)
         // TODO:MSFT:20642297 - Use a sentinel value (-1) for "Infinite scrollback"
         result._historySize = historySize.asInt();
     }
+    if (auto historyMemoryLimit{ json[JsonKey(HistoryMemoryLimitKey)] })
+    {
+        result._historyMemoryLimit = historyMemoryLimit.asInt();
+    }
     if (auto snapOnInput{ json[JsonKey(SnapOnInputKey)] })
     {
         result._snapOnInput = snapOnInput.asBool();
@@ -85,6 +85,7 @@ private:
     std::array<uint32_t, COLOR_TABLE_SIZE> _colorTable;
     std::optional<std::wstring> _tabTitle;
     int32_t _historySize;
+    std::optional<int32_t> _historyMemoryLimit;
     bool _snapOnInput;
     uint32_t _cursorColor;
     uint32_t _cursorHeight;
@@ -996,8 +996,9 @@ namespace winrt::TerminalApp::implementation
     }
 
     // Method Description:
-    // - Place `copiedData` into the clipboard as text. Triggered when a
-    //   terminal control raises it's CopyToClipboard event.
+    // - Place `copiedData` into the clipboard as text, HTML and RTF. Triggered
+    //   when a terminal control raises it's CopyToClipboard event, which might
+    //   not be on the UI thread.
     // Arguments:
     // - copiedData: the new string content to place on the clipboard.
     void TerminalPage::_CopyToClipboardHandler(const IInspectable& /*sender*/,
@@ -1017,6 +1018,13 @@ namespace winrt::TerminalApp::implementation
                 dataPack.SetHtmlFormat(htmlData);
             }
 
+            // copy rtf to dataPack
+            const auto rtfData = copiedData.Rtf();
+            if (!rtfData.empty())
+            {
+                dataPack.SetRtf(rtfData);
+            }
+
             try
             {
                 Clipboard::SetContent(dataPack);
@@ -0,0 +1,321 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+// TerminalBenchmark replays captured output through a Terminal that isn't
+// attached to anything: there's no window, no renderer and no connection, just
+// the parser and the buffer. It reports how fast the output went through, how
+// long each chunk of it took, and how much memory that needed, so changes to
+// the core can be measured on a build machine.
+//
+// Usage: TerminalBenchmark [options] <capture file>...
+//   --width <columns>      width of the terminal (default 120)
+//   --height <rows>        height of the terminal (default 30)
+//   --scrollback <rows>    rows of scrollback (default 9001)
+//   --chunk <characters>   how much is written at a time (default 4096)
+//   --iterations <count>   how many times each file is replayed (default 5)
+//
+// A capture file is the raw UTF-8 output of a program, as a connection would
+// read it, e.g. what `script` records, or the output of a command redirected to
+// a file. Each line of the report is one file, tab separated:
+//   file  bytes  MB/s  p50 us  p99 us  max us  peak working set KB
+//
+// Each file is replayed in a process of its own (this program again, run with
+// --child), since a process's peak working set only ever goes up: measured in
+// one process, every file after the biggest would report the biggest's peak.
+
+#include "precomp.h"
+
+#include "../TerminalCore/Terminal.hpp"
+#include "../TerminalCore/LatencyHistogram.hpp"
+#include "../../renderer/inc/DummyRenderTarget.hpp"
+
+using namespace Microsoft::Terminal::Core;
+
+struct Options
+{
+    COORD size{ 120, 30 };
+    SHORT scrollback{ 9001 };
+    size_t chunk{ 4096 };
+    unsigned int iterations{ 5 };
+    bool child{ false };
+    std::vector<std::wstring> files;
+};
+
+struct Result
+{
+    size_t bytes;
+    double megabytesPerSecond;
+    LatencyHistogram latency;
+    size_t peakWorkingSet;
+};
+
+static void PrintUsage()
+{
+    fwprintf(stderr,
+             L"Usage: TerminalBenchmark [--width <columns>] [--height <rows>] [--scrollback <rows>]\n"
+             L"                         [--chunk <characters>] [--iterations <count>] <capture file>...\n");
+}
+
+// Routine Description:
+// - Reads the options from the command line.
+// Arguments:
+// - argc, argv: the command line
+// - options: receives the options
+// Return Value:
+// - false if the command line wasn't understood.
+static bool ParseArguments(const int argc, const wchar_t* const argv[], Options& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::wstring_view arg{ argv[i] };
+        if (arg == L"--child")
+        {
+            options.child = true;
+        }
+        else if (arg.size() > 2 && arg.substr(0, 2) == L"--")
+        {
+            if (i + 1 >= argc)
+            {
+                return false;
+            }
+
+            const auto value = wcstoul(argv[++i], nullptr, 10);
+            if (value == 0 || value > SHRT_MAX)
+            {
+                return false;
+            }
+
+            if (arg == L"--width")
+            {
+                options.size.X = gsl::narrow<SHORT>(value);
+            }
+            else if (arg == L"--height")
+            {
+                options.size.Y = gsl::narrow<SHORT>(value);
+            }
+            else if (arg == L"--scrollback")
+            {
+                options.scrollback = gsl::narrow<SHORT>(value);
+            }
+            else if (arg == L"--chunk")
+            {
+                options.chunk = value;
+            }
+            else if (arg == L"--iterations")
+            {
+                options.iterations = value;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        else
+        {
+            options.files.emplace_back(arg);
+        }
+    }
+
+    return !options.files.empty();
+}
+
+// Routine Description:
+// - Reads a capture file and decodes it to the UTF-16 a connection would hand
+//   the terminal.
+// Arguments:
+// - path: the file to read
+// - bytes: receives the size of the file
+// Return Value:
+// - The text of the file.
+// Note:
+// - will throw exception on error
+static std::wstring ReadCapture(const std::wstring& path, size_t& bytes)
+{
+    wil::unique_hfile file{ CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr) };
+    THROW_LAST_ERROR_IF(!file);
+
+    LARGE_INTEGER size{};
+    THROW_IF_WIN32_BOOL_FALSE(GetFileSizeEx(file.get(), &size));
+    THROW_HR_IF(E_OUTOFMEMORY, size.QuadPart > INT_MAX);
+
+    std::string utf8(gsl::narrow<size_t>(size.QuadPart), '\0');
+    DWORD read = 0;
+    THROW_IF_WIN32_BOOL_FALSE(ReadFile(file.get(), utf8.data(), gsl::narrow<DWORD>(utf8.size()), &read, nullptr));
+    utf8.resize(read);
+    bytes = utf8.size();
+
+    std::wstring text;
+    if (!utf8.empty())
+    {
+        const auto length = MultiByteToWideChar(CP_UTF8, 0, utf8.data(), gsl::narrow<int>(utf8.size()), nullptr, 0);
+        THROW_LAST_ERROR_IF(length == 0);
+        text.resize(length);
+        THROW_LAST_ERROR_IF(MultiByteToWideChar(CP_UTF8, 0, utf8.data(), gsl::narrow<int>(utf8.size()), text.data(), length) == 0);
+    }
+    return text;
+}
+
+// Routine Description:
+// - Writes some text through a new terminal a chunk at a time, the way the
+//   control does with what it reads from its connection.
+// Arguments:
+// - options: the size of the terminal, and of the chunks
+// - text: the text to write
+// - latency: every chunk's time is recorded in here
+// Return Value:
+// - How long it took to write all of the text.
+static std::chrono::steady_clock::duration Replay(const Options& options, const std::wstring_view text, LatencyHistogram& latency)
+{
+    Terminal terminal;
+    DummyRenderTarget renderTarget;
+    terminal.Create(options.size, options.scrollback, renderTarget);
+
+    const auto start = std::chrono::steady_clock::now();
+    auto chunkStart = start;
+    for (size_t offset = 0; offset < text.size();)
+    {
+        // Like the control, don't split a surrogate pair between two writes.
+        auto length = std::min(options.chunk, text.size() - offset);
+        if (offset + length < text.size() && IS_HIGH_SURROGATE(text[offset + length - 1]))
+        {
+            ++length;
+        }
+
+        terminal.Write(text.substr(offset, length));
+        offset += length;
+
+        const auto chunkEnd = std::chrono::steady_clock::now();
+        latency.Record(std::chrono::duration_cast<std::chrono::microseconds>(chunkEnd - chunkStart));
+        chunkStart = chunkEnd;
+    }
+    return chunkStart - start;
+}
+
+// Routine Description:
+// - Replays a capture file as many times as asked.
+// Arguments:
+// - options: how to replay it
+// - path: the capture file
+// Return Value:
+// - The measurements. The throughput is the best of the iterations, which is
+//   the least disturbed by whatever else the machine was doing, and the
+//   latencies are of every chunk of every iteration.
+// Note:
+// - will throw exception on error
+static Result Benchmark(const Options& options, const std::wstring& path)
+{
+    Result result{};
+    const auto text = ReadCapture(path, result.bytes);
+
+    auto best = std::chrono::steady_clock::duration::max();
+    for (unsigned int i = 0; i < options.iterations; ++i)
+    {
+        best = std::min(best, Replay(options, text, result.latency));
+    }
+
+    const auto seconds = std::chrono::duration<double>(best).count();
+    result.megabytesPerSecond = seconds > 0 ? result.bytes / (1024.0 * 1024.0) / seconds : 0;
+
+    PROCESS_MEMORY_COUNTERS counters{};
+    counters.cb = sizeof(counters);
+    THROW_IF_WIN32_BOOL_FALSE(GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)));
+    result.peakWorkingSet = counters.PeakWorkingSetSize;
+
+    return result;
+}
+
+// Routine Description:
+// - Benchmarks a capture file in a new process of this program, so that the
+//   peak working set reported for it is its own. The process writes its line
+//   of the report to the same output as this one.
+// Arguments:
+// - options: how to replay it
+// - path: the capture file
+// Return Value:
+// - The exit code of the process.
+// Note:
+// - will throw exception on error
+static DWORD BenchmarkInChildProcess(const Options& options, const std::wstring& path)
+{
+    const auto self = wil::GetModuleFileNameW<std::wstring>(nullptr);
+    std::wstring commandLine = L"\"" + self + L"\" --child";
+    commandLine += L" --width " + std::to_wstring(options.size.X);
+    commandLine += L" --height " + std::to_wstring(options.size.Y);
+    commandLine += L" --scrollback " + std::to_wstring(options.scrollback);
+    commandLine += L" --chunk " + std::to_wstring(options.chunk);
+    commandLine += L" --iterations " + std::to_wstring(options.iterations);
+    commandLine += L" \"" + path + L"\"";
+
+    STARTUPINFOW startupInfo{};
+    startupInfo.cb = sizeof(startupInfo);
+    startupInfo.dwFlags = STARTF_USESTDHANDLES;
+    startupInfo.hStdInput = GetStdHandle(STD_INPUT_HANDLE);
+    startupInfo.hStdOutput = GetStdHandle(STD_OUTPUT_HANDLE);
+    startupInfo.hStdError = GetStdHandle(STD_ERROR_HANDLE);
+
+    // Anything this process has written has to come out before the child's line.
+    fflush(stdout);
+    fflush(stderr);
+
+    wil::unique_process_information processInfo;
+    THROW_IF_WIN32_BOOL_FALSE(CreateProcessW(self.c_str(), commandLine.data(), nullptr, nullptr, TRUE, 0, nullptr, nullptr, &startupInfo, &processInfo));
+    THROW_LAST_ERROR_IF(WaitForSingleObject(processInfo.hProcess, INFINITE) != WAIT_OBJECT_0);
+
+    DWORD exitCode = 0;
+    THROW_IF_WIN32_BOOL_FALSE(GetExitCodeProcess(processInfo.hProcess, &exitCode));
+    return exitCode;
+}
+
+int __cdecl wmain(int argc, wchar_t* argv[])
+{
+    Options options;
+    if (!ParseArguments(argc, argv, options))
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    int exitCode = 0;
+    if (!options.child)
+    {
+        wprintf(L"file\tbytes\tMB/s\tp50 us\tp99 us\tmax us\tpeak working set KB\n");
+        for (const auto& file : options.files)
+        {
+            try
+            {
+                if (BenchmarkInChildProcess(options, file) != 0)
+                {
+                    exitCode = 1;
+                }
+            }
+            catch (...)
+            {
+                fwprintf(stderr, L"%ls: failed with 0x%08x\n", file.c_str(), static_cast<unsigned int>(wil::ResultFromCaughtException()));
+                exitCode = 1;
+            }
+        }
+        return exitCode;
+    }
+
+    for (const auto& file : options.files)
+    {
+        try
+        {
+            const auto result = Benchmark(options, file);
+            wprintf(L"%ls\t%zu\t%.1f\t%lld\t%lld\t%lld\t%zu\n",
+                    file.c_str(),
+                    result.bytes,
+                    result.megabytesPerSecond,
+                    result.latency.Percentile(50).count(),
+                    result.latency.Percentile(99).count(),
+                    result.latency.Max().count(),
+                    result.peakWorkingSet / 1024);
+        }
+        catch (...)
+        {
+            fwprintf(stderr, L"%ls: failed with 0x%08x\n", file.c_str(), static_cast<unsigned int>(wil::ResultFromCaughtException()));
+            exitCode = 1;
+        }
+    }
+    return exitCode;
+}
@@ -122,6 +122,15 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
 
         THROW_LAST_ERROR_IF_NULL(_hOutputThread);
 
+        _hDispatchThread.reset(CreateThread(nullptr,
+                                            0,
+                                            StaticDispatchThreadProc,
+                                            this,
+                                            0,
+                                            nullptr));
+
+        THROW_LAST_ERROR_IF_NULL(_hDispatchThread);
+
         _connected = true;
     }
 
@@ -166,11 +175,21 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
             _inPipe.reset();
             _outPipe.reset();
 
+            // The output thread might be waiting for room in the queue.
+            {
+                std::lock_guard<std::mutex> lock{ _outputLock };
+                _outputDispatched.notify_all();
+            }
+
             // Tear down our output thread -- now that the output pipe was closed on the
             // far side, we can run down our local reader.
             WaitForSingleObject(_hOutputThread.get(), INFINITE);
             _hOutputThread.reset();
 
+            // The output thread ended the output on its way out, so this stops too.
+            WaitForSingleObject(_hDispatchThread.get(), INFINITE);
+            _hDispatchThread.reset();
+
             // Wait for conhost to terminate.
             WaitForSingleObject(_piConhost.hProcess, INFINITE);
 
@@ -188,26 +207,28 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
     DWORD ConhostConnection::_OutputThread()
     {
         UTF8OutPipeReader pipeReader{ _outPipe.get() };
-        std::string_view strView{};
+        std::wstring_view wstrView{};
 
         // process the data of the output pipe in a loop
         while (true)
         {
-            HRESULT result = pipeReader.Read(strView);
+            HRESULT result = pipeReader.Read(wstrView);
             if (FAILED(result) || result == S_FALSE)
             {
                 if (_closing.load())
                 {
                     // This is okay, break out to kill the thread
+                    _EndOutput(false);
                     return 0;
                 }
 
-                _disconnectHandlers();
+                _EndOutput(true);
                 return (DWORD)-1;
             }
 
-            if (strView.empty())
+            if (wstrView.empty())
             {
+                _EndOutput(false);
                 return 0;
             }
 
@@ -226,13 +247,83 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
                 _recievedFirstByte = true;
             }
 
-            // Convert buffer to hstring
-            auto hstr{ winrt::to_hstring(strView) };
+            // Queue the output up for the dispatch thread, once there's room for it.
+            std::unique_lock<std::mutex> lock{ _outputLock };
+            _outputDispatched.wait(lock, [&]() { return _queuedOutput.size() < _maxQueuedOutput || _closing.load(); });
+            if (_closing.load())
+            {
+                lock.unlock();
+                _EndOutput(false);
+                return 0;
+            }
 
-            // Pass the output to our registered event handlers
-            _outputHandlers(hstr);
+            const bool wasEmpty = _queuedOutput.empty();
+            _queuedOutput.append(wstrView);
+            if (wasEmpty)
+            {
+                _outputQueued.notify_one();
+            }
         }
 
         return 0;
     }
+
+    // Method Description:
+    // - Tells the dispatch thread that there won't be any more output, once it's
+    //   passed on what's already been queued.
+    // Arguments:
+    // - disconnected: true if the output ended because the connection broke,
+    //   rather than because it was closed.
+    void ConhostConnection::_EndOutput(const bool disconnected)
+    {
+        std::lock_guard<std::mutex> lock{ _outputLock };
+        _outputEnded = true;
+        _outputDisconnected = disconnected;
+        _outputQueued.notify_one();
+    }
+
+    DWORD WINAPI ConhostConnection::StaticDispatchThreadProc(LPVOID lpParameter)
+    {
+        ConhostConnection* const pInstance = (ConhostConnection*)lpParameter;
+        return pInstance->_DispatchThread();
+    }
+
+    // Method Description:
+    // - Hands the queued output to our registered event handlers. Everything
+    //   that was queued while the handlers were busy with the last batch goes
+    //   out as one batch, so a flood of output is written to the terminal (and
+    //   its lock taken) a few times, instead of once for every read.
+    DWORD ConhostConnection::_DispatchThread()
+    {
+        // The batches are swapped in and out of the queue, so that the two
+        // strings' buffers are reused rather than allocated each time.
+        std::wstring batch;
+
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock{ _outputLock };
+                _outputQueued.wait(lock, [&]() { return !_queuedOutput.empty() || _outputEnded; });
+                if (_queuedOutput.empty() || _closing.load())
+                {
+                    const bool disconnected = _outputDisconnected;
+                    lock.unlock();
+
+                    if (disconnected)
+                    {
+                        _disconnectHandlers();
+                        return (DWORD)-1;
+                    }
+                    return 0;
+                }
+
+                batch.clear();
+                batch.swap(_queuedOutput);
+                _outputDispatched.notify_one();
+            }
+
+            // Pass the output to our registered event handlers
+            _outputHandlers(hstring{ batch });
+        }
+    }
 }
@@ -5,6 +5,8 @@
 
 #include "ConhostConnection.g.h"
 
+#include <condition_variable>
+
 namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
 {
     struct ConhostConnection : ConhostConnectionT<ConhostConnection>
@@ -42,11 +44,28 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
         wil::unique_hfile _outPipe; // The pipe for reading output from
         wil::unique_hfile _signalPipe;
         wil::unique_handle _hOutputThread;
+        wil::unique_handle _hDispatchThread;
         wil::unique_process_information _piConhost;
         wil::unique_handle _hJob;
 
+        // The output thread queues up what it reads here, and the dispatch
+        // thread hands everything that's queued to the output handlers in one
+        // go. When the handlers fall behind, the queue fills up and the output
+        // thread waits, which stops it reading from the pipe, which in turn
+        // holds up the client.
+        static constexpr size_t _maxQueuedOutput{ 1024 * 1024 };
+        std::mutex _outputLock;
+        std::condition_variable _outputQueued;
+        std::condition_variable _outputDispatched;
+        std::wstring _queuedOutput;
+        bool _outputEnded{ false };
+        bool _outputDisconnected{ false };
+
         static DWORD WINAPI StaticOutputThreadProc(LPVOID lpParameter);
         DWORD _OutputThread();
+        static DWORD WINAPI StaticDispatchThreadProc(LPVOID lpParameter);
+        DWORD _DispatchThread();
+        void _EndOutput(const bool disconnected);
     };
 }
 
@@ -32,6 +32,11 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         _initializedTerminal{ false },
         _root{ nullptr },
         _swapChainPanel{ nullptr },
+        _outputRing{ 256 * 1024 },
+        _outputMarks{ 4096 },
+        _outputQueuedCount{ 0 },
+        _outputQueuedEvent{ wil::EventOptions::None },
+        _outputParsedEvent{ wil::EventOptions::None },
         _settings{ settings },
         _closing{ false },
         _lastScrollOffset{ std::nullopt },
@@ -441,8 +446,12 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         THROW_IF_FAILED(dxEngine->Enable());
         _renderEngine = std::move(dxEngine);
 
+        _lastOutputLatencyReport = std::chrono::steady_clock::now();
+        _hParseThread.reset(CreateThread(nullptr, 0, _StaticParseThreadProc, this, 0, nullptr));
+        THROW_LAST_ERROR_IF_NULL(_hParseThread);
+
         auto onRecieveOutputFn = [this](const hstring str) {
-            _terminal->Write(str.c_str());
+            _QueueOutput(str);
         };
         _connectionOutputEventToken = _connection.TerminalOutput(onRecieveOutputFn);
 
@@ -748,6 +757,7 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
             // macro directly with a VirtualKeyModifiers
             const auto altEnabled = WI_IsFlagSet(modifiers, static_cast<uint32_t>(VirtualKeyModifiers::Menu));
             const auto shiftEnabled = WI_IsFlagSet(modifiers, static_cast<uint32_t>(VirtualKeyModifiers::Shift));
+            const auto ctrlEnabled = WI_IsFlagSet(modifiers, static_cast<uint32_t>(VirtualKeyModifiers::Control));
 
             if (point.Properties().IsLeftButtonPressed())
             {
@@ -771,7 +781,15 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
                 }
                 else if (multiClickMapper == 2)
                 {
-                    _terminal->DoubleClickSelection(terminalPosition);
+                    // CTRL selects the whole URL or path, instead of a word of it
+                    if (ctrlEnabled)
+                    {
+                        _terminal->SemanticUnitSelection(terminalPosition);
+                    }
+                    else
+                    {
+                        _terminal->DoubleClickSelection(terminalPosition);
+                    }
                     _renderer->TriggerSelection();
                 }
                 else
@@ -1191,6 +1209,10 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         }
         _focused = true;
 
+        // Memory for the shared history limit is taken from the terminals
+        // that have been focused least recently first.
+        ::Microsoft::Terminal::Core::MemoryGovernor::Instance().NoteViewed(*_terminal);
+
         if (_cursorTimer.has_value())
         {
             _cursorTimer.value().Start();
@@ -1221,6 +1243,36 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         _connection.WriteInput(wstr);
     }
 
+    // Method Description:
+    // - Sends pasted text to the connection, all in one write. If the
+    //      connected application enabled bracketed paste mode, the text is
+    //      wrapped in ESC[200~ and ESC[201~, so the application can tell
+    //      it apart from typed keys and take it in as a single block.
+    // Arguments:
+    // - wstr: the text to paste
+    void TermControl::_SendPastedTextToConnection(const std::wstring& wstr)
+    {
+        bool bracketedPaste;
+        {
+            auto lock = _terminal->LockForReading();
+            bracketedPaste = _terminal->IsBracketedPasteModeEnabled();
+        }
+
+        if (bracketedPaste)
+        {
+            std::wstring bracketed;
+            bracketed.reserve(wstr.size() + 12);
+            bracketed.append(L"\x1b[200~");
+            bracketed.append(wstr);
+            bracketed.append(L"\x1b[201~");
+            _connection.WriteInput(bracketed);
+        }
+        else
+        {
+            _connection.WriteInput(wstr);
+        }
+    }
+
     // Method Description:
     // - Update the font with the renderer. This will be called either when the
     //      font changes or the DPI changes, as DPI changes will necessitate a
@@ -1424,37 +1476,56 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         {
             return false;
         }
-        // extract text from buffer
-        const auto bufferData = _terminal->RetrieveSelectedTextFromBuffer(trimTrailingWhitespace);
-
-        // convert text: vector<string> --> string
-        std::wstring textData;
-        for (const auto& text : bufferData.text)
+        // extract a snapshot of the selection from the buffer, while nothing can write to it
+        TextBuffer::TextAndColorRuns bufferData;
         {
-            textData += text;
+            auto lock = _terminal->LockForReading();
+            bufferData = _terminal->RetrieveSelectedTextRunsFromBuffer(trimTrailingWhitespace);
         }
 
-        // convert text to HTML format
-        const auto htmlData = TextBuffer::GenHTML(bufferData, _actualFont.GetUnscaledSize().Y, _actualFont.GetFaceName(), "Windows Terminal");
-
         if (!_terminal->IsCopyOnSelectActive())
         {
             _terminal->ClearSelection();
         }
 
-        // send data up for clipboard
-        auto copyArgs = winrt::make_self<CopyToClipboardEventArgs>(winrt::hstring(textData.data(), gsl::narrow<winrt::hstring::size_type>(textData.size())), winrt::to_hstring(htmlData));
-        _clipboardCopyHandlers(*this, *copyArgs);
+        _CopyToClipboardAsync(std::move(bufferData), _actualFont.GetUnscaledSize().Y, std::wstring{ _actualFont.GetFaceName() });
         return true;
     }
 
+    // Method Description:
+    // - Formats a snapshot of the selection as HTML and RTF, off of the UI
+    //   thread, then sends it up for the clipboard along with its text.
+    // Arguments:
+    // - bufferData: the text of the selection, and the runs of its colors
+    // - fontHeightPoints: the unscaled height of the font
+    // - fontFaceName: the name of the font
+    winrt::fire_and_forget TermControl::_CopyToClipboardAsync(::TextBuffer::TextAndColorRuns bufferData, const int fontHeightPoints, std::wstring fontFaceName)
+    {
+        auto weakThis{ get_weak() };
+
+        co_await winrt::resume_background();
+
+        // convert text to HTML and RTF formats
+        const auto htmlData = TextBuffer::GenHTML(bufferData, fontHeightPoints, fontFaceName, "Windows Terminal");
+        const auto rtfData = TextBuffer::GenRTF(bufferData, fontHeightPoints, fontFaceName);
+
+        if (auto control{ weakThis.get() })
+        {
+            // send data up for clipboard
+            auto copyArgs = winrt::make_self<CopyToClipboardEventArgs>(winrt::hstring(bufferData.text.data(), gsl::narrow<winrt::hstring::size_type>(bufferData.text.size())),
+                                                                       winrt::to_hstring(htmlData),
+                                                                       winrt::to_hstring(rtfData));
+            control->_clipboardCopyHandlers(*control, *copyArgs);
+        }
+    }
+
     // Method Description:
     // - Initiate a paste operation.
     void TermControl::PasteTextFromClipboard()
     {
-        // attach TermControl::_SendInputToConnection() as the clipboardDataHandler.
+        // attach TermControl::_SendPastedTextToConnection() as the clipboardDataHandler.
         // This is called when the clipboard data is loaded.
-        auto clipboardDataHandler = std::bind(&TermControl::_SendInputToConnection, this, std::placeholders::_1);
+        auto clipboardDataHandler = std::bind(&TermControl::_SendPastedTextToConnection, this, std::placeholders::_1);
         auto pasteArgs = winrt::make_self<PasteFromClipboardEventArgs>(clipboardDataHandler);
 
         // send paste event up to TermApp
@@ -1468,6 +1539,16 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
             // Stop accepting new output before we disconnect everything.
             _connection.TerminalOutput(_connectionOutputEventToken);
 
+            // Wake the parse thread, and anything waiting on it for room in
+            // the ring, so that they see we're closing.
+            _outputQueuedEvent.SetEvent();
+            _outputParsedEvent.SetEvent();
+            if (_hParseThread)
+            {
+                WaitForSingleObject(_hParseThread.get(), INFINITE);
+                _hParseThread.reset();
+            }
+
             // Clear out the cursor timer, so it doesn't trigger again on us once we're destructed.
             if (auto localCursorTimer{ std::exchange(_cursorTimer, std::nullopt) })
             {
@@ -1505,6 +1586,130 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         }
     }
 
+    // Method Description:
+    // - Queues output from the connection for the parse thread. If the ring is
+    //   full, this waits for the parse thread to make room, which holds up the
+    //   connection (and, through it, the client).
+    // Arguments:
+    // - text: the output to queue
+    void TermControl::_QueueOutput(std::wstring_view text)
+    {
+        const auto queuedAt = std::chrono::steady_clock::now();
+        while (!text.empty() && !_closing.load())
+        {
+            const auto pushed = _outputRing.Push({ text.data(), gsl::narrow<ptrdiff_t>(text.size()) });
+            if (pushed != 0)
+            {
+                _outputQueuedCount += pushed;
+
+                // If there are too many marks waiting already, this one's
+                // dropped. That only costs a sample in the latency histogram.
+                const OutputMark mark{ _outputQueuedCount, queuedAt };
+                _outputMarks.Push({ &mark, 1 });
+
+                _outputQueuedEvent.SetEvent();
+                text = text.substr(pushed);
+            }
+
+            if (!text.empty())
+            {
+                WaitForSingleObject(_outputParsedEvent.get(), INFINITE);
+            }
+        }
+    }
+
+    DWORD WINAPI TermControl::_StaticParseThreadProc(LPVOID lpParameter)
+    {
+        const auto pInstance = reinterpret_cast<TermControl*>(lpParameter);
+        return pInstance->_ParseThread();
+    }
+
+    // Method Description:
+    // - Takes output out of the ring and parses it into the terminal, a slice
+    //   at a time. The terminal's lock is only held while a slice is parsed, so
+    //   the renderer and input get a look in between slices.
+    DWORD TermControl::_ParseThread()
+    {
+        std::vector<wchar_t> slice(16 * 1024);
+        size_t carried = 0;
+        uint64_t popped = 0;
+
+        while (!_closing.load())
+        {
+            const auto count = _outputRing.Pop({ slice.data() + carried, gsl::narrow<ptrdiff_t>(slice.size() - carried) });
+            if (count == 0)
+            {
+                WaitForSingleObject(_outputQueuedEvent.get(), INFINITE);
+                continue;
+            }
+
+            // There's room in the ring again.
+            _outputParsedEvent.SetEvent();
+            popped += count;
+
+            // Don't split a surrogate pair between two slices: hold the
+            // leading half back until the next one.
+            auto length = carried + count;
+            carried = IS_HIGH_SURROGATE(slice[length - 1]) ? 1 : 0;
+            length -= carried;
+
+            if (length != 0)
+            {
+                try
+                {
+                    _terminal->Write({ slice.data(), length });
+                }
+                CATCH_LOG();
+            }
+
+            if (carried != 0)
+            {
+                slice[0] = slice[length];
+            }
+
+            _RecordOutputLatency(popped - carried);
+        }
+
+        return 0;
+    }
+
+    // Method Description:
+    // - Records how long the chunks of output that have now been parsed waited
+    //   to be, and every so often, reports the percentiles.
+    // Arguments:
+    // - parsedCount: how many characters have been parsed in all
+    void TermControl::_RecordOutputLatency(const uint64_t parsedCount)
+    {
+        const auto now = std::chrono::steady_clock::now();
+        for (auto mark = _outputMarks.Front(); mark && mark->end <= parsedCount; mark = _outputMarks.Front())
+        {
+            _outputLatency.Record(std::chrono::duration_cast<std::chrono::microseconds>(now - mark->queuedAt));
+            _outputMarks.PopFront();
+        }
+
+        if (_outputLatency.Count() != 0 && now - _lastOutputLatencyReport >= std::chrono::seconds(10))
+        {
+            const auto parse = _terminal->GetParseMetrics();
+            const auto backlog = (_outputRing.Size() + parse.backlog) * sizeof(wchar_t);
+
+            TraceLoggingWrite(g_hTerminalControlProvider,
+                              "OutputLatency",
+                              TraceLoggingDescription("How long output from the connection waited to be parsed into the buffer"),
+                              TraceLoggingUInt64(_outputLatency.Count(), "Chunks"),
+                              TraceLoggingInt64(_outputLatency.Percentile(50).count(), "P50Microseconds"),
+                              TraceLoggingInt64(_outputLatency.Percentile(99).count(), "P99Microseconds"),
+                              TraceLoggingInt64(_outputLatency.Max().count(), "MaxMicroseconds"),
+                              TraceLoggingUInt64(parse.slices, "ParseSlices"),
+                              TraceLoggingUInt64(parse.slicesOverBudget, "ParseSlicesOverBudget"),
+                              TraceLoggingUInt64(backlog, "BacklogBytes"),
+                              TraceLoggingKeyword(MICROSOFT_KEYWORD_MEASURES),
+                              TelemetryPrivacyDataTag(PDT_ProductAndServicePerformance));
+
+            _outputLatency.Reset();
+            _lastOutputLatencyReport = now;
+        }
+    }
+
     void TermControl::ScrollViewport(int viewTop)
     {
         _terminal->UserScrollViewport(viewTop);
@@ -1539,6 +1744,19 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         return viewPort.Height();
     }
 
+    // Method Description:
+    // - Gets how much memory this control's buffer is using, history and all.
+    // Return Value:
+    // - The number of bytes, or 0 if the terminal hasn't been set up yet.
+    uint64_t TermControl::BufferMemoryUsage()
+    {
+        if (!_initializedTerminal)
+        {
+            return 0;
+        }
+        return _terminal->GetBufferMemoryUsage();
+    }
+
     // Function Description:
     // - Determines how much space (in pixels) an app would need to reserve to
     //   create a control with the settings stored in the settings param. This
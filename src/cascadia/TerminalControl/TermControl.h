@@ -11,6 +11,9 @@
 #include "../../renderer/base/Renderer.hpp"
 #include "../../renderer/dx/DxRenderer.hpp"
 #include "../../cascadia/TerminalCore/Terminal.hpp"
+#include "../../cascadia/TerminalCore/SpscRing.hpp"
+#include "../../cascadia/TerminalCore/LatencyHistogram.hpp"
+#include "../../cascadia/TerminalCore/MemoryGovernor.hpp"
 #include "../../cascadia/inc/cppwinrt_utils.h"
 
 namespace winrt::Microsoft::Terminal::TerminalControl::implementation
@@ -19,16 +22,19 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         public CopyToClipboardEventArgsT<CopyToClipboardEventArgs>
     {
     public:
-        CopyToClipboardEventArgs(hstring text, hstring html) :
+        CopyToClipboardEventArgs(hstring text, hstring html, hstring rtf) :
             _text(text),
-            _html(html) {}
+            _html(html),
+            _rtf(rtf) {}
 
         hstring Text() { return _text; };
         hstring Html() { return _html; };
+        hstring Rtf() { return _rtf; };
 
     private:
         hstring _text;
         hstring _html;
+        hstring _rtf;
     };
 
     struct PasteFromClipboardEventArgs :
@@ -67,6 +73,7 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         void KeyboardScrollViewport(int viewTop);
         int GetScrollOffset();
         int GetViewHeight() const;
+        uint64_t BufferMemoryUsage();
 
         void SwapChainChanged();
         ~TermControl();
@@ -100,6 +107,27 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
 
         std::unique_ptr<::Microsoft::Terminal::Core::Terminal> _terminal;
 
+        // Output from the connection is queued in _outputRing on whichever
+        // thread the connection raises its events on, and parsed into the
+        // terminal on _hParseThread. Reading from the connection never waits
+        // for the terminal's lock; it only waits when the ring is full.
+        struct OutputMark
+        {
+            uint64_t end; // how many characters had been queued, up to the end of the chunk
+            std::chrono::steady_clock::time_point queuedAt;
+        };
+        ::Microsoft::Terminal::Core::SpscRing<wchar_t> _outputRing;
+        ::Microsoft::Terminal::Core::SpscRing<OutputMark> _outputMarks;
+        uint64_t _outputQueuedCount;
+        wil::unique_event _outputQueuedEvent;
+        wil::unique_event _outputParsedEvent;
+        wil::unique_handle _hParseThread;
+
+        // How long output waits in the ring before it's in the buffer. Only
+        // touched by the parse thread.
+        ::Microsoft::Terminal::Core::LatencyHistogram _outputLatency;
+        std::chrono::steady_clock::time_point _lastOutputLatencyReport;
+
         std::unique_ptr<::Microsoft::Console::Render::Renderer> _renderer;
         std::unique_ptr<::Microsoft::Console::Render::DxEngine> _renderEngine;
 
@@ -163,6 +191,12 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         void _BlinkCursor(Windows::Foundation::IInspectable const& sender, Windows::Foundation::IInspectable const& e);
         void _SetEndSelectionPointAtCursor(Windows::Foundation::Point const& cursorPosition);
         void _SendInputToConnection(const std::wstring& wstr);
+        void _SendPastedTextToConnection(const std::wstring& wstr);
+        winrt::fire_and_forget _CopyToClipboardAsync(::TextBuffer::TextAndColorRuns bufferData, const int fontHeightPoints, std::wstring fontFaceName);
+        void _QueueOutput(std::wstring_view text);
+        static DWORD WINAPI _StaticParseThreadProc(LPVOID lpParameter);
+        DWORD _ParseThread();
+        void _RecordOutputLatency(const uint64_t parsedCount);
         void _SwapChainSizeChanged(Windows::Foundation::IInspectable const& sender, Windows::UI::Xaml::SizeChangedEventArgs const& e);
         void _SwapChainScaleChanged(Windows::UI::Xaml::Controls::SwapChainPanel const& sender, Windows::Foundation::IInspectable const& args);
         void _DoResize(const double newWidth, const double newHeight);
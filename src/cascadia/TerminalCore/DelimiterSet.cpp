@@ -0,0 +1,113 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include "DelimiterSet.hpp"
+
+using namespace Microsoft::Terminal::Core;
+
+// Routine Description:
+// - Works out the set of delimiters in a string.
+// Arguments:
+// - delimiters - every delimiter, one after another
+// Note:
+// - will throw exception on error
+DelimiterSet::DelimiterSet(const std::wstring_view delimiters) :
+    _delimiters{ delimiters }
+{
+    for (const auto wch : delimiters)
+    {
+        if (wch < 0x100)
+        {
+            _bitmap[wch / 64] |= 1ull << (wch % 64);
+        }
+        else
+        {
+            _wideDelimiters.push_back(wch);
+        }
+    }
+
+    std::sort(_wideDelimiters.begin(), _wideDelimiters.end());
+    _wideDelimiters.erase(std::unique(_wideDelimiters.begin(), _wideDelimiters.end()), _wideDelimiters.end());
+}
+
+// Routine Description:
+// - Checks if a character is one of the delimiters.
+bool DelimiterSet::Contains(const wchar_t wch) const noexcept
+{
+    if (wch < 0x100)
+    {
+        return (_bitmap[wch / 64] >> (wch % 64)) & 1;
+    }
+    return std::binary_search(_wideDelimiters.cbegin(), _wideDelimiters.cend(), wch);
+}
+
+// Routine Description:
+// - Checks if the glyph in a cell is one of the delimiters.
+// Arguments:
+// - glyph - the text of the cell
+// Return Value:
+// - true if it's a delimiter.
+bool DelimiterSet::Contains(const std::wstring_view glyph) const noexcept
+{
+    if (glyph.size() == 1)
+    {
+        return Contains(glyph.front());
+    }
+    return !glyph.empty() && _delimiters.find(glyph) != std::wstring::npos;
+}
+
+// Routine Description:
+// - Finds the last delimiter in a row, at or before a column.
+// Arguments:
+// - charRow - the cells of the row
+// - column - the column to start looking from
+// Return Value:
+// - The column of the delimiter, or npos if there isn't one.
+// Note:
+// - will throw exception on error
+size_t DelimiterSet::FindLast(const CharRow& charRow, const size_t column) const
+{
+    for (auto x = std::min(column + 1, charRow.size()); x != 0; --x)
+    {
+        if (_IsDelimiterAt(charRow, x - 1))
+        {
+            return x - 1;
+        }
+    }
+    return std::wstring::npos;
+}
+
+// Routine Description:
+// - Finds the first delimiter in a row, at or after a column.
+// Arguments:
+// - charRow - the cells of the row
+// - column - the column to start looking from
+// Return Value:
+// - The column of the delimiter, or npos if there isn't one.
+// Note:
+// - will throw exception on error
+size_t DelimiterSet::FindFirst(const CharRow& charRow, const size_t column) const
+{
+    for (auto x = column; x < charRow.size(); ++x)
+    {
+        if (_IsDelimiterAt(charRow, x))
+        {
+            return x;
+        }
+    }
+    return std::wstring::npos;
+}
+
+// Routine Description:
+// - Checks if the cell at a column of a row is a delimiter. Only a glyph that
+//   didn't fit in the cell has to be looked up in the unicode storage.
+bool DelimiterSet::_IsDelimiterAt(const CharRow& charRow, const size_t column) const
+{
+    const auto& cell = *(charRow.cbegin() + column);
+    if (!cell.DbcsAttr().IsGlyphStored())
+    {
+        return Contains(cell.Char());
+    }
+    return Contains(std::wstring_view{ charRow.GlyphAt(column) });
+}
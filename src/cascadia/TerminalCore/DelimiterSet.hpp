@@ -0,0 +1,47 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- DelimiterSet.hpp
+
+Abstract:
+- A set of delimiters (like the wordDelimiters setting), worked out once when
+  the setting is loaded, so that checking a cell against it doesn't search
+  the setting's string.
+- Delimiters below U+0100 are kept in a bitmap. Any others are kept sorted,
+  and binary searched, since there's rarely more than a handful of them.
+- The cells of a row are scanned straight out of its CharRow, without making
+  a cell iterator (or a copy of the text) for each of them.
+--*/
+
+#pragma once
+
+#include <array>
+
+#include "../../buffer/out/CharRow.hpp"
+
+namespace Microsoft::Terminal::Core
+{
+    class DelimiterSet final
+    {
+    public:
+        DelimiterSet() = default;
+        explicit DelimiterSet(const std::wstring_view delimiters);
+
+        bool Contains(const wchar_t wch) const noexcept;
+        bool Contains(const std::wstring_view glyph) const noexcept;
+
+        size_t FindLast(const CharRow& charRow, const size_t column) const;
+        size_t FindFirst(const CharRow& charRow, const size_t column) const;
+
+    private:
+        bool _IsDelimiterAt(const CharRow& charRow, const size_t column) const;
+
+        std::array<uint64_t, 4> _bitmap{};
+        std::vector<wchar_t> _wideDelimiters;
+        // Delimiters that take more than one wchar_t (surrogate pairs) can
+        // only be found by searching the setting itself.
+        std::wstring _delimiters;
+    };
+}
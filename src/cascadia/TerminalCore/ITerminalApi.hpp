@@ -38,5 +38,7 @@ namespace Microsoft::Terminal::Core
 
         virtual bool SetDefaultForeground(const DWORD dwColor) = 0;
         virtual bool SetDefaultBackground(const DWORD dwColor) = 0;
+
+        virtual bool SetBracketedPasteMode(const bool enabled) = 0;
     };
 }
@@ -0,0 +1,75 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include "LatencyHistogram.hpp"
+
+using namespace Microsoft::Terminal::Core;
+
+// Routine Description:
+// - Counts one latency into its bucket.
+// Arguments:
+// - latency - how long something took
+void LatencyHistogram::Record(const std::chrono::microseconds latency) noexcept
+{
+    const auto value = gsl::narrow_cast<uint64_t>(std::max<int64_t>(latency.count(), 0));
+
+    // Bucket n holds the values from 2^n up to 2^(n+1), except that bucket 0
+    // holds 0 as well, and the last bucket holds everything past it.
+    size_t bucket = 0;
+    for (auto remaining = value >> 1; remaining != 0 && bucket < _bucketCount - 1; remaining >>= 1)
+    {
+        ++bucket;
+    }
+
+    ++_buckets[bucket];
+    ++_count;
+    _max = std::max(_max, latency);
+}
+
+void LatencyHistogram::Reset() noexcept
+{
+    _buckets.fill(0);
+    _count = 0;
+    _max = std::chrono::microseconds{ 0 };
+}
+
+size_t LatencyHistogram::Count() const noexcept
+{
+    return _count;
+}
+
+std::chrono::microseconds LatencyHistogram::Max() const noexcept
+{
+    return _max;
+}
+
+// Routine Description:
+// - Works out a percentile of the recorded latencies, to the top of the bucket
+//   it falls in (but never more than the largest latency recorded).
+// Arguments:
+// - percentile - the percentile to work out, from 0 to 100
+// Return Value:
+// - The latency, or 0 if nothing's been recorded.
+std::chrono::microseconds LatencyHistogram::Percentile(const double percentile) const noexcept
+{
+    if (_count == 0)
+    {
+        return std::chrono::microseconds{ 0 };
+    }
+
+    const auto clamped = std::clamp(percentile, 0.0, 100.0);
+    const auto rank = std::max<size_t>(1, gsl::narrow_cast<size_t>(std::ceil(clamped / 100.0 * _count)));
+
+    size_t seen = 0;
+    for (size_t bucket = 0; bucket < _bucketCount; ++bucket)
+    {
+        seen += _buckets[bucket];
+        if (seen >= rank)
+        {
+            const std::chrono::microseconds top{ (2ll << bucket) - 1 };
+            return std::min(top, _max);
+        }
+    }
+    return _max;
+}
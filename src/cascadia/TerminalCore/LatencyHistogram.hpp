@@ -0,0 +1,37 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- LatencyHistogram.hpp
+
+Abstract:
+- Counts latencies into buckets that double in size (under 2us, 2-4us, 4-8us
+  and so on), so that recording one is a couple of instructions and the whole
+  histogram is a few hundred bytes, however many are recorded.
+- Percentiles are worked out to the top of the bucket they fall in, so they're
+  never more than twice the real value.
+--*/
+
+#pragma once
+
+namespace Microsoft::Terminal::Core
+{
+    class LatencyHistogram final
+    {
+    public:
+        void Record(const std::chrono::microseconds latency) noexcept;
+        void Reset() noexcept;
+
+        size_t Count() const noexcept;
+        std::chrono::microseconds Max() const noexcept;
+        std::chrono::microseconds Percentile(const double percentile) const noexcept;
+
+    private:
+        static constexpr size_t _bucketCount{ 32 };
+
+        std::array<size_t, _bucketCount> _buckets{};
+        size_t _count{ 0 };
+        std::chrono::microseconds _max{ 0 };
+    };
+}
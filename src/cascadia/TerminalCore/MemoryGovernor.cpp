@@ -0,0 +1,155 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include "MemoryGovernor.hpp"
+#include "Terminal.hpp"
+
+using namespace Microsoft::Terminal::Core;
+
+// Routine Description:
+// - Gets the governor that every Terminal in the process shares.
+MemoryGovernor& MemoryGovernor::Instance()
+{
+    static MemoryGovernor instance;
+    return instance;
+}
+
+// Routine Description:
+// - Starts keeping a terminal's buffer under the shared limit. It counts as
+//   having just been looked at.
+// Arguments:
+// - terminal - the terminal to keep track of
+// Return Value:
+// - <none>
+// Note:
+// - will throw exception on error
+void MemoryGovernor::Register(Terminal& terminal)
+{
+    std::lock_guard<std::mutex> guard{ _mutex };
+    _entries.push_back({ &terminal, std::chrono::steady_clock::now(), 0 });
+}
+
+// Routine Description:
+// - Stops keeping track of a terminal, before it's destroyed.
+// Arguments:
+// - terminal - the terminal to forget about
+void MemoryGovernor::Unregister(const Terminal& terminal) noexcept
+{
+    std::lock_guard<std::mutex> guard{ _mutex };
+    _entries.erase(std::remove_if(_entries.begin(),
+                                  _entries.end(),
+                                  [&](const auto& entry) { return entry.terminal == &terminal; }),
+                   _entries.end());
+}
+
+// Routine Description:
+// - Makes a note that a terminal has just been looked at, so that memory is
+//   taken from it only after every terminal that's been looked at less
+//   recently.
+// Arguments:
+// - terminal - the terminal that's been looked at
+void MemoryGovernor::NoteViewed(const Terminal& terminal) noexcept
+{
+    std::lock_guard<std::mutex> guard{ _mutex };
+    for (auto& entry : _entries)
+    {
+        if (entry.terminal == &terminal)
+        {
+            entry.lastViewed = std::chrono::steady_clock::now();
+        }
+    }
+}
+
+// Routine Description:
+// - Sets how many bytes the buffers of all the terminals may use between
+//   them. It's only enforced the next time the governor rebalances.
+// Arguments:
+// - limit - the number of bytes, or 0 for no limit
+void MemoryGovernor::SetLimit(const size_t limit) noexcept
+{
+    _limit.store(limit);
+}
+
+size_t MemoryGovernor::GetLimit() const noexcept
+{
+    return _limit.load();
+}
+
+// Routine Description:
+// - Gets how many bytes the buffers of all the terminals are using between
+//   them, as of the last time each of them was measured.
+size_t MemoryGovernor::GetUsage() const
+{
+    std::lock_guard<std::mutex> guard{ _mutex };
+    size_t usage = 0;
+    for (const auto& entry : _entries)
+    {
+        usage += entry.terminal->GetLastBufferMemoryUsage();
+    }
+    return usage;
+}
+
+// Routine Description:
+// - Brings the buffers of all the terminals back under the shared limit, if
+//   they're over it, by trimming the history of the one looked at least
+//   recently first (see Terminal::TrimBufferMemory). Once compacting it isn't
+//   enough, its oldest lines are dropped.
+// - This has to be called without holding any terminal's lock.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+// Note:
+// - will throw exception on error
+void MemoryGovernor::Rebalance()
+{
+    const auto limit = _limit.load();
+    if (limit == 0)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> guard{ _mutex };
+
+    size_t usage = 0;
+    for (const auto& entry : _entries)
+    {
+        usage += entry.terminal->GetLastBufferMemoryUsage();
+    }
+    if (usage <= limit)
+    {
+        return;
+    }
+
+    std::vector<Entry*> leastRecentlyViewed;
+    leastRecentlyViewed.reserve(_entries.size());
+    for (auto& entry : _entries)
+    {
+        leastRecentlyViewed.push_back(&entry);
+    }
+    std::stable_sort(leastRecentlyViewed.begin(),
+                     leastRecentlyViewed.end(),
+                     [](const auto lhs, const auto rhs) { return lhs->lastViewed < rhs->lastViewed; });
+
+    for (const auto entry : leastRecentlyViewed)
+    {
+        if (usage <= limit)
+        {
+            break;
+        }
+
+        const auto before = entry->terminal->GetLastBufferMemoryUsage();
+        if (before <= entry->floor)
+        {
+            continue;
+        }
+
+        const auto excess = usage - limit;
+        const auto target = before > excess ? before - excess : 0;
+        const auto after = entry->terminal->TrimBufferMemory(target);
+
+        entry->floor = after > target ? after : 0;
+        usage -= before - std::min(before, after);
+    }
+}
@@ -0,0 +1,61 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- MemoryGovernor.hpp
+
+Abstract:
+- Keeps the buffers of every Terminal in the process under one shared memory
+  limit, so that a window full of panes and tabs can't grow without bound.
+- Every Terminal registers itself when it's constructed. When the buffers
+  between them are using more than the limit, memory is taken back from the
+  Terminal that was looked at least recently first, and only from the next one
+  once that one has nothing left to give. Its history's oldest rows are
+  compacted, and if that isn't enough, the history is made shorter, dropping
+  its oldest lines (see Terminal::TrimBufferMemory).
+- The governor's lock is never held by anything that holds a Terminal's lock,
+  so it's safe for it to take a Terminal's lock while holding its own.
+--*/
+
+#pragma once
+
+#include <mutex>
+
+namespace Microsoft::Terminal::Core
+{
+    class Terminal;
+
+    class MemoryGovernor final
+    {
+    public:
+        static MemoryGovernor& Instance();
+
+        void Register(Terminal& terminal);
+        void Unregister(const Terminal& terminal) noexcept;
+        void NoteViewed(const Terminal& terminal) noexcept;
+
+        void SetLimit(const size_t limit) noexcept;
+        size_t GetLimit() const noexcept;
+        size_t GetUsage() const;
+
+        void Rebalance();
+
+    private:
+        struct Entry
+        {
+            Terminal* terminal;
+            std::chrono::steady_clock::time_point lastViewed;
+            // What the terminal's buffer was still using after the last time
+            // it couldn't be trimmed as far as it was asked to. It isn't asked
+            // again until it's grown past this.
+            size_t floor;
+        };
+
+        // The number of bytes all the buffers may use, or 0 for no limit.
+        std::atomic<size_t> _limit{ 0 };
+
+        mutable std::mutex _mutex;
+        std::vector<Entry> _entries;
+    };
+}
@@ -0,0 +1,132 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- SpscRing.hpp
+
+Abstract:
+- A fixed size ring buffer that passes items from one thread (the producer)
+  to exactly one other thread (the consumer) without taking a lock.
+- The producer only ever moves the tail, and the consumer only ever moves the
+  head. Each publishes its move with a release store, and reads the other's
+  with an acquire load, so the items between them are always safe to touch.
+- The positions count up forever, and are wrapped into the buffer with a mask,
+  so the capacity has to be a power of two.
+- Neither side ever waits. A producer that finds the ring full (or a consumer
+  that finds it empty) has to decide for itself how to wait for the other.
+--*/
+
+#pragma once
+
+namespace Microsoft::Terminal::Core
+{
+    template<typename T>
+    class SpscRing final
+    {
+    public:
+        explicit SpscRing(const size_t capacity) :
+            _items(capacity),
+            _mask(capacity - 1)
+        {
+            FAIL_FAST_IF(capacity == 0 || (capacity & _mask) != 0);
+        }
+
+        size_t Capacity() const noexcept
+        {
+            return _items.size();
+        }
+
+        // Routine Description:
+        // - Gets the number of items in the ring. It's only a snapshot: the
+        //   other thread can change it at any time.
+        size_t Size() const noexcept
+        {
+            const auto head = _head.load(std::memory_order_acquire);
+            const auto tail = _tail.load(std::memory_order_acquire);
+            return tail - head;
+        }
+
+        // Routine Description:
+        // - Copies as many of the items into the ring as there's room for.
+        //   Only the producer may call this.
+        // Arguments:
+        // - items - the items to add
+        // Return Value:
+        // - The number of items that were added, from the start of items.
+        size_t Push(const gsl::span<const T> items) noexcept
+        {
+            const auto tail = _tail.load(std::memory_order_relaxed);
+            const auto head = _head.load(std::memory_order_acquire);
+            const auto count = std::min(gsl::narrow_cast<size_t>(items.size()), _items.size() - (tail - head));
+
+            _CopyIn(items.data(), count, tail);
+            _tail.store(tail + count, std::memory_order_release);
+            return count;
+        }
+
+        // Routine Description:
+        // - Moves as many items out of the ring as will fit. Only the consumer
+        //   may call this.
+        // Arguments:
+        // - items - where to put the items
+        // Return Value:
+        // - The number of items that were taken, now at the start of items.
+        size_t Pop(const gsl::span<T> items) noexcept
+        {
+            const auto head = _head.load(std::memory_order_relaxed);
+            const auto tail = _tail.load(std::memory_order_acquire);
+            const auto count = std::min(gsl::narrow_cast<size_t>(items.size()), tail - head);
+
+            _CopyOut(head, count, items.data());
+            _head.store(head + count, std::memory_order_release);
+            return count;
+        }
+
+        // Routine Description:
+        // - Gets the item at the front of the ring without taking it. Only the
+        //   consumer may call this.
+        // Return Value:
+        // - The item at the front, or nullptr if the ring is empty.
+        const T* Front() const noexcept
+        {
+            const auto head = _head.load(std::memory_order_relaxed);
+            const auto tail = _tail.load(std::memory_order_acquire);
+            return head == tail ? nullptr : &_items[head & _mask];
+        }
+
+        // Routine Description:
+        // - Takes the item at the front of the ring, which must be there. Only
+        //   the consumer may call this.
+        void PopFront() noexcept
+        {
+            const auto head = _head.load(std::memory_order_relaxed);
+            _head.store(head + 1, std::memory_order_release);
+        }
+
+    private:
+        void _CopyIn(const T* source, const size_t count, const size_t position) noexcept
+        {
+            const auto start = position & _mask;
+            const auto first = std::min(count, _items.size() - start);
+            std::copy_n(source, first, _items.begin() + start);
+            std::copy_n(source + first, count - first, _items.begin());
+        }
+
+        void _CopyOut(const size_t position, const size_t count, T* dest) const noexcept
+        {
+            const auto start = position & _mask;
+            const auto first = std::min(count, _items.size() - start);
+            std::copy_n(_items.cbegin() + start, first, dest);
+            std::copy_n(_items.cbegin(), count - first, dest + first);
+        }
+
+        std::vector<T> _items;
+        const size_t _mask;
+
+        // The head and tail are written by different threads, so they're kept
+        // on different cache lines.
+        alignas(64) std::atomic<size_t> _head{ 0 };
+        alignas(64) std::atomic<size_t> _tail{ 0 };
+    };
+}
@@ -5,6 +5,7 @@
 #include "Terminal.hpp"
 #include "../../terminal/parser/OutputStateMachineEngine.hpp"
 #include "TerminalDispatch.hpp"
+#include "MemoryGovernor.hpp"
 #include "../../inc/unicode.hpp"
 #include "../../inc/DefaultSettings.h"
 #include "../../inc/argb.h"
@@ -43,12 +44,20 @@ Terminal::Terminal() :
     _pfnWriteInput{ nullptr },
     _scrollOffset{ 0 },
     _snapOnInput{ true },
+    _bracketedPasteMode{ false },
     _boxSelection{ false },
     _selectionActive{ false },
     _allowSingleCharSelection{ false },
     _copyOnSelect{ false },
     _selectionAnchor{ 0, 0 },
-    _endSelectionPosition{ 0, 0 }
+    _endSelectionPosition{ 0, 0 },
+    _semanticUnitDelimiters{ s_SemanticUnitDelimiters },
+    _parseSlices{ 0 },
+    _parseSlicesOverBudget{ 0 },
+    _parseBacklog{ 0 },
+    _scrollNotificationPending{ false },
+    _historyMemoryLimit{ 0 },
+    _bufferMemoryUsage{ 0 }
 {
     _stateMachine = std::make_unique<StateMachine>(new OutputStateMachineEngine(new TerminalDispatch(*this)));
 
@@ -64,6 +73,13 @@ Terminal::Terminal() :
     _terminalInput = std::make_unique<TerminalInput>(passAlongInput);
 
     _InitializeColorTable();
+
+    MemoryGovernor::Instance().Register(*this);
+}
+
+Terminal::~Terminal()
+{
+    MemoryGovernor::Instance().Unregister(*this);
 }
 
 void Terminal::Create(COORD viewportSize, SHORT scrollbackLines, IRenderTarget& renderTarget)
@@ -75,6 +91,7 @@ void Terminal::Create(COORD viewportSize, SHORT scrollbackLines, IRenderTarget&
     const TextAttribute attr{};
     const UINT cursorSize = 12;
     _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, renderTarget);
+    _bufferMemoryUsage = _buffer->GetMemoryUsage();
 }
 
 // Method Description:
@@ -87,8 +104,19 @@ void Terminal::CreateFromSettings(winrt::Microsoft::Terminal::Settings::ICoreSet
 {
     const COORD viewportSize{ Utils::ClampToShortMax(settings.InitialCols(), 1),
                               Utils::ClampToShortMax(settings.InitialRows(), 1) };
+
     // TODO:MSFT:20642297 - Support infinite scrollback here, if HistorySize is -1
-    Create(viewportSize, Utils::ClampToShortMax(settings.HistorySize(), 0), renderTarget);
+    auto scrollbackLines = Utils::ClampToShortMax(settings.HistorySize(), 0);
+
+    // A memory limit (in MB) takes the place of the number of lines.
+    const auto historyMemoryLimitMB = gsl::narrow_cast<size_t>(std::max(settings.HistoryMemoryLimit(), 0));
+    _historyMemoryLimit = std::min(historyMemoryLimitMB, SIZE_MAX >> 20) << 20;
+    if (_historyMemoryLimit != 0)
+    {
+        scrollbackLines = _GetScrollbackLinesForMemoryLimit(viewportSize, _historyMemoryLimit);
+    }
+
+    Create(viewportSize, scrollbackLines, renderTarget);
 
     UpdateSettings(settings);
 }
@@ -135,10 +163,15 @@ void Terminal::UpdateSettings(winrt::Microsoft::Terminal::Settings::ICoreSetting
 
     _snapOnInput = settings.SnapOnInput();
 
-    _wordDelimiters = settings.WordDelimiters();
+    _wordDelimiters = DelimiterSet{ settings.WordDelimiters() };
 
     _copyOnSelect = settings.CopyOnSelect();
 
+    // The shared limit is the same for every terminal, it's just passed along
+    // with each of their settings.
+    const auto sharedHistoryMemoryLimitMB = gsl::narrow_cast<size_t>(std::max(settings.SharedHistoryMemoryLimit(), 0));
+    MemoryGovernor::Instance().SetLimit(std::min(sharedHistoryMemoryLimitMB, SIZE_MAX >> 20) << 20);
+
     // TODO:MSFT:21327402 - if HistorySize has changed, resize the buffer so we
     // have a smaller scrollback. We should do this carefully - if the new buffer
     // size is smaller than where the mutable viewport currently is, we'll want
@@ -164,6 +197,13 @@ void Terminal::UpdateSettings(winrt::Microsoft::Terminal::Settings::ICoreSetting
 
     const auto oldTop = _mutableViewport.Top();
 
+    // The width of a row decides how much memory it needs, so with a memory
+    // limit, the number of lines that fit changes with it.
+    if (_historyMemoryLimit != 0)
+    {
+        _scrollbackLines = _GetScrollbackLinesForMemoryLimit(viewportSize, _historyMemoryLimit);
+    }
+
     const short newBufferHeight = viewportSize.Y + _scrollbackLines;
     COORD bufferSize{ viewportSize.X, newBufferHeight };
     RETURN_IF_FAILED(_buffer->ResizeTraditional(bufferSize));
@@ -180,16 +220,91 @@ void Terminal::UpdateSettings(winrt::Microsoft::Terminal::Settings::ICoreSetting
 
     _mutableViewport = Viewport::FromDimensions({ 0, proposedTop }, viewportSize);
     _scrollOffset = 0;
+    _bufferMemoryUsage = _buffer->GetMemoryUsage();
     _NotifyScrollEvent();
 
     return S_OK;
 }
 
+// Method Description:
+// - Parses some text into the buffer. It's done a slice at a time, and the
+//   write lock is let go of between slices, so that a large write doesn't keep
+//   the renderer (or anything else that needs the lock) waiting until it's all
+//   been parsed.
+// Arguments:
+// - stringView: the text to parse
+// Return Value:
+// - <none>
 void Terminal::Write(std::wstring_view stringView)
+{
+    while (!stringView.empty())
+    {
+        _parseBacklog.store(stringView.size());
+        stringView = stringView.substr(WriteSlice(stringView, s_ParseSliceBudget));
+
+        if (!stringView.empty())
+        {
+            // Give whoever's been waiting for the lock a chance to take it.
+            std::this_thread::yield();
+        }
+    }
+    _parseBacklog.store(0);
+
+    // The lock's been let go of, so the governor is free to take this
+    // terminal's (or any other's) to trim it.
+    MemoryGovernor::Instance().Rebalance();
+}
+
+// Method Description:
+// - Parses as much of some text into the buffer as can be done in the given
+//   time, holding the write lock for all of it. At least one chunk of the text
+//   is always parsed, so that every call makes progress.
+// - A surrogate pair is never split between two slices.
+// Arguments:
+// - stringView: the text to parse
+// - budget: roughly how long to spend parsing
+// Return Value:
+// - The number of characters from the start of the text that were parsed.
+size_t Terminal::WriteSlice(std::wstring_view stringView, const std::chrono::steady_clock::duration budget)
 {
     auto lock = LockForWriting();
 
-    _stateMachine->ProcessString(stringView.data(), stringView.size());
+    const auto deadline = std::chrono::steady_clock::now() + budget;
+    size_t parsed = 0;
+    do
+    {
+        auto end = std::min(parsed + s_ParseSliceChunk, stringView.size());
+        if (end < stringView.size() && IS_HIGH_SURROGATE(stringView[end - 1]))
+        {
+            ++end;
+        }
+
+        _stateMachine->ProcessString(stringView.data() + parsed, end - parsed);
+        parsed = end;
+    } while (parsed < stringView.size() && std::chrono::steady_clock::now() < deadline);
+
+    // Rows only move into the history as the buffer scrolls, so it can only
+    // have grown past its limit if it has.
+    if (_scrollNotificationPending)
+    {
+        _UpdateHistoryMemory();
+    }
+    _NotifyPendingScroll();
+
+    ++_parseSlices;
+    if (parsed < stringView.size())
+    {
+        ++_parseSlicesOverBudget;
+    }
+    return parsed;
+}
+
+// Method Description:
+// - Gets how the parser has been keeping up with the output written to it.
+//   This can be called without the lock, from any thread.
+Terminal::ParseMetrics Terminal::GetParseMetrics() const noexcept
+{
+    return { _parseSlices.load(), _parseSlicesOverBudget.load(), _parseBacklog.load() };
 }
 
 // Method Description:
@@ -325,97 +440,261 @@ Viewport Terminal::_GetVisibleViewport() const noexcept
 //       I had to make a bunch of hacks to get Japanese and emoji to work-ish.
 void Terminal::_WriteBuffer(const std::wstring_view& stringView)
 {
+    // The control characters that move the cursor (or, for BEL, do nothing).
+    // Everything between them is written a row at a time.
+    static constexpr std::array<wchar_t, 4> controls{ UNICODE_LINEFEED, UNICODE_CARRIAGERETURN, UNICODE_BACKSPACE, UNICODE_BEL };
+
     auto& cursor = _buffer->GetCursor();
     const Viewport bufferSize = _buffer->GetSize();
+    COORD position = cursor.GetPosition();
+
+    // Moves the position down a row. If we're about to go past the bottom of
+    // the buffer, instead cycle the buffer, and move the viewport down if the
+    // position has gone below it. This is essentially equivalent to
+    // `AdjustCursorPosition`.
+    const auto lineFeed = [&]() {
+        ++position.Y;
+        while (position.Y >= bufferSize.Height())
+        {
+            _buffer->IncrementCircularBuffer();
+            --position.Y;
+            _scrollNotificationPending = true;
+        }
 
-    for (size_t i = 0; i < stringView.size(); i++)
-    {
-        wchar_t wch = stringView[i];
-        const COORD cursorPosBefore = cursor.GetPosition();
-        COORD proposedCursorPosition = cursorPosBefore;
-        bool notifyScroll = false;
+        if (position.Y > _mutableViewport.BottomInclusive())
+        {
+            const auto newViewTop = std::max(0, position.Y - (_mutableViewport.Height() - 1));
+            if (newViewTop != _mutableViewport.Top())
+            {
+                _mutableViewport = Viewport::FromDimensions({ 0, gsl::narrow<short>(newViewTop) }, _mutableViewport.Dimensions());
+                _scrollNotificationPending = true;
+            }
+        }
+    };
 
+    size_t i = 0;
+    while (i < stringView.size())
+    {
+        const wchar_t wch = stringView[i];
         if (wch == UNICODE_LINEFEED)
         {
-            proposedCursorPosition.Y++;
+            // A line feed clears a wrap that's still pending after a run filled
+            // its row, or the next run would start yet another row down.
+            if (position.X >= bufferSize.Width())
+            {
+                position.X = bufferSize.Width() - 1;
+            }
+            lineFeed();
+            ++i;
         }
         else if (wch == UNICODE_CARRIAGERETURN)
         {
-            proposedCursorPosition.X = 0;
+            position.X = 0;
+            ++i;
         }
         else if (wch == UNICODE_BACKSPACE)
         {
-            if (cursorPosBefore.X == 0)
+            if (position.X == 0)
             {
-                proposedCursorPosition.X = bufferSize.Width() - 1;
-                proposedCursorPosition.Y--;
+                position.X = bufferSize.Width() - 1;
+                position.Y--;
             }
             else
             {
-                proposedCursorPosition.X--;
+                position.X--;
             }
+            ++i;
         }
         else if (wch == UNICODE_BEL)
         {
             // TODO: GitHub #1883
             // For now its empty just so we don't try to write the BEL character
+            ++i;
         }
         else
         {
-            // TODO: MSFT 21006766
-            // This is not great but I need it demoable. Fix by making a buffer stream writer.
-            if (wch >= 0xD800 && wch <= 0xDFFF)
-            {
-                OutputCellIterator it{ stringView.substr(i, 2), _buffer->GetCurrentAttributes() };
-                const auto end = _buffer->Write(it);
-                const auto cellDistance = end.GetCellDistance(it);
-                i += cellDistance - 1;
-                proposedCursorPosition.X += gsl::narrow<SHORT>(cellDistance);
-            }
-            else
-            {
-                OutputCellIterator it{ stringView.substr(i, 1), _buffer->GetCurrentAttributes() };
-                const auto end = _buffer->Write(it);
-                const auto cellDistance = end.GetCellDistance(it);
-                proposedCursorPosition.X += gsl::narrow<SHORT>(cellDistance);
-            }
-        }
-
-        // If we're about to scroll past the bottom of the buffer, instead cycle the buffer.
-        const auto newRows = proposedCursorPosition.Y - bufferSize.Height() + 1;
-        if (newRows > 0)
-        {
-            for (auto dy = 0; dy < newRows; dy++)
+            const auto runEnd = std::min(stringView.find_first_of(controls.data(), i, controls.size()), stringView.size());
+            OutputCellIterator it{ stringView.substr(i, runEnd - i), _buffer->GetCurrentAttributes() };
+            while (it)
             {
-                _buffer->IncrementCircularBuffer();
-                proposedCursorPosition.Y--;
+                // The last run filled its row, so this one starts on the next.
+                if (position.X >= bufferSize.Width())
+                {
+                    position.X = 0;
+                    lineFeed();
+                }
+
+                const auto end = _buffer->WriteLine(it, position, true);
+                if (position.X == 0 && end.GetInputDistance(it) == 0)
+                {
+                    // Not even a whole row can fit what's next (a wide glyph
+                    // in a one column buffer), so the rest is dropped.
+                    break;
+                }
+
+                position.X += gsl::narrow<SHORT>(end.GetCellDistance(it));
+                if (end)
+                {
+                    // The row is full. If a wide glyph didn't fit in its last
+                    // column, that column's been padded out.
+                    position.X = bufferSize.Width();
+                }
+                it = end;
             }
-            notifyScroll = true;
+            i = runEnd;
         }
+    }
 
-        // This section is essentially equivalent to `AdjustCursorPosition`
-        // Update Cursor Position
-        cursor.SetPosition(proposedCursorPosition);
+    cursor.SetPosition(position);
+}
 
-        const COORD cursorPosAfter = cursor.GetPosition();
+// Method Description:
+// - Works out how many lines of scrollback fit in a memory limit, for a
+//   viewport of the given size.
+// - The rows are only given three quarters of the limit: the rest is left for
+//   what some of them need on top (their colors, and glyphs that don't fit in
+//   a cell), so that the oldest rows only have to be stripped of those when
+//   the history is unusually colorful.
+// Arguments:
+// - viewportSize: the size of the viewport
+// - limit: how many bytes the buffer may use
+// Return Value:
+// - The number of scrollback lines.
+SHORT Terminal::_GetScrollbackLinesForMemoryLimit(const COORD viewportSize, const size_t limit) noexcept
+{
+    const auto rowUsage = TextBuffer::s_GetLeastRowMemoryUsage(std::max<SHORT>(viewportSize.X, 1));
+    const auto rows = limit / 4 * 3 / rowUsage;
+    const auto viewportRows = gsl::narrow_cast<size_t>(std::max<SHORT>(viewportSize.Y, 0));
+    return gsl::narrow_cast<SHORT>(std::min<size_t>(rows > viewportRows ? rows - viewportRows : 0, SHRT_MAX));
+}
 
-        // Move the viewport down if the cursor moved below the viewport.
-        if (cursorPosAfter.Y > _mutableViewport.BottomInclusive())
+// Method Description:
+// - Brings the memory the buffer is using back under its own limit, by taking
+//   it from the oldest rows of the history, and measures it for the shared
+//   limit. The viewport is never touched.
+void Terminal::_UpdateHistoryMemory()
+{
+    try
+    {
+        if (_historyMemoryLimit != 0)
         {
-            const auto newViewTop = std::max(0, cursorPosAfter.Y - (_mutableViewport.Height() - 1));
-            if (newViewTop != _mutableViewport.Top())
-            {
-                _mutableViewport = Viewport::FromDimensions({ 0, gsl::narrow<short>(newViewTop) }, _mutableViewport.Dimensions());
-                notifyScroll = true;
-            }
+            _bufferMemoryUsage = _buffer->TrimMemoryUsage(_historyMemoryLimit, _mutableViewport.Top());
         }
-
-        if (notifyScroll)
+        else if (MemoryGovernor::Instance().GetLimit() != 0)
         {
-            _buffer->GetRenderTarget().TriggerRedrawAll();
-            _NotifyScrollEvent();
+            _bufferMemoryUsage = _buffer->GetMemoryUsage();
         }
     }
+    CATCH_LOG();
+}
+
+// Method Description:
+// - Gets how much memory the buffer is using, history and all.
+// Return Value:
+// - The number of bytes.
+size_t Terminal::GetBufferMemoryUsage()
+{
+    auto lock = LockForReading();
+    return _buffer->GetMemoryUsage();
+}
+
+// Method Description:
+// - Gets how much memory the buffer was using the last time it was measured,
+//   without taking the lock. It's only kept up to date while there's a limit
+//   on it, of its own or a shared one.
+// Return Value:
+// - The number of bytes.
+size_t Terminal::GetLastBufferMemoryUsage() const noexcept
+{
+    return _bufferMemoryUsage.load();
+}
+
+// Method Description:
+// - Brings the memory the buffer is using under a limit, by taking it from the
+//   oldest rows of the history. They're compacted first, which loses nothing.
+//   If that isn't enough, the history is made as short as it would be if the
+//   limit were its own, dropping its oldest lines, and the lines left are
+//   trimmed the same way they are for a limit of its own (see
+//   TextBuffer::TrimMemoryUsage). The viewport is never touched.
+// Arguments:
+// - limit - how many bytes the buffer may use
+// Return Value:
+// - The number of bytes the buffer is using afterwards.
+// Note:
+// - will throw exception on error
+size_t Terminal::TrimBufferMemory(const size_t limit)
+{
+    auto lock = LockForWriting();
+    if (!_buffer)
+    {
+        return 0;
+    }
+
+    const auto before = _bufferMemoryUsage.load();
+    _bufferMemoryUsage = _buffer->CompactMemoryUsage(limit, _mutableViewport.Top());
+    if (_bufferMemoryUsage > limit)
+    {
+        _ShrinkScrollback(limit);
+        _bufferMemoryUsage = _buffer->TrimMemoryUsage(limit, _mutableViewport.Top());
+    }
+
+    // The history might be on screen, even if the terminal isn't focused.
+    if (_bufferMemoryUsage != before)
+    {
+        _buffer->GetRenderTarget().TriggerRedrawAll();
+    }
+    _NotifyPendingScroll();
+    return _bufferMemoryUsage;
+}
+
+// Method Description:
+// - Makes the history short enough to fit in a memory limit (as worked out by
+//   _GetScrollbackLinesForMemoryLimit), dropping its oldest lines. It stays
+//   that short, unless a memory limit of its own is worked out again when
+//   the terminal is resized.
+// - The viewport keeps its contents. The view scrolled back into the history
+//   keeps its place, unless that place is gone, and a selection is cleared,
+//   since the rows it's in have moved.
+// Arguments:
+// - limit - how many bytes the buffer may use
+// Note:
+// - will throw exception on error
+void Terminal::_ShrinkScrollback(const size_t limit)
+{
+    const auto viewportSize = _mutableViewport.Dimensions();
+    const auto scrollbackLines = _GetScrollbackLinesForMemoryLimit(viewportSize, limit);
+    const auto newHeight = Utils::ClampToShortMax(viewportSize.Y + scrollbackLines, 1);
+    if (newHeight >= _buffer->GetSize().Height())
+    {
+        return;
+    }
+
+    const auto droppedRows = gsl::narrow_cast<SHORT>(std::max(0, _mutableViewport.Top() - scrollbackLines));
+    THROW_IF_FAILED(_buffer->DropOldestRows(droppedRows, newHeight));
+
+    _scrollbackLines = scrollbackLines;
+    _mutableViewport = Viewport::FromDimensions({ 0, gsl::narrow_cast<SHORT>(_mutableViewport.Top() - droppedRows) }, viewportSize);
+    _scrollOffset = std::min(_scrollOffset, static_cast<int>(_mutableViewport.Top()));
+    if (IsSelectionActive())
+    {
+        ClearSelection();
+    }
+    _scrollNotificationPending = true;
+}
+
+// Method Description:
+// - Lets the renderer and the scroll bar know that the buffer has scrolled,
+//   if it has since the last time this was called. Writing the buffer only
+//   makes a note of it, so that however much output is written under one
+//   lock, they hear about it once.
+void Terminal::_NotifyPendingScroll()
+{
+    if (_scrollNotificationPending)
+    {
+        _scrollNotificationPending = false;
+        _buffer->GetRenderTarget().TriggerRedrawAll();
+        _NotifyScrollEvent();
+    }
 }
 
 void Terminal::UserScrollViewport(const int viewTop)
@@ -496,3 +775,11 @@ bool Terminal::IsCursorBlinkingAllowed() const noexcept
     const auto& cursor = _buffer->GetCursor();
     return cursor.IsBlinkingAllowed();
 }
+
+// Method Description:
+// - Returns true if the connected application asked for pasted text to be
+//      wrapped in bracketed paste sequences.
+bool Terminal::IsBracketedPasteModeEnabled() const noexcept
+{
+    return _bracketedPasteMode;
+}
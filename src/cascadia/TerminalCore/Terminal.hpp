@@ -14,6 +14,7 @@
 #include "../../types/IUiaData.h"
 #include "../../cascadia/terminalcore/ITerminalApi.hpp"
 #include "../../cascadia/terminalcore/ITerminalInput.hpp"
+#include "../../cascadia/terminalcore/DelimiterSet.hpp"
 
 // You have to forward decl the ICoreSettings here, instead of including the header.
 // If you include the header, there will be compilation errors with other
@@ -36,7 +37,7 @@ class Microsoft::Terminal::Core::Terminal final :
 {
 public:
     Terminal();
-    virtual ~Terminal(){};
+    virtual ~Terminal();
 
     void Create(COORD viewportSize,
                 SHORT scrollbackLines,
@@ -49,6 +50,20 @@ public:
 
     // Write goes through the parser
     void Write(std::wstring_view stringView);
+    size_t WriteSlice(std::wstring_view stringView, const std::chrono::steady_clock::duration budget);
+
+    // How the parser has been keeping up with the output written to it.
+    struct ParseMetrics
+    {
+        uint64_t slices; // slices parsed so far
+        uint64_t slicesOverBudget; // slices that ran out of time before the end of their text
+        size_t backlog; // characters passed to Write that haven't been parsed yet
+    };
+    ParseMetrics GetParseMetrics() const noexcept;
+
+    size_t GetBufferMemoryUsage();
+    size_t GetLastBufferMemoryUsage() const noexcept;
+    size_t TrimBufferMemory(const size_t limit);
 
     [[nodiscard]] std::shared_lock<std::shared_mutex> LockForReading();
     [[nodiscard]] std::unique_lock<std::shared_mutex> LockForWriting();
@@ -78,6 +93,7 @@ public:
     bool SetCursorStyle(const ::Microsoft::Console::VirtualTerminal::DispatchTypes::CursorStyle cursorStyle) override;
     bool SetDefaultForeground(const COLORREF dwColor) override;
     bool SetDefaultBackground(const COLORREF dwColor) override;
+    bool SetBracketedPasteMode(const bool enabled) override;
 #pragma endregion
 
 #pragma region ITerminalInput
@@ -129,17 +145,19 @@ public:
 
     void SetCursorVisible(const bool isVisible) noexcept;
     bool IsCursorBlinkingAllowed() const noexcept;
+    bool IsBracketedPasteModeEnabled() const noexcept;
 
 #pragma region TextSelection
     // These methods are defined in TerminalSelection.cpp
     const bool IsCopyOnSelectActive() const noexcept;
     void DoubleClickSelection(const COORD position);
     void TripleClickSelection(const COORD position);
+    void SemanticUnitSelection(const COORD position);
     void SetSelectionAnchor(const COORD position);
     void SetEndSelectionPosition(const COORD position);
     void SetBoxSelection(const bool isEnabled) noexcept;
 
-    const TextBuffer::TextAndColor RetrieveSelectedTextFromBuffer(bool trimTrailingWhitespace) const;
+    const TextBuffer::TextAndColorRuns RetrieveSelectedTextRunsFromBuffer(bool trimTrailingWhitespace) const;
 #pragma endregion
 
 private:
@@ -158,6 +176,7 @@ private:
     COLORREF _defaultBg;
 
     bool _snapOnInput;
+    bool _bracketedPasteMode;
 
 #pragma region Text Selection
     enum SelectionExpansionMode
@@ -174,21 +193,45 @@ private:
     bool _copyOnSelect;
     SHORT _selectionAnchor_YOffset;
     SHORT _endSelectionPosition_YOffset;
-    std::wstring _wordDelimiters;
+    Microsoft::Terminal::Core::DelimiterSet _wordDelimiters;
+    Microsoft::Terminal::Core::DelimiterSet _semanticUnitDelimiters;
+    // A URL or a path runs between these, less any of the trailing
+    // punctuation that usually follows one in a sentence.
+    static constexpr std::wstring_view s_SemanticUnitDelimiters{ L" \t\"'`<>()[]{}|\x2502" };
+    static constexpr std::wstring_view s_SemanticUnitTrailingPunctuation{ L".,;:!?" };
     SelectionExpansionMode _multiClickSelectionMode;
 #pragma endregion
 
     std::shared_mutex _readWriteLock;
 
+    // Write parses in slices of about this long, letting go of the lock in
+    // between, so a flood of output can't keep the renderer and input out.
+    static constexpr std::chrono::milliseconds s_ParseSliceBudget{ 3 };
+    // The clock is checked every this many characters.
+    static constexpr size_t s_ParseSliceChunk = 1024;
+
+    std::atomic<uint64_t> _parseSlices;
+    std::atomic<uint64_t> _parseSlicesOverBudget;
+    std::atomic<size_t> _parseBacklog;
+
     // TODO: These members are not shared by an alt-buffer. They should be
     //      encapsulated, such that a Terminal can have both a main and alt buffer.
     std::unique_ptr<TextBuffer> _buffer;
     Microsoft::Console::Types::Viewport _mutableViewport;
     SHORT _scrollbackLines;
+    // When this isn't 0, it's how many bytes the buffer may use, and the
+    // number of scrollback lines is worked out from it.
+    size_t _historyMemoryLimit;
+    // How many bytes the buffer was using the last time it was measured. It's
+    // only kept up to date while there's a limit, of its own or a shared one.
+    std::atomic<size_t> _bufferMemoryUsage;
 
     // _scrollOffset is the number of lines above the viewport that are currently visible
     // If _scrollOffset is 0, then the visible region of the buffer is the viewport.
     int _scrollOffset;
+    // Set when writing the buffer has scrolled it, until the renderer and the
+    // scroll bar have been told.
+    bool _scrollNotificationPending;
     // TODO this might not be the value we want to store.
     // We might want to store the height in the scrollback that's currenty visible.
     // Think on this some more.
@@ -210,17 +253,22 @@ private:
 
     void _InitializeColorTable();
 
+    static SHORT _GetScrollbackLinesForMemoryLimit(const COORD viewportSize, const size_t limit) noexcept;
+    void _ShrinkScrollback(const size_t limit);
+    void _UpdateHistoryMemory();
+
     void _WriteBuffer(const std::wstring_view& stringView);
 
     void _NotifyScrollEvent();
+    void _NotifyPendingScroll();
 
 #pragma region TextSelection
     // These methods are defined in TerminalSelection.cpp
     std::vector<SMALL_RECT> _GetSelectionRects() const;
     const SHORT _ExpandWideGlyphSelectionLeft(const SHORT xPos, const SHORT yPos) const;
     const SHORT _ExpandWideGlyphSelectionRight(const SHORT xPos, const SHORT yPos) const;
-    COORD _ExpandDoubleClickSelectionLeft(const COORD position) const;
-    COORD _ExpandDoubleClickSelectionRight(const COORD position) const;
+    COORD _ExpandToDelimiterLeft(const Microsoft::Terminal::Core::DelimiterSet& delimiters, const COORD position, const bool acrossWrappedRows) const;
+    COORD _ExpandToDelimiterRight(const Microsoft::Terminal::Core::DelimiterSet& delimiters, const COORD position, const bool acrossWrappedRows) const;
     const bool _isWordDelimiter(std::wstring_view cellChar) const;
     const COORD _ConvertToBufferCell(const COORD viewportPos) const;
     const bool _isSingleCellSelection() const noexcept;
@@ -474,3 +474,16 @@ bool Terminal::SetDefaultBackground(const COLORREF dwColor)
     _buffer->GetRenderTarget().TriggerRedrawAll();
     return true;
 }
+
+// Method Description:
+// - Enables or disables bracketed paste mode. While it's enabled, pasted
+//      text is sent to the connection between ESC[200~ and ESC[201~.
+// Arguments:
+// - enabled: whether bracketed paste mode should be enabled
+// Return Value:
+// - true
+bool Terminal::SetBracketedPasteMode(const bool enabled)
+{
+    _bracketedPasteMode = enabled;
+    return true;
+}
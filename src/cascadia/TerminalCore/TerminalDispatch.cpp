@@ -154,3 +154,62 @@ bool TerminalDispatch::EraseInDisplay(const DispatchTypes::EraseType eraseType)
 {
     return _terminalApi.EraseInDisplay(eraseType);
 }
+
+// Routine Description:
+// - Sets or resets each of the given DEC private modes. The Terminal only
+//      tracks the ones that change how it sends input to the connection.
+// Arguments:
+// - rgParams - array of params to set or reset
+// - cParams - length of rgParams
+// - enable - true to set the modes, false to reset them
+// Return Value:
+// - True if all of the modes were handled. False otherwise.
+bool TerminalDispatch::_SetResetPrivateModes(_In_reads_(cParams) const DispatchTypes::PrivateModeParams* const rgParams,
+                                             const size_t cParams,
+                                             const bool enable)
+{
+    // Like the console, handle every mode we know about, and only report a
+    //      failure once they've all been tried.
+    size_t cFailures = 0;
+    for (size_t i = 0; i < cParams; i++)
+    {
+        bool success = false;
+        switch (rgParams[i])
+        {
+        case DispatchTypes::PrivateModeParams::XTERM_BracketedPasteMode:
+            success = _terminalApi.SetBracketedPasteMode(enable);
+            break;
+        default:
+            success = false;
+            break;
+        }
+        cFailures += success ? 0 : 1;
+    }
+    return cFailures == 0;
+}
+
+// Routine Description:
+// - DECSET - Enables the given DEC private mode params.
+// Arguments:
+// - rgParams - array of params to set
+// - cParams - length of rgParams
+// Return Value:
+// - True if handled successfully. False otherwise.
+bool TerminalDispatch::SetPrivateModes(_In_reads_(cParams) const DispatchTypes::PrivateModeParams* const rgParams,
+                                       const size_t cParams)
+{
+    return _SetResetPrivateModes(rgParams, cParams, true);
+}
+
+// Routine Description:
+// - DECRST - Disables the given DEC private mode params.
+// Arguments:
+// - rgParams - array of params to reset
+// - cParams - length of rgParams
+// Return Value:
+// - True if handled successfully. False otherwise.
+bool TerminalDispatch::ResetPrivateModes(_In_reads_(cParams) const DispatchTypes::PrivateModeParams* const rgParams,
+                                         const size_t cParams)
+{
+    return _SetResetPrivateModes(rgParams, cParams, false);
+}
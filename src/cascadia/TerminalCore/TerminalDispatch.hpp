@@ -36,6 +36,11 @@ public:
     bool InsertCharacter(const unsigned int uiCount) override;
     bool EraseInDisplay(const ::Microsoft::Console::VirtualTerminal::DispatchTypes::EraseType eraseType) override;
 
+    bool SetPrivateModes(_In_reads_(cParams) const ::Microsoft::Console::VirtualTerminal::DispatchTypes::PrivateModeParams* const rgParams,
+                         const size_t cParams) override; // DECSET
+    bool ResetPrivateModes(_In_reads_(cParams) const ::Microsoft::Console::VirtualTerminal::DispatchTypes::PrivateModeParams* const rgParams,
+                           const size_t cParams) override; // DECRST
+
 private:
     ::Microsoft::Terminal::Core::ITerminalApi& _terminalApi;
 
@@ -49,4 +54,8 @@ private:
     bool _SetBoldColorHelper(const ::Microsoft::Console::VirtualTerminal::DispatchTypes::GraphicsOptions option);
     bool _SetDefaultColorHelper(const ::Microsoft::Console::VirtualTerminal::DispatchTypes::GraphicsOptions option);
     void _SetGraphicsOptionHelper(const ::Microsoft::Console::VirtualTerminal::DispatchTypes::GraphicsOptions opt);
+
+    bool _SetResetPrivateModes(_In_reads_(cParams) const ::Microsoft::Console::VirtualTerminal::DispatchTypes::PrivateModeParams* const rgParams,
+                               const size_t cParams,
+                               const bool enable);
 };
@@ -73,8 +73,10 @@ std::vector<SMALL_RECT> Terminal::_GetSelectionRects() const
             }
             else
             {
-                selectionRow.Left = _ExpandDoubleClickSelectionLeft({ selectionRow.Left, row }).X;
-                selectionRow.Right = _ExpandDoubleClickSelectionRight({ selectionRow.Right, row }).X;
+                // The ends of the selection were already found across wrapped
+                // rows, so each row only has to be expanded within itself.
+                selectionRow.Left = _ExpandToDelimiterLeft(_wordDelimiters, { selectionRow.Left, row }, false).X;
+                selectionRow.Right = _ExpandToDelimiterRight(_wordDelimiters, { selectionRow.Right, row }, false).X;
             }
         }
         else if (_multiClickSelectionMode == SelectionExpansionMode::Line)
@@ -193,13 +195,13 @@ void Terminal::DoubleClickSelection(const COORD position)
 
     // scan leftwards until delimiter is found and
     // set selection anchor to one right of that spot
-    _selectionAnchor = _ExpandDoubleClickSelectionLeft(positionWithOffsets);
+    _selectionAnchor = _ExpandToDelimiterLeft(_wordDelimiters, positionWithOffsets, true);
     THROW_IF_FAILED(ShortSub(_selectionAnchor.Y, gsl::narrow<SHORT>(_ViewStartIndex()), &_selectionAnchor.Y));
     _selectionAnchor_YOffset = gsl::narrow<SHORT>(_ViewStartIndex());
 
     // scan rightwards until delimiter is found and
     // set endSelectionPosition to one left of that spot
-    _endSelectionPosition = _ExpandDoubleClickSelectionRight(positionWithOffsets);
+    _endSelectionPosition = _ExpandToDelimiterRight(_wordDelimiters, positionWithOffsets, true);
     THROW_IF_FAILED(ShortSub(_endSelectionPosition.Y, gsl::narrow<SHORT>(_ViewStartIndex()), &_endSelectionPosition.Y));
     _endSelectionPosition_YOffset = gsl::narrow<SHORT>(_ViewStartIndex());
 
@@ -207,6 +209,50 @@ void Terminal::DoubleClickSelection(const COORD position)
     _multiClickSelectionMode = SelectionExpansionMode::Word;
 }
 
+// Method Description:
+// - Select the URL or path (or whatever else runs between whitespace, quotes
+//   and brackets) at the position clicked, including where it's wrapped onto
+//   the rows above or below. Punctuation at its end, like the full stop at the
+//   end of a sentence, isn't selected.
+// Arguments:
+// - position: the (x,y) coordinate on the visible viewport
+void Terminal::SemanticUnitSelection(const COORD position)
+{
+    // if you click a delimiter, just select that one cell
+    COORD positionWithOffsets = _ConvertToBufferCell(position);
+    if (_semanticUnitDelimiters.Contains(_buffer->GetCellDataAt(positionWithOffsets)->Chars()))
+    {
+        SetSelectionAnchor(position);
+        return;
+    }
+
+    const auto start = _ExpandToDelimiterLeft(_semanticUnitDelimiters, positionWithOffsets, true);
+    auto end = _ExpandToDelimiterRight(_semanticUnitDelimiters, positionWithOffsets, true);
+
+    const auto bufferViewport = _buffer->GetSize();
+    while (end != start && end != positionWithOffsets)
+    {
+        const auto cellChar = _buffer->GetCellDataAt(end)->Chars();
+        if (cellChar.size() != 1 || s_SemanticUnitTrailingPunctuation.find(cellChar.front()) == std::wstring_view::npos)
+        {
+            break;
+        }
+        bufferViewport.DecrementInBounds(end);
+    }
+
+    _selectionAnchor = start;
+    THROW_IF_FAILED(ShortSub(_selectionAnchor.Y, gsl::narrow<SHORT>(_ViewStartIndex()), &_selectionAnchor.Y));
+    _selectionAnchor_YOffset = gsl::narrow<SHORT>(_ViewStartIndex());
+
+    _endSelectionPosition = end;
+    THROW_IF_FAILED(ShortSub(_endSelectionPosition.Y, gsl::narrow<SHORT>(_ViewStartIndex()), &_endSelectionPosition.Y));
+    _endSelectionPosition_YOffset = gsl::narrow<SHORT>(_ViewStartIndex());
+
+    _selectionActive = true;
+    _allowSingleCharSelection = true;
+    _multiClickSelectionMode = SelectionExpansionMode::Cell;
+}
+
 // Method Description:
 // - Select the entire row of the position clicked
 // Arguments:
@@ -287,74 +333,114 @@ void Terminal::ClearSelection()
 }
 
 // Method Description:
-// - get wstring text from highlighted portion of text buffer
+// - get the text from highlighted portion of text buffer, along with the runs
+//   of its colors, as a snapshot that can be turned into HTML or RTF once the
+//   terminal's lock has been released
 // Arguments:
 // - trimTrailingWhitespace: enable removing any whitespace from copied selection
 //    and get text to appear on separate lines.
 // Return Value:
-// - wstring text from buffer. If extended to multiple lines, each line is separated by \r\n
-const TextBuffer::TextAndColor Terminal::RetrieveSelectedTextFromBuffer(bool trimTrailingWhitespace) const
+// - the text of the selection, and the runs of its colors
+const TextBuffer::TextAndColorRuns Terminal::RetrieveSelectedTextRunsFromBuffer(bool trimTrailingWhitespace) const
 {
     std::function<COLORREF(TextAttribute&)> GetForegroundColor = std::bind(&Terminal::GetForegroundColor, this, std::placeholders::_1);
     std::function<COLORREF(TextAttribute&)> GetBackgroundColor = std::bind(&Terminal::GetBackgroundColor, this, std::placeholders::_1);
 
-    return _buffer->GetTextForClipboard(!_boxSelection,
-                                        trimTrailingWhitespace,
-                                        _GetSelectionRects(),
-                                        GetForegroundColor,
-                                        GetBackgroundColor);
+    return _buffer->GetTextRunsForClipboard(!_boxSelection,
+                                            trimTrailingWhitespace,
+                                            _GetSelectionRects(),
+                                            GetForegroundColor,
+                                            GetBackgroundColor);
 }
 
 // Method Description:
-// - expand the double click selection to the left (stopped by delimiter)
+// - expand the selection to the left, up to (but not including) the nearest
+//   delimiter. A delimiter at the start of the row it's expanded from is
+//   included, as it always has been, so that expanding a row that starts with
+//   one doesn't shrink it.
 // Arguments:
-// - position: viewport coordinate for selection
+// - delimiters: the delimiters to stop at
+// - position: buffer coordinate to expand from
+// - acrossWrappedRows: whether to carry on into the row above, if there's no
+//   delimiter before the start of this one and the row above was wrapped
 // Return Value:
 // - updated copy of "position" to new expanded location (with vertical offset)
-COORD Terminal::_ExpandDoubleClickSelectionLeft(const COORD position) const
+COORD Terminal::_ExpandToDelimiterLeft(const DelimiterSet& delimiters, const COORD position, const bool acrossWrappedRows) const
 {
-    COORD positionWithOffsets = position;
-    const auto bufferViewport = _buffer->GetSize();
-    auto cellChar = _buffer->GetCellDataAt(positionWithOffsets)->Chars();
-    while (positionWithOffsets.X != 0 && !_isWordDelimiter(cellChar))
+    const auto width = gsl::narrow_cast<size_t>(_buffer->GetSize().Width());
+    auto y = position.Y;
+    auto column = gsl::narrow_cast<size_t>(std::max<SHORT>(position.X, 0));
+    for (;;)
     {
-        bufferViewport.DecrementInBounds(positionWithOffsets);
-        cellChar = _buffer->GetCellDataAt(positionWithOffsets)->Chars();
-    }
+        const auto delimiter = delimiters.FindLast(_buffer->GetRowByOffset(y).GetCharRow(), column);
+        if (delimiter == 0 && y == position.Y)
+        {
+            return { 0, y };
+        }
+        if (delimiter != std::wstring::npos)
+        {
+            // move off of delimiter to highlight properly
+            return { gsl::narrow_cast<SHORT>(std::min(delimiter + 1, width - 1)), y };
+        }
+        if (!acrossWrappedRows || y == 0 || !_buffer->GetRowByOffset(y - 1).GetCharRow().WasWrapForced())
+        {
+            return { 0, y };
+        }
 
-    if (positionWithOffsets.X != 0 && _isWordDelimiter(cellChar))
-    {
-        // move off of delimiter to highlight properly
-        bufferViewport.IncrementInBounds(positionWithOffsets);
+        --y;
+        column = width - 1;
+        if (delimiters.FindLast(_buffer->GetRowByOffset(y).GetCharRow(), column) == column)
+        {
+            // The word starts right at the start of the row below.
+            return { 0, gsl::narrow_cast<SHORT>(y + 1) };
+        }
     }
-
-    return positionWithOffsets;
 }
 
 // Method Description:
-// - expand the double click selection to the right (stopped by delimiter)
+// - expand the selection to the right, up to (but not including) the nearest
+//   delimiter. A delimiter at the end of the row it's expanded from is
+//   included, as it always has been, so that expanding a row that ends with
+//   one doesn't shrink it.
 // Arguments:
-// - position: viewport coordinate for selection
+// - delimiters: the delimiters to stop at
+// - position: buffer coordinate to expand from
+// - acrossWrappedRows: whether to carry on into the row below, if there's no
+//   delimiter after the end of this one and this row was wrapped
 // Return Value:
 // - updated copy of "position" to new expanded location (with vertical offset)
-COORD Terminal::_ExpandDoubleClickSelectionRight(const COORD position) const
+COORD Terminal::_ExpandToDelimiterRight(const DelimiterSet& delimiters, const COORD position, const bool acrossWrappedRows) const
 {
-    COORD positionWithOffsets = position;
-    const auto bufferViewport = _buffer->GetSize();
-    auto cellChar = _buffer->GetCellDataAt(positionWithOffsets)->Chars();
-    while (positionWithOffsets.X != _buffer->GetSize().RightInclusive() && !_isWordDelimiter(cellChar))
+    const auto bufferSize = _buffer->GetSize();
+    const auto width = gsl::narrow_cast<size_t>(bufferSize.Width());
+    auto y = position.Y;
+    auto column = gsl::narrow_cast<size_t>(std::max<SHORT>(position.X, 0));
+    for (;;)
     {
-        bufferViewport.IncrementInBounds(positionWithOffsets);
-        cellChar = _buffer->GetCellDataAt(positionWithOffsets)->Chars();
-    }
+        const auto& charRow = _buffer->GetRowByOffset(y).GetCharRow();
+        const auto delimiter = delimiters.FindFirst(charRow, column);
+        if (delimiter == width - 1 && y == position.Y)
+        {
+            return { gsl::narrow_cast<SHORT>(delimiter), y };
+        }
+        if (delimiter != std::wstring::npos)
+        {
+            // move off of delimiter to highlight properly
+            return { gsl::narrow_cast<SHORT>(delimiter == 0 ? 0 : delimiter - 1), y };
+        }
+        if (!acrossWrappedRows || y == bufferSize.BottomInclusive() || !charRow.WasWrapForced())
+        {
+            return { gsl::narrow_cast<SHORT>(width - 1), y };
+        }
 
-    if (positionWithOffsets.X != bufferViewport.RightInclusive() && _isWordDelimiter(cellChar))
-    {
-        // move off of delimiter to highlight properly
-        bufferViewport.DecrementInBounds(positionWithOffsets);
+        ++y;
+        column = 0;
+        if (delimiters.FindFirst(_buffer->GetRowByOffset(y).GetCharRow(), column) == column)
+        {
+            // The word ends right at the end of the row above.
+            return { gsl::narrow_cast<SHORT>(width - 1), gsl::narrow_cast<SHORT>(y - 1) };
+        }
     }
-
-    return positionWithOffsets;
 }
 
 // Method Description:
@@ -365,7 +451,7 @@ COORD Terminal::_ExpandDoubleClickSelectionRight(const COORD position) const
 // - true if cell data contains the delimiter.
 const bool Terminal::_isWordDelimiter(std::wstring_view cellChar) const
 {
-    return _wordDelimiters.find(cellChar) != std::wstring_view::npos;
+    return _wordDelimiters.Contains(cellChar);
 }
 
 // Method Description:
@@ -14,6 +14,8 @@ namespace winrt::Microsoft::Terminal::Settings::implementation
         _defaultBackground{ DEFAULT_BACKGROUND_WITH_ALPHA },
         _colorTable{},
         _historySize{ DEFAULT_HISTORY_SIZE },
+        _historyMemoryLimit{ 0 },
+        _sharedHistoryMemoryLimit{ 0 },
         _initialRows{ 30 },
         _initialCols{ 80 },
         _snapOnInput{ true },
@@ -80,6 +82,26 @@ namespace winrt::Microsoft::Terminal::Settings::implementation
         _historySize = value;
     }
 
+    int32_t TerminalSettings::HistoryMemoryLimit()
+    {
+        return _historyMemoryLimit;
+    }
+
+    void TerminalSettings::HistoryMemoryLimit(int32_t value)
+    {
+        _historyMemoryLimit = value;
+    }
+
+    int32_t TerminalSettings::SharedHistoryMemoryLimit()
+    {
+        return _sharedHistoryMemoryLimit;
+    }
+
+    void TerminalSettings::SharedHistoryMemoryLimit(int32_t value)
+    {
+        _sharedHistoryMemoryLimit = value;
+    }
+
     int32_t TerminalSettings::InitialRows()
     {
         return _initialRows;
@@ -33,6 +33,10 @@ namespace winrt::Microsoft::Terminal::Settings::implementation
         void SetColorTableEntry(int32_t index, uint32_t value);
         int32_t HistorySize();
         void HistorySize(int32_t value);
+        int32_t HistoryMemoryLimit();
+        void HistoryMemoryLimit(int32_t value);
+        int32_t SharedHistoryMemoryLimit();
+        void SharedHistoryMemoryLimit(int32_t value);
         int32_t InitialRows();
         void InitialRows(int32_t value);
         int32_t InitialCols();
@@ -99,6 +103,8 @@ namespace winrt::Microsoft::Terminal::Settings::implementation
         uint32_t _defaultBackground;
         std::array<uint32_t, COLOR_TABLE_SIZE> _colorTable;
         int32_t _historySize;
+        int32_t _historyMemoryLimit;
+        int32_t _sharedHistoryMemoryLimit;
         int32_t _initialRows;
         int32_t _initialCols;
         bool _snapOnInput;
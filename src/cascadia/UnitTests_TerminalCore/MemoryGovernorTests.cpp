@@ -0,0 +1,113 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include <WexTestClass.h>
+
+#include "../cascadia/TerminalCore/Terminal.hpp"
+#include "../cascadia/TerminalCore/MemoryGovernor.hpp"
+#include "../renderer/inc/DummyRenderTarget.hpp"
+#include "consoletaeftemplates.hpp"
+
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+using namespace Microsoft::Terminal::Core;
+
+namespace TerminalCoreUnitTests
+{
+    class MemoryGovernorTests
+    {
+        TEST_CLASS(MemoryGovernorTests);
+
+        TEST_METHOD(LeastRecentlyViewedTerminalIsTrimmedFirst)
+        {
+            auto& governor = MemoryGovernor::Instance();
+            auto resetLimit = wil::scope_exit([&]() { governor.SetLimit(0); });
+
+            DummyRenderTarget emptyRT;
+            Terminal older;
+            older.Create({ 10, 5 }, 20, emptyRT);
+            Terminal newer;
+            newer.Create({ 10, 5 }, 20, emptyRT);
+
+            // Buffers are only measured as they're written while there's a
+            // limit, so start with one that can't be reached.
+            governor.SetLimit(SIZE_MAX);
+            for (auto i = 0; i < 30; ++i)
+            {
+                older.Write(L"\x1b[31mA\x1b[32mB\x1b[33mC\x1b[m\r\n");
+                newer.Write(L"\x1b[31mA\x1b[32mB\x1b[33mC\x1b[m\r\n");
+            }
+            governor.NoteViewed(newer);
+
+            const auto olderUsage = older.GetLastBufferMemoryUsage();
+            const auto newerUsage = newer.GetLastBufferMemoryUsage();
+            VERIFY_ARE_EQUAL(olderUsage + newerUsage, governor.GetUsage());
+
+            Log::Comment(L"Going just over the limit only costs the terminal viewed least recently.");
+            governor.SetLimit(olderUsage + newerUsage - 1);
+            governor.Rebalance();
+            const auto olderTrimmedUsage = older.GetLastBufferMemoryUsage();
+            VERIFY_IS_LESS_THAN(olderTrimmedUsage, olderUsage);
+            VERIFY_ARE_EQUAL(newerUsage, newer.GetLastBufferMemoryUsage());
+            VERIFY_IS_LESS_THAN_OR_EQUAL(governor.GetUsage(), governor.GetLimit());
+
+            Log::Comment(L"Once it has nothing left to give, memory comes from the next one.");
+            governor.SetLimit(governor.GetUsage() / 2);
+            governor.Rebalance();
+            VERIFY_IS_LESS_THAN(older.GetLastBufferMemoryUsage(), olderTrimmedUsage);
+            VERIFY_IS_LESS_THAN(newer.GetLastBufferMemoryUsage(), newerUsage);
+        }
+
+        TEST_METHOD(TextOnlyBuffersAreBroughtUnderTheLimit)
+        {
+            auto& governor = MemoryGovernor::Instance();
+            auto resetLimit = wil::scope_exit([&]() { governor.SetLimit(0); });
+
+            DummyRenderTarget emptyRT;
+            std::array<Terminal, 3> terminals;
+            for (auto& terminal : terminals)
+            {
+                terminal.Create({ 10, 5 }, 100, emptyRT);
+            }
+
+            // There's nothing but text, so there's nothing to strip from any
+            // of the rows.
+            governor.SetLimit(SIZE_MAX);
+            for (auto i = 0; i < 120; ++i)
+            {
+                for (auto& terminal : terminals)
+                {
+                    terminal.Write(L"line\r\n");
+                }
+            }
+            for (auto& terminal : terminals)
+            {
+                terminal.Write(L"last");
+                governor.NoteViewed(terminal);
+            }
+
+            const auto usage = governor.GetUsage();
+            governor.SetLimit(usage / 2);
+            governor.Rebalance();
+            VERIFY_IS_LESS_THAN_OR_EQUAL(governor.GetUsage(), governor.GetLimit());
+
+            Log::Comment(L"The terminal viewed least recently gave up its history first.");
+            const auto bufferHeight = [](Terminal& terminal) { return terminal.GetTextBuffer().GetSize().Height(); };
+            VERIFY_IS_LESS_THAN(bufferHeight(terminals[0]), bufferHeight(terminals[1]));
+            VERIFY_ARE_EQUAL(105i16, bufferHeight(terminals[2]));
+
+            Log::Comment(L"Each viewport kept its contents, and its cursor.");
+            for (auto& terminal : terminals)
+            {
+                const auto& buffer = terminal.GetTextBuffer();
+                const auto cursor = buffer.GetCursor().GetPosition();
+                VERIFY_ARE_EQUAL(4i16, cursor.X);
+                VERIFY_ARE_EQUAL(std::wstring_view{ L"last" }, std::wstring_view{ buffer.GetRowByOffset(cursor.Y).GetText() }.substr(0, 4));
+                VERIFY_ARE_EQUAL(std::wstring_view{ L"line" }, std::wstring_view{ buffer.GetRowByOffset(cursor.Y - 1).GetText() }.substr(0, 4));
+                VERIFY_ARE_EQUAL(cursor.Y, terminal.GetViewport().BottomInclusive());
+            }
+        }
+    };
+}
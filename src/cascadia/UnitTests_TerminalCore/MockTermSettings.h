@@ -23,6 +23,8 @@ namespace TerminalCoreUnitTests
 
         // property getters - all implemented
         int32_t HistorySize() { return _historySize; }
+        int32_t HistoryMemoryLimit() { return _historyMemoryLimit; }
+        int32_t SharedHistoryMemoryLimit() { return 0; }
         int32_t InitialRows() { return _initialRows; }
         int32_t InitialCols() { return _initialCols; }
         uint32_t DefaultForeground() { return COLOR_WHITE; }
@@ -39,6 +41,8 @@ namespace TerminalCoreUnitTests
 
         // property setters - all unimplemented
         void HistorySize(int32_t) {}
+        void HistoryMemoryLimit(int32_t historyMemoryLimit) { _historyMemoryLimit = historyMemoryLimit; }
+        void SharedHistoryMemoryLimit(int32_t) {}
         void InitialRows(int32_t) {}
         void InitialCols(int32_t) {}
         void DefaultForeground(uint32_t) {}
@@ -55,6 +59,7 @@ namespace TerminalCoreUnitTests
 
     private:
         int32_t _historySize;
+        int32_t _historyMemoryLimit{ 0 };
         int32_t _initialRows;
         int32_t _initialCols;
         bool _copyOnSelect{ false };
@@ -0,0 +1,139 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include <WexTestClass.h>
+
+#include "../cascadia/TerminalCore/SpscRing.hpp"
+#include "../cascadia/TerminalCore/LatencyHistogram.hpp"
+#include "../cascadia/TerminalCore/Terminal.hpp"
+#include "../renderer/inc/DummyRenderTarget.hpp"
+#include "consoletaeftemplates.hpp"
+
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+using namespace Microsoft::Terminal::Core;
+
+namespace TerminalCoreUnitTests
+{
+    class OutputQueueTest
+    {
+        TEST_CLASS(OutputQueueTest);
+
+        TEST_METHOD(RingWrapsAround)
+        {
+            SpscRing<wchar_t> ring{ 8 };
+            std::array<wchar_t, 8> out{};
+
+            const std::wstring_view first{ L"abcdef" };
+            VERIFY_ARE_EQUAL(first.size(), ring.Push({ first.data(), gsl::narrow<ptrdiff_t>(first.size()) }));
+            VERIFY_ARE_EQUAL(static_cast<size_t>(4), ring.Pop({ out.data(), 4 }));
+            VERIFY_ARE_EQUAL(std::wstring_view{ L"abcd" }, std::wstring_view(out.data(), 4));
+
+            Log::Comment(L"Only as much as there's room for is pushed, and it wraps around the end of the buffer.");
+            const std::wstring_view second{ L"ghijklmnop" };
+            VERIFY_ARE_EQUAL(static_cast<size_t>(6), ring.Push({ second.data(), gsl::narrow<ptrdiff_t>(second.size()) }));
+            VERIFY_ARE_EQUAL(ring.Capacity(), ring.Size());
+
+            VERIFY_ARE_EQUAL(static_cast<size_t>(8), ring.Pop({ out.data(), gsl::narrow<ptrdiff_t>(out.size()) }));
+            VERIFY_ARE_EQUAL(std::wstring_view{ L"efghijkl" }, std::wstring_view(out.data(), 8));
+            VERIFY_ARE_EQUAL(static_cast<size_t>(0), ring.Pop({ out.data(), gsl::narrow<ptrdiff_t>(out.size()) }));
+        }
+
+        TEST_METHOD(RingPassesEverythingBetweenThreads)
+        {
+            SpscRing<uint32_t> ring{ 64 };
+            constexpr uint32_t count = 1000000;
+
+            std::thread producer{ [&]() {
+                std::array<uint32_t, 37> chunk{};
+                uint32_t next = 0;
+                while (next < count)
+                {
+                    const auto length = std::min<uint32_t>(gsl::narrow_cast<uint32_t>(chunk.size()), count - next);
+                    for (uint32_t i = 0; i < length; ++i)
+                    {
+                        chunk[i] = next + i;
+                    }
+
+                    const auto pushed = ring.Push({ chunk.data(), gsl::narrow<ptrdiff_t>(length) });
+                    next += gsl::narrow_cast<uint32_t>(pushed);
+                    if (pushed == 0)
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+            } };
+
+            std::array<uint32_t, 23> out{};
+            uint32_t expected = 0;
+            bool inOrder = true;
+            while (expected < count)
+            {
+                const auto popped = ring.Pop({ out.data(), gsl::narrow<ptrdiff_t>(out.size()) });
+                for (size_t i = 0; i < popped; ++i)
+                {
+                    inOrder = inOrder && out[i] == expected;
+                    ++expected;
+                }
+                if (popped == 0)
+                {
+                    std::this_thread::yield();
+                }
+            }
+            producer.join();
+
+            VERIFY_IS_TRUE(inOrder);
+        }
+
+        TEST_METHOD(HistogramPercentiles)
+        {
+            LatencyHistogram histogram;
+            VERIFY_ARE_EQUAL(0ll, histogram.Percentile(50).count());
+
+            for (int i = 1; i <= 100; ++i)
+            {
+                histogram.Record(std::chrono::microseconds(i));
+            }
+
+            VERIFY_ARE_EQUAL(static_cast<size_t>(100), histogram.Count());
+            VERIFY_ARE_EQUAL(100ll, histogram.Max().count());
+
+            Log::Comment(L"The 50th latency is 50us, which is in the 32-63us bucket.");
+            VERIFY_ARE_EQUAL(63ll, histogram.Percentile(50).count());
+
+            Log::Comment(L"The 99th is in the 64-127us bucket, but nothing took longer than 100us.");
+            VERIFY_ARE_EQUAL(100ll, histogram.Percentile(99).count());
+
+            histogram.Reset();
+            VERIFY_ARE_EQUAL(static_cast<size_t>(0), histogram.Count());
+        }
+
+        TEST_METHOD(WriteSliceMakesProgressWithNoBudget)
+        {
+            Terminal term;
+            DummyRenderTarget emptyRT;
+            term.Create({ 80, 25 }, 100, emptyRT);
+
+            Log::Comment(L"With no time to spend, a slice still parses one chunk.");
+            const std::wstring text(5000, L'x');
+            const auto parsed = term.WriteSlice(text, std::chrono::steady_clock::duration::zero());
+            VERIFY_IS_GREATER_THAN(parsed, static_cast<size_t>(0));
+            VERIFY_IS_LESS_THAN(parsed, text.size());
+            VERIFY_ARE_EQUAL(1ull, term.GetParseMetrics().slicesOverBudget);
+
+            Log::Comment(L"A surrogate pair that straddles the end of a chunk is kept whole.");
+            std::wstring pairs(parsed - 1, L'x');
+            pairs += L"\xD83C\xDF2F";
+            pairs += text;
+            VERIFY_ARE_EQUAL(parsed + 1, term.WriteSlice(pairs, std::chrono::steady_clock::duration::zero()));
+
+            Log::Comment(L"Write parses everything, however many slices it takes.");
+            term.Write(text);
+            const auto metrics = term.GetParseMetrics();
+            VERIFY_IS_GREATER_THAN(metrics.slices, 2ull);
+            VERIFY_ARE_EQUAL(static_cast<size_t>(0), metrics.backlog);
+        }
+    };
+}
@@ -82,5 +82,26 @@ namespace TerminalCoreUnitTests
             farTooBigHistorySizeTerminal.CreateFromSettings(farTooBigHistorySizeSettings, emptyRenderTarget);
             VERIFY_ARE_EQUAL(farTooBigHistorySizeTerminal.GetTextBuffer().TotalRowCount(), static_cast<unsigned int>(SHRT_MAX), L"History size that is far too large is clamped to SHRT_MAX - initial row count");
         }
+
+        TEST_METHOD(HistoryMemoryLimitDecidesScrollback)
+        {
+            DummyRenderTarget emptyRenderTarget;
+
+            // Three quarters of the limit goes to the rows, whatever historySize says.
+            auto settings = winrt::make<MockTermSettings>(100, 30, 100);
+            settings.HistoryMemoryLimit(1);
+            Terminal term;
+            term.CreateFromSettings(settings, emptyRenderTarget);
+
+            const size_t limit = 1024 * 1024;
+            const auto expectedRows = limit / 4 * 3 / TextBuffer::s_GetLeastRowMemoryUsage(100);
+            VERIFY_ARE_EQUAL(static_cast<unsigned int>(expectedRows), term.GetTextBuffer().TotalRowCount(), L"Row count is worked out from the limit");
+            VERIFY_IS_LESS_THAN_OR_EQUAL(term.GetBufferMemoryUsage(), limit);
+
+            // Wider rows cost more, so fewer of them fit after a resize.
+            VERIFY_SUCCEEDED(term.UserResize({ 200, 30 }));
+            const auto expectedWideRows = limit / 4 * 3 / TextBuffer::s_GetLeastRowMemoryUsage(200);
+            VERIFY_ARE_EQUAL(static_cast<unsigned int>(expectedWideRows), term.GetTextBuffer().TotalRowCount(), L"Row count follows the width");
+        }
     };
 }
@@ -434,6 +434,67 @@ namespace TerminalCoreUnitTests
             VERIFY_ARE_EQUAL(selection, SMALL_RECT({ 4, 10, 32, 10 }));
         }
 
+        TEST_METHOD(DoubleClick_AcrossWrappedRows)
+        {
+            Terminal term;
+            DummyRenderTarget emptyRT;
+            term.Create({ 10, 5 }, 0, emptyRT);
+
+            // set word delimiters for terminal
+            auto settings = winrt::make<MockTermSettings>(0, 10, 5);
+            term.UpdateSettings(settings);
+
+            // buffer: abc wrappe
+            //         dword end
+            term.Write(L"abc wrappedword end");
+
+            // Simulate double click at (x,y) = (2,1)
+            term.DoubleClickSelection({ 2, 1 });
+
+            // Simulate renderer calling TriggerSelection and acquiring selection area
+            auto selectionRects = term.GetSelectionRects();
+
+            // Validate selection area
+            VERIFY_ARE_EQUAL(selectionRects.size(), static_cast<size_t>(2));
+
+            auto selection = term.GetViewport().ConvertToOrigin(selectionRects.at(0)).ToInclusive();
+            VERIFY_ARE_EQUAL(selection, SMALL_RECT({ 4, 0, 9, 0 }));
+
+            selection = term.GetViewport().ConvertToOrigin(selectionRects.at(1)).ToInclusive();
+            VERIFY_ARE_EQUAL(selection, SMALL_RECT({ 0, 1, 4, 1 }));
+        }
+
+        TEST_METHOD(SemanticUnit_Url)
+        {
+            Terminal term;
+            DummyRenderTarget emptyRT;
+            term.Create({ 10, 5 }, 0, emptyRT);
+
+            // buffer: go http://
+            //         x.io/path/
+            //         to, ok
+            term.Write(L"go http://x.io/path/to, ok");
+
+            // Simulate selecting the unit at (x,y) = (5,1)
+            term.SemanticUnitSelection({ 5, 1 });
+
+            // Simulate renderer calling TriggerSelection and acquiring selection area
+            auto selectionRects = term.GetSelectionRects();
+
+            // Validate selection area: the slashes don't stop it, but the
+            // comma after it isn't part of it.
+            VERIFY_ARE_EQUAL(selectionRects.size(), static_cast<size_t>(3));
+
+            auto selection = term.GetViewport().ConvertToOrigin(selectionRects.at(0)).ToInclusive();
+            VERIFY_ARE_EQUAL(selection, SMALL_RECT({ 3, 0, 9, 0 }));
+
+            selection = term.GetViewport().ConvertToOrigin(selectionRects.at(1)).ToInclusive();
+            VERIFY_ARE_EQUAL(selection, SMALL_RECT({ 0, 1, 9, 1 }));
+
+            selection = term.GetViewport().ConvertToOrigin(selectionRects.at(2)).ToInclusive();
+            VERIFY_ARE_EQUAL(selection, SMALL_RECT({ 0, 2, 1, 2 }));
+        }
+
         TEST_METHOD(TripleClick_GeneralCase)
         {
             Terminal term;
@@ -0,0 +1,88 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include <WexTestClass.h>
+
+#include "../cascadia/TerminalCore/Terminal.hpp"
+#include "../renderer/inc/DummyRenderTarget.hpp"
+#include "consoletaeftemplates.hpp"
+
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+using namespace Microsoft::Terminal::Core;
+
+namespace TerminalCoreUnitTests
+{
+    class TerminalBufferTests
+    {
+        TEST_CLASS(TerminalBufferTests);
+
+        TEST_METHOD(PrintableRunsWrapAtTheRightEdge)
+        {
+            Terminal term;
+            DummyRenderTarget emptyRT;
+            term.Create({ 10, 5 }, 0, emptyRT);
+
+            term.Write(L"0123456789abc\r\nxy\bz");
+
+            const auto& buffer = term.GetTextBuffer();
+            VERIFY_ARE_EQUAL(std::wstring_view{ L"0123456789" }, std::wstring_view{ buffer.GetRowByOffset(0).GetText() }.substr(0, 10));
+            VERIFY_ARE_EQUAL(std::wstring_view{ L"abc" }, std::wstring_view{ buffer.GetRowByOffset(1).GetText() }.substr(0, 3));
+            VERIFY_ARE_EQUAL(std::wstring_view{ L"xz" }, std::wstring_view{ buffer.GetRowByOffset(2).GetText() }.substr(0, 2));
+
+            const auto cursor = buffer.GetCursor().GetPosition();
+            VERIFY_ARE_EQUAL(2i16, cursor.X);
+            VERIFY_ARE_EQUAL(2i16, cursor.Y);
+
+            Log::Comment(L"A run that exactly fills its row doesn't wrap until there's more to print.");
+            term.Write(L"\r\n0123456789\r\nnext");
+            VERIFY_ARE_EQUAL(std::wstring_view{ L"next" }, std::wstring_view{ buffer.GetRowByOffset(4).GetText() }.substr(0, 4));
+        }
+
+        TEST_METHOD(LineFeedClearsPendingWrap)
+        {
+            Terminal term;
+            DummyRenderTarget emptyRT;
+            term.Create({ 10, 5 }, 0, emptyRT);
+
+            term.Write(L"0123456789\nx");
+
+            Log::Comment(L"The line feed moved down to the very next row, at the last column.");
+            const auto& buffer = term.GetTextBuffer();
+            VERIFY_ARE_EQUAL(std::wstring_view{ L"0123456789" }, std::wstring_view{ buffer.GetRowByOffset(0).GetText() }.substr(0, 10));
+            VERIFY_ARE_EQUAL(std::wstring_view{ L"         x" }, std::wstring_view{ buffer.GetRowByOffset(1).GetText() }.substr(0, 10));
+            VERIFY_ARE_EQUAL(std::wstring_view{ L"          " }, std::wstring_view{ buffer.GetRowByOffset(2).GetText() }.substr(0, 10));
+            VERIFY_ARE_EQUAL(1i16, buffer.GetCursor().GetPosition().Y);
+        }
+
+        TEST_METHOD(ScrollingIsNotifiedOncePerWrite)
+        {
+            Terminal term;
+            DummyRenderTarget emptyRT;
+            term.Create({ 10, 5 }, 5, emptyRT);
+
+            int notifications = 0;
+            int lastTop = 0;
+            term.SetScrollPositionChangedCallback([&](const int top, const int /*height*/, const int /*bottom*/) {
+                ++notifications;
+                lastTop = top;
+            });
+
+            std::wstring lines;
+            for (int i = 0; i < 50; ++i)
+            {
+                lines += L"line\r\n";
+            }
+            term.Write(lines);
+
+            VERIFY_ARE_EQUAL(1, notifications);
+            VERIFY_ARE_EQUAL(5, lastTop);
+
+            Log::Comment(L"Nothing's said when nothing scrolls.");
+            term.Write(L"text");
+            VERIFY_ARE_EQUAL(1, notifications);
+        }
+    };
+}
@@ -18,6 +18,8 @@ const std::wstring_view ConsoleArguments::FILEPATH_LEADER_PREFIX = L"\\??\\";
 const std::wstring_view ConsoleArguments::WIDTH_ARG = L"--width";
 const std::wstring_view ConsoleArguments::HEIGHT_ARG = L"--height";
 const std::wstring_view ConsoleArguments::INHERIT_CURSOR_ARG = L"--inheritcursor";
+const std::wstring_view ConsoleArguments::VT_FRAME_BUDGET_ARG = L"--vtframebudget";
+const std::wstring_view ConsoleArguments::VT_SCROLL_MARGINS_ARG = L"--vtscrollmargins";
 const std::wstring_view ConsoleArguments::FEATURE_ARG = L"--feature";
 const std::wstring_view ConsoleArguments::FEATURE_PTY_ARG = L"pty";
 
@@ -114,6 +116,8 @@ ConsoleArguments::ConsoleArguments(const std::wstring& commandline,
     _width = 0;
     _height = 0;
     _inheritCursor = false;
+    _vtFrameBudget = 0;
+    _vtScrollMargins = false;
 }
 
 ConsoleArguments::ConsoleArguments() :
@@ -138,6 +142,8 @@ ConsoleArguments& ConsoleArguments::operator=(const ConsoleArguments& other)
         _width = other._width;
         _height = other._height;
         _inheritCursor = other._inheritCursor;
+        _vtFrameBudget = other._vtFrameBudget;
+        _vtScrollMargins = other._vtScrollMargins;
         _recievedEarlySizeChange = other._recievedEarlySizeChange;
     }
 
@@ -276,6 +282,56 @@ void ConsoleArguments::s_ConsumeArg(_Inout_ std::vector<std::wstring>& args, _In
     return (succeeded) ? S_OK : E_INVALIDARG;
 }
 
+// Routine Description:
+//  Given the commandline of tokens `args`, tries to find the argument at
+//      index+1, and places its value into pSetting. See above for examples.
+//  This implementation attempts to parse an unsigned 32-bit value from the argument.
+// Arguments:
+//  args: A collection of wstrings representing command-line arguments
+//  index: the index of the argument of which to get the value for. The value
+//      should be at (index+1). index will be decremented by one on success.
+//  pSetting: receives the DWORD at index+1
+// Return Value:
+//  S_OK if we parsed the DWORD successfully, otherwise E_INVALIDARG indicating
+//      failure. This could be the case for non-numeric or negative arguments,
+//      or for >MAXDWORD args.
+[[nodiscard]] HRESULT ConsoleArguments::s_GetArgumentValue(_Inout_ std::vector<std::wstring>& args,
+                                                           _Inout_ size_t& index,
+                                                           _Out_opt_ DWORD* const pSetting)
+{
+    bool succeeded = (index + 1) < args.size();
+    if (succeeded)
+    {
+        s_ConsumeArg(args, index);
+        if (pSetting != nullptr)
+        {
+            try
+            {
+                // std::stoull would happily skip whitespace and negate a
+                //      leading '-', so only accept digits from the start.
+                size_t pos = 0;
+                const auto& arg = args[index];
+                const auto value = (!arg.empty() && iswdigit(arg.front())) ? std::stoull(arg, &pos) : 0;
+                if (pos == 0 || value > MAXDWORD || pos != arg.length())
+                {
+                    succeeded = false;
+                }
+                else
+                {
+                    *pSetting = static_cast<DWORD>(value);
+                    succeeded = true;
+                }
+            }
+            catch (...)
+            {
+                succeeded = false;
+            }
+        }
+        s_ConsumeArg(args, index);
+    }
+    return (succeeded) ? S_OK : E_INVALIDARG;
+}
+
 // Routine Description:
 // - Parsing helper that will turn a string into a handle value if possible.
 // Arguments:
@@ -463,6 +519,15 @@ void ConsoleArguments::s_ConsumeArg(_Inout_ std::vector<std::wstring>& args, _In
         {
             hr = s_GetArgumentValue(args, i, &_height);
         }
+        else if (arg == VT_FRAME_BUDGET_ARG)
+        {
+            hr = s_GetArgumentValue(args, i, &_vtFrameBudget);
+            // A budget of no bytes at all can't be met.
+            if (SUCCEEDED(hr) && _vtFrameBudget == 0)
+            {
+                hr = E_INVALIDARG;
+            }
+        }
         else if (arg == FEATURE_ARG)
         {
             hr = s_HandleFeatureValue(args, i);
@@ -479,6 +544,12 @@ void ConsoleArguments::s_ConsumeArg(_Inout_ std::vector<std::wstring>& args, _In
             s_ConsumeArg(args, i);
             hr = S_OK;
         }
+        else if (arg == VT_SCROLL_MARGINS_ARG)
+        {
+            _vtScrollMargins = true;
+            s_ConsumeArg(args, i);
+            hr = S_OK;
+        }
         else if (arg == CLIENT_COMMANDLINE_ARG)
         {
             // Everything after this is the explicit commandline
@@ -612,6 +683,23 @@ bool ConsoleArguments::GetInheritCursor() const
     return _inheritCursor;
 }
 
+// Method Description:
+// - Gets the maximum number of bytes the VT renderer should try to write in a
+//      single frame, or 0 if there's no limit.
+DWORD ConsoleArguments::GetVtFrameBudget() const
+{
+    return _vtFrameBudget;
+}
+
+// Method Description:
+// - Gets whether the terminal on the other end of the pty is known to scroll
+//      within the margins set by DECSTBM, so the VT renderer can scroll
+//      regions of the viewport rather than repainting them.
+bool ConsoleArguments::GetVtScrollMargins() const
+{
+    return _vtScrollMargins;
+}
+
 // Method Description:
 // - Tell us to use a different size than the one parsed as the size of the
 //      console. This is called by the PtySignalInputThread when it receives a
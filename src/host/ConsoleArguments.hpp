@@ -50,6 +50,8 @@ public:
     short GetWidth() const;
     short GetHeight() const;
     bool GetInheritCursor() const;
+    DWORD GetVtFrameBudget() const;
+    bool GetVtScrollMargins() const;
 
     void SetExpectedSize(COORD dimensions) noexcept;
 
@@ -64,6 +66,8 @@ public:
     static const std::wstring_view WIDTH_ARG;
     static const std::wstring_view HEIGHT_ARG;
     static const std::wstring_view INHERIT_CURSOR_ARG;
+    static const std::wstring_view VT_FRAME_BUDGET_ARG;
+    static const std::wstring_view VT_SCROLL_MARGINS_ARG;
     static const std::wstring_view FEATURE_ARG;
     static const std::wstring_view FEATURE_PTY_ARG;
 
@@ -82,7 +86,9 @@ private:
                      const bool createServerHandle,
                      const DWORD serverHandle,
                      const DWORD signalHandle,
-                     const bool inheritCursor) :
+                     const bool inheritCursor,
+                     const bool vtScrollMargins = false,
+                     const DWORD vtFrameBudget = 0) :
         _commandline(commandline),
         _clientCommandline(clientCommandline),
         _vtInHandle(vtInHandle),
@@ -96,6 +102,8 @@ private:
         _serverHandle(serverHandle),
         _signalHandle(signalHandle),
         _inheritCursor(inheritCursor),
+        _vtFrameBudget{ vtFrameBudget },
+        _vtScrollMargins{ vtScrollMargins },
         _recievedEarlySizeChange{ false },
         _originalWidth{ -1 },
         _originalHeight{ -1 }
@@ -123,6 +131,8 @@ private:
     DWORD _serverHandle;
     DWORD _signalHandle;
     bool _inheritCursor;
+    DWORD _vtFrameBudget;
+    bool _vtScrollMargins;
 
     bool _recievedEarlySizeChange;
     short _originalWidth;
@@ -140,6 +150,9 @@ private:
     [[nodiscard]] static HRESULT s_GetArgumentValue(_Inout_ std::vector<std::wstring>& args,
                                                     _Inout_ size_t& index,
                                                     _Out_opt_ short* const pSetting);
+    [[nodiscard]] static HRESULT s_GetArgumentValue(_Inout_ std::vector<std::wstring>& args,
+                                                    _Inout_ size_t& index,
+                                                    _Out_opt_ DWORD* const pSetting);
     [[nodiscard]] static HRESULT s_HandleFeatureValue(_Inout_ std::vector<std::wstring>& args,
                                                       _Inout_ size_t& index);
 
@@ -217,7 +230,9 @@ namespace WEX
                        expected.GetServerHandle() == actual.GetServerHandle() &&
                        expected.HasSignalHandle() == actual.HasSignalHandle() &&
                        expected.GetSignalHandle() == actual.GetSignalHandle() &&
-                       expected.GetInheritCursor() == actual.GetInheritCursor();
+                       expected.GetInheritCursor() == actual.GetInheritCursor() &&
+                       expected.GetVtScrollMargins() == actual.GetVtScrollMargins() &&
+                       expected.GetVtFrameBudget() == actual.GetVtFrameBudget();
             }
 
             static bool AreSame(const ConsoleArguments& expected, const ConsoleArguments& actual)
@@ -242,7 +257,9 @@ namespace WEX
                        !object.ShouldCreateServerHandle() &&
                        object.GetServerHandle() == 0 &&
                        (object.GetSignalHandle() == 0 || object.GetSignalHandle() == INVALID_HANDLE_VALUE) &&
-                       !object.GetInheritCursor();
+                       !object.GetInheritCursor() &&
+                       !object.GetVtScrollMargins() &&
+                       object.GetVtFrameBudget() == 0;
             }
         };
     }
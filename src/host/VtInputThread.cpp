@@ -28,7 +28,6 @@ VtInputThread::VtInputThread(_In_ wil::unique_hfile hPipe,
                              const bool inheritCursor) :
     _hFile{ std::move(hPipe) },
     _hThread{},
-    _utf8Parser{ CP_UTF8 },
     _dwThreadId{ 0 },
     _exitRequested{ false },
     _exitResult{ S_OK }
@@ -50,7 +49,9 @@ VtInputThread::VtInputThread(_In_ wil::unique_hfile hPipe,
 // Method Description:
 // - Processes a buffer of input characters. The characters should be utf-8
 //      encoded, and will get converted to wchar_t's to be processed by the
-//      input state machine.
+//      input state machine. A sequence that's split across two reads is held
+//      onto until the rest of it arrives, and invalid bytes are replaced with
+//      U+FFFD.
 // Arguments:
 // - charBuffer - the UTF-8 characters recieved.
 // - cch - number of UTF-8 characters in charBuffer
@@ -68,16 +69,12 @@ VtInputThread::VtInputThread(_In_ wil::unique_hfile hPipe,
 
     try
     {
-        std::unique_ptr<wchar_t[]> pwsSequence;
-        unsigned int cchConsumed;
-        unsigned int cchSequence;
-        auto hr = _utf8Parser.Parse(charBuffer, cch, cchConsumed, pwsSequence, cchSequence);
-        // If we hit a parsing error, eat it. It's bad utf-8, we can't do anything with it.
-        if (FAILED(hr))
+        const std::string_view utf8{ reinterpret_cast<const char*>(charBuffer), gsl::narrow<size_t>(cch) };
+        const auto cchSequence = _utf8Decoder.Decode(utf8, { _decoded, gsl::narrow<ptrdiff_t>(ARRAYSIZE(_decoded)) });
+        if (cchSequence > 0)
         {
-            return S_FALSE;
+            _pInputStateMachine->ProcessString(_decoded, cchSequence);
         }
-        _pInputStateMachine->ProcessString(pwsSequence.get(), cchSequence);
     }
     CATCH_RETURN();
 
@@ -106,7 +103,7 @@ DWORD WINAPI VtInputThread::StaticVtInputThreadProc(_In_ LPVOID lpParameter)
 // - <none>
 void VtInputThread::DoReadInput(const bool throwOnFail)
 {
-    byte buffer[256];
+    byte buffer[_readBufferSize];
     DWORD dwRead = 0;
     bool fSuccess = !!ReadFile(_hFile.get(), buffer, ARRAYSIZE(buffer), &dwRead, nullptr);
 
@@ -15,7 +15,7 @@ Author(s):
 #pragma once
 
 #include "..\terminal\parser\StateMachine.hpp"
-#include "utf8ToWideCharParser.hpp"
+#include "../types/inc/Utf8Transcoder.hpp"
 
 namespace Microsoft::Console
 {
@@ -40,6 +40,11 @@ namespace Microsoft::Console
         HRESULT _exitResult;
 
         std::unique_ptr<Microsoft::Console::VirtualTerminal::StateMachine> _pInputStateMachine;
-        Utf8ToWideCharParser _utf8Parser;
+
+        // Large enough that a paste arrives in a few reads, each parsed under
+        //      a single acquisition of the console lock.
+        static constexpr size_t _readBufferSize{ 4096 };
+        Microsoft::Console::Utf8::StreamDecoder _utf8Decoder;
+        wchar_t _decoded[Microsoft::Console::Utf8::StreamDecoder::MaxOutputLength(_readBufferSize)]{ 0 };
     };
 }
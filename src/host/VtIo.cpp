@@ -25,6 +25,8 @@ VtIo::VtIo() :
     _initialized(false),
     _objectsCreated(false),
     _lookingForCursorPosition(false),
+    _frameByteBudget(0),
+    _scrollMargins(false),
     _IoMode(VtIoMode::INVALID)
 {
 }
@@ -73,6 +75,8 @@ VtIo::VtIo() :
 [[nodiscard]] HRESULT VtIo::Initialize(const ConsoleArguments* const pArgs)
 {
     _lookingForCursorPosition = pArgs->GetInheritCursor();
+    _frameByteBudget = pArgs->GetVtFrameBudget();
+    _scrollMargins = pArgs->GetVtScrollMargins();
 
     // If we were already given VT handles, set up the VT IO engine to use those.
     if (pArgs->InConptyMode())
@@ -192,6 +196,18 @@ VtIo::VtIo() :
             if (_pVtRenderEngine)
             {
                 _pVtRenderEngine->SetTerminalOwner(this);
+                _pVtRenderEngine->SetFrameByteBudget(_frameByteBudget);
+                _pVtRenderEngine->SetScrollMarginsSupported(_scrollMargins);
+
+                // If the renderer skips a frame because the terminal hasn't
+                //      read the last one yet, the engine needs another frame
+                //      once the pipe drains. This is called on the engine's
+                //      writer thread, without the console lock, so all it may
+                //      do is wake up the render thread. It's set before the
+                //      engine is handed any frames to write.
+                _pVtRenderEngine->SetRepaintCallback([]() {
+                    ServiceLocator::LocateGlobals().pRender->NotifyPaintFrame();
+                });
             }
         }
     }
@@ -245,6 +261,12 @@ bool VtIo::IsUsingVt() const
     // We need both handles for this initialization to work. If we don't have
     //      both, we'll skip it. They either aren't going to be reading output
     //      (so they can't get the DSR) or they can't write the response to us.
+    // Pastes are only worth bracketing if we're the ones reading the input.
+    if (_pVtRenderEngine && _pVtInputThread)
+    {
+        LOG_IF_FAILED(_pVtRenderEngine->RequestBracketedPaste());
+    }
+
     if (_lookingForCursorPosition && _pVtRenderEngine && _pVtInputThread)
     {
         LOG_IF_FAILED(_pVtRenderEngine->RequestCursor());
@@ -51,6 +51,8 @@ namespace Microsoft::Console::VirtualTerminal
         bool _objectsCreated;
 
         bool _lookingForCursorPosition;
+        DWORD _frameByteBudget;
+        bool _scrollMargins;
         std::mutex _shutdownLock;
 
         std::unique_ptr<Microsoft::Console::Render::VtEngine> _pVtRenderEngine;
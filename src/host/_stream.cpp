@@ -14,14 +14,19 @@
 #include "dbcs.h"
 #include "handle.h"
 #include "misc.h"
-#include "utf8ToWidecharParser.hpp"
 
 #include "../types/inc/convert.hpp"
+#include "../types/inc/Utf8Transcoder.hpp"
 #include "../types/inc/GlyphWidth.hpp"
 #include "../types/inc/Viewport.hpp"
 
 #include "..\interactivity\inc\ServiceLocator.hpp"
 
+#if defined(_M_IX86) || defined(_M_X64)
+#include <emmintrin.h>
+#define STREAM_SSE2
+#endif
+
 #pragma hdrstop
 using namespace Microsoft::Console::Types;
 using Microsoft::Console::Interactivity::ServiceLocator;
@@ -29,6 +34,43 @@ using Microsoft::Console::VirtualTerminal::StateMachine;
 // Used by WriteCharsLegacy.
 #define IS_GLYPH_CHAR(wch) (((wch) < L' ') || ((wch) == 0x007F))
 
+// Routine Description:
+// - Counts the printable ASCII characters at the start of a string. They're
+//   never control characters and never full width, so WriteCharsLegacy can
+//   write a run of them without looking at each one.
+// Arguments:
+// - pwch - the start of the string
+// - cch - the most characters to count
+// Return Value:
+// - the number of printable ASCII characters before the first other one.
+static size_t CountPrintableAscii(const wchar_t* const pwch, const size_t cch) noexcept
+{
+    size_t count = 0;
+#ifdef STREAM_SSE2
+    const auto belowSpace = _mm_set1_epi16(L' ' - 1);
+    const auto deleteChar = _mm_set1_epi16(0x007F);
+    for (; count + 8 <= cch; count += 8)
+    {
+        // Characters from 0x8000 up are negative as signed shorts, so they
+        // fail the first comparison along with the C0 controls.
+        const auto chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pwch + count));
+        const auto printable = _mm_and_si128(_mm_cmpgt_epi16(chars, belowSpace), _mm_cmplt_epi16(chars, deleteChar));
+        const auto mask = static_cast<unsigned long>(_mm_movemask_epi8(printable));
+        if (mask != 0xffff)
+        {
+            unsigned long first;
+            _BitScanForward(&first, ~mask);
+            return count + first / sizeof(wchar_t);
+        }
+    }
+#endif
+    while (count < cch && pwch[count] >= L' ' && pwch[count] < 0x007F)
+    {
+        ++count;
+    }
+    return count;
+}
+
 // Routine Description:
 // - This routine updates the cursor position.  Its input is the non-special
 //   cased new location of the cursor.  For example, if the cursor were being
@@ -400,6 +442,35 @@ using Microsoft::Console::VirtualTerminal::StateMachine;
         XPosition = cursor.GetPosition().X;
         size_t i = 0;
         wchar_t* LocalBufPtr = LocalBuffer;
+        const wchar_t* RunText = LocalBuffer;
+
+        // Printable ASCII comes out just as it went in, so a run of it (up to
+        // the end of the row) is written straight from the string, rather than
+        // being copied through LocalBuffer a character at a time.
+        if (XPosition < coordScreenBufferSize.X)
+        {
+            const size_t cchRemaining = (BufferSize - *pcb) / sizeof(wchar_t);
+            size_t cchRun = CountPrintableAscii(lpString, std::min<size_t>(cchRemaining, coordScreenBufferSize.X - XPosition));
+
+            // If what follows the run could be a combining mark, the run's last
+            // character is left for the loop below, so they end up in one cell.
+            if (cchRun != 0 && cchRun < cchRemaining && lpString[cchRun] >= 0x80)
+            {
+                --cchRun;
+            }
+            if (cchRun != 0)
+            {
+                RunText = lpString;
+                i = cchRun;
+                XPosition = gsl::narrow_cast<SHORT>(XPosition + cchRun);
+                lpString += cchRun;
+                pwchRealUnicode += cchRun;
+                pwchBuffer += cchRun;
+                *pcb += cchRun * sizeof(wchar_t);
+                goto EndWhile;
+            }
+        }
+
         while (*pcb < BufferSize && i < LOCAL_BUFFER_SIZE && XPosition < coordScreenBufferSize.X)
         {
 #pragma prefast(suppress : 26019, "Buffer is taken in multiples of 2. Validation is ok.")
@@ -556,16 +627,21 @@ using Microsoft::Console::VirtualTerminal::StateMachine;
             }
 
             // line was wrapped if we're writing up to the end of the current row
-            OutputCellIterator it(std::wstring_view(LocalBuffer, i), Attributes);
+            OutputCellIterator it(std::wstring_view(RunText, i), Attributes);
             const auto itEnd = screenInfo.Write(it);
 
+            // XPosition counted a column for every character, but a combining mark
+            // shares its cell with the character before it. The cells the write
+            // actually took are where the cursor belongs.
+            const auto cellsWritten = gsl::narrow<SHORT>(itEnd.GetCellDistance(it));
+
             // Notify accessibility
-            screenInfo.NotifyAccessibilityEventing(CursorPosition.X, CursorPosition.Y, CursorPosition.X + gsl::narrow<SHORT>(i - 1), CursorPosition.Y);
+            screenInfo.NotifyAccessibilityEventing(CursorPosition.X, CursorPosition.Y, CursorPosition.X + cellsWritten - 1, CursorPosition.Y);
 
             // The number of "spaces" or "cells" we have consumed needs to be reported and stored for later
             // when/if we need to erase the command line.
-            TempNumSpaces += itEnd.GetCellDistance(it);
-            CursorPosition.X = XPosition;
+            TempNumSpaces += cellsWritten;
+            CursorPosition.X += cellsWritten;
 
             // enforce a delayed newline if we're about to pass the end and the WC_DELAY_EOL_WRAP flag is set.
             if (WI_IsFlagSet(dwFlags, WC_DELAY_EOL_WRAP) && CursorPosition.X >= coordScreenBufferSize.X)
@@ -1124,34 +1200,29 @@ using Microsoft::Console::VirtualTerminal::StateMachine;
 
         const auto codepage = gci.OutputCP;
 
-        // Convert our input parameters to Unicode
-        std::unique_ptr<wchar_t[]> wideCharBuffer{ nullptr };
-        static Utf8ToWideCharParser parser{ gci.OutputCP };
-
-        // update current codepage in case it was changed from last time
-        // this was called. We do this outside the UTF-8 check because the parser drops its state
-        // when the codepage changes.
-        parser.SetCodePage(gci.OutputCP);
+        // Convert our input parameters to Unicode.
+        // The decoder holds onto a UTF-8 sequence that was split across two calls, and the
+        // decoded text is written into the same buffer every time, so it only grows as big
+        // as the largest write. We do this outside the UTF-8 check because the decoder drops
+        // its state when the codepage changes.
+        static Microsoft::Console::Utf8::StreamDecoder decoder;
+        static UINT decoderCodepage = codepage;
+        static std::wstring decoded;
+        if (decoderCodepage != codepage)
+        {
+            decoder.Reset();
+            decoderCodepage = codepage;
+        }
 
         SCREEN_INFORMATION& ScreenInfo = context.GetActiveBuffer();
         wchar_t* pwchBuffer;
         size_t cchBuffer;
         if (codepage == CP_UTF8)
         {
-            wideCharBuffer.release();
-            unsigned int charCount;
-            unsigned int charsConsumed;
-            unsigned int charsGenerated;
-            RETURN_IF_FAILED(SizeTToUInt(buffer.size(), &charCount));
-            RETURN_IF_FAILED(parser.Parse(reinterpret_cast<const byte*>(buffer.data()),
-                                          charCount,
-                                          charsConsumed,
-                                          wideCharBuffer,
-                                          charsGenerated));
-
-            pwchBuffer = reinterpret_cast<wchar_t*>(wideCharBuffer.get());
-            cchBuffer = charsGenerated;
-            read = charsConsumed;
+            decoded.resize(Microsoft::Console::Utf8::StreamDecoder::MaxOutputLength(buffer.size()));
+            cchBuffer = decoder.Decode(buffer, { decoded.data(), gsl::narrow<ptrdiff_t>(decoded.size()) });
+            pwchBuffer = decoded.data();
+            read = buffer.size();
         }
         else
         {
@@ -11,7 +11,7 @@
 
 #include "../interactivity/inc/ServiceLocator.hpp"
 #include "../types/inc/GlyphWidth.hpp"
-#include "../types/inc/Utf16Parser.hpp"
+#include "../types/inc/GraphemeClusterIterator.hpp"
 
 // Attributes flags:
 #define COMMON_LVB_GRID_SINGLEFLAG 0x2000 // DBCS: Grid attribute: use for ime cursor.
@@ -226,19 +226,17 @@ std::vector<OutputCell> ConsoleImeInfo::s_ConvertToCells(const std::wstring_view
 {
     std::vector<OutputCell> cells;
 
-    // - Convert incoming wchar_t stream into UTF-16 units.
-    const auto glyphs = Utf16Parser::Parse(text);
-
-    // - Walk through all of the grouped up text, match up the correct attribute to it, and make a new cell.
+    // - Walk through the incoming wchar_t stream one grapheme cluster at a time,
+    //   match up the correct attribute to it, and make a new cell.
     size_t attributesUsed = 0;
-    for (const auto& parsedGlyph : glyphs)
+    for (GraphemeClusterIterator it{ text }; it; ++it)
     {
-        const std::wstring_view glyph{ parsedGlyph.data(), parsedGlyph.size() };
+        const auto glyph = *it;
         // Collect up attributes that apply to this glyph range.
         auto drawingAttr = s_RetrieveAttributeAt(attributesUsed, attributes, colorArray);
         attributesUsed++;
 
-        // The IME gave us an attribute for every glyph position in a surrogate pair.
+        // The IME gave us an attribute for every wchar_t of the cluster.
         // But the only important information will be the cursor position.
         // Check all additional attributes to see if the cursor resides on top of them.
         for (size_t i = 1; i < glyph.size(); i++)
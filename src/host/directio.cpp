@@ -420,7 +420,7 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 // Return Value:
 // - HRESULT indicating success or failure
 [[nodiscard]] static HRESULT _WriteConsoleInputWImplHelper(InputBuffer& context,
-                                                           std::deque<std::unique_ptr<IInputEvent>>& events,
+                                                           const gsl::span<const INPUT_RECORD> records,
                                                            size_t& written,
                                                            const bool append) noexcept
 {
@@ -431,11 +431,11 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
         // add to InputBuffer
         if (append)
         {
-            written = context.Write(events);
+            written = context.Write(records);
         }
         else
         {
-            written = context.Prepend(events);
+            written = context.Prepend(records);
         }
 
         return S_OK;
@@ -444,21 +444,21 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 }
 
 // Routine Description:
-// - Writes events to the input buffer already formed into IInputEvents (private call)
+// - Writes records to the input buffer (private call)
 // Arguments:
 // - context - the input buffer to write to
-// - events - the events to written
+// - records - the records to written
 // - written  - on output, the number of events written
 // - append - true if events should be written to the end of the input
 // buffer, false if they should be written to the front
 // Return Value:
 // - HRESULT indicating success or failure
 [[nodiscard]] HRESULT DoSrvPrivateWriteConsoleInputW(_Inout_ InputBuffer* const pInputBuffer,
-                                                     _Inout_ std::deque<std::unique_ptr<IInputEvent>>& events,
+                                                     const gsl::span<const INPUT_RECORD> records,
                                                      _Out_ size_t& eventsWritten,
                                                      const bool append) noexcept
 {
-    return _WriteConsoleInputWImplHelper(*pInputBuffer, events, eventsWritten, append);
+    return _WriteConsoleInputWImplHelper(*pInputBuffer, records, eventsWritten, append);
 }
 
 // Routine Description:
@@ -500,7 +500,8 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
             context.StoreWritePartialByteSequence(std::move(partialEvent));
         }
 
-        return _WriteConsoleInputWImplHelper(context, events, written, append);
+        const auto records = IInputEvent::ToInputRecords(events);
+        return _WriteConsoleInputWImplHelper(context, records, written, append);
     }
     CATCH_RETURN();
 }
@@ -527,9 +528,10 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 
     try
     {
-        auto events = IInputEvent::Create(buffer);
+        // The records are stored as they are, so they don't need to be converted.
+        const gsl::span<const INPUT_RECORD> records{ buffer.data(), gsl::narrow<ptrdiff_t>(buffer.size()) };
 
-        return _WriteConsoleInputWImplHelper(context, events, written, append);
+        return _WriteConsoleInputWImplHelper(context, records, written, append);
     }
     CATCH_RETURN();
 }
@@ -22,7 +22,7 @@ Revision History:
 class SCREEN_INFORMATION;
 
 [[nodiscard]] HRESULT DoSrvPrivateWriteConsoleInputW(_Inout_ InputBuffer* const pInputBuffer,
-                                                     _Inout_ std::deque<std::unique_ptr<IInputEvent>>& events,
+                                                     const gsl::span<const INPUT_RECORD> records,
                                                      _Out_ size_t& eventsWritten,
                                                      const bool append) noexcept;
 
@@ -32,6 +32,35 @@ using Microsoft::Console::Interactivity::ServiceLocator;
 // for maintaining LRU, then this datatype can be changed.
 std::list<CommandHistory> CommandHistory::s_historyLists;
 
+// Overrides where histories are persisted. Only set by the unit tests.
+std::wstring CommandHistory::s_persistenceDirectory;
+
+// A persisted history file starts with this, followed by one record for each
+// change that was made to the history (see s_AppendPersistedRecord).
+static constexpr std::array<char, 8> PersistedHistoryMagic{ 'C', 'M', 'D', 'H', 'I', 'S', 'T', '1' };
+
+// Routine Description:
+// - Takes the lock on a persisted file, waiting for whichever console holds it
+//   to let it go. The lock is on a byte well past the end of any real file, so
+//   it doesn't get in the way of reading the file.
+// Arguments:
+// - file - the persisted file
+// Return Value:
+// - An object that lets the lock go when it's destroyed.
+// Note:
+// - will throw exception on error
+static auto LockPersistedHistory(const HANDLE file)
+{
+    OVERLAPPED range{};
+    range.Offset = MAXDWORD;
+    range.OffsetHigh = MAXLONG;
+    THROW_IF_WIN32_BOOL_FALSE(LockFileEx(file, LOCKFILE_EXCLUSIVE_LOCK, 0, 1, 0, &range));
+
+    return wil::scope_exit([file, range]() mutable noexcept {
+        LOG_IF_WIN32_BOOL_FALSE(UnlockFileEx(file, 0, 1, 0, &range));
+    });
+}
+
 CommandHistory* CommandHistory::s_Find(const HANDLE processHandle)
 {
     for (auto& historyList : s_historyLists)
@@ -77,6 +106,17 @@ static bool CaseInsensitiveEquality(wchar_t a, wchar_t b)
     return ::towlower(a) == ::towlower(b);
 }
 
+static bool CaseInsensitiveLess(wchar_t a, wchar_t b)
+{
+    return ::towlower(a) < ::towlower(b);
+}
+
+static bool CaseInsensitiveStartsWith(const std::wstring_view text, const std::wstring_view prefix)
+{
+    return text.size() >= prefix.size() &&
+           std::equal(prefix.cbegin(), prefix.cend(), text.cbegin(), CaseInsensitiveEquality);
+}
+
 bool CommandHistory::IsAppNameMatch(const std::wstring_view other) const
 {
     return std::equal(_appName.cbegin(), _appName.cend(), other.cbegin(), other.cend(), CaseInsensitiveEquality);
@@ -117,13 +157,14 @@ void CommandHistory::_Reset()
                 SHORT index;
                 if (FindMatchingCommand(newCommand, LastDisplayed, index, CommandHistory::MatchOptions::ExactMatch))
                 {
-                    reuse = Remove(index);
+                    reuse = _Remove(index);
                 }
             }
 
             // find free record.  if all records are used, free the lru one.
             if ((SHORT)_commands.size() == _maxCommands)
             {
+                _IndexErase(0, true);
                 _commands.erase(_commands.cbegin());
                 // move LastDisplayed back one in order to stay synced with the
                 // command it referred to before erasing the lru one
@@ -139,6 +180,8 @@ void CommandHistory::_Reset()
             {
                 _commands.emplace_back(newCommand);
             }
+            _IndexInsert(gsl::narrow<SHORT>(_commands.size() - 1));
+            _AppendPersisted(PersistedChange::Add, { newCommand });
 
             if (LastDisplayed == -1 ||
                 _commands.at(LastDisplayed).size() != newCommand.size() ||
@@ -249,8 +292,10 @@ std::wstring_view CommandHistory::GetLastCommand() const
 void CommandHistory::Empty()
 {
     _commands.clear();
+    _prefixIndex.clear();
     LastDisplayed = -1;
     Flags = CLE_RESET;
+    _AppendPersisted(PersistedChange::Empty, {});
 }
 
 bool CommandHistory::AtFirstCommand() const
@@ -290,6 +335,7 @@ void CommandHistory::Realloc(const size_t commands)
     {
         _commands.emplace_back(oldCommands[i]);
     }
+    _RebuildIndex();
 
     WI_SetFlag(Flags, CLE_RESET);
     LastDisplayed = gsl::narrow<SHORT>(_commands.size()) - 1;
@@ -370,6 +416,7 @@ CommandHistory* CommandHistory::s_Allocate(const std::wstring_view appName, cons
         History.LastDisplayed = -1;
         History._maxCommands = gsl::narrow<SHORT>(gci.GetHistoryBufferSize());
         History._processHandle = processHandle;
+        History._LoadPersisted(s_GetPersistencePath(appName));
         return &s_historyLists.emplace_front(History);
     }
     else if (!BestCandidate.has_value() && s_historyLists.size() > 0)
@@ -392,6 +439,7 @@ CommandHistory* CommandHistory::s_Allocate(const std::wstring_view appName, cons
         if (!SameApp)
         {
             BestCandidate->_commands.clear();
+            BestCandidate->_prefixIndex.clear();
             BestCandidate->LastDisplayed = -1;
             BestCandidate->_appName = appName;
         }
@@ -399,6 +447,11 @@ CommandHistory* CommandHistory::s_Allocate(const std::wstring_view appName, cons
         BestCandidate->_processHandle = processHandle;
         WI_SetFlag(BestCandidate->Flags, CLE_ALLOCATED);
 
+        if (!SameApp)
+        {
+            BestCandidate->_LoadPersisted(s_GetPersistencePath(appName));
+        }
+
         return &s_historyLists.emplace_front(BestCandidate.value());
     }
 
@@ -446,7 +499,23 @@ void CommandHistory::_Inc(SHORT& ind) const
     }
 }
 
+// Routine Description:
+// - Removes a command from the history, and from its persisted file.
+// Arguments:
+// - iDel - the index of the command to remove
+// Return Value:
+// - The command that was removed, or an empty string if there wasn't one.
 std::wstring CommandHistory::Remove(const SHORT iDel)
+{
+    auto str = _Remove(iDel);
+    if (!str.empty())
+    {
+        _AppendPersisted(PersistedChange::Remove, { str });
+    }
+    return str;
+}
+
+std::wstring CommandHistory::_Remove(const SHORT iDel)
 {
     SHORT iFirst = 0;
     SHORT iLast = gsl::narrow<SHORT>(_commands.size() - 1);
@@ -471,6 +540,7 @@ std::wstring CommandHistory::Remove(const SHORT iDel)
     try
     {
         const auto str = _commands.at(iDel);
+        _IndexErase(iDel, true);
 
         if (iDel < iLast)
         {
@@ -501,6 +571,9 @@ std::wstring CommandHistory::Remove(const SHORT iDel)
 
 // Routine Description:
 // - this routine finds the most recent command that starts with the letters already in the current command.  it returns the array index (no mod needed).
+// - The commands that start with the letters are found with a binary search of
+//   the prefix index, and the one nearest to the starting index (going back,
+//   and wrapping around) is the one that's returned.
 [[nodiscard]] bool CommandHistory::FindMatchingCommand(const std::wstring_view givenCommand,
                                                        const SHORT startingIndex,
                                                        SHORT& indexFound,
@@ -527,29 +600,394 @@ std::wstring CommandHistory::Remove(const SHORT iDel)
         return true;
     }
 
+    const auto count = gsl::narrow<SHORT>(_commands.size());
+    if (indexFound < 0 || indexFound >= count)
+    {
+        return false;
+    }
+
+    const auto [first, last] = _FindPrefix(givenCommand);
+
+    std::optional<SHORT> nearest;
+    SHORT nearestDistance = count;
+    for (auto it = first; it != last; ++it)
+    {
+        const auto position = *it;
+        if (WI_IsFlagSet(options, MatchOptions::ExactMatch) && _commands[position].size() != givenCommand.size())
+        {
+            continue;
+        }
+
+        const auto distance = gsl::narrow_cast<SHORT>((indexFound - position + count) % count);
+        if (distance < nearestDistance)
+        {
+            nearest = position;
+            nearestDistance = distance;
+        }
+    }
+
+    if (nearest.has_value())
+    {
+        indexFound = nearest.value();
+        return true;
+    }
+
+    return false;
+}
+
+// Routine Description:
+// - Adds a command to the prefix index.
+// Arguments:
+// - position - the index of the command in the history
+// Return Value:
+// - <none>
+// Note:
+// - will throw exception on error
+void CommandHistory::_IndexInsert(const SHORT position)
+{
+    const auto less = [this](const SHORT a, const SHORT b) {
+        const auto& textA = _commands[a];
+        const auto& textB = _commands[b];
+        if (std::lexicographical_compare(textA.cbegin(), textA.cend(), textB.cbegin(), textB.cend(), CaseInsensitiveLess))
+        {
+            return true;
+        }
+        if (std::lexicographical_compare(textB.cbegin(), textB.cend(), textA.cbegin(), textA.cend(), CaseInsensitiveLess))
+        {
+            return false;
+        }
+        return a < b;
+    };
+
+    _prefixIndex.insert(std::upper_bound(_prefixIndex.cbegin(), _prefixIndex.cend(), position, less), position);
+}
+
+// Routine Description:
+// - Removes a command from the prefix index.
+// Arguments:
+// - position - the index of the command in the history
+// - shiftLater - true if the commands after it are about to move down one, so
+//   their positions in the index should be moved down too
+void CommandHistory::_IndexErase(const SHORT position, const bool shiftLater) noexcept
+{
+    // Moving every position after the erased one down by the same amount keeps
+    // the index sorted, so this is one pass rather than a re-sort.
+    auto kept = _prefixIndex.begin();
+    for (auto it = _prefixIndex.begin(); it != _prefixIndex.end(); ++it)
+    {
+        if (*it == position)
+        {
+            continue;
+        }
+        *kept++ = (shiftLater && *it > position) ? *it - 1 : *it;
+    }
+    _prefixIndex.erase(kept, _prefixIndex.end());
+}
+
+// Routine Description:
+// - Builds the prefix index again from scratch, for when most of the commands
+//   have moved.
+// Note:
+// - will throw exception on error
+void CommandHistory::_RebuildIndex()
+{
+    _prefixIndex.clear();
+    for (SHORT i = 0; i < gsl::narrow<SHORT>(_commands.size()); i++)
+    {
+        _IndexInsert(i);
+    }
+}
+
+// Routine Description:
+// - Finds the commands that start with the given text, ignoring case.
+// Arguments:
+// - prefix - the text the commands have to start with
+// Return Value:
+// - The range of the prefix index that holds the commands.
+std::pair<std::vector<SHORT>::const_iterator, std::vector<SHORT>::const_iterator> CommandHistory::_FindPrefix(const std::wstring_view prefix) const
+{
+    // Sorting the commands puts all the ones that start with the prefix next to
+    // each other, starting with the first one that isn't less than the prefix.
+    const auto first = std::partition_point(_prefixIndex.cbegin(), _prefixIndex.cend(), [&](const SHORT position) {
+        const auto& text = _commands[position];
+        return std::lexicographical_compare(text.cbegin(), text.cend(), prefix.cbegin(), prefix.cend(), CaseInsensitiveLess);
+    });
+    const auto last = std::partition_point(first, _prefixIndex.cend(), [&](const SHORT position) {
+        return CaseInsensitiveStartsWith(_commands[position], prefix);
+    });
+    return { first, last };
+}
+
+// Routine Description:
+// - Works out where an app's history is persisted.
+// Arguments:
+// - appName - the name of the app's executable
+// Return Value:
+// - The path of the file, or an empty path if history isn't being persisted.
+std::filesystem::path CommandHistory::s_GetPersistencePath(const std::wstring_view appName)
+{
+    const CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    if (!gci.GetPersistHistory() || appName.empty())
+    {
+        return {};
+    }
+
+    try
+    {
+        std::filesystem::path directory{ s_persistenceDirectory };
+        if (directory.empty())
+        {
+            wil::unique_cotaskmem_string localAppData;
+            THROW_IF_FAILED(SHGetKnownFolderPath(FOLDERID_LocalAppData, KF_FLAG_DEFAULT, nullptr, &localAppData));
+            directory = std::filesystem::path{ localAppData.get() } / L"Microsoft" / L"Console" / L"History";
+        }
+
+        // App names are matched ignoring case, so the files are named in lower case.
+        std::wstring fileName{ appName };
+        for (auto& ch : fileName)
+        {
+            ch = (ch < L' ' || wcschr(L"\\/:*?\"<>|", ch)) ? L'_' : ::towlower(ch);
+        }
+        return directory / (fileName + L".history");
+    }
+    CATCH_LOG();
+
+    return {};
+}
+
+// Routine Description:
+// - Reads the history persisted for this app back in, by replaying the changes
+//   recorded in the file, then starts recording the new ones.
+// - While consoles are running the app, the file is only ever appended to, so
+//   that none of them can lose the changes another one made. It's compacted
+//   here instead, down to just the commands the history ended up with, when it
+//   has a lot more records than that or doesn't end cleanly. Consoles hold the
+//   file's lock whenever they append to it or compact it.
+// - The file is mapped rather than read, since it's only walked through once.
+//   Anything that doesn't look like a record ends the walk, so a file that was
+//   cut short by a crash still gives back the changes before the cut.
+// Arguments:
+// - path - the file the history is persisted to, or an empty path if it isn't
+// Return Value:
+// - <none>
+void CommandHistory::_LoadPersisted(const std::filesystem::path& path)
+{
+    _persistencePath.clear();
+
+    if (path.empty())
+    {
+        return;
+    }
+
     try
     {
-        for (size_t i = 0; i < _commands.size(); i++)
+        const CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+        std::error_code ec;
+        std::filesystem::create_directories(path.parent_path(), ec);
+
+        wil::unique_hfile file{ CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr) };
+        THROW_LAST_ERROR_IF(!file);
+        const auto lock = LockPersistedHistory(file.get());
+
+        size_t records = 0;
+        bool complete = false;
+
+        LARGE_INTEGER fileSize{};
+        THROW_IF_WIN32_BOOL_FALSE(GetFileSizeEx(file.get(), &fileSize));
+        if (fileSize.QuadPart > gsl::narrow_cast<LONGLONG>(PersistedHistoryMagic.size()))
         {
-            const auto& storedCommand = _commands.at(indexFound);
-            if ((WI_IsFlagClear(options, MatchOptions::ExactMatch) && (givenCommand.size() <= storedCommand.size())) || (givenCommand.size() == storedCommand.size()))
+            wil::unique_handle mapping{ CreateFileMappingW(file.get(), nullptr, PAGE_READONLY, 0, 0, nullptr) };
+            THROW_LAST_ERROR_IF(!mapping);
+            wil::unique_mapview_ptr<const BYTE> view{ static_cast<const BYTE*>(MapViewOfFile(mapping.get(), FILE_MAP_READ, 0, 0, 0)) };
+            THROW_LAST_ERROR_IF(!view);
+
+            const gsl::span<const BYTE> data{ view.get(), gsl::narrow<ptrdiff_t>(fileSize.QuadPart) };
+            if (std::equal(PersistedHistoryMagic.cbegin(), PersistedHistoryMagic.cend(), data.begin()))
             {
-                if (std::equal(storedCommand.begin(),
-                               storedCommand.begin() + givenCommand.size(),
-                               givenCommand.begin(),
-                               givenCommand.end(),
-                               CaseInsensitiveEquality))
-                {
+                auto remaining = data.subspan(PersistedHistoryMagic.size());
+
+                // Takes the next command off the front of what's left, if
+                // that's what's there.
+                const auto readCommand = [&](std::wstring& command) {
+                    USHORT length;
+                    if (remaining.size() < gsl::narrow_cast<ptrdiff_t>(sizeof(length)))
+                    {
+                        return false;
+                    }
+                    memcpy(&length, remaining.data(), sizeof(length));
+
+                    const auto bytes = gsl::narrow_cast<ptrdiff_t>(length * sizeof(wchar_t));
+                    if (length == 0 || bytes > remaining.size() - gsl::narrow_cast<ptrdiff_t>(sizeof(length)))
+                    {
+                        return false;
+                    }
+
+                    command.assign(length, UNICODE_NULL);
+                    memcpy(command.data(), remaining.data() + sizeof(length), bytes);
+                    remaining = remaining.subspan(sizeof(length) + bytes);
                     return true;
+                };
+
+                // Changes name the commands they apply to by their text, since
+                // other consoles might have added commands in between.
+                const auto findLast = [&](const std::wstring& command) {
+                    const auto found = std::find(_commands.crbegin(), _commands.crend(), command);
+                    return gsl::narrow_cast<SHORT>(std::distance(found, _commands.crend()) - 1);
+                };
+
+                std::wstring first;
+                std::wstring second;
+                while (remaining.size() >= gsl::narrow_cast<ptrdiff_t>(sizeof(PersistedChange)))
+                {
+                    PersistedChange change;
+                    memcpy(&change, remaining.data(), sizeof(change));
+                    remaining = remaining.subspan(sizeof(change));
+
+                    if (change == PersistedChange::Add && readCommand(first))
+                    {
+                        LOG_IF_FAILED(Add(first, gci.GetHistoryNoDup()));
+                    }
+                    else if (change == PersistedChange::Remove && readCommand(first))
+                    {
+                        const auto position = findLast(first);
+                        if (position >= 0)
+                        {
+                            _Remove(position);
+                        }
+                    }
+                    else if (change == PersistedChange::Swap && readCommand(first) && readCommand(second))
+                    {
+                        const auto positionA = findLast(first);
+                        const auto positionB = findLast(second);
+                        if (positionA >= 0 && positionB >= 0)
+                        {
+                            Swap(positionA, positionB);
+                        }
+                    }
+                    else if (change == PersistedChange::Empty)
+                    {
+                        _commands.clear();
+                        _prefixIndex.clear();
+                        LastDisplayed = -1;
+                    }
+                    else
+                    {
+                        break;
+                    }
+                    ++records;
                 }
+                complete = remaining.empty();
             }
+        }
+
+        _persistencePath = path;
 
-            _Prev(indexFound);
+        // Replaying the file added the commands to the history as it went, but
+        // the file itself might have grown long enough to be worth compacting,
+        // or might not hold a history at all yet.
+        if (!complete || records > 2 * gsl::narrow_cast<size_t>(_maxCommands))
+        {
+            _CompactPersisted(file.get());
         }
     }
     CATCH_LOG();
+}
 
-    return false;
+// Routine Description:
+// - Appends a record of a change that was just made to the history to the
+//   persisted file.
+// Arguments:
+// - change - what kind of change it was
+// - commands - the commands it applies to
+// Return Value:
+// - <none>
+void CommandHistory::_AppendPersisted(const PersistedChange change, const std::initializer_list<std::wstring_view> commands)
+{
+    if (_persistencePath.empty())
+    {
+        return;
+    }
+
+    try
+    {
+        std::vector<BYTE> record;
+        s_AppendPersistedRecord(record, change, commands);
+        if (record.empty())
+        {
+            return;
+        }
+
+        wil::unique_hfile file{ CreateFileW(_persistencePath.c_str(), GENERIC_READ | FILE_APPEND_DATA, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+        THROW_LAST_ERROR_IF(!file);
+
+        // Each record is written with a single write, so that two consoles
+        // running the same app can't interleave halves of their records, and
+        // under the lock, so that it can't land while the file is compacted.
+        const auto lock = LockPersistedHistory(file.get());
+
+        DWORD written;
+        THROW_IF_WIN32_BOOL_FALSE(WriteFile(file.get(), record.data(), gsl::narrow<DWORD>(record.size()), &written, nullptr));
+    }
+    CATCH_LOG();
+}
+
+// Routine Description:
+// - Writes the persisted file again with nothing in it but the commands in the
+//   history. The file's lock has to be held, so that no other console appends
+//   to it in the meantime.
+// Arguments:
+// - file - the persisted file, opened for reading and writing
+// Return Value:
+// - <none>
+// Note:
+// - will throw exception on error
+void CommandHistory::_CompactPersisted(const HANDLE file) const
+{
+    std::vector<BYTE> contents{ PersistedHistoryMagic.cbegin(), PersistedHistoryMagic.cend() };
+    for (const auto& command : _commands)
+    {
+        s_AppendPersistedRecord(contents, PersistedChange::Add, { command });
+    }
+
+    THROW_IF_WIN32_BOOL_FALSE(SetFilePointerEx(file, {}, nullptr, FILE_BEGIN));
+
+    DWORD written;
+    THROW_IF_WIN32_BOOL_FALSE(WriteFile(file, contents.data(), gsl::narrow<DWORD>(contents.size()), &written, nullptr));
+    THROW_IF_WIN32_BOOL_FALSE(SetEndOfFile(file));
+}
+
+// Routine Description:
+// - Lays out a record of a change to the history on the end of the contents of
+//   a persisted file: what kind of change it was, then each of the commands it
+//   applies to, as its length in wchar_ts and then its text. Nothing is laid
+//   out if one of the commands can't be recorded.
+// Arguments:
+// - contents - the contents to lay the record out on the end of
+// - change - what kind of change it was
+// - commands - the commands it applies to
+// Return Value:
+// - <none>
+void CommandHistory::s_AppendPersistedRecord(std::vector<BYTE>& contents, const PersistedChange change, const std::initializer_list<std::wstring_view> commands)
+{
+    if (std::any_of(commands.begin(), commands.end(), [](const auto& command) { return command.empty() || command.size() > USHRT_MAX; }))
+    {
+        return;
+    }
+
+    const auto append = [&](const void* const data, const size_t size) {
+        const auto offset = contents.size();
+        contents.resize(offset + size);
+        memcpy(contents.data() + offset, data, size);
+    };
+
+    append(&change, sizeof(change));
+    for (const auto& command : commands)
+    {
+        const auto length = gsl::narrow_cast<USHORT>(command.size());
+        append(&length, sizeof(length));
+        append(command.data(), command.size() * sizeof(wchar_t));
+    }
 }
 
 #ifdef UNIT_TESTING
@@ -557,6 +995,11 @@ void CommandHistory::s_ClearHistoryListStorage()
 {
     s_historyLists.clear();
 }
+
+void CommandHistory::s_SetPersistenceDirectory(const std::wstring_view directory)
+{
+    s_persistenceDirectory = directory;
+}
 #endif
 
 // Routine Description:
@@ -567,6 +1010,17 @@ void CommandHistory::s_ClearHistoryListStorage()
 void CommandHistory::Swap(const short indexA, const short indexB)
 {
     std::swap(_commands.at(indexA), _commands.at(indexB));
+
+    // The positions haven't changed, but the text at them has, so they're
+    // taken out of the index and put back where their new text sorts.
+    _IndexErase(indexA, false);
+    _IndexErase(indexB, false);
+    _IndexInsert(indexA);
+    if (indexB != indexA)
+    {
+        _IndexInsert(indexB);
+    }
+    _AppendPersisted(PersistedChange::Swap, { _commands.at(indexA), _commands.at(indexB) });
 }
 
 // Routine Description:
@@ -8,6 +8,13 @@ Module Name:
 Abstract:
 - Encapsulates the cmdline functions and structures specifically related to
         command history functionality.
+- Each history keeps an index of its commands sorted (case insensitively) by
+        their text, so that finding the commands that start with what's been
+        typed is a binary search rather than a walk through every command.
+- When the PersistHistory setting is on, each app's changes to its history
+        are also recorded in a file that's only appended to while consoles
+        are running the app, and replayed (and the file compacted) when the
+        app next starts.
 --*/
 
 #pragma once
@@ -74,6 +81,29 @@ public:
 
 private:
     void _Reset();
+    std::wstring _Remove(const SHORT iDel);
+
+    // The prefix index holds the position of every command, sorted by the
+    // command's text and then its position.
+    void _IndexInsert(const SHORT position);
+    void _IndexErase(const SHORT position, const bool shiftLater) noexcept;
+    void _RebuildIndex();
+    std::pair<std::vector<SHORT>::const_iterator, std::vector<SHORT>::const_iterator> _FindPrefix(const std::wstring_view prefix) const;
+
+    // The changes recorded in a persisted history file.
+    enum class PersistedChange : USHORT
+    {
+        Add = 1, // the command that was added
+        Remove = 2, // the command that was removed
+        Swap = 3, // the two commands that changed places
+        Empty = 4 // no commands
+    };
+
+    void _LoadPersisted(const std::filesystem::path& path);
+    void _AppendPersisted(const PersistedChange change, const std::initializer_list<std::wstring_view> commands);
+    void _CompactPersisted(const HANDLE file) const;
+    static void s_AppendPersistedRecord(std::vector<BYTE>& contents, const PersistedChange change, const std::initializer_list<std::wstring_view> commands);
+    static std::filesystem::path s_GetPersistencePath(const std::wstring_view appName);
 
     // _Next and _Prev go to the next and prev command
     // _Inc  and _Dec go to the next and prev slots
@@ -84,12 +114,17 @@ private:
     void _Inc(SHORT& ind) const;
 
     std::vector<std::wstring> _commands;
+    std::vector<SHORT> _prefixIndex;
     SHORT _maxCommands;
 
+    // Where this history is persisted (empty when it isn't).
+    std::filesystem::path _persistencePath;
+
     std::wstring _appName;
     HANDLE _processHandle;
 
     static std::list<CommandHistory> s_historyLists;
+    static std::wstring s_persistenceDirectory;
 
 public:
     DWORD Flags;
@@ -97,6 +132,7 @@ public:
 
 #ifdef UNIT_TESTING
     static void s_ClearHistoryListStorage();
+    static void s_SetPersistenceDirectory(const std::wstring_view directory);
     friend class HistoryTests;
 #endif
 };
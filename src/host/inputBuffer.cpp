@@ -150,7 +150,7 @@ void InputBuffer::ReinitializeInputBuffer()
 {
     ServiceLocator::LocateGlobals().hInputEvent.ResetEvent();
     InputMode = INPUT_BUFFER_DEFAULT_INPUT_MODE;
-    _storage.clear();
+    _storage.Clear();
 }
 
 // Routine Description:
@@ -185,7 +185,7 @@ void InputBuffer::TerminateRead(_In_ WaitTerminationReason Flag)
 // - The console lock must be held when calling this routine.
 size_t InputBuffer::GetNumberOfReadyEvents() const noexcept
 {
-    return _storage.size();
+    return _storage.Size();
 }
 
 // Routine Description:
@@ -198,7 +198,7 @@ size_t InputBuffer::GetNumberOfReadyEvents() const noexcept
 // - The console lock must be held when calling this routine.
 void InputBuffer::Flush()
 {
-    _storage.clear();
+    _storage.Clear();
     ServiceLocator::LocateGlobals().hInputEvent.ResetEvent();
 }
 
@@ -212,10 +212,9 @@ void InputBuffer::Flush()
 // - The console lock must be held when calling this routine.
 void InputBuffer::FlushAllButKeys()
 {
-    auto newEnd = std::remove_if(_storage.begin(), _storage.end(), [](const std::unique_ptr<IInputEvent>& event) {
-        return event->EventType() != InputEventType::KeyEvent;
+    _storage.RemoveIf([](const INPUT_RECORD& record) {
+        return record.EventType != KEY_EVENT;
     });
-    _storage.erase(newEnd, _storage.end());
 }
 
 // Routine Description:
@@ -244,39 +243,16 @@ void InputBuffer::FlushAllButKeys()
 {
     try
     {
-        if (_storage.empty())
-        {
-            if (!WaitForData)
-            {
-                return STATUS_SUCCESS;
-            }
-            return CONSOLE_STATUS_WAIT;
-        }
-
-        // read from buffer
-        std::deque<std::unique_ptr<IInputEvent>> events;
+        // We can't read more events than are stored, so don't make room for more.
+        std::vector<INPUT_RECORD> records(std::min(AmountToRead, _storage.Size()));
         size_t eventsRead;
-        bool resetWaitEvent;
-        _ReadBuffer(events,
-                    AmountToRead,
-                    eventsRead,
-                    Peek,
-                    resetWaitEvent,
-                    Unicode,
-                    Stream);
+        const NTSTATUS Status = Read(records, eventsRead, Peek, WaitForData, Unicode, Stream);
 
-        // copy events to outEvents
-        while (!events.empty())
+        for (size_t i = 0; i < eventsRead; ++i)
         {
-            OutEvents.push_back(std::move(events.front()));
-            events.pop_front();
+            OutEvents.push_back(IInputEvent::Create(records.at(i)));
         }
-
-        if (resetWaitEvent)
-        {
-            ServiceLocator::LocateGlobals().hInputEvent.ResetEvent();
-        }
-        return STATUS_SUCCESS;
+        return Status;
     }
     catch (...)
     {
@@ -309,16 +285,17 @@ void InputBuffer::FlushAllButKeys()
     NTSTATUS Status;
     try
     {
-        std::deque<std::unique_ptr<IInputEvent>> outEvents;
-        Status = Read(outEvents,
-                      1,
+        INPUT_RECORD record;
+        size_t eventsRead;
+        Status = Read(gsl::make_span(&record, 1),
+                      eventsRead,
                       Peek,
                       WaitForData,
                       Unicode,
                       Stream);
-        if (!outEvents.empty())
+        if (eventsRead != 0)
         {
-            outEvent.swap(outEvents.front());
+            outEvent = IInputEvent::Create(record);
         }
     }
     catch (...)
@@ -329,125 +306,144 @@ void InputBuffer::FlushAllButKeys()
     return Status;
 }
 
+// Routine Description:
+// - This routine reads records from the input buffer, without converting
+//   them to IInputEvents.
+// - It can convert returned data to through the currently set Input CP, it can optionally return a wait condition
+//   if there isn't enough data in the buffer, and it can be set to not remove records as it reads them out.
+// Note:
+// - The console lock must be held when calling this routine.
+// Arguments:
+// - outRecords - where to store the read records. Its size is the amount of events to try to read.
+// - eventsRead - on exit, the number of records stored in outRecords
+// - Peek - If true, copy events to pInputRecord but don't remove them from the input buffer.
+// - WaitForData - if true, wait until an event is input (if there aren't enough to fill client buffer). if false, return immediately
+// - Unicode - true if the data in key events should be treated as unicode. false if they should be converted by the current input CP.
+// - Stream - true if read should unpack KeyEvents that have a >1 repeat count. outRecords must have a size of 1 if Stream is true.
+// Return Value:
+// - STATUS_SUCCESS if records were read into the client buffer and everything is OK.
+// - CONSOLE_STATUS_WAIT if there weren't enough records to satisfy the request (and waits are allowed)
+// - otherwise a suitable memory/math/string error in NTSTATUS form.
+[[nodiscard]] NTSTATUS InputBuffer::Read(const gsl::span<INPUT_RECORD> outRecords,
+                                         _Out_ size_t& eventsRead,
+                                         const bool Peek,
+                                         const bool WaitForData,
+                                         const bool Unicode,
+                                         const bool Stream)
+{
+    eventsRead = 0;
+    try
+    {
+        if (_storage.IsEmpty())
+        {
+            if (!WaitForData)
+            {
+                return STATUS_SUCCESS;
+            }
+            return CONSOLE_STATUS_WAIT;
+        }
+
+        // read from buffer
+        bool resetWaitEvent;
+        _ReadBuffer(outRecords,
+                    eventsRead,
+                    Peek,
+                    resetWaitEvent,
+                    Unicode,
+                    Stream);
+
+        if (resetWaitEvent)
+        {
+            ServiceLocator::LocateGlobals().hInputEvent.ResetEvent();
+        }
+        return STATUS_SUCCESS;
+    }
+    catch (...)
+    {
+        return NTSTATUS_FROM_HRESULT(wil::ResultFromCaughtException());
+    }
+}
+
 // Routine Description:
 // - This routine reads from a buffer. It does the buffer manipulation.
 // Arguments:
-// - outEvents - where read events are placed
-// - readCount - amount of events to read
+// - outRecords - where read records are placed. Its size is the amount of events to read.
 // - eventsRead - where to store number of events read
 // - peek - if true , don't remove data from buffer, just copy it.
 // - resetWaitEvent - on exit, true if buffer became empty.
 // - unicode - true if read should be done in unicode mode
-// - streamRead - true if read should unpack KeyEvents that have a >1 repeat count. readCount must be 1 if streamRead is true.
+// - streamRead - true if read should unpack KeyEvents that have a >1 repeat count. outRecords must have a size of 1 if streamRead is true.
 // Return Value:
 // - <none>
 // Note:
 // - The console lock must be held when calling this routine.
-void InputBuffer::_ReadBuffer(_Out_ std::deque<std::unique_ptr<IInputEvent>>& outEvents,
-                              const size_t readCount,
+void InputBuffer::_ReadBuffer(const gsl::span<INPUT_RECORD> outRecords,
                               _Out_ size_t& eventsRead,
                               const bool peek,
                               _Out_ bool& resetWaitEvent,
                               const bool unicode,
                               const bool streamRead)
 {
+    const auto readCount = static_cast<size_t>(outRecords.size());
+
     // when stream reading, the previous behavior was to only allow reading of a single
     // event at a time.
     FAIL_FAST_IF(streamRead && readCount != 1);
 
     resetWaitEvent = false;
+    eventsRead = 0;
 
-    std::deque<std::unique_ptr<IInputEvent>> readEvents;
+    // the number of records at the front of the storage that were read in full.
+    size_t recordsConsumed = 0;
     // we need another var to keep track of how many we've read
     // because dbcs records count for two when we aren't doing a
     // unicode read but the eventsRead count should return the number
     // of events actually put into outRecords.
     size_t virtualReadCount = 0;
 
-    while (!_storage.empty() && virtualReadCount < readCount)
+    while (recordsConsumed < _storage.Size() && virtualReadCount < readCount)
     {
-        bool performNormalRead = true;
-        // for stream reads we need to split any key events that have been coalesced
-        if (streamRead)
+        INPUT_RECORD& stored = _storage[recordsConsumed];
+        INPUT_RECORD& record = outRecords.at(eventsRead);
+        record = stored;
+
+        // for stream reads we need to split any key events that have been coalesced.
+        // the split off event is read, and the rest stays in the buffer. peeking
+        // leaves the buffer alone altogether.
+        if (streamRead &&
+            record.EventType == KEY_EVENT &&
+            record.Event.KeyEvent.wRepeatCount > 1)
         {
-            if (_storage.front()->EventType() == InputEventType::KeyEvent)
+            record.Event.KeyEvent.wRepeatCount = 1;
+            if (!peek)
             {
-                KeyEvent* const pKeyEvent = static_cast<KeyEvent* const>(_storage.front().get());
-                if (pKeyEvent->GetRepeatCount() > 1)
-                {
-                    // split the key event
-                    std::unique_ptr<KeyEvent> streamKeyEvent = std::make_unique<KeyEvent>(*pKeyEvent);
-                    streamKeyEvent->SetRepeatCount(1);
-                    readEvents.push_back(std::move(streamKeyEvent));
-                    pKeyEvent->SetRepeatCount(pKeyEvent->GetRepeatCount() - 1);
-                    performNormalRead = false;
-                }
+                stored.Event.KeyEvent.wRepeatCount--;
             }
         }
-
-        if (performNormalRead)
+        else
         {
-            readEvents.push_back(std::move(_storage.front()));
-            _storage.pop_front();
+            ++recordsConsumed;
         }
 
+        ++eventsRead;
         ++virtualReadCount;
         if (!unicode)
         {
-            if (readEvents.back()->EventType() == InputEventType::KeyEvent)
-            {
-                const KeyEvent* const pKeyEvent = static_cast<const KeyEvent* const>(readEvents.back().get());
-                if (IsGlyphFullWidth(pKeyEvent->GetCharData()))
-                {
-                    ++virtualReadCount;
-                }
-            }
-        }
-    }
-
-    // the amount of events that were actually read
-    eventsRead = readEvents.size();
-
-    // copy the events back if we were supposed to peek
-    if (peek)
-    {
-        if (streamRead)
-        {
-            // we need to check and see if the event was split from a coalesced key event
-            // or if it was unrelated to the current front event in storage
-            if (!readEvents.empty() &&
-                !_storage.empty() &&
-                readEvents.back()->EventType() == InputEventType::KeyEvent &&
-                _storage.front()->EventType() == InputEventType::KeyEvent &&
-                _CanCoalesce(static_cast<const KeyEvent&>(*readEvents.back()),
-                             static_cast<const KeyEvent&>(*_storage.front())))
-            {
-                KeyEvent& keyEvent = static_cast<KeyEvent&>(*_storage.front());
-                keyEvent.SetRepeatCount(keyEvent.GetRepeatCount() + 1);
-            }
-            else
-            {
-                _storage.push_front(IInputEvent::Create(readEvents.back()->ToInputRecord()));
-            }
-        }
-        else
-        {
-            for (auto it = readEvents.crbegin(); it != readEvents.crend(); ++it)
+            if (record.EventType == KEY_EVENT &&
+                IsGlyphFullWidth(record.Event.KeyEvent.uChar.UnicodeChar))
             {
-                _storage.push_front(IInputEvent::Create((*it)->ToInputRecord()));
+                ++virtualReadCount;
             }
         }
     }
 
-    // move events read to proper deque
-    while (!readEvents.empty())
+    if (!peek)
     {
-        outEvents.push_back(std::move(readEvents.front()));
-        readEvents.pop_front();
+        _storage.PopFront(recordsConsumed);
     }
 
     // signal if we emptied the buffer
-    if (_storage.empty())
+    if (_storage.IsEmpty())
     {
         resetWaitEvent = true;
     }
@@ -457,52 +453,71 @@ void InputBuffer::_ReadBuffer(_Out_ std::deque<std::unique_ptr<IInputEvent>>& ou
 // -  Writes events to the beginning of the input buffer.
 // Arguments:
 // - inEvents - events to write to buffer.
-// - eventsWritten - The number of events written to the buffer on exit.
 // Return Value:
-// S_OK if successful.
+// - The number of events written to the buffer.
 // Note:
 // - The console lock must be held when calling this routine.
 size_t InputBuffer::Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
 {
     try
     {
-        _HandleConsoleSuspensionEvents(inEvents);
-        if (inEvents.empty())
+        const auto records = IInputEvent::ToInputRecords(inEvents);
+        return Prepend(records);
+    }
+    catch (...)
+    {
+        LOG_HR(wil::ResultFromCaughtException());
+        return 0;
+    }
+}
+
+// Routine Description:
+// -  Writes records to the beginning of the input buffer.
+// Arguments:
+// - inRecords - records to write to buffer.
+// Return Value:
+// - The number of events written to the buffer.
+// Note:
+// - The console lock must be held when calling this routine.
+size_t InputBuffer::Prepend(const gsl::span<const INPUT_RECORD> inRecords)
+{
+    try
+    {
+        std::vector<INPUT_RECORD> remainingRecords;
+        const auto records = _HandleConsoleSuspensionEvents(inRecords, remainingRecords);
+        if (records.size() == 0)
         {
             return STATUS_SUCCESS;
         }
-        // read all of the records out of the buffer, then write the
-        // prepend ones, then write the original set. We need to do it
-        // this way to handle any coalescing that might occur.
-
-        // get all of the existing records, "emptying" the buffer
-        std::deque<std::unique_ptr<IInputEvent>> existingStorage;
-        existingStorage.swap(_storage);
-
-        // We will need this variable to pass to _WriteBuffer so it can attempt to determine wait status.
-        // However, because we swapped the storage out from under it with an empty deque, it will always
-        // return true after the first one (as it is filling the newly emptied backing deque.)
-        // Then after the second one, because we've inserted some input, it will always say false.
-        bool unusedWaitStatus = false;
 
-        // write the prepend records
+        const bool initiallyEmptyQueue = _storage.IsEmpty();
         size_t prependEventsWritten;
-        _WriteBuffer(inEvents, prependEventsWritten, unusedWaitStatus);
-        FAIL_FAST_IF(!(unusedWaitStatus));
+        if (IsInVirtualTerminalInputMode())
+        {
+            // The records may be translated into VT sequences, which are
+            // written to the back of the storage as they're generated. Write
+            // them to empty storage, then put the existing records back
+            // behind them.
+            InputEventQueue existingStorage;
+            std::swap(existingStorage, _storage);
 
-        // write all previously existing records
-        size_t existingEventsWritten;
-        _WriteBuffer(existingStorage, existingEventsWritten, unusedWaitStatus);
-        FAIL_FAST_IF(!(!unusedWaitStatus));
+            bool unusedWaitStatus = false;
+            _WriteBuffer(records, prependEventsWritten, unusedWaitStatus);
+
+            for (size_t i = 0; i < existingStorage.Size(); ++i)
+            {
+                _storage.PushBack(existingStorage[i]);
+            }
+        }
+        else
+        {
+            _storage.PushFront(records);
+            prependEventsWritten = records.size();
+        }
 
         // We need to set the wait event if there were 0 events in the
         // input queue when we started.
-        // Because we did interesting manipulation of the wait queue
-        // in order to prepend, we can't trust what _WriteBuffer said
-        // and instead need to set the event if the original backing
-        // buffer (the one we swapped out at the top) was empty
-        // when this whole thing started.
-        if (existingStorage.empty())
+        if (initiallyEmptyQueue)
         {
             ServiceLocator::LocateGlobals().hInputEvent.SetEvent();
         }
@@ -532,9 +547,8 @@ size_t InputBuffer::Write(_Inout_ std::unique_ptr<IInputEvent> inEvent)
 {
     try
     {
-        std::deque<std::unique_ptr<IInputEvent>> inEvents;
-        inEvents.push_back(std::move(inEvent));
-        return Write(inEvents);
+        const INPUT_RECORD record = inEvent->ToInputRecord();
+        return Write(gsl::make_span(&record, 1));
     }
     catch (...)
     {
@@ -556,8 +570,32 @@ size_t InputBuffer::Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEv
 {
     try
     {
-        _HandleConsoleSuspensionEvents(inEvents);
-        if (inEvents.empty())
+        const auto records = IInputEvent::ToInputRecords(inEvents);
+        return Write(records);
+    }
+    catch (...)
+    {
+        LOG_HR(wil::ResultFromCaughtException());
+        return 0;
+    }
+}
+
+// Routine Description:
+// - Writes records to the input buffer. Wakes up any readers that are
+// waiting for additional input events.
+// Arguments:
+// - inRecords - input records to store in the buffer.
+// Return Value:
+// - The number of events that were written to input buffer.
+// Note:
+// - The console lock must be held when calling this routine.
+size_t InputBuffer::Write(const gsl::span<const INPUT_RECORD> inRecords)
+{
+    try
+    {
+        std::vector<INPUT_RECORD> remainingRecords;
+        const auto records = _HandleConsoleSuspensionEvents(inRecords, remainingRecords);
+        if (records.size() == 0)
         {
             return 0;
         }
@@ -565,7 +603,7 @@ size_t InputBuffer::Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEv
         // Write to buffer.
         size_t EventsWritten;
         bool SetWaitEvent;
-        _WriteBuffer(inEvents, EventsWritten, SetWaitEvent);
+        _WriteBuffer(records, EventsWritten, SetWaitEvent);
 
         if (SetWaitEvent)
         {
@@ -584,9 +622,9 @@ size_t InputBuffer::Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEv
 }
 
 // Routine Description:
-// - Coalesces input events and transfers them to storage queue.
+// - Coalesces input records and transfers them to storage queue.
 // Arguments:
-// - inRecords - The events to store.
+// - inRecords - The records to store.
 // - eventsWritten - The number of events written since this function
 // was called.
 // - setWaitEvent - on exit, true if buffer became non-empty.
@@ -595,145 +633,117 @@ size_t InputBuffer::Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEv
 // Note:
 // - The console lock must be held when calling this routine.
 // - will throw on failure
-void InputBuffer::_WriteBuffer(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
+void InputBuffer::_WriteBuffer(const gsl::span<const INPUT_RECORD> inRecords,
                                _Out_ size_t& eventsWritten,
                                _Out_ bool& setWaitEvent)
 {
     eventsWritten = 0;
     setWaitEvent = false;
-    const bool initiallyEmptyQueue = _storage.empty();
-    const size_t initialInEventsSize = inEvents.size();
+    const bool initiallyEmptyQueue = _storage.IsEmpty();
+    const size_t initialInEventsSize = inRecords.size();
     const bool vtInputMode = IsInVirtualTerminalInputMode();
 
-    while (!inEvents.empty())
+    if (!vtInputMode && initialInEventsSize > 1)
+    {
+        // Nothing is translated or coalesced, so all of the records can be
+        // stored at once.
+        _storage.PushBack(inRecords);
+        eventsWritten = initialInEventsSize;
+    }
+    else
     {
-        // Pop the next event.
-        // If we're in vt mode, try and handle it with the vt input module.
-        // If it was handled, do nothing else for it.
-        // If there was one event passed in, try coalescing it with the previous event currently in the buffer.
-        // If it's not coalesced, append it to the buffer.
-        std::unique_ptr<IInputEvent> inEvent = std::move(inEvents.front());
-        inEvents.pop_front();
-        if (vtInputMode)
+        for (const auto& inRecord : inRecords)
         {
-            const bool handled = _termInput.HandleKey(inEvent.get());
-            if (handled)
+            // If we're in vt mode, try and handle it with the vt input module.
+            // If it was handled, do nothing else for it.
+            // If there was one event passed in, try coalescing it with the previous event currently in the buffer.
+            // If it's not coalesced, append it to the buffer.
+            if (vtInputMode && inRecord.EventType == KEY_EVENT)
             {
-                eventsWritten++;
-                continue;
+                const KeyEvent keyEvent{ inRecord.Event.KeyEvent };
+                const bool handled = _termInput.HandleKey(&keyEvent);
+                if (handled)
+                {
+                    eventsWritten++;
+                    continue;
+                }
             }
-        }
 
-        // we only check for possible coalescing when storing one
-        // record at a time because this is the original behavior of
-        // the input buffer. Changing this behavior may break stuff
-        // that was depending on it.
-        if (initialInEventsSize == 1 && !_storage.empty())
-        {
-            // coalescing requires a deque of events, so push it back onto the front.
-            inEvents.push_front(std::move(inEvent));
-
-            bool coalesced = false;
+            // we only check for possible coalescing when storing one
+            // record at a time because this is the original behavior of
+            // the input buffer. Changing this behavior may break stuff
+            // that was depending on it.
+            //
             // this looks kinda weird but we don't want to coalesce a
             // mouse event and then try to coalesce a key event right after.
-            //
-            // we also pass the whole deque to the coalescing methods
-            // even though they only want one event because it should
-            // be their responsibility to maintain the correct state
-            // of the deque if they process any records in it.
-            if (_CoalesceMouseMovedEvents(inEvents))
-            {
-                coalesced = true;
-            }
-            else if (_CoalesceRepeatedKeyPressEvents(inEvents))
+            if (initialInEventsSize == 1 && !_storage.IsEmpty())
             {
-                coalesced = true;
-            }
-            if (coalesced)
-            {
-                eventsWritten = 1;
-                return;
-            }
-            else
-            {
-                // We didn't coalesce the event. pull it from the queue again,
-                //  to keep the state consistent with the start of this block.
-                inEvent = std::move(inEvents.front());
-                inEvents.pop_front();
+                if (_CoalesceMouseMovedEvents(inRecord) ||
+                    _CoalesceRepeatedKeyPressEvents(inRecord))
+                {
+                    eventsWritten = 1;
+                    return;
+                }
             }
+            // At this point, the event was neither coalesced, nor processed by VT.
+            _storage.PushBack(inRecord);
+            ++eventsWritten;
         }
-        // At this point, the event was neither coalesced, nor processed by VT.
-        _storage.push_back(std::move(inEvent));
-        ++eventsWritten;
     }
-    if (initiallyEmptyQueue && !_storage.empty())
+    if (initiallyEmptyQueue && !_storage.IsEmpty())
     {
         setWaitEvent = true;
     }
 }
 
 // Routine Description:
-// - Checks if the last saved event and the first event of inRecords are
-// both MOUSE_MOVED events. If they are, the last saved event is
-// updated with the new mouse position and the first event of inRecords is
-// dropped.
+// - Checks if the last saved event and the incoming record are both
+// MOUSE_MOVED events. If they are, the last saved event is updated with
+// the new mouse position and the incoming record can be dropped.
 // Arguments:
-// - inRecords - The incoming records to process.
+// - inRecord - The incoming record to process.
 // Return Value:
 // true if events were coalesced, false if they were not.
 // Note:
-// - The size of inRecords must be 1.
 // - Coalescing here means updating a record that already exists in
 // the buffer with updated values from an incoming event, instead of
 // storing the incoming event (which would make the original one
 // redundant/out of date with the most current state).
-bool InputBuffer::_CoalesceMouseMovedEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+bool InputBuffer::_CoalesceMouseMovedEvents(const INPUT_RECORD& inRecord) noexcept
 {
-    FAIL_FAST_IF(!(inEvents.size() == 1));
-    FAIL_FAST_IF(_storage.empty());
-    const IInputEvent* const pFirstInEvent = inEvents.front().get();
-    const IInputEvent* const pLastStoredEvent = _storage.back().get();
-    if (pFirstInEvent->EventType() == InputEventType::MouseEvent &&
-        pLastStoredEvent->EventType() == InputEventType::MouseEvent)
-    {
-        const MouseEvent* const pInMouseEvent = static_cast<const MouseEvent* const>(pFirstInEvent);
-        const MouseEvent* const pLastMouseEvent = static_cast<const MouseEvent* const>(pLastStoredEvent);
-
-        if (pInMouseEvent->IsMouseMoveEvent() &&
-            pLastMouseEvent->IsMouseMoveEvent())
-        {
-            // update mouse moved position
-            MouseEvent* const pMouseEvent = static_cast<MouseEvent* const>(_storage.back().release());
-            pMouseEvent->SetPosition(pInMouseEvent->GetPosition());
-            std::unique_ptr<IInputEvent> tempPtr(pMouseEvent);
-            tempPtr.swap(_storage.back());
-
-            inEvents.pop_front();
-            return true;
-        }
+    FAIL_FAST_IF(_storage.IsEmpty());
+    INPUT_RECORD& lastStoredRecord = _storage.Back();
+    if (inRecord.EventType == MOUSE_EVENT &&
+        lastStoredRecord.EventType == MOUSE_EVENT &&
+        inRecord.Event.MouseEvent.dwEventFlags == MOUSE_MOVED &&
+        lastStoredRecord.Event.MouseEvent.dwEventFlags == MOUSE_MOVED)
+    {
+        // update mouse moved position
+        lastStoredRecord.Event.MouseEvent.dwMousePosition = inRecord.Event.MouseEvent.dwMousePosition;
+        return true;
     }
     return false;
 }
 
 // Routine Description:
-// - checks two KeyEvents to see if they're similiar enough to be coalesced
+// - checks two key events to see if they're similiar enough to be coalesced
 // Arguments:
-// - a - the first KeyEvent
-// - b - the other KeyEvent
+// - a - the first key event
+// - b - the other key event
 // Return Value:
 // - true if the events could be coalesced, false otherwise
-bool InputBuffer::_CanCoalesce(const KeyEvent& a, const KeyEvent& b) const noexcept
+bool InputBuffer::_CanCoalesce(const KEY_EVENT_RECORD& a, const KEY_EVENT_RECORD& b) const noexcept
 {
-    if (WI_IsFlagSet(a.GetActiveModifierKeys(), NLS_IME_CONVERSION) &&
-        a.GetCharData() == b.GetCharData() &&
-        a.GetActiveModifierKeys() == b.GetActiveModifierKeys())
+    if (WI_IsFlagSet(a.dwControlKeyState, NLS_IME_CONVERSION) &&
+        a.uChar.UnicodeChar == b.uChar.UnicodeChar &&
+        a.dwControlKeyState == b.dwControlKeyState)
     {
         return true;
     }
     // other key events check
-    else if (a.GetVirtualScanCode() == b.GetVirtualScanCode() &&
-             a.GetCharData() == b.GetCharData() &&
-             a.GetActiveModifierKeys() == b.GetActiveModifierKeys())
+    else if (a.wVirtualScanCode == b.wVirtualScanCode &&
+             a.uChar.UnicodeChar == b.uChar.UnicodeChar &&
+             a.dwControlKeyState == b.dwControlKeyState)
     {
         return true;
     }
@@ -741,44 +751,35 @@ bool InputBuffer::_CanCoalesce(const KeyEvent& a, const KeyEvent& b) const noexc
 }
 
 // Routine Description::
-// - If the last input event saved and the first input event in inRecords
-// are both a keypress down event for the same key, update the repeat
-// count of the saved event and drop the first from inRecords.
+// - If the last input event saved and the incoming record are both a
+// keypress down event for the same key, update the repeat count of the
+// saved event and drop the incoming record.
 // Arguments:
-// - inRecords - The incoming records to process.
+// - inRecord - The incoming record to process.
 // Return Value:
 // true if events were coalesced, false if they were not.
 // Note:
-// - The size of inRecords must be 1.
 // - Coalescing here means updating a record that already exists in
 // the buffer with updated values from an incoming event, instead of
 // storing the incoming event (which would make the original one
 // redundant/out of date with the most current state).
-bool InputBuffer::_CoalesceRepeatedKeyPressEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+bool InputBuffer::_CoalesceRepeatedKeyPressEvents(const INPUT_RECORD& inRecord) noexcept
 {
-    FAIL_FAST_IF(!(inEvents.size() == 1));
-    FAIL_FAST_IF(_storage.empty());
-    const IInputEvent* const pFirstInEvent = inEvents.front().get();
-    const IInputEvent* const pLastStoredEvent = _storage.back().get();
-    if (pFirstInEvent->EventType() == InputEventType::KeyEvent &&
-        pLastStoredEvent->EventType() == InputEventType::KeyEvent)
-    {
-        const KeyEvent* const pInKeyEvent = static_cast<const KeyEvent* const>(pFirstInEvent);
-        const KeyEvent* const pLastKeyEvent = static_cast<const KeyEvent* const>(pLastStoredEvent);
-
-        if (pInKeyEvent->IsKeyDown() &&
-            pLastKeyEvent->IsKeyDown() &&
-            !IsGlyphFullWidth(pInKeyEvent->GetCharData()) &&
-            _CanCoalesce(*pInKeyEvent, *pLastKeyEvent))
+    FAIL_FAST_IF(_storage.IsEmpty());
+    INPUT_RECORD& lastStoredRecord = _storage.Back();
+    if (inRecord.EventType == KEY_EVENT &&
+        lastStoredRecord.EventType == KEY_EVENT)
+    {
+        const KEY_EVENT_RECORD& inKeyEvent = inRecord.Event.KeyEvent;
+        KEY_EVENT_RECORD& lastKeyEvent = lastStoredRecord.Event.KeyEvent;
+
+        if (inKeyEvent.bKeyDown &&
+            lastKeyEvent.bKeyDown &&
+            !IsGlyphFullWidth(inKeyEvent.uChar.UnicodeChar) &&
+            _CanCoalesce(inKeyEvent, lastKeyEvent))
         {
             // increment repeat count
-            KeyEvent* const pKeyEvent = static_cast<KeyEvent* const>(_storage.back().release());
-            WORD repeatCount = pKeyEvent->GetRepeatCount() + pInKeyEvent->GetRepeatCount();
-            pKeyEvent->SetRepeatCount(repeatCount);
-            std::unique_ptr<IInputEvent> tempPtr(pKeyEvent);
-            tempPtr.swap(_storage.back());
-
-            inEvents.pop_front();
+            lastKeyEvent.wRepeatCount += inKeyEvent.wRepeatCount;
             return true;
         }
     }
@@ -788,42 +789,53 @@ bool InputBuffer::_CoalesceRepeatedKeyPressEvents(_Inout_ std::deque<std::unique
 // Routine Description:
 // - Handles records that suspend/resume the console.
 // Arguments:
-// - records - records to check for pause/unpause events
+// - inRecords - records to check for pause/unpause events
+// - remainingRecords - storage for the records that are left, used only if
+//   any of them had to be removed
 // Return Value:
-// - None
+// - The records that should still be written to the buffer. This is
+//   inRecords itself unless something was removed from it.
 // Note:
 // - The console lock must be held when calling this routine.
 // - will throw exception on error
-void InputBuffer::_HandleConsoleSuspensionEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+gsl::span<const INPUT_RECORD> InputBuffer::_HandleConsoleSuspensionEvents(const gsl::span<const INPUT_RECORD> inRecords,
+                                                                          _Out_ std::vector<INPUT_RECORD>& remainingRecords)
 {
     CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
 
-    std::deque<std::unique_ptr<IInputEvent>> outEvents;
-    while (!inEvents.empty())
+    remainingRecords.clear();
+    bool removedAny = false;
+    for (auto it = inRecords.begin(); it != inRecords.end(); ++it)
     {
-        std::unique_ptr<IInputEvent> currEvent = std::move(inEvents.front());
-        inEvents.pop_front();
-        if (currEvent->EventType() == InputEventType::KeyEvent)
+        bool remove = false;
+        if (it->EventType == KEY_EVENT && it->Event.KeyEvent.bKeyDown)
         {
-            const KeyEvent* const pKeyEvent = static_cast<const KeyEvent* const>(currEvent.get());
-            if (pKeyEvent->IsKeyDown())
+            if (WI_IsFlagSet(gci.Flags, CONSOLE_SUSPENDED) &&
+                !IsSystemKey(it->Event.KeyEvent.wVirtualKeyCode))
             {
-                if (WI_IsFlagSet(gci.Flags, CONSOLE_SUSPENDED) &&
-                    !IsSystemKey(pKeyEvent->GetVirtualKeyCode()))
-                {
-                    UnblockWriteConsole(CONSOLE_OUTPUT_SUSPENDED);
-                    continue;
-                }
-                else if (WI_IsFlagSet(InputMode, ENABLE_LINE_INPUT) && pKeyEvent->IsPauseKey())
-                {
-                    WI_SetFlag(gci.Flags, CONSOLE_SUSPENDED);
-                    continue;
-                }
+                UnblockWriteConsole(CONSOLE_OUTPUT_SUSPENDED);
+                remove = true;
+            }
+            else if (WI_IsFlagSet(InputMode, ENABLE_LINE_INPUT) && it->Event.KeyEvent.wVirtualKeyCode == VK_PAUSE)
+            {
+                WI_SetFlag(gci.Flags, CONSOLE_SUSPENDED);
+                remove = true;
             }
         }
-        outEvents.push_back(std::move(currEvent));
+
+        if (remove && !removedAny)
+        {
+            // Only now do the records need to be copied: everything up to here is kept.
+            remainingRecords.assign(inRecords.begin(), it);
+            removedAny = true;
+        }
+        else if (!remove && removedAny)
+        {
+            remainingRecords.push_back(*it);
+        }
     }
-    inEvents.swap(outEvents);
+
+    return removedAny ? gsl::span<const INPUT_RECORD>{ remainingRecords } : inRecords;
 }
 
 // Routine Description:
@@ -841,8 +853,7 @@ bool InputBuffer::IsInVirtualTerminalInputMode() const
 // - Handler for inserting key sequences into the buffer when the terminal emulation layer
 //   has determined a key can be converted appropriately into a sequence of inputs
 // Arguments:
-// - rgInput - Series of input records to insert into the buffer
-// - cInput - Length of input records array
+// - inEvents - Series of input events to insert into the buffer
 // Return Value:
 // - <none>
 void InputBuffer::_HandleTerminalInputCallback(std::deque<std::unique_ptr<IInputEvent>>& inEvents)
@@ -850,12 +861,11 @@ void InputBuffer::_HandleTerminalInputCallback(std::deque<std::unique_ptr<IInput
     try
     {
         // add all input events to the storage queue
-        while (!inEvents.empty())
+        for (const auto& inEvent : inEvents)
         {
-            std::unique_ptr<IInputEvent> inEvent = std::move(inEvents.front());
-            inEvents.pop_front();
-            _storage.push_back(std::move(inEvent));
+            _storage.PushBack(inEvent->ToInputRecord());
         }
+        inEvents.clear();
     }
     catch (...)
     {
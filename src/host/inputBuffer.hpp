@@ -14,12 +14,15 @@ Author:
 Revision History:
 - Moved from input.h/input.cpp. (AustDi, 2017)
 - Refactored to class, added stl container usage (AustDi, 2017)
+- Events are stored by value as INPUT_RECORDs. The IInputEvent overloads
+  convert to and from them at the edges.
 --*/
 
 #pragma once
 
 #include "inputReadHandleData.h"
 #include "readData.hpp"
+#include "inputEventQueue.hpp"
 #include "../types/inc/IInputEvent.hpp"
 
 #include "../server/ObjectHandle.h"
@@ -68,36 +71,45 @@ public:
                                 const bool Unicode,
                                 const bool Stream);
 
+    [[nodiscard]] NTSTATUS Read(const gsl::span<INPUT_RECORD> outRecords,
+                                _Out_ size_t& eventsRead,
+                                const bool Peek,
+                                const bool WaitForData,
+                                const bool Unicode,
+                                const bool Stream);
+
     size_t Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
+    size_t Prepend(const gsl::span<const INPUT_RECORD> inRecords);
 
     size_t Write(_Inout_ std::unique_ptr<IInputEvent> inEvent);
     size_t Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
+    size_t Write(const gsl::span<const INPUT_RECORD> inRecords);
 
     bool IsInVirtualTerminalInputMode() const;
     Microsoft::Console::VirtualTerminal::TerminalInput& GetTerminalInput();
 
 private:
-    std::deque<std::unique_ptr<IInputEvent>> _storage;
+    InputEventQueue _storage;
     std::unique_ptr<IInputEvent> _readPartialByteSequence;
     std::unique_ptr<IInputEvent> _writePartialByteSequence;
     Microsoft::Console::VirtualTerminal::TerminalInput _termInput;
 
-    void _ReadBuffer(_Out_ std::deque<std::unique_ptr<IInputEvent>>& outEvents,
-                     const size_t readCount,
+    void _ReadBuffer(const gsl::span<INPUT_RECORD> outRecords,
                      _Out_ size_t& eventsRead,
                      const bool peek,
                      _Out_ bool& resetWaitEvent,
                      const bool unicode,
                      const bool streamRead);
 
-    void _WriteBuffer(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inRecords,
+    void _WriteBuffer(const gsl::span<const INPUT_RECORD> inRecords,
                       _Out_ size_t& eventsWritten,
                       _Out_ bool& setWaitEvent);
 
-    bool _CanCoalesce(const KeyEvent& a, const KeyEvent& b) const noexcept;
-    bool _CoalesceMouseMovedEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
-    bool _CoalesceRepeatedKeyPressEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
-    void _HandleConsoleSuspensionEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
+    bool _CanCoalesce(const KEY_EVENT_RECORD& a, const KEY_EVENT_RECORD& b) const noexcept;
+    bool _CoalesceMouseMovedEvents(const INPUT_RECORD& inRecord) noexcept;
+    bool _CoalesceRepeatedKeyPressEvents(const INPUT_RECORD& inRecord) noexcept;
+    gsl::span<const INPUT_RECORD> _HandleConsoleSuspensionEvents(const gsl::span<const INPUT_RECORD> inRecords,
+                                                                 _Out_ std::vector<INPUT_RECORD>& remainingRecords);
 
     void _HandleTerminalInputCallback(_In_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
 
@@ -0,0 +1,212 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "inputEventQueue.hpp"
+
+// The capacity a queue starts out with, and shrinks back to once it's emptied.
+static constexpr size_t s_minimumCapacity = 64;
+
+InputEventQueue::InputEventQueue() noexcept :
+    _records{},
+    _head{ 0 },
+    _size{ 0 }
+{
+}
+
+// Routine Description:
+// - Gets the number of records in the queue.
+size_t InputEventQueue::Size() const noexcept
+{
+    return _size;
+}
+
+bool InputEventQueue::IsEmpty() const noexcept
+{
+    return _size == 0;
+}
+
+// Routine Description:
+// - Gets the record at the given position, counting from the front of the
+//      queue. The index must be less than Size().
+INPUT_RECORD& InputEventQueue::operator[](const size_t index) noexcept
+{
+    return _records[_Wrap(_head + index)];
+}
+
+const INPUT_RECORD& InputEventQueue::operator[](const size_t index) const noexcept
+{
+    return _records[_Wrap(_head + index)];
+}
+
+INPUT_RECORD& InputEventQueue::Front() noexcept
+{
+    return (*this)[0];
+}
+
+INPUT_RECORD& InputEventQueue::Back() noexcept
+{
+    return (*this)[_size - 1];
+}
+
+// Routine Description:
+// - Adds a record to the back of the queue.
+// Arguments:
+// - record - the record to add
+// Return Value:
+// - <none>
+// Note:
+// - will throw exception on error
+void InputEventQueue::PushBack(const INPUT_RECORD& record)
+{
+    PushBack(gsl::make_span(&record, 1));
+}
+
+// Routine Description:
+// - Adds records to the back of the queue, in order.
+// Arguments:
+// - records - the records to add
+// Return Value:
+// - <none>
+// Note:
+// - will throw exception on error
+void InputEventQueue::PushBack(const gsl::span<const INPUT_RECORD> records)
+{
+    const auto count = static_cast<size_t>(records.size());
+    if (count == 0)
+    {
+        return;
+    }
+
+    _Reserve(_size + count);
+    _Write(_Wrap(_head + _size), records);
+    _size += count;
+}
+
+// Routine Description:
+// - Adds records to the front of the queue. The first of the records will be
+//      the new front of the queue.
+// Arguments:
+// - records - the records to add
+// Return Value:
+// - <none>
+// Note:
+// - will throw exception on error
+void InputEventQueue::PushFront(const gsl::span<const INPUT_RECORD> records)
+{
+    const auto count = static_cast<size_t>(records.size());
+    if (count == 0)
+    {
+        return;
+    }
+
+    _Reserve(_size + count);
+    _head = _Wrap(_head + _records.size() - count);
+    _Write(_head, records);
+    _size += count;
+}
+
+// Routine Description:
+// - Removes records from the front of the queue.
+// Arguments:
+// - count - the number of records to remove. If there aren't that many,
+//      the queue is emptied.
+// Return Value:
+// - <none>
+void InputEventQueue::PopFront(const size_t count) noexcept
+{
+    const auto removed = std::min(count, _size);
+    if (removed == 0)
+    {
+        return;
+    }
+
+    _head = _Wrap(_head + removed);
+    _size -= removed;
+    _ReleaseIfEmpty();
+}
+
+// Routine Description:
+// - Removes every record from the queue.
+void InputEventQueue::Clear() noexcept
+{
+    _size = 0;
+    _ReleaseIfEmpty();
+}
+
+// Routine Description:
+// - Maps a position that might be past the end of the storage back to the
+//      start of it.
+size_t InputEventQueue::_Wrap(const size_t position) const noexcept
+{
+    // The capacity is a power of two.
+    return position & (_records.size() - 1);
+}
+
+// Routine Description:
+// - Makes sure the queue can hold the given number of records. When it
+//      can't, the records are moved into new storage twice as large (or
+//      larger), starting at the front.
+// Arguments:
+// - size - the number of records the queue should be able to hold.
+// Return Value:
+// - <none>
+// Note:
+// - will throw exception on error
+void InputEventQueue::_Reserve(const size_t size)
+{
+    if (size <= _records.size())
+    {
+        return;
+    }
+
+    auto capacity = std::max(_records.size(), s_minimumCapacity);
+    while (capacity < size)
+    {
+        capacity *= 2;
+    }
+
+    std::vector<INPUT_RECORD> records(capacity);
+    for (size_t i = 0; i < _size; ++i)
+    {
+        records[i] = (*this)[i];
+    }
+
+    _records.swap(records);
+    _head = 0;
+}
+
+// Routine Description:
+// - Copies records into the storage, wrapping around the end of it if
+//      necessary. There must be room for all of them.
+// Arguments:
+// - position - the index in the storage to write the first record to.
+// - records - the records to write.
+// Return Value:
+// - <none>
+void InputEventQueue::_Write(const size_t position, const gsl::span<const INPUT_RECORD> records) noexcept
+{
+    const auto count = static_cast<size_t>(records.size());
+    const auto beforeEnd = std::min(count, _records.size() - position);
+    std::copy_n(records.data(), beforeEnd, _records.data() + position);
+    std::copy_n(records.data() + beforeEnd, count - beforeEnd, _records.data());
+}
+
+// Routine Description:
+// - Once the queue is empty, the next record can go anywhere, so start over
+//      at the beginning of the storage. If the storage grew to hold a large
+//      burst of input, let go of it.
+void InputEventQueue::_ReleaseIfEmpty() noexcept
+{
+    if (_size != 0)
+    {
+        return;
+    }
+
+    _head = 0;
+    if (_records.size() > s_minimumCapacity)
+    {
+        // Swapping with an empty vector (rather than shrinking) can't throw.
+        std::vector<INPUT_RECORD>{}.swap(_records);
+    }
+}
@@ -0,0 +1,69 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- inputEventQueue.hpp
+
+Abstract:
+- The storage behind the input buffer: a ring buffer of INPUT_RECORDs.
+- An INPUT_RECORD is already a small tagged union of every kind of input event,
+    so storing them by value keeps the events in one block of memory, and lets
+    whole runs of them be appended, prepended and read back with a couple of
+    copies, instead of one heap allocation per event.
+- The capacity is always a power of two, and grows as needed. When a large
+    burst of input (like a paste) has been read out, the memory it used is
+    given back.
+--*/
+
+#pragma once
+
+class InputEventQueue final
+{
+public:
+    InputEventQueue() noexcept;
+
+    size_t Size() const noexcept;
+    bool IsEmpty() const noexcept;
+
+    INPUT_RECORD& operator[](const size_t index) noexcept;
+    const INPUT_RECORD& operator[](const size_t index) const noexcept;
+    INPUT_RECORD& Front() noexcept;
+    INPUT_RECORD& Back() noexcept;
+
+    void PushBack(const INPUT_RECORD& record);
+    void PushBack(const gsl::span<const INPUT_RECORD> records);
+    void PushFront(const gsl::span<const INPUT_RECORD> records);
+    void PopFront(const size_t count) noexcept;
+    void Clear() noexcept;
+
+    // Routine Description:
+    // - Removes every record that matches the predicate, keeping the order of
+    //      the others.
+    template<typename Predicate>
+    void RemoveIf(Predicate predicate)
+    {
+        size_t kept = 0;
+        for (size_t i = 0; i < _size; ++i)
+        {
+            const auto& record = (*this)[i];
+            if (!predicate(record))
+            {
+                (*this)[kept++] = record;
+            }
+        }
+        _size = kept;
+        _ReleaseIfEmpty();
+    }
+
+private:
+    // The capacity of the queue is _records.size().
+    std::vector<INPUT_RECORD> _records;
+    size_t _head;
+    size_t _size;
+
+    size_t _Wrap(const size_t position) const noexcept;
+    void _Reserve(const size_t size);
+    void _Write(const size_t position, const gsl::span<const INPUT_RECORD> records) noexcept;
+    void _ReleaseIfEmpty() noexcept;
+};
@@ -281,6 +281,24 @@ static void _ScrollScreen(SCREEN_INFORMATION& screenInfo, const Viewport& source
     // Get the render target and send it commands.
     // It will figure out whether or not we're active and where the messages need to go.
     auto& render = screenInfo.GetRenderTarget();
+
+    // If whole rows just moved up or down (like when text scrolls within the
+    //      margins set by DECSTBM), let the renderer know that it's a scroll.
+    //      Some renderers can move the rows instead of redrawing all of them.
+    if (source.Left() == target.Left() && source.Width() == target.Width() && source.Top() != target.Top())
+    {
+        const auto region = Viewport::Union(source, target);
+        render.TriggerScrollRegion(region, gsl::narrow<short>(target.Top() - source.Top()));
+        // The uncovered rows of the region are redrawn as part of the scroll.
+        //      Anything that was filled outside of it still needs a redraw.
+        const auto remaining = Viewport::Subtract(fill, region);
+        for (size_t i = 0; i < remaining.size(); i++)
+        {
+            render.TriggerRedraw(remaining.at(i));
+        }
+        return;
+    }
+
     // Redraw anything in the target area
     render.TriggerRedraw(target);
     // Also redraw anything that was filled.
@@ -281,13 +281,13 @@ BOOL ConhostInternalGetSet::PrivateBoldText(const bool bolded)
 // - eventsWritten - on output, the number of events written
 // Return Value:
 // - TRUE if successful (see DoSrvWriteConsoleInput). FALSE otherwise.
-BOOL ConhostInternalGetSet::PrivateWriteConsoleInputW(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& events,
+BOOL ConhostInternalGetSet::PrivateWriteConsoleInputW(const gsl::span<const INPUT_RECORD> records,
                                                       _Out_ size_t& eventsWritten)
 {
     eventsWritten = 0;
 
     return SUCCEEDED(DoSrvPrivateWriteConsoleInputW(_io.GetActiveInputBuffer(),
-                                                    events,
+                                                    records,
                                                     eventsWritten,
                                                     true)); // append
 }
@@ -89,7 +89,7 @@ public:
 
     BOOL PrivateBoldText(const bool bolded) override;
 
-    BOOL PrivateWriteConsoleInputW(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& events,
+    BOOL PrivateWriteConsoleInputW(const gsl::span<const INPUT_RECORD> records,
                                    _Out_ size_t& eventsWritten) override;
 
     BOOL ScrollConsoleScreenBufferW(const SMALL_RECT* pScrollRectangle,
@@ -7,9 +7,21 @@
 
 #include "dbcs.h"
 #include "../buffer/out/CharRow.hpp"
-#include "../types/inc/Utf16Parser.hpp"
+#include "../types/inc/GraphemeClusterIterator.hpp"
 #include "../types/inc/GlyphWidth.hpp"
 
+#include <array>
+
+// The Boyer-Moore-Horspool shift table is indexed by the low byte of the last
+// character in a cell. Cells that share a low byte share a slot, which holds
+// the smallest shift of any of them, so a match is never skipped.
+static constexpr size_t s_shiftTableSize = 256;
+
+static size_t s_ShiftKey(const std::wstring_view cell) noexcept
+{
+    return cell.empty() ? 0 : (cell.back() & (s_shiftTableSize - 1));
+}
+
 // Routine Description:
 // - Constructs a Search object.
 // - Make a Search object then call .FindNext() to locate items.
@@ -19,15 +31,21 @@
 // - str - The search term you want to find (the "needle")
 // - direction - The direction to search (upward or downward)
 // - sensitivity - Whether or not you care about case
+// - syntax - Whether the search term is text, or a regular expression
+// Note:
+// - will throw exception if the search term is a regular expression that isn't valid
 Search::Search(const SCREEN_INFORMATION& screenInfo,
                const std::wstring& str,
                const Direction direction,
-               const Sensitivity sensitivity) :
+               const Sensitivity sensitivity,
+               const Syntax syntax) :
     _direction(direction),
     _sensitivity(sensitivity),
     _screenInfo(screenInfo),
     _needle(s_CreateNeedleFromString(str)),
-    _coordAnchor(s_GetInitialAnchor(screenInfo, direction))
+    _coordAnchor(s_GetInitialAnchor(screenInfo, direction)),
+    _regex(s_CreateRegex(str, sensitivity, syntax)),
+    _regexLiteral(syntax == Syntax::RegularExpression ? s_GetRequiredLiteral(str) : std::wstring{})
 {
     _coordNext = _coordAnchor;
 }
@@ -42,16 +60,22 @@ Search::Search(const SCREEN_INFORMATION& screenInfo,
 // - direction - The direction to search (upward or downward)
 // - sensitivity - Whether or not you care about case
 // - anchor - starting search location in screenInfo
+// - syntax - Whether the search term is text, or a regular expression
+// Note:
+// - will throw exception if the search term is a regular expression that isn't valid
 Search::Search(const SCREEN_INFORMATION& screenInfo,
                const std::wstring& str,
                const Direction direction,
                const Sensitivity sensitivity,
-               const COORD anchor) :
+               const COORD anchor,
+               const Syntax syntax) :
     _direction(direction),
     _sensitivity(sensitivity),
     _screenInfo(screenInfo),
     _needle(s_CreateNeedleFromString(str)),
-    _coordAnchor(anchor)
+    _coordAnchor(anchor),
+    _regex(s_CreateRegex(str, sensitivity, syntax)),
+    _regexLiteral(syntax == Syntax::RegularExpression ? s_GetRequiredLiteral(str) : std::wstring{})
 {
     _coordNext = _coordAnchor;
 }
@@ -71,22 +95,82 @@ bool Search::FindNext()
         return false;
     }
 
-    do
+    const auto& matches = _GetMatches();
+    const auto cellCount = _GetCellCount();
+    const auto next = _IndexFromCoord(_coordNext);
+    const auto anchor = _IndexFromCoord(_coordAnchor);
+
+    // The positions left to look at run from the next one up to (but not
+    // including) the anchor, in the direction of the search, wrapping around
+    // the buffer. When the next one is the anchor, that's the whole buffer.
+    auto remaining = (_direction == Direction::Forward) ?
+                         (anchor + cellCount - next) % cellCount :
+                         (next + cellCount - anchor) % cellCount;
+    if (remaining == 0)
+    {
+        remaining = cellCount;
+    }
+
+    // Find the closest match to the next position, in the direction of the search.
+    std::optional<Match> found;
+    if (!matches.empty())
     {
-        if (_FindNeedleInHaystackAt(_coordNext, _coordSelStart, _coordSelEnd))
+        const auto startsBefore = [](const Match& match, const size_t index) { return match.first < index; };
+        const auto startsAfter = [](const size_t index, const Match& match) { return index < match.first; };
+
+        Match match;
+        size_t distance = 0;
+        if (_direction == Direction::Forward)
         {
-            _UpdateNextPosition();
-            _reachedEnd = _coordNext == _coordAnchor;
-            return true;
+            auto it = std::lower_bound(matches.cbegin(), matches.cend(), next, startsBefore);
+            match = (it != matches.cend()) ? *it : matches.front();
+            distance = (match.first + cellCount - next) % cellCount;
         }
         else
         {
-            _UpdateNextPosition();
+            auto it = std::upper_bound(matches.cbegin(), matches.cend(), next, startsAfter);
+            match = (it != matches.cbegin()) ? *(it - 1) : matches.back();
+            distance = (next + cellCount - match.first) % cellCount;
+        }
+
+        if (distance < remaining)
+        {
+            found = match;
         }
+    }
+
+    if (!found.has_value())
+    {
+        _coordNext = _coordAnchor;
+        return false;
+    }
+
+    _coordSelStart = _CoordFromIndex(found.value().first);
+    _coordSelEnd = _CoordFromIndex(found.value().second);
+
+    _coordNext = _coordSelStart;
+    _UpdateNextPosition();
+    _reachedEnd = _coordNext == _coordAnchor;
+    return true;
+}
 
-    } while (_coordNext != _coordAnchor);
+// Routine Description
+// - Locates every instance of the search term within the screen buffer.
+// Arguments:
+// - <none> - Uses internal state from constructor
+// Return Value:
+// - The start and end positions of each instance, in buffer order.
+std::vector<std::pair<COORD, COORD>> Search::FindAll()
+{
+    const auto& matches = _GetMatches();
 
-    return false;
+    std::vector<std::pair<COORD, COORD>> locations;
+    locations.reserve(matches.size());
+    for (const auto& match : matches)
+    {
+        locations.emplace_back(_CoordFromIndex(match.first), _CoordFromIndex(match.second));
+    }
+    return locations;
 }
 
 // Routine Description:
@@ -164,72 +248,482 @@ COORD Search::s_GetInitialAnchor(const SCREEN_INFORMATION& screenInfo, const Dir
 }
 
 // Routine Description:
-// - Attempts to compare the search term (the needle) to the screen buffer (the haystack)
-//   at the given coordinate position of the screen buffer.
-// - Performs one comparison. Call again with new positions to check other spots.
-// Arguments:
-// - pos - The position in the haystack (screen buffer) to compare
-// - start - If we found it, this is filled with the coordinate of the first character of the needle.
-// - end - If we found it, this is filled with the coordinate of the last character of the needle.
+// - Gets every match of the search term (the needle) in the screen buffer
+//   (the haystack), finding them the first time they're needed.
 // Return Value:
-// - True if we found it. False if not.
-bool Search::_FindNeedleInHaystackAt(const COORD pos, COORD& start, COORD& end) const
+// - The first and last cells of every match, in order of where they start.
+const std::vector<Search::Match>& Search::_GetMatches()
 {
-    start = { 0 };
-    end = { 0 };
+    if (!_matches.has_value())
+    {
+        _matches = _regex.has_value() ? _FindRegexMatches() : _FindLiteralMatches();
+    }
+    return _matches.value();
+}
 
-    COORD bufferPos = pos;
+// Routine Description:
+// - Finds every match of the search term (the needle) in the screen buffer
+//   (the haystack) in one pass over the buffer.
+// - The buffer is read a row at a time, with each row's cells case folded as
+//   they're read. The last few cells of the row before are kept in front of
+//   it, so that matches which run off the end of one row and onto the next are
+//   found, as are matches that wrap from the end of the buffer to the start.
+// - Each row is scanned with Boyer-Moore-Horspool, comparing whole cells: a
+//   cell matches a cell of the needle when their (folded) text is the same.
+// - Rows that the buffer's search index rules out are skipped without being
+//   read.
+// Return Value:
+// - The first and last cells of every match, in order of where they start.
+std::vector<Search::Match> Search::_FindLiteralMatches() const
+{
+    std::vector<Match> matches;
 
-    for (const auto& needleCell : _needle)
+    const auto needleLength = _needle.size();
+    const auto cellCount = _GetCellCount();
+    if (needleLength == 0 || needleLength > cellCount)
     {
-        // Haystack is the buffer. Needle is the string we were given.
-        const auto hayIter = _screenInfo.GetTextDataAt(bufferPos);
-        const auto hayChars = *hayIter;
-        const auto needleChars = std::wstring_view(needleCell.data(), needleCell.size());
+        return matches;
+    }
 
-        // If we didn't match at any point of the needle, return false.
-        if (!_CompareChars(hayChars, needleChars))
+    // Fold the needle once, and lay its cells end to end.
+    std::wstring needleText;
+    std::vector<size_t> needleCells{ 0 };
+    for (const auto& cell : _needle)
+    {
+        for (const auto wch : cell)
         {
-            return false;
+            needleText.push_back(_ApplySensitivity(wch));
         }
+        needleCells.push_back(needleText.size());
+    }
+
+    const auto needleCell = [&](const size_t i) {
+        return std::wstring_view{ needleText }.substr(needleCells[i], needleCells[i + 1] - needleCells[i]);
+    };
 
-        _IncrementCoord(bufferPos);
+    // How far the needle can move along when the cell under its last cell is a given one.
+    std::array<size_t, s_shiftTableSize> shifts;
+    shifts.fill(needleLength);
+    for (size_t i = 0; i < needleLength - 1; ++i)
+    {
+        shifts[s_ShiftKey(needleCell(i))] = needleLength - 1 - i;
     }
 
-    _DecrementCoord(bufferPos);
+    // The haystack is laid out the same way, along with the buffer index of its first cell.
+    std::wstring hayText;
+    std::vector<size_t> hayCells{ 0 };
+    size_t hayStart = 0;
 
-    // If we made it the whole way through the needle, then it was in the haystack.
-    // Fill out the span that we found the result at and return true.
-    start = pos;
-    end = bufferPos;
+    const auto hayCell = [&](const size_t i) {
+        return std::wstring_view{ hayText }.substr(hayCells[i], hayCells[i + 1] - hayCells[i]);
+    };
 
-    return true;
+    const auto& textBuffer = _screenInfo.GetTextBuffer();
+    const auto width = gsl::narrow_cast<size_t>(_screenInfo.GetBufferSize().Width());
+    const auto height = cellCount / width;
+
+    // Rows that can't hold the start of a match, going by the buffer's search
+    // index, don't need to be read at all. A match can run on from the row it
+    // starts in into the rows below it, so a row has to be read if it or any of
+    // the rows just above it might hold the start of one.
+    // (A row's signature only runs on into the row below it, so a buffer one
+    // column wide would have trigrams in no signature at all.)
+    std::vector<bool> rowNeeded(height, true);
+    const auto needleSignature = RowSearchIndex::s_Signature(needleText);
+    if (width > 1 && !RowSearchIndex::s_IsEmpty(needleSignature))
+    {
+        const auto rowsSpanned = (width + needleLength - 2) / width;
+
+        std::vector<bool> mayStartMatch(height);
+        for (size_t row = 0; row < height; ++row)
+        {
+            auto signature = textBuffer.GetRowSearchSignature(row);
+            for (size_t below = 1; below <= rowsSpanned; ++below)
+            {
+                const auto other = textBuffer.GetRowSearchSignature((row + below) % height);
+                for (size_t i = 0; i < signature.size(); ++i)
+                {
+                    signature[i] |= other[i];
+                }
+            }
+            mayStartMatch[row] = RowSearchIndex::s_MayContain(signature, needleSignature);
+        }
+
+        for (size_t row = 0; row < height; ++row)
+        {
+            bool needed = false;
+            for (size_t above = 0; above <= std::min(row, rowsSpanned) && !needed; ++above)
+            {
+                needed = mayStartMatch[row - above];
+            }
+            rowNeeded[row] = needed;
+        }
+    }
+
+    const auto appendCell = [&](const size_t index) {
+        const auto& charRow = textBuffer.GetRowByOffset(index / width).GetCharRow();
+        const std::wstring_view glyph = charRow.GlyphAt(index % width);
+        for (const auto wch : glyph)
+        {
+            hayText.push_back(_ApplySensitivity(wch));
+        }
+        hayCells.push_back(hayText.size());
+    };
+
+    // Keep only as many cells as could start a match that ends in cells that haven't been read yet.
+    const auto keepTail = [&]() {
+        const auto count = hayCells.size() - 1;
+        const auto dropped = count - std::min(count, needleLength - 1);
+        const auto droppedText = hayCells[dropped];
+        hayText.erase(0, droppedText);
+        hayCells.erase(hayCells.begin(), hayCells.begin() + dropped);
+        for (auto& offset : hayCells)
+        {
+            offset -= droppedText;
+        }
+        hayStart += dropped;
+    };
+
+    const auto scan = [&]() {
+        const auto count = hayCells.size() - 1;
+        size_t pos = 0;
+        while (pos + needleLength <= count)
+        {
+            auto i = needleLength;
+            while (i > 0 && hayCell(pos + i - 1) == needleCell(i - 1))
+            {
+                --i;
+            }
+
+            if (i == 0)
+            {
+                const auto start = (hayStart + pos) % cellCount;
+                matches.emplace_back(start, (start + needleLength - 1) % cellCount);
+            }
+
+            pos += shifts[s_ShiftKey(hayCell(pos + needleLength - 1))];
+        }
+    };
+
+    for (size_t row = 0; row < height; ++row)
+    {
+        if (!rowNeeded[row])
+        {
+            // Nothing read so far can be part of a match, so start over after this row.
+            hayText.clear();
+            hayCells.assign(1, 0);
+            hayStart = (row + 1) * width;
+            continue;
+        }
+
+        keepTail();
+        for (size_t column = 0; column < width; ++column)
+        {
+            appendCell(row * width + column);
+        }
+        scan();
+    }
+
+    // Matches that start at the end of the buffer and wrap around to the start.
+    keepTail();
+    for (size_t index = 0; index < needleLength - 1; ++index)
+    {
+        appendCell(index);
+    }
+    scan();
+
+    // The wrapped matches start at the end of the buffer, so they're already in order.
+    return matches;
 }
 
 // Routine Description:
-// - Provides an abstraction for comparing two spans of text.
-// - Internally handles case sensitivity based on object construction.
+// - Finds every match of the regular expression in the screen buffer.
+// - The expression is matched against one logical line at a time: a row,
+//   joined with the rows below it for as long as they were wrapped. The second
+//   cell of a full width character isn't part of the text, and the spaces at
+//   the end of the line are left off, so that $ matches where the text ends.
+// - If every match has to contain some literal text, lines that don't contain
+//   it are skipped without running the expression, and lines that the buffer's
+//   search index rules out aren't read at all.
+// Return Value:
+// - The first and last cells of every match, in order of where they start.
+std::vector<Search::Match> Search::_FindRegexMatches() const
+{
+    std::vector<Match> matches;
+
+    const auto& textBuffer = _screenInfo.GetTextBuffer();
+    const auto width = gsl::narrow_cast<size_t>(_screenInfo.GetBufferSize().Width());
+    const auto height = _GetCellCount() / width;
+
+    std::wstring literal;
+    for (const auto wch : _regexLiteral)
+    {
+        literal.push_back(_ApplySensitivity(wch));
+    }
+
+    // Row signatures are made from the text of every cell, so a full width
+    // glyph is in them twice (once for each of its cells). The literal's
+    // signature has to be made the same way for the rows holding it to pass.
+    std::wstring literalCells;
+    for (GraphemeClusterIterator it{ literal }; it; ++it)
+    {
+        const auto glyph = *it;
+        if (IsGlyphFullWidth(glyph))
+        {
+            literalCells.append(glyph.begin(), glyph.end());
+        }
+        literalCells.append(glyph.begin(), glyph.end());
+    }
+
+    const auto literalSignature = RowSearchIndex::s_Signature(literalCells);
+    const auto useSearchIndex = width > 1 && !RowSearchIndex::s_IsEmpty(literalSignature);
+
+    // The text of the line, and the first and last cells (counted from the
+    // start of the line) of the glyph each of its characters belongs to.
+    std::wstring text;
+    std::wstring foldedText;
+    std::vector<size_t> firstCells;
+    std::vector<size_t> lastCells;
+
+    for (size_t firstRow = 0; firstRow < height;)
+    {
+        auto lastRow = firstRow;
+        while (lastRow + 1 < height && textBuffer.GetRowByOffset(lastRow).GetCharRow().WasWrapForced())
+        {
+            ++lastRow;
+        }
+
+        const auto lineStart = firstRow * width;
+        const auto lineFirstRow = firstRow;
+        firstRow = lastRow + 1;
+
+        if (useSearchIndex)
+        {
+            RowSearchIndex::Signature signature{};
+            for (auto row = lineFirstRow; row <= lastRow; ++row)
+            {
+                const auto rowSignature = textBuffer.GetRowSearchSignature(row);
+                for (size_t i = 0; i < signature.size(); ++i)
+                {
+                    signature[i] |= rowSignature[i];
+                }
+            }
+
+            if (!RowSearchIndex::s_MayContain(signature, literalSignature))
+            {
+                continue;
+            }
+        }
+
+        text.clear();
+        firstCells.clear();
+        lastCells.clear();
+        for (auto row = lineFirstRow; row <= lastRow; ++row)
+        {
+            const auto& charRow = textBuffer.GetRowByOffset(row).GetCharRow();
+            for (size_t column = 0; column < width; ++column)
+            {
+                const auto dbcsAttr = charRow.DbcsAttrAt(column);
+                if (dbcsAttr.IsTrailing())
+                {
+                    continue;
+                }
+
+                const auto cell = (row - lineFirstRow) * width + column;
+                const std::wstring_view glyph = charRow.GlyphAt(column);
+                text.append(glyph);
+                firstCells.insert(firstCells.end(), glyph.size(), cell);
+                lastCells.insert(lastCells.end(), glyph.size(), dbcsAttr.IsLeading() ? cell + 1 : cell);
+            }
+        }
+
+        const auto textEnd = text.find_last_not_of(L' ');
+        text.resize(textEnd == std::wstring::npos ? 0 : textEnd + 1);
+
+        if (!literal.empty())
+        {
+            std::wstring_view haystack{ text };
+            if (_sensitivity == Sensitivity::CaseInsensitive)
+            {
+                foldedText.clear();
+                std::transform(text.cbegin(), text.cend(), std::back_inserter(foldedText), ::towlower);
+                haystack = foldedText;
+            }
+
+            if (haystack.find(literal) == std::wstring_view::npos)
+            {
+                continue;
+            }
+        }
+
+        const auto begin = text.data();
+        for (std::wcregex_iterator it{ begin, begin + text.size(), _regex.value() }, end; it != end; ++it)
+        {
+            const auto position = gsl::narrow_cast<size_t>(it->position());
+            const auto length = gsl::narrow_cast<size_t>(it->length());
+
+            // An empty match doesn't cover any cells to select.
+            if (length == 0)
+            {
+                continue;
+            }
+
+            matches.emplace_back(lineStart + firstCells.at(position), lineStart + lastCells.at(position + length - 1));
+        }
+    }
+
+    return matches;
+}
+
+// Routine Description:
+// - Creates the regular expression for a search, if it's a regular expression search.
 // Arguments:
-// - one - String view representing the first string of text
-// - two - String view representing the second string of text
+// - wstr - The search term
+// - sensitivity - Whether or not the search cares about case
+// - syntax - Whether the search term is text, or a regular expression
 // Return Value:
-// - True if they are the same. False otherwise.
-bool Search::_CompareChars(const std::wstring_view one, const std::wstring_view two) const
+// - The regular expression, or nothing if the search term is text.
+// Note:
+// - will throw exception if the regular expression isn't valid
+std::optional<std::wregex> Search::s_CreateRegex(const std::wstring& wstr, const Sensitivity sensitivity, const Syntax syntax)
 {
-    if (one.size() != two.size())
+    if (syntax != Syntax::RegularExpression)
     {
-        return false;
+        return std::nullopt;
     }
 
-    for (size_t i = 0; i < one.size(); i++)
+    auto flags = std::regex_constants::ECMAScript | std::regex_constants::optimize;
+    if (sensitivity == Sensitivity::CaseInsensitive)
     {
-        if (_ApplySensitivity(one[i]) != _ApplySensitivity(two[i]))
+        flags |= std::regex_constants::icase;
+    }
+    return std::wregex{ wstr, flags };
+}
+
+// Routine Description:
+// - Finds some literal text that every match of a regular expression has to
+//   contain, so that lines without it can be skipped without running the
+//   expression. It's the longest run of plain characters outside of any group,
+//   as long as there's no alternation anywhere in the expression.
+// Arguments:
+// - pattern - The regular expression
+// Return Value:
+// - The literal text, or an empty string if there isn't any we can be sure of.
+std::wstring Search::s_GetRequiredLiteral(const std::wstring& pattern)
+{
+    std::wstring longest;
+    std::wstring run;
+    size_t depth = 0;
+
+    const auto endRun = [&]() {
+        if (run.size() > longest.size())
         {
-            return false;
+            longest = run;
+        }
+        run.clear();
+    };
+
+    for (size_t i = 0; i < pattern.size(); ++i)
+    {
+        const auto wch = pattern[i];
+        switch (wch)
+        {
+        case L'|':
+            return {};
+        case L'(':
+            endRun();
+            ++depth;
+            break;
+        case L')':
+            endRun();
+            depth = depth > 0 ? depth - 1 : 0;
+            break;
+        case L'[':
+            // Skip over the whole character class.
+            endRun();
+            for (++i; i < pattern.size() && pattern[i] != L']'; ++i)
+            {
+                if (pattern[i] == L'\\')
+                {
+                    ++i;
+                }
+            }
+            break;
+        case L'?':
+        case L'*':
+        case L'{':
+            // The character before this could be left out of a match.
+            if (!run.empty())
+            {
+                run.pop_back();
+            }
+            endRun();
+            if (wch == L'{')
+            {
+                i = std::min(pattern.find(L'}', i), pattern.size());
+            }
+            break;
+        case L'+':
+            // The character before this is in every match, but it might not
+            // be next to whatever comes after it.
+            endRun();
+            break;
+        case L'.':
+        case L'^':
+        case L'$':
+            endRun();
+            break;
+        case L'\\':
+            if (i + 1 < pattern.size() && std::wstring_view{ L"\\^$.|?*+()[]{}/-" }.find(pattern[i + 1]) != std::wstring_view::npos)
+            {
+                // An escaped special character is just that character.
+                ++i;
+                if (depth == 0)
+                {
+                    run.push_back(pattern[i]);
+                }
+            }
+            else
+            {
+                // Anything else is a class (like \d), an assertion (like \b),
+                // a back reference or a character code. None of them are
+                // worth working out, so skip over them.
+                endRun();
+                ++i;
+                if (i < pattern.size())
+                {
+                    switch (pattern[i])
+                    {
+                    case L'x':
+                        i += 2;
+                        break;
+                    case L'u':
+                        i += 4;
+                        break;
+                    case L'c':
+                        i += 1;
+                        break;
+                    default:
+                        while (i + 1 < pattern.size() && std::iswdigit(pattern[i]) && std::iswdigit(pattern[i + 1]))
+                        {
+                            ++i;
+                        }
+                        break;
+                    }
+                }
+            }
+            break;
+        default:
+            if (depth == 0)
+            {
+                run.push_back(wch);
+            }
+            break;
         }
     }
 
-    return true;
+    endRun();
+    return longest;
 }
 
 // Routine Description:
@@ -269,6 +763,31 @@ void Search::_DecrementCoord(COORD& coord) const
     _screenInfo.GetBufferSize().DecrementInBoundsCircular(coord);
 }
 
+// Routine Description:
+// - Gets the number of cells in the associated screen buffer
+size_t Search::_GetCellCount() const noexcept
+{
+    const auto size = _screenInfo.GetBufferSize().Dimensions();
+    return gsl::narrow_cast<size_t>(size.X) * gsl::narrow_cast<size_t>(size.Y);
+}
+
+// Routine Description:
+// - Converts a coordinate in the associated screen buffer to its index, counting
+//   cells from the top left corner of the buffer a row at a time.
+size_t Search::_IndexFromCoord(const COORD coord) const noexcept
+{
+    const auto width = gsl::narrow_cast<size_t>(_screenInfo.GetBufferSize().Width());
+    return gsl::narrow_cast<size_t>(coord.Y) * width + gsl::narrow_cast<size_t>(coord.X);
+}
+
+// Routine Description:
+// - Converts an index in the associated screen buffer back to a coordinate.
+COORD Search::_CoordFromIndex(const size_t index) const noexcept
+{
+    const auto width = gsl::narrow_cast<size_t>(_screenInfo.GetBufferSize().Width());
+    return { gsl::narrow_cast<SHORT>(index % width), gsl::narrow_cast<SHORT>(index / width) };
+}
+
 // Routine Description:
 // - Helper to update the coordinate position to the next point to be searched
 // Return Value:
@@ -298,15 +817,15 @@ void Search::_UpdateNextPosition()
 // - Structured text data for comparison to screen buffer text data.
 std::vector<std::vector<wchar_t>> Search::s_CreateNeedleFromString(const std::wstring& wstr)
 {
-    const auto charData = Utf16Parser::Parse(wstr);
     std::vector<std::vector<wchar_t>> cells;
-    for (const auto chars : charData)
+    for (GraphemeClusterIterator it{ wstr }; it; ++it)
     {
-        if (IsGlyphFullWidth(std::wstring_view{ chars.data(), chars.size() }))
+        const auto glyph = *it;
+        if (IsGlyphFullWidth(glyph))
         {
-            cells.emplace_back(chars);
+            cells.emplace_back(glyph.begin(), glyph.end());
         }
-        cells.emplace_back(chars);
+        cells.emplace_back(glyph.begin(), glyph.end());
     }
     return cells;
 }
@@ -7,6 +7,12 @@ Module Name:
 
 Abstract:
 - This module is used for searching through the screen for a substring
+- The screen is read once, a row at a time, and every match is found in that
+  one pass with a Boyer-Moore-Horspool scan. FindNext then walks through the
+  matches, and FindAll returns all of them at once.
+- The search term can also be a regular expression (ECMAScript syntax), which
+  is matched against each logical line of the screen: rows joined together
+  for as long as they were wrapped.
 
 Author(s):
 - Michael Niksa (MiNiksa) 20-Apr-2018
@@ -17,6 +23,8 @@ Revision History:
 
 #pragma once
 
+#include <regex>
+
 // This used to be in find.h.
 #define SEARCH_STRING_LENGTH (80)
 
@@ -35,34 +43,53 @@ public:
         CaseSensitive
     };
 
+    enum class Syntax
+    {
+        Literal,
+        RegularExpression
+    };
+
     Search(const SCREEN_INFORMATION& ScreenInfo,
            const std::wstring& str,
            const Direction dir,
-           const Sensitivity sensitivity);
+           const Sensitivity sensitivity,
+           const Syntax syntax = Syntax::Literal);
 
     Search(const SCREEN_INFORMATION& ScreenInfo,
            const std::wstring& str,
            const Direction dir,
            const Sensitivity sensitivity,
-           const COORD anchor);
+           const COORD anchor,
+           const Syntax syntax = Syntax::Literal);
 
     bool FindNext();
+    std::vector<std::pair<COORD, COORD>> FindAll();
     void Select() const;
     void Color(const TextAttribute attr) const;
 
     std::pair<COORD, COORD> GetFoundLocation() const noexcept;
 
 private:
+    // The first and last cells of a match, as buffer indices.
+    using Match = std::pair<size_t, size_t>;
+
     wchar_t _ApplySensitivity(const wchar_t wch) const;
-    bool Search::_FindNeedleInHaystackAt(const COORD pos, COORD& start, COORD& end) const;
-    bool _CompareChars(const std::wstring_view one, const std::wstring_view two) const;
+    const std::vector<Match>& _GetMatches();
+    std::vector<Match> _FindLiteralMatches() const;
+    std::vector<Match> _FindRegexMatches() const;
     void _UpdateNextPosition();
 
+    size_t _GetCellCount() const noexcept;
+    size_t _IndexFromCoord(const COORD coord) const noexcept;
+    COORD _CoordFromIndex(const size_t index) const noexcept;
+
     void _IncrementCoord(COORD& coord) const;
     void _DecrementCoord(COORD& coord) const;
 
     static COORD s_GetInitialAnchor(const SCREEN_INFORMATION& screenInfo, const Direction dir);
     static std::vector<std::vector<wchar_t>> s_CreateNeedleFromString(const std::wstring& wstr);
+    static std::optional<std::wregex> s_CreateRegex(const std::wstring& wstr, const Sensitivity sensitivity, const Syntax syntax);
+    static std::wstring s_GetRequiredLiteral(const std::wstring& pattern);
 
     bool _reachedEnd = false;
     COORD _coordNext = { 0 };
@@ -75,6 +102,15 @@ private:
     const Sensitivity _sensitivity;
     const SCREEN_INFORMATION& _screenInfo;
 
+    // Only for regular expression searches: the expression, and some text
+    // that every match of it has to contain (if there is any).
+    const std::optional<std::wregex> _regex;
+    const std::wstring _regexLiteral;
+
+    // Every match, in order of where they start, using buffer indices
+    // (row * width + column). Found the first time they're needed.
+    std::optional<std::vector<Match>> _matches;
+
 #ifdef UNIT_TESTING
     friend class SearchTests;
 #endif
@@ -57,7 +57,8 @@ Settings::Settings() :
     _DefaultForeground(INVALID_COLOR),
     _DefaultBackground(INVALID_COLOR),
     _fUseDx(false),
-    _fCopyColor(false)
+    _fCopyColor(false),
+    _fPersistHistory(false)
 {
     _dwScreenBufferSize.X = 80;
     _dwScreenBufferSize.Y = 25;
@@ -944,3 +945,13 @@ bool Settings::GetCopyColor() const noexcept
 {
     return _fCopyColor;
 }
+
+bool Settings::GetPersistHistory() const noexcept
+{
+    return _fPersistHistory;
+}
+
+void Settings::SetPersistHistory(const bool fPersistHistory) noexcept
+{
+    _fPersistHistory = fPersistHistory;
+}
@@ -185,6 +185,9 @@ public:
     bool GetUseDx() const noexcept;
     bool GetCopyColor() const noexcept;
 
+    bool GetPersistHistory() const noexcept;
+    void SetPersistHistory(const bool fPersistHistory) noexcept;
+
     COLORREF CalculateDefaultForeground() const noexcept;
     COLORREF CalculateDefaultBackground() const noexcept;
     COLORREF LookupForegroundColor(const TextAttribute& attr) const noexcept;
@@ -233,6 +236,7 @@ private:
     bool _fRenderGridWorldwide;
     bool _fUseDx;
     bool _fCopyColor;
+    bool _fPersistHistory;
 
     COLORREF _XtermColorTable[XTERM_COLOR_TABLE_SIZE];
 
@@ -60,8 +60,10 @@ using Microsoft::Console::Interactivity::ServiceLocator;
     NTSTATUS Status;
     for (;;)
     {
-        std::unique_ptr<IInputEvent> inputEvent;
-        Status = pInputBuffer->Read(inputEvent,
+        INPUT_RECORD record;
+        size_t eventsRead;
+        Status = pInputBuffer->Read(gsl::make_span(&record, 1),
+                                    eventsRead,
                                     false, // peek
                                     Wait,
                                     true, // unicode
@@ -71,43 +73,43 @@ using Microsoft::Console::Interactivity::ServiceLocator;
         {
             return Status;
         }
-        else if (inputEvent.get() == nullptr)
+        else if (eventsRead == 0)
         {
             FAIL_FAST_IF(Wait);
             return STATUS_UNSUCCESSFUL;
         }
 
-        if (inputEvent->EventType() == InputEventType::KeyEvent)
+        if (record.EventType == KEY_EVENT)
         {
-            std::unique_ptr<KeyEvent> keyEvent = std::unique_ptr<KeyEvent>(static_cast<KeyEvent*>(inputEvent.release()));
+            const KeyEvent keyEvent{ record.Event.KeyEvent };
 
             bool commandLineEditKey = false;
             if (pCommandLineEditingKeys)
             {
-                commandLineEditKey = keyEvent->IsCommandLineEditingKey();
+                commandLineEditKey = keyEvent.IsCommandLineEditingKey();
             }
             else if (pPopupKeys)
             {
-                commandLineEditKey = keyEvent->IsPopupKey();
+                commandLineEditKey = keyEvent.IsPopupKey();
             }
 
             if (pdwKeyState)
             {
-                *pdwKeyState = keyEvent->GetActiveModifierKeys();
+                *pdwKeyState = keyEvent.GetActiveModifierKeys();
             }
 
-            if (keyEvent->GetCharData() != 0 && !commandLineEditKey)
+            if (keyEvent.GetCharData() != 0 && !commandLineEditKey)
             {
                 // chars that are generated using alt + numpad
-                if (!keyEvent->IsKeyDown() && keyEvent->GetVirtualKeyCode() == VK_MENU)
+                if (!keyEvent.IsKeyDown() && keyEvent.GetVirtualKeyCode() == VK_MENU)
                 {
-                    if (keyEvent->IsAltNumpadSet())
+                    if (keyEvent.IsAltNumpadSet())
                     {
-                        if (HIBYTE(keyEvent->GetCharData()))
+                        if (HIBYTE(keyEvent.GetCharData()))
                         {
                             char chT[2] = {
-                                static_cast<char>(HIBYTE(keyEvent->GetCharData())),
-                                static_cast<char>(LOBYTE(keyEvent->GetCharData())),
+                                static_cast<char>(HIBYTE(keyEvent.GetCharData())),
+                                static_cast<char>(LOBYTE(keyEvent.GetCharData())),
                             };
                             *pwchOut = CharToWchar(chT, 2);
                         }
@@ -116,39 +118,39 @@ using Microsoft::Console::Interactivity::ServiceLocator;
                             // Because USER doesn't know our codepage,
                             // it gives us the raw OEM char and we
                             // convert it to a Unicode character.
-                            char chT = LOBYTE(keyEvent->GetCharData());
+                            char chT = LOBYTE(keyEvent.GetCharData());
                             *pwchOut = CharToWchar(&chT, 1);
                         }
                     }
                     else
                     {
-                        *pwchOut = keyEvent->GetCharData();
+                        *pwchOut = keyEvent.GetCharData();
                     }
                     return STATUS_SUCCESS;
                 }
                 // Ignore Escape and Newline chars
-                else if (keyEvent->IsKeyDown() &&
+                else if (keyEvent.IsKeyDown() &&
                          (WI_IsFlagSet(pInputBuffer->InputMode, ENABLE_VIRTUAL_TERMINAL_INPUT) ||
-                          (keyEvent->GetVirtualKeyCode() != VK_ESCAPE &&
-                           keyEvent->GetCharData() != UNICODE_LINEFEED)))
+                          (keyEvent.GetVirtualKeyCode() != VK_ESCAPE &&
+                           keyEvent.GetCharData() != UNICODE_LINEFEED)))
                 {
-                    *pwchOut = keyEvent->GetCharData();
+                    *pwchOut = keyEvent.GetCharData();
                     return STATUS_SUCCESS;
                 }
             }
 
-            if (keyEvent->IsKeyDown())
+            if (keyEvent.IsKeyDown())
             {
                 if (pCommandLineEditingKeys && commandLineEditKey)
                 {
                     *pCommandLineEditingKeys = true;
-                    *pwchOut = static_cast<wchar_t>(keyEvent->GetVirtualKeyCode());
+                    *pwchOut = static_cast<wchar_t>(keyEvent.GetVirtualKeyCode());
                     return STATUS_SUCCESS;
                 }
                 else if (pPopupKeys && commandLineEditKey)
                 {
                     *pPopupKeys = true;
-                    *pwchOut = static_cast<char>(keyEvent->GetVirtualKeyCode());
+                    *pwchOut = static_cast<char>(keyEvent.GetVirtualKeyCode());
                     return STATUS_SUCCESS;
                 }
                 else
@@ -162,11 +164,11 @@ using Microsoft::Console::Interactivity::ServiceLocator;
                         // Convert real Windows NT modifier bit into bizarre Console bits
                         std::unordered_set<ModifierKeyState> consoleModKeyState = FromVkKeyScan(zeroControlKeyState);
 
-                        if (zeroVKey == keyEvent->GetVirtualKeyCode() &&
-                            keyEvent->DoActiveModifierKeysMatch(consoleModKeyState))
+                        if (zeroVKey == keyEvent.GetVirtualKeyCode() &&
+                            keyEvent.DoActiveModifierKeysMatch(consoleModKeyState))
                         {
                             // This really is the character 0x0000
-                            *pwchOut = keyEvent->GetCharData();
+                            *pwchOut = keyEvent.GetCharData();
                             return STATUS_SUCCESS;
                         }
                     }
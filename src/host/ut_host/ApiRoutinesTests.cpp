@@ -14,6 +14,8 @@
 
 #include "..\interactivity\inc\ServiceLocator.hpp"
 
+#include <chrono>
+
 using namespace Microsoft::Console::Types;
 using namespace WEX::Logging;
 using namespace WEX::TestExecution;
@@ -417,6 +419,47 @@ class ApiRoutinesTests
         }
     }
 
+    TEST_METHOD(ApiWriteConsoleAUtf8Throughput)
+    {
+        Log::Comment(L"Benchmark: write ~256KB of mixed ASCII, CJK and emoji UTF-8 "
+                     L"in 4KB pieces that split sequences, the way a pipe would "
+                     L"hand it to us.");
+
+        CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        SCREEN_INFORMATION& si = gci.GetActiveOutputBuffer();
+
+        gci.LockConsole();
+        auto Unlock = wil::scope_exit([&] { gci.UnlockConsole(); });
+
+        gci.OutputCP = CP_UTF8;
+        SetConsoleCPInfo(TRUE);
+
+        const std::string_view line{ "drwxr-xr-x 1 user group 4096 \xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e \xf0\x9f\x98\x80 paint.cpp\r\n" };
+        std::string text;
+        while (text.size() < 256 * 1024)
+        {
+            text.append(line);
+        }
+
+        const size_t cchChunk = 4096;
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < text.size(); i += cchChunk)
+        {
+            const size_t cchWriteLength = std::min(cchChunk, text.size() - i);
+            size_t cchRead = 0;
+            std::unique_ptr<IWaitRoutine> waiter;
+            VERIFY_SUCCEEDED(_pApiRoutines->WriteConsoleAImpl(si, { text.data() + i, cchWriteLength }, cchRead, waiter));
+            VERIFY_IS_NULL(waiter.get());
+            VERIFY_ARE_EQUAL(cchWriteLength, cchRead);
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        Log::Comment(WEX::Common::String().Format(L"Wrote %zu bytes in %.3fms (%.1f MB/s)",
+                                                  text.size(),
+                                                  elapsed.count() * 1000,
+                                                  text.size() / elapsed.count() / (1024 * 1024)));
+    }
+
     TEST_METHOD(ApiWriteConsoleW)
     {
         BEGIN_TEST_METHOD_PROPERTIES()
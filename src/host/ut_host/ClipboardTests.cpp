@@ -84,10 +84,19 @@ class ClipboardTests
         selection.emplace_back(SMALL_RECT{ 0, 2, 14, 2 });
         selection.emplace_back(SMALL_RECT{ 0, 3, 8, 3 });
 
-        return Clipboard::Instance().RetrieveTextFromBuffer(screenInfo,
-                                                            fLineSelection,
-                                                            selection)
-            .text;
+        const auto rows = Clipboard::Instance().RetrieveTextFromBuffer(screenInfo,
+                                                                       fLineSelection,
+                                                                       selection);
+
+        // The text of the rows comes out one after another, so split it back up.
+        std::vector<std::wstring> text;
+        size_t rowStart = 0;
+        for (const auto rowEnd : rows.rowEnds)
+        {
+            text.emplace_back(rows.text.substr(rowStart, rowEnd - rowStart));
+            rowStart = rowEnd;
+        }
+        return text;
     }
 
 #pragma prefast(push)
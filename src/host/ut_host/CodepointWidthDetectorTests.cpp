@@ -25,7 +25,13 @@ static const std::vector<std::tuple<unsigned int, std::wstring, CodepointWidth>>
     { 0x30CA, L"\x30CA", CodepointWidth::Wide }, // U+30CA katakana na
     { 0x72D7, L"\x72D7", CodepointWidth::Wide }, // U+72D7
     { 0x1F47E, L"\xD83D\xDC7E", CodepointWidth::Wide }, // U+1F47E alien monster
-    { 0x1F51C, L"\xD83D\xDD1C", CodepointWidth::Wide } // U+1F51C SOON
+    { 0x1F51C, L"\xD83D\xDD1C", CodepointWidth::Wide }, // U+1F51C SOON
+    { 0xA1, L"\xA1", CodepointWidth::Ambiguous }, // U+00A1 inverted exclamation mark, first in the table
+    { 0xA2, L"\xA2", CodepointWidth::Narrow }, // U+00A2 cent sign, between two ranges
+    { 0x2FFFD, L"\xD87F\xDFFD", CodepointWidth::Wide }, // last codepoint of a range
+    { 0x2FFFE, L"\xD87F\xDFFE", CodepointWidth::Narrow }, // first codepoint after a range
+    { 0x10FFFD, L"\xDBFF\xDFFD", CodepointWidth::Ambiguous }, // last in the table
+    { 0x10FFFF, L"\xDBFF\xDFFF", CodepointWidth::Narrow } // last codepoint of Unicode
 };
 
 class CodepointWidthDetectorTests
@@ -62,6 +68,20 @@ class CodepointWidthDetectorTests
         }
     }
 
+    TEST_METHOD(WidthTableMatchesRangeTable)
+    {
+        Log::Comment(L"Every codepoint in the two-stage table has the width the range table gives it.");
+        for (unsigned int codepoint = 0; codepoint <= 0x10FFFF; codepoint++)
+        {
+            const auto expected = CodepointWidthDetector::_searchWidth(codepoint);
+            const auto actual = CodepointWidthDetector::_lookupWidth(codepoint);
+            if (expected != actual)
+            {
+                VERIFY_ARE_EQUAL(expected, actual, WEX::Common::NoThrowString().Format(L"U+%X", codepoint));
+            }
+        }
+    }
+
     static bool FallbackMethod(const std::wstring_view glyph)
     {
         if (glyph.size() < 1)
@@ -81,21 +101,98 @@ class CodepointWidthDetectorTests
         widthDetector.SetFallbackMethod(std::bind(&FallbackMethod, std::placeholders::_1));
 
         // Ensure fallback cache is empty.
-        VERIFY_ARE_EQUAL(0u, widthDetector._fallbackCache.size());
+        VERIFY_ARE_EQUAL(0u, widthDetector._fallbackCacheSize);
 
         // Lookup ambiguous width character.
         widthDetector.IsWide(ambiguous);
 
         // Cache should hold it.
-        VERIFY_ARE_EQUAL(1u, widthDetector._fallbackCache.size());
+        VERIFY_ARE_EQUAL(1u, widthDetector._fallbackCacheSize);
 
         // Cached item should match what we expect
-        const auto it = widthDetector._fallbackCache.begin();
-        VERIFY_ARE_EQUAL(ambiguous, it->first);
-        VERIFY_ARE_EQUAL(FallbackMethod(ambiguous), it->second);
+        const auto codepoint = widthDetector._extractCodepoint(ambiguous);
+        bool isWide = false;
+        VERIFY_IS_TRUE(widthDetector._tryGetCachedFallback(codepoint, isWide));
+        VERIFY_ARE_EQUAL(FallbackMethod(ambiguous), isWide);
 
         // Cache should empty when font changes.
         widthDetector.NotifyFontChanged();
-        VERIFY_ARE_EQUAL(0u, widthDetector._fallbackCache.size());
+        VERIFY_ARE_EQUAL(0u, widthDetector._fallbackCacheSize);
+        VERIFY_IS_FALSE(widthDetector._tryGetCachedFallback(codepoint, isWide));
+    }
+
+    TEST_METHOD(AmbiguousCacheGrows)
+    {
+        CodepointWidthDetector widthDetector;
+
+        // Cache enough codepoints that the cache has to grow a few times.
+        const unsigned int first = 0x400;
+        const unsigned int count = 1000;
+        for (unsigned int codepoint = first; codepoint < first + count; codepoint++)
+        {
+            widthDetector._cacheFallback(codepoint, codepoint % 3 == 0);
+        }
+        VERIFY_ARE_EQUAL(count, widthDetector._fallbackCacheSize);
+
+        // Caching the same codepoint again replaces the answer.
+        widthDetector._cacheFallback(first, false);
+        VERIFY_ARE_EQUAL(count, widthDetector._fallbackCacheSize);
+
+        for (unsigned int codepoint = first; codepoint < first + count; codepoint++)
+        {
+            bool isWide = false;
+            VERIFY_IS_TRUE(widthDetector._tryGetCachedFallback(codepoint, isWide));
+            VERIFY_ARE_EQUAL(codepoint != first && codepoint % 3 == 0, isWide);
+        }
+
+        bool isWide = false;
+        VERIFY_IS_FALSE(widthDetector._tryGetCachedFallback(first + count, isWide));
+    }
+
+    TEST_METHOD(CanGetWidthsOfRun)
+    {
+        CodepointWidthDetector widthDetector;
+        widthDetector.SetFallbackMethod(std::bind(&FallbackMethod, std::placeholders::_1));
+
+        // ASCII, hiragana na, alien monster, cyrillic capital de (ambiguous,
+        // and even, so the fallback method says it's narrow), and a lone
+        // trailing surrogate.
+        const std::wstring_view run = L"a\x306A\xD83D\xDC7E\x414\xDC7E";
+        std::vector<CodepointWidth> widths(run.size(), CodepointWidth::Ambiguous);
+        widthDetector.GetWidths(run, { widths.data(), gsl::narrow<ptrdiff_t>(widths.size()) });
+
+        const std::vector<CodepointWidth> expected{
+            CodepointWidth::Narrow,
+            CodepointWidth::Wide,
+            CodepointWidth::Wide,
+            CodepointWidth::Invalid,
+            CodepointWidth::Narrow,
+            CodepointWidth::Narrow
+        };
+        VERIFY_ARE_EQUAL(expected.size(), widths.size());
+        for (size_t i = 0; i < expected.size(); i++)
+        {
+            VERIFY_ARE_EQUAL(expected.at(i), widths.at(i));
+        }
+
+        // Each of them should agree with IsWide.
+        VERIFY_IS_TRUE(widthDetector.IsWide(L'\x306A'));
+        VERIFY_IS_FALSE(widthDetector.IsWide(L'\x414'));
+    }
+
+    TEST_METHOD(CanLookUpClusters)
+    {
+        CodepointWidthDetector widthDetector;
+
+        // A cluster is as wide as its base character...
+        VERIFY_IS_FALSE(widthDetector.IsWide(L"e\x0301")); // e + combining acute accent
+        VERIFY_IS_TRUE(widthDetector.IsWide(L"\x306F\x3099")); // hiragana ha + combining dakuten
+        VERIFY_IS_TRUE(widthDetector.IsWide(L"\xD83D\xDC4D\xD83C\xDFFD")); // thumbs up + skin tone modifier
+        VERIFY_IS_TRUE(widthDetector.IsWide(L"\xD83D\xDC68\x200D\xD83D\xDC69\x200D\xD83D\xDC67")); // family: man, woman, girl
+
+        // ...unless it asks for emoji presentation, or is a flag.
+        VERIFY_IS_FALSE(widthDetector.IsWide(L"\x2764")); // heavy black heart
+        VERIFY_IS_TRUE(widthDetector.IsWide(L"\x2764\xFE0F")); // heavy black heart + variation selector-16
+        VERIFY_IS_TRUE(widthDetector.IsWide(L"\xD83C\xDDFA\xD83C\xDDF8")); // regional indicators U + S
     }
 };
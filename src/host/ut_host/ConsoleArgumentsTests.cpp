@@ -32,6 +32,8 @@ public:
     TEST_METHOD(HeadlessArgTests);
     TEST_METHOD(SignalHandleTests);
     TEST_METHOD(FeatureArgTests);
+    TEST_METHOD(VtScrollMarginsArgTests);
+    TEST_METHOD(VtFrameBudgetArgTests);
 };
 
 ConsoleArguments CreateAndParse(std::wstring& commandline, HANDLE hVtIn, HANDLE hVtOut)
@@ -1140,3 +1142,173 @@ void ConsoleArgumentsTests::FeatureArgTests()
                                     false), // inheritCursor
                    false); // successful parse?
 }
+
+void ConsoleArgumentsTests::VtScrollMarginsArgTests()
+{
+    // Just some assorted positive values that could be valid handles. No specific correlation to anything.
+    HANDLE hInSample = UlongToHandle(0x10);
+    HANDLE hOutSample = UlongToHandle(0x24);
+
+    std::wstring commandline;
+
+    commandline = L"conhost.exe --headless --vtscrollmargins";
+    ArgTestsRunner(L"#1 The terminal supports scrolling margins",
+                   commandline,
+                   hInSample,
+                   hOutSample,
+                   ConsoleArguments(commandline,
+                                    L"",
+                                    hInSample,
+                                    hOutSample,
+                                    L"", // vtMode
+                                    0, // width
+                                    0, // height
+                                    false, // forceV1
+                                    true, // headless
+                                    true, // createServerHandle
+                                    0, // serverHandle
+                                    0, // signalHandle
+                                    false, // inheritCursor
+                                    true), // vtScrollMargins
+                   true); // successful parse?
+
+    commandline = L"conhost.exe --headless";
+    ArgTestsRunner(L"#2 Without the switch, scrolling margins aren't used",
+                   commandline,
+                   hInSample,
+                   hOutSample,
+                   ConsoleArguments(commandline,
+                                    L"",
+                                    hInSample,
+                                    hOutSample,
+                                    L"", // vtMode
+                                    0, // width
+                                    0, // height
+                                    false, // forceV1
+                                    true, // headless
+                                    true, // createServerHandle
+                                    0, // serverHandle
+                                    0, // signalHandle
+                                    false, // inheritCursor
+                                    false), // vtScrollMargins
+                   true); // successful parse?
+}
+
+void ConsoleArgumentsTests::VtFrameBudgetArgTests()
+{
+    // Just some assorted positive values that could be valid handles. No specific correlation to anything.
+    HANDLE hInSample = UlongToHandle(0x10);
+    HANDLE hOutSample = UlongToHandle(0x24);
+
+    std::wstring commandline;
+
+    commandline = L"conhost.exe --headless --vtframebudget 100000";
+    ArgTestsRunner(L"#1 A budget bigger than a short",
+                   commandline,
+                   hInSample,
+                   hOutSample,
+                   ConsoleArguments(commandline,
+                                    L"",
+                                    hInSample,
+                                    hOutSample,
+                                    L"", // vtMode
+                                    0, // width
+                                    0, // height
+                                    false, // forceV1
+                                    true, // headless
+                                    true, // createServerHandle
+                                    0, // serverHandle
+                                    0, // signalHandle
+                                    false, // inheritCursor
+                                    false, // vtScrollMargins
+                                    100000), // vtFrameBudget
+                   true); // successful parse?
+
+    commandline = L"conhost.exe --headless --vtframebudget 0";
+    ArgTestsRunner(L"#2 A budget of no bytes at all is invalid",
+                   commandline,
+                   hInSample,
+                   hOutSample,
+                   ConsoleArguments(commandline,
+                                    L"",
+                                    hInSample,
+                                    hOutSample,
+                                    L"", // vtMode
+                                    0, // width
+                                    0, // height
+                                    false, // forceV1
+                                    true, // headless
+                                    true, // createServerHandle
+                                    0, // serverHandle
+                                    0, // signalHandle
+                                    false, // inheritCursor
+                                    false, // vtScrollMargins
+                                    0), // vtFrameBudget
+                   false); // successful parse?
+
+    commandline = L"conhost.exe --headless --vtframebudget -1";
+    ArgTestsRunner(L"#3 Negative budgets are invalid",
+                   commandline,
+                   hInSample,
+                   hOutSample,
+                   ConsoleArguments(commandline,
+                                    L"",
+                                    hInSample,
+                                    hOutSample,
+                                    L"", // vtMode
+                                    0, // width
+                                    0, // height
+                                    false, // forceV1
+                                    true, // headless
+                                    true, // createServerHandle
+                                    0, // serverHandle
+                                    0, // signalHandle
+                                    false, // inheritCursor
+                                    false, // vtScrollMargins
+                                    0), // vtFrameBudget
+                   false); // successful parse?
+
+    commandline = L"conhost.exe --headless --vtframebudget 4294967296";
+    ArgTestsRunner(L"#4 Budgets past 32 bits are invalid",
+                   commandline,
+                   hInSample,
+                   hOutSample,
+                   ConsoleArguments(commandline,
+                                    L"",
+                                    hInSample,
+                                    hOutSample,
+                                    L"", // vtMode
+                                    0, // width
+                                    0, // height
+                                    false, // forceV1
+                                    true, // headless
+                                    true, // createServerHandle
+                                    0, // serverHandle
+                                    0, // signalHandle
+                                    false, // inheritCursor
+                                    false, // vtScrollMargins
+                                    0), // vtFrameBudget
+                   false); // successful parse?
+
+    commandline = L"conhost.exe --headless --vtframebudget 8foo";
+    ArgTestsRunner(L"#5 Budgets have to be numbers",
+                   commandline,
+                   hInSample,
+                   hOutSample,
+                   ConsoleArguments(commandline,
+                                    L"",
+                                    hInSample,
+                                    hOutSample,
+                                    L"", // vtMode
+                                    0, // width
+                                    0, // height
+                                    false, // forceV1
+                                    true, // headless
+                                    true, // createServerHandle
+                                    0, // serverHandle
+                                    0, // signalHandle
+                                    false, // inheritCursor
+                                    false, // vtScrollMargins
+                                    0), // vtFrameBudget
+                   false); // successful parse?
+}
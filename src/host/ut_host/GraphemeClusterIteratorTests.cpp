@@ -0,0 +1,111 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "../../types/inc/GraphemeClusterIterator.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+class GraphemeClusterIteratorTests
+{
+    TEST_CLASS(GraphemeClusterIteratorTests);
+
+    // Splits the text into clusters and checks that they're the expected ones,
+    // and that they're all views into the original text.
+    void VerifyClusters(const std::wstring_view text, const std::vector<std::wstring_view>& expected)
+    {
+        size_t count = 0;
+        auto expectedStart = text.data();
+        for (GraphemeClusterIterator it{ text }; it; ++it)
+        {
+            VERIFY_IS_LESS_THAN(count, expected.size());
+            const auto cluster = *it;
+            VERIFY_ARE_EQUAL(expected.at(count), cluster);
+            VERIFY_ARE_EQUAL(expectedStart, cluster.data());
+            expectedStart += cluster.size();
+            count++;
+        }
+        VERIFY_ARE_EQUAL(expected.size(), count);
+    }
+
+    TEST_METHOD(EmptyText)
+    {
+        GraphemeClusterIterator it{ L"" };
+        VERIFY_IS_FALSE(static_cast<bool>(it));
+        VERIFY_ARE_EQUAL(0u, GraphemeClusterIterator::NextCluster(L"").size());
+    }
+
+    TEST_METHOD(SplitsAscii)
+    {
+        VerifyClusters(L"abc", { L"a", L"b", L"c" });
+    }
+
+    TEST_METHOD(KeepsCrLfTogether)
+    {
+        VerifyClusters(L"a\r\n\n\r", { L"a", L"\r\n", L"\n", L"\r" });
+    }
+
+    TEST_METHOD(KeepsCombiningMarks)
+    {
+        // e + combining acute accent + combining diaeresis, then x
+        VerifyClusters(L"e\x0301\x0308x", { L"e\x0301\x0308", L"x" });
+
+        // A combining mark after a control character stands on its own.
+        VerifyClusters(L"\t\x0301", { L"\t", L"\x0301" });
+    }
+
+    TEST_METHOD(KeepsSurrogatePairs)
+    {
+        // alien monster, then smiling face with sunglasses
+        VerifyClusters(L"\xD83D\xDC7E\xD83D\xDE0E", { L"\xD83D\xDC7E", L"\xD83D\xDE0E" });
+    }
+
+    TEST_METHOD(SeparatesUnpairedSurrogates)
+    {
+        VerifyClusters(L"a\xD83D" L"b\xDE0E\xD83D", { L"a", L"\xD83D", L"b", L"\xDE0E", L"\xD83D" });
+    }
+
+    TEST_METHOD(KeepsEmojiSequences)
+    {
+        // thumbs up + skin tone modifier
+        VerifyClusters(L"\xD83D\xDC4D\xD83C\xDFFD!", { L"\xD83D\xDC4D\xD83C\xDFFD", L"!" });
+
+        // family: man ZWJ woman ZWJ girl
+        const std::wstring_view family = L"\xD83D\xDC68\x200D\xD83D\xDC69\x200D\xD83D\xDC67";
+        VerifyClusters(family, { family });
+
+        // A ZWJ only joins pictographs, a letter after it starts a new cluster.
+        VerifyClusters(L"a\x200D" L"b", { L"a\x200D", L"b" });
+    }
+
+    TEST_METHOD(PairsRegionalIndicators)
+    {
+        // U, S, G: a flag and a lonely regional indicator
+        VerifyClusters(L"\xD83C\xDDFA\xD83C\xDDF8\xD83C\xDDEC", { L"\xD83C\xDDFA\xD83C\xDDF8", L"\xD83C\xDDEC" });
+    }
+
+    TEST_METHOD(KeepsHangulSyllables)
+    {
+        // Jamo L + V + T, a precomposed LV syllable + T, and a precomposed LVT syllable.
+        VerifyClusters(L"\x1100\x1161\x11A8\xAC00\x11A8\xAC01", { L"\x1100\x1161\x11A8", L"\xAC00\x11A8", L"\xAC01" });
+    }
+
+    TEST_METHOD(KeepsPrependedCharacters)
+    {
+        // arabic number sign joins with the digit that follows it
+        VerifyClusters(L"\x0600" L"1", { L"\x0600" L"1" });
+    }
+
+    TEST_METHOD(RemainingText)
+    {
+        GraphemeClusterIterator it{ L"e\x0301xy" };
+        ++it;
+        VERIFY_ARE_EQUAL(std::wstring_view{ L"xy" }, it.Remaining());
+        VERIFY_ARE_EQUAL(std::wstring_view{ L"x" }, *it);
+    }
+};
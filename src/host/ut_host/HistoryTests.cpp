@@ -242,6 +242,139 @@ class HistoryTests
         VERIFY_ARE_EQUAL(2ul, history->GetNumberOfCommands());
     }
 
+    TEST_METHOD(FindMatchingCommandNearestFirst)
+    {
+        auto history = CommandHistory::s_Allocate(_manyApps[0], _MakeHandle(0));
+        VERIFY_IS_NOT_NULL(history);
+
+        VERIFY_SUCCEEDED(history->Add(L"dir", false));
+        VERIFY_SUCCEEDED(history->Add(L"cd src", false));
+        VERIFY_SUCCEEDED(history->Add(L"DIR /w", false));
+        VERIFY_SUCCEEDED(history->Add(L"git status", false));
+
+        SHORT index;
+        Log::Comment(L"Going back from the last command finds the nearest one that starts with the text, ignoring case.");
+        VERIFY_IS_TRUE(history->FindMatchingCommand(L"di", 3, index, CommandHistory::MatchOptions::JustLooking));
+        VERIFY_ARE_EQUAL(2i16, index);
+
+        Log::Comment(L"Going back from before it wraps around.");
+        VERIFY_IS_TRUE(history->FindMatchingCommand(L"git", 1, index, CommandHistory::MatchOptions::JustLooking));
+        VERIFY_ARE_EQUAL(3i16, index);
+
+        VERIFY_IS_TRUE(history->FindMatchingCommand(L"dir", 3, index, CommandHistory::MatchOptions::JustLooking | CommandHistory::MatchOptions::ExactMatch));
+        VERIFY_ARE_EQUAL(0i16, index);
+
+        VERIFY_IS_FALSE(history->FindMatchingCommand(L"ls", 3, index, CommandHistory::MatchOptions::JustLooking));
+        VERIFY_IS_FALSE(history->FindMatchingCommand(L"dir /w /p", 3, index, CommandHistory::MatchOptions::JustLooking));
+    }
+
+    TEST_METHOD(FindMatchingCommandAfterHistoryChanges)
+    {
+        auto history = CommandHistory::s_Allocate(_manyApps[0], _MakeHandle(0));
+        VERIFY_IS_NOT_NULL(history);
+        for (size_t j = 0; j < _manyHistoryItems.size(); j++)
+        {
+            VERIFY_SUCCEEDED(history->Add(_manyHistoryItems[j], false));
+        }
+
+        SHORT index;
+        Log::Comment(L"The oldest commands fell off the front when it filled up.");
+        VERIFY_IS_FALSE(history->FindMatchingCommand(L"dir /w", 0, index, CommandHistory::MatchOptions::JustLooking));
+        VERIFY_IS_TRUE(history->FindMatchingCommand(L"ipconfig /all", 0, index, CommandHistory::MatchOptions::JustLooking));
+        VERIFY_ARE_EQUAL(String(L"ipconfig /all"), String(history->GetNth(index).data()));
+
+        Log::Comment(L"Swapped commands are found where they moved to.");
+        const auto last = gsl::narrow<SHORT>(history->GetNumberOfCommands() - 1);
+        const std::wstring first{ history->GetNth(0) };
+        history->Swap(0, last);
+        VERIFY_IS_TRUE(history->FindMatchingCommand(first, last, index, CommandHistory::MatchOptions::JustLooking | CommandHistory::MatchOptions::ExactMatch));
+        VERIFY_ARE_EQUAL(last, index);
+
+        Log::Comment(L"Removed commands aren't found, and the ones after them have moved down.");
+        history->Remove(last);
+        VERIFY_IS_FALSE(history->FindMatchingCommand(first, 0, index, CommandHistory::MatchOptions::JustLooking | CommandHistory::MatchOptions::ExactMatch));
+        VERIFY_IS_TRUE(history->FindMatchingCommand(L"ipconfig /all", 0, index, CommandHistory::MatchOptions::JustLooking));
+        VERIFY_ARE_EQUAL(String(L"ipconfig /all"), String(history->GetNth(index).data()));
+    }
+
+    TEST_METHOD(PersistedHistoryIsReadBackIn)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        wchar_t tempPath[MAX_PATH];
+        VERIFY_ARE_NOT_EQUAL(0u, GetTempPathW(ARRAYSIZE(tempPath), tempPath));
+        const auto directory = std::filesystem::path{ tempPath } / L"HistoryTests";
+        std::filesystem::remove_all(directory);
+
+        gci.SetPersistHistory(true);
+        CommandHistory::s_SetPersistenceDirectory(directory.wstring());
+        auto cleanup = wil::scope_exit([&] {
+            gci.SetPersistHistory(false);
+            CommandHistory::s_SetPersistenceDirectory({});
+            std::error_code ec;
+            std::filesystem::remove_all(directory, ec);
+        });
+
+        auto history = CommandHistory::s_Allocate(_manyApps[0], _MakeHandle(0));
+        VERIFY_IS_NOT_NULL(history);
+        VERIFY_SUCCEEDED(history->Add(L"dir", false));
+        VERIFY_SUCCEEDED(history->Add(L"cd src", false));
+        VERIFY_SUCCEEDED(history->Add(L"git status", false));
+        history->Remove(1);
+
+        Log::Comment(L"Start again, as if the app was started in a new console.");
+        CommandHistory::s_ClearHistoryListStorage();
+        history = CommandHistory::s_Allocate(_manyApps[0], _MakeHandle(0));
+        VERIFY_IS_NOT_NULL(history);
+
+        VERIFY_ARE_EQUAL(2ul, history->GetNumberOfCommands());
+        VERIFY_ARE_EQUAL(String(L"dir"), String(history->GetNth(0).data()));
+        VERIFY_ARE_EQUAL(String(L"git status"), String(history->GetNth(1).data()));
+
+        SHORT index;
+        VERIFY_IS_TRUE(history->FindMatchingCommand(L"git", 1, index, CommandHistory::MatchOptions::JustLooking));
+        VERIFY_ARE_EQUAL(1i16, index);
+    }
+
+    TEST_METHOD(PersistedHistoryKeepsOtherConsolesCommands)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        wchar_t tempPath[MAX_PATH];
+        VERIFY_ARE_NOT_EQUAL(0u, GetTempPathW(ARRAYSIZE(tempPath), tempPath));
+        const auto directory = std::filesystem::path{ tempPath } / L"HistoryTests";
+        std::filesystem::remove_all(directory);
+
+        gci.SetPersistHistory(true);
+        CommandHistory::s_SetPersistenceDirectory(directory.wstring());
+        auto cleanup = wil::scope_exit([&] {
+            gci.SetPersistHistory(false);
+            CommandHistory::s_SetPersistenceDirectory({});
+            std::error_code ec;
+            std::filesystem::remove_all(directory, ec);
+        });
+
+        Log::Comment(L"Run the same app in two consoles at once.");
+        auto first = CommandHistory::s_Allocate(_manyApps[0], _MakeHandle(0));
+        auto second = CommandHistory::s_Allocate(_manyApps[0], _MakeHandle(1));
+        VERIFY_IS_NOT_NULL(first);
+        VERIFY_IS_NOT_NULL(second);
+        VERIFY_ARE_NOT_EQUAL(first, second);
+
+        VERIFY_SUCCEEDED(first->Add(L"dir", false));
+        VERIFY_SUCCEEDED(second->Add(L"cd src", false));
+        VERIFY_SUCCEEDED(first->Add(L"git status", false));
+
+        Log::Comment(L"Removing a command in one console doesn't lose what the other added.");
+        VERIFY_ARE_EQUAL(String(L"dir"), String(first->Remove(0).c_str()));
+
+        CommandHistory::s_ClearHistoryListStorage();
+        const auto history = CommandHistory::s_Allocate(_manyApps[0], _MakeHandle(0));
+        VERIFY_IS_NOT_NULL(history);
+
+        VERIFY_ARE_EQUAL(2ul, history->GetNumberOfCommands());
+        VERIFY_ARE_EQUAL(String(L"cd src"), String(history->GetNth(0).data()));
+        VERIFY_ARE_EQUAL(String(L"git status"), String(history->GetNth(1).data()));
+    }
+
 private:
     const std::array<std::wstring, 5> _manyApps = {
         L"foo.exe",
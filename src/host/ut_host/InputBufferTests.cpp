@@ -9,6 +9,8 @@
 #include "..\interactivity\inc\ServiceLocator.hpp"
 #include "..\types\inc\IInputEvent.hpp"
 
+#include <chrono>
+
 using namespace WEX::Logging;
 using Microsoft::Console::Interactivity::ServiceLocator;
 
@@ -78,7 +80,7 @@ class InputBufferTests
             INPUT_RECORD record;
             record.EventType = MENU_EVENT;
             VERIFY_IS_GREATER_THAN(inputBuffer.Write(IInputEvent::Create(record)), 0u);
-            VERIFY_ARE_EQUAL(record, inputBuffer._storage.back()->ToInputRecord());
+            VERIFY_ARE_EQUAL(record, inputBuffer._storage.Back());
         }
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), RECORD_INSERT_COUNT);
     }
@@ -98,7 +100,7 @@ class InputBufferTests
         // verify that the events are the same in storage
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
-            VERIFY_ARE_EQUAL(inputBuffer._storage[i]->ToInputRecord(), record);
+            VERIFY_ARE_EQUAL(inputBuffer._storage[i], record);
         }
     }
 
@@ -121,10 +123,9 @@ class InputBufferTests
         // check that they coalesced
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 1u);
         // check that the mouse position is being updated correctly
-        const IInputEvent* const pOutEvent = inputBuffer._storage.front().get();
-        const MouseEvent* const pMouseEvent = static_cast<const MouseEvent* const>(pOutEvent);
-        VERIFY_ARE_EQUAL(pMouseEvent->GetPosition().X, static_cast<SHORT>(RECORD_INSERT_COUNT));
-        VERIFY_ARE_EQUAL(pMouseEvent->GetPosition().Y, static_cast<SHORT>(RECORD_INSERT_COUNT * 2));
+        const MOUSE_EVENT_RECORD& outMouseEvent = inputBuffer._storage.Front().Event.MouseEvent;
+        VERIFY_ARE_EQUAL(outMouseEvent.dwMousePosition.X, static_cast<SHORT>(RECORD_INSERT_COUNT));
+        VERIFY_ARE_EQUAL(outMouseEvent.dwMousePosition.Y, static_cast<SHORT>(RECORD_INSERT_COUNT * 2));
 
         // add a key event and another mouse event to make sure that
         // an event between two mouse events stopped the coalescing.
@@ -162,10 +163,10 @@ class InputBufferTests
         // no events should have been coalesced
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), RECORD_INSERT_COUNT + 1);
         // check that the events stored match those inserted
-        VERIFY_ARE_EQUAL(inputBuffer._storage.front()->ToInputRecord(), mouseRecords[0]);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.Front(), mouseRecords[0]);
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
-            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1]->ToInputRecord(), mouseRecords[i]);
+            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1], mouseRecords[i]);
         }
     }
 
@@ -221,10 +222,10 @@ class InputBufferTests
         // no events should have been coalesced
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), RECORD_INSERT_COUNT + 1);
         // check that the events stored match those inserted
-        VERIFY_ARE_EQUAL(inputBuffer._storage.front()->ToInputRecord(), keyRecords[0]);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.Front(), keyRecords[0]);
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
-            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1]->ToInputRecord(), keyRecords[i]);
+            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1], keyRecords[i]);
         }
     }
 
@@ -239,7 +240,7 @@ class InputBufferTests
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
             VERIFY_IS_GREATER_THAN(inputBuffer.Write(IInputEvent::Create(record)), 0u);
-            VERIFY_ARE_EQUAL(inputBuffer._storage.back()->ToInputRecord(), record);
+            VERIFY_ARE_EQUAL(inputBuffer._storage.Back(), record);
         }
 
         // The events shouldn't be coalesced
@@ -382,11 +383,10 @@ class InputBufferTests
         VERIFY_IS_GREATER_THAN(inputBuffer.Write(inEvents), 0u);
 
         // read one record, make sure ResetWaitEvent isn't set
-        std::deque<std::unique_ptr<IInputEvent>> outEvents;
+        std::vector<INPUT_RECORD> outRecords(1);
         size_t eventsRead = 0;
         bool resetWaitEvent = false;
-        inputBuffer._ReadBuffer(outEvents,
-                                1,
+        inputBuffer._ReadBuffer(outRecords,
                                 eventsRead,
                                 false,
                                 resetWaitEvent,
@@ -396,9 +396,8 @@ class InputBufferTests
         VERIFY_IS_FALSE(!!resetWaitEvent);
 
         // read the rest, resetWaitEvent should be set to true
-        outEvents.clear();
-        inputBuffer._ReadBuffer(outEvents,
-                                RECORD_INSERT_COUNT - 1,
+        outRecords.resize(RECORD_INSERT_COUNT - 1);
+        inputBuffer._ReadBuffer(outRecords,
                                 eventsRead,
                                 false,
                                 resetWaitEvent,
@@ -431,11 +430,10 @@ class InputBufferTests
         VERIFY_IS_GREATER_THAN(inputBuffer.Write(inEvents), 0u);
 
         // read them out non-unicode style and compare
-        std::deque<std::unique_ptr<IInputEvent>> outEvents;
+        std::vector<INPUT_RECORD> outRecords(recordInsertCount);
         size_t eventsRead = 0;
         bool resetWaitEvent = false;
-        inputBuffer._ReadBuffer(outEvents,
-                                recordInsertCount,
+        inputBuffer._ReadBuffer(outRecords,
                                 eventsRead,
                                 false,
                                 resetWaitEvent,
@@ -444,10 +442,9 @@ class InputBufferTests
         // the dbcs record should have counted for two elements in
         // the array, making it so that we get less events read
         VERIFY_ARE_EQUAL(eventsRead, recordInsertCount - 1);
-        VERIFY_ARE_EQUAL(eventsRead, outEvents.size());
         for (size_t i = 0; i < eventsRead; ++i)
         {
-            VERIFY_ARE_EQUAL(outEvents[i]->ToInputRecord(), inRecords[i]);
+            VERIFY_ARE_EQUAL(outRecords[i], inRecords[i]);
         }
     }
 
@@ -508,6 +505,86 @@ class InputBufferTests
         }
     }
 
+    TEST_METHOD(PrependAndAppendWrapAroundStorage)
+    {
+        Log::Comment(L"Records should come out in order after the front of the storage has moved "
+                     L"and both ends of it have wrapped around.");
+
+        InputBuffer inputBuffer;
+        std::vector<INPUT_RECORD> expected;
+        auto makeRecords = [&](const size_t count, const WCHAR first) {
+            std::vector<INPUT_RECORD> records;
+            for (size_t i = 0; i < count; ++i)
+            {
+                const WCHAR wch = static_cast<WCHAR>(first + i);
+                records.push_back(MakeKeyEvent(TRUE, 1, wch, 0, wch, 0));
+            }
+            return records;
+        };
+
+        // fill most of the storage, then read most of it back out so the front
+        // of the queue is near the end of the storage.
+        const auto first = makeRecords(48, L'A');
+        VERIFY_ARE_EQUAL(inputBuffer.Write(first), first.size());
+        std::vector<INPUT_RECORD> outRecords(40);
+        size_t eventsRead = 0;
+        VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outRecords, eventsRead, false, false, true, false));
+        VERIFY_ARE_EQUAL(eventsRead, outRecords.size());
+        expected.insert(expected.end(), first.begin() + 40, first.end());
+
+        // the back of the queue wraps around to the start of the storage...
+        const auto second = makeRecords(40, L'a');
+        VERIFY_ARE_EQUAL(inputBuffer.Write(second), second.size());
+        expected.insert(expected.end(), second.begin(), second.end());
+
+        // ...and prepending moves the front of it back past the end again.
+        const auto prepended = makeRecords(20, L'0');
+        VERIFY_ARE_EQUAL(inputBuffer.Prepend(prepended), prepended.size());
+        expected.insert(expected.begin(), prepended.begin(), prepended.end());
+
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), expected.size());
+        outRecords.resize(expected.size());
+        VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outRecords, eventsRead, false, false, true, false));
+        VERIFY_ARE_EQUAL(eventsRead, expected.size());
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            VERIFY_ARE_EQUAL(expected[i], outRecords[i]);
+        }
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 0u);
+    }
+
+    TEST_METHOD(PasteSizedWriteReadThroughput)
+    {
+        Log::Comment(L"Benchmark: write the key events for a 64K character paste in one go, "
+                     L"then read them back out the way ReadConsoleInput would.");
+
+        InputBuffer inputBuffer;
+        std::vector<INPUT_RECORD> records;
+        for (size_t i = 0; i < 64 * 1024; ++i)
+        {
+            const WCHAR wch = static_cast<WCHAR>(L'a' + i % 26);
+            records.push_back(MakeKeyEvent(TRUE, 1, wch, 0, wch, 0));
+            records.push_back(MakeKeyEvent(FALSE, 1, wch, 0, wch, 0));
+        }
+
+        std::vector<INPUT_RECORD> outRecords(4096);
+        size_t totalRead = 0;
+        const auto start = std::chrono::steady_clock::now();
+        VERIFY_ARE_EQUAL(inputBuffer.Write(records), records.size());
+        while (inputBuffer.GetNumberOfReadyEvents() > 0)
+        {
+            size_t eventsRead = 0;
+            VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outRecords, eventsRead, false, false, true, false));
+            totalRead += eventsRead;
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        VERIFY_ARE_EQUAL(totalRead, records.size());
+        Log::Comment(WEX::Common::String().Format(L"Wrote and read %zu records in %.3fms",
+                                                  records.size(),
+                                                  elapsed.count() * 1000));
+    }
+
     TEST_METHOD(CanReinitializeInputBuffer)
     {
         InputBuffer inputBuffer;
@@ -589,22 +666,17 @@ class InputBufferTests
     {
         InputBuffer inputBuffer;
         INPUT_RECORD record = MakeKeyEvent(true, 1, L'a', 0, L'a', 0);
-        std::unique_ptr<IInputEvent> inputEvent = IInputEvent::Create(record);
         size_t eventsWritten;
         bool waitEvent = false;
         inputBuffer.Flush();
         // write one event to an empty buffer
-        std::deque<std::unique_ptr<IInputEvent>> storage;
-        storage.push_back(std::move(inputEvent));
-        inputBuffer._WriteBuffer(storage, eventsWritten, waitEvent);
+        inputBuffer._WriteBuffer(gsl::make_span(&record, 1), eventsWritten, waitEvent);
         VERIFY_IS_TRUE(waitEvent);
         // write another, it shouldn't signal this time
         INPUT_RECORD record2 = MakeKeyEvent(true, 1, L'b', 0, L'b', 0);
-        std::unique_ptr<IInputEvent> inputEvent2 = IInputEvent::Create(record2);
         // write another event to a non-empty buffer
         waitEvent = false;
-        storage.push_back(std::move(inputEvent2));
-        inputBuffer._WriteBuffer(storage, eventsWritten, waitEvent);
+        inputBuffer._WriteBuffer(gsl::make_span(&record2, 1), eventsWritten, waitEvent);
 
         VERIFY_IS_FALSE(waitEvent);
     }
@@ -624,8 +696,8 @@ class InputBufferTests
                                                  true,
                                                  true));
         VERIFY_ARE_EQUAL(outEvents.size(), 1u);
-        VERIFY_ARE_EQUAL(inputBuffer._storage.size(), 1u);
-        VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*inputBuffer._storage.front()).GetRepeatCount(), repeatCount - 1);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.Size(), 1u);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.Front().Event.KeyEvent.wRepeatCount, repeatCount - 1);
         VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*outEvents.front()).GetRepeatCount(), 1u);
     }
 
@@ -644,8 +716,8 @@ class InputBufferTests
                                                  true,
                                                  true));
         VERIFY_ARE_EQUAL(outEvents.size(), 1u);
-        VERIFY_ARE_EQUAL(inputBuffer._storage.size(), 1u);
-        VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*inputBuffer._storage.front()).GetRepeatCount(), repeatCount);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.Size(), 1u);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.Front().Event.KeyEvent.wRepeatCount, repeatCount);
         VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*outEvents.front()).GetRepeatCount(), 1u);
     }
 };
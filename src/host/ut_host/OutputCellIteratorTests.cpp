@@ -277,6 +277,32 @@ class OutputCellIteratorTests
         VERIFY_IS_FALSE(it);
     }
 
+    TEST_METHOD(StringDataWithCarriageReturnLineFeed)
+    {
+        SetVerifyOutput settings(VerifyOutputSettings::LogOnlyFailures);
+
+        const std::wstring testText(L"a\r\nb\r\n");
+
+        OutputCellIterator it(testText);
+        const auto original = it;
+
+        for (const auto& wch : testText)
+        {
+            OutputCellView expected({ &wch, 1 },
+                                    {},
+                                    InvalidTextAttribute,
+                                    TextAttributeBehavior::Current);
+
+            VERIFY_IS_TRUE(it);
+            VERIFY_ARE_EQUAL(expected, *it);
+            it++;
+        }
+
+        VERIFY_IS_FALSE(it);
+        VERIFY_ARE_EQUAL(gsl::narrow_cast<ptrdiff_t>(testText.size()), it.GetCellDistance(original));
+        VERIFY_ARE_EQUAL(gsl::narrow_cast<ptrdiff_t>(testText.size()), it.GetInputDistance(original));
+    }
+
     TEST_METHOD(FullWidthStringData)
     {
         SetVerifyOutput settings(VerifyOutputSettings::LogOnlyFailures);
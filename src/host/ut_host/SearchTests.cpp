@@ -164,4 +164,121 @@ class SearchTests
         Search s(outputBuffer, L"\x304b", Search::Direction::Backward, Search::Sensitivity::CaseInsensitive);
         DoFoundChecks(s, coordStartExpected, -1);
     }
+
+    TEST_METHOD(FindAllCaseInsensitive)
+    {
+        const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        const auto& outputBuffer = gci.GetActiveOutputBuffer();
+
+        Search s(outputBuffer, L"ab", Search::Direction::Forward, Search::Sensitivity::CaseInsensitive);
+        const auto matches = s.FindAll();
+
+        VERIFY_ARE_EQUAL(static_cast<size_t>(4), matches.size());
+        for (SHORT row = 0; row < 4; ++row)
+        {
+            VERIFY_ARE_EQUAL((COORD{ 0, row }), matches.at(row).first);
+            VERIFY_ARE_EQUAL((COORD{ 1, row }), matches.at(row).second);
+        }
+    }
+
+    TEST_METHOD(FindAcrossEndOfRow)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        auto& outputBuffer = gci.GetActiveOutputBuffer();
+        auto& textBuffer = outputBuffer.GetTextBuffer();
+
+        const SHORT lastColumn = CommonState::s_csBufferWidth - 1;
+        const SHORT secondLastColumn = lastColumn - 1;
+        textBuffer.GetRowByOffset(5).GetCharRow().GlyphAt(secondLastColumn) = L"x";
+        textBuffer.GetRowByOffset(5).GetCharRow().GlyphAt(lastColumn) = L"y";
+        textBuffer.GetRowByOffset(6).GetCharRow().GlyphAt(0) = L"z";
+
+        Search forward(outputBuffer, L"xyz", Search::Direction::Forward, Search::Sensitivity::CaseSensitive);
+        VERIFY_IS_TRUE(forward.FindNext());
+        VERIFY_ARE_EQUAL((COORD{ secondLastColumn, 5 }), forward._coordSelStart);
+        VERIFY_ARE_EQUAL((COORD{ 0, 6 }), forward._coordSelEnd);
+        VERIFY_IS_FALSE(forward.FindNext());
+
+        Search backward(outputBuffer, L"xyz", Search::Direction::Backward, Search::Sensitivity::CaseSensitive);
+        VERIFY_IS_TRUE(backward.FindNext());
+        VERIFY_ARE_EQUAL((COORD{ secondLastColumn, 5 }), backward._coordSelStart);
+        VERIFY_ARE_EQUAL((COORD{ 0, 6 }), backward._coordSelEnd);
+        VERIFY_IS_FALSE(backward.FindNext());
+    }
+
+    TEST_METHOD(RegexFindAll)
+    {
+        const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        const auto& outputBuffer = gci.GetActiveOutputBuffer();
+
+        // Each filled row reads "AB\x304bC\x304dDE", and both of the Japanese
+        // characters take up two cells.
+        Search s(outputBuffer, L"c.d", Search::Direction::Forward, Search::Sensitivity::CaseInsensitive, Search::Syntax::RegularExpression);
+        const auto matches = s.FindAll();
+
+        VERIFY_ARE_EQUAL(static_cast<size_t>(4), matches.size());
+        for (SHORT row = 0; row < 4; ++row)
+        {
+            VERIFY_ARE_EQUAL((COORD{ 4, row }), matches.at(row).first);
+            VERIFY_ARE_EQUAL((COORD{ 7, row }), matches.at(row).second);
+        }
+    }
+
+    TEST_METHOD(RegexFindFullWidthLiteral)
+    {
+        const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        const auto& outputBuffer = gci.GetActiveOutputBuffer();
+
+        // The literal the rows have to hold includes a character that takes
+        // up two cells, so the search index has to count it twice too.
+        Search s(outputBuffer, L"C\x304dD+", Search::Direction::Forward, Search::Sensitivity::CaseSensitive, Search::Syntax::RegularExpression);
+        VERIFY_ARE_EQUAL(std::wstring(L"C\x304dD"), s._regexLiteral);
+        const auto matches = s.FindAll();
+
+        VERIFY_ARE_EQUAL(static_cast<size_t>(4), matches.size());
+        for (SHORT row = 0; row < 4; ++row)
+        {
+            VERIFY_ARE_EQUAL((COORD{ 4, row }), matches.at(row).first);
+            VERIFY_ARE_EQUAL((COORD{ 7, row }), matches.at(row).second);
+        }
+    }
+
+    TEST_METHOD(RegexFindAcrossWrappedRows)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        auto& outputBuffer = gci.GetActiveOutputBuffer();
+        auto& textBuffer = outputBuffer.GetTextBuffer();
+
+        const SHORT lastColumn = CommonState::s_csBufferWidth - 1;
+        const SHORT secondLastColumn = lastColumn - 1;
+        textBuffer.GetRowByOffset(5).GetCharRow().GlyphAt(secondLastColumn) = L"e";
+        textBuffer.GetRowByOffset(5).GetCharRow().GlyphAt(lastColumn) = L"r";
+        textBuffer.GetRowByOffset(6).GetCharRow().GlyphAt(0) = L"r";
+        textBuffer.GetRowByOffset(6).GetCharRow().GlyphAt(1) = L"o";
+        textBuffer.GetRowByOffset(6).GetCharRow().GlyphAt(2) = L"r";
+
+        Log::Comment(L"Rows that weren't wrapped are separate lines.");
+        Search unwrapped(outputBuffer, L"er+or$", Search::Direction::Forward, Search::Sensitivity::CaseSensitive, Search::Syntax::RegularExpression);
+        VERIFY_IS_FALSE(unwrapped.FindNext());
+
+        Log::Comment(L"Rows that were wrapped are one line.");
+        textBuffer.GetRowByOffset(5).GetCharRow().SetWrapForced(true);
+        Search wrapped(outputBuffer, L"er+or$", Search::Direction::Forward, Search::Sensitivity::CaseSensitive, Search::Syntax::RegularExpression);
+        VERIFY_IS_TRUE(wrapped.FindNext());
+        VERIFY_ARE_EQUAL((COORD{ secondLastColumn, 5 }), wrapped._coordSelStart);
+        VERIFY_ARE_EQUAL((COORD{ 2, 6 }), wrapped._coordSelEnd);
+        VERIFY_IS_FALSE(wrapped.FindNext());
+    }
+
+    TEST_METHOD(RegexRequiredLiteral)
+    {
+        VERIFY_ARE_EQUAL(std::wstring(L": undeclared"), Search::s_GetRequiredLiteral(L"error C\\d+: undeclared"));
+        VERIFY_ARE_EQUAL(std::wstring(L"ab"), Search::s_GetRequiredLiteral(L"abc?d"));
+        VERIFY_ARE_EQUAL(std::wstring(L"xy"), Search::s_GetRequiredLiteral(L"(abc)?xy"));
+        VERIFY_ARE_EQUAL(std::wstring(L"foo.bar"), Search::s_GetRequiredLiteral(L"foo\\.bar"));
+        VERIFY_ARE_EQUAL(std::wstring(L"def"), Search::s_GetRequiredLiteral(L"[abc]+def"));
+
+        Log::Comment(L"With alternation, no literal is required.");
+        VERIFY_ARE_EQUAL(std::wstring(L""), Search::s_GetRequiredLiteral(L"warning|error"));
+    }
 };
@@ -132,6 +132,9 @@ class TextBufferTests
     TEST_METHOD(TestBackspaceStrings);
     TEST_METHOD(TestBackspaceStringsAPI);
 
+    TEST_METHOD(TestWriteCharsLegacyPrintableRuns);
+    TEST_METHOD(TestWriteCharsLegacyCombiningMarks);
+
     TEST_METHOD(TestRepeatCharacter);
 
     TEST_METHOD(ResizeTraditional);
@@ -143,6 +146,10 @@ class TextBufferTests
     TEST_METHOD(ResizeTraditionalHighUnicodeColumnRemoval);
 
     TEST_METHOD(TestBurrito);
+
+    TEST_METHOD(TrimMemoryUsageTakesFromOldestRows);
+
+    TEST_METHOD(ClipboardRunsMergeColorsAndFormat);
 };
 
 void TextBufferTests::TestBufferCreate()
@@ -1549,6 +1556,72 @@ void TextBufferTests::TestBackspaceStringsAPI()
     VERIFY_ARE_EQUAL(cursor.GetPosition().Y, y0);
 }
 
+void TextBufferTests::TestWriteCharsLegacyPrintableRuns()
+{
+    CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    SCREEN_INFORMATION& si = gci.GetActiveOutputBuffer().GetActiveBuffer();
+    const TextBuffer& tbi = si.GetTextBuffer();
+    Cursor& cursor = si.GetTextBuffer().GetCursor();
+
+    gci.SetVirtTermLevel(0);
+    WI_ClearFlag(si.OutputMode, ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+    WI_SetFlag(si.OutputMode, ENABLE_PROCESSED_OUTPUT);
+    VERIFY_SUCCEEDED(si.SetViewportOrigin(true, COORD({ 0, 0 }), true));
+    cursor.SetPosition({ 0, 0 });
+
+    Log::Comment(L"Write printable ASCII longer than a row, broken up by a tab and an accented letter.");
+    const auto width = si.GetBufferSize().Width();
+    std::wstring text{ L"abc\tdef" };
+    text.append(width, L'x');
+    text.append(L"\x00e9z");
+
+    size_t cb = text.size() * sizeof(wchar_t);
+    VERIFY_SUCCESS_NTSTATUS(WriteCharsLegacy(si, text.data(), text.data(), text.data(), &cb, nullptr, cursor.GetPosition().X, 0, nullptr));
+    VERIFY_ARE_EQUAL(text.size() * sizeof(wchar_t), cb);
+
+    Log::Comment(L"The tab is expanded, and the run of x's carries on into the second row.");
+    std::wstring expectedRow0{ L"abc     def" };
+    expectedRow0.append(width - expectedRow0.size(), L'x');
+    const std::wstring expectedRow1{ L"xxxxxxxxxxx\x00e9z" };
+
+    const auto row0Text = tbi.GetRowByOffset(0).GetText();
+    const auto row1Text = tbi.GetRowByOffset(1).GetText();
+    VERIFY_ARE_EQUAL(String(expectedRow0.c_str()), String(row0Text.substr(0, expectedRow0.size()).c_str()));
+    VERIFY_ARE_EQUAL(String(expectedRow1.c_str()), String(row1Text.substr(0, expectedRow1.size()).c_str()));
+
+    VERIFY_ARE_EQUAL(gsl::narrow<SHORT>(expectedRow1.size()), cursor.GetPosition().X);
+    VERIFY_ARE_EQUAL(1, cursor.GetPosition().Y);
+}
+
+void TextBufferTests::TestWriteCharsLegacyCombiningMarks()
+{
+    CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    SCREEN_INFORMATION& si = gci.GetActiveOutputBuffer().GetActiveBuffer();
+    const TextBuffer& tbi = si.GetTextBuffer();
+    Cursor& cursor = si.GetTextBuffer().GetCursor();
+
+    gci.SetVirtTermLevel(0);
+    WI_ClearFlag(si.OutputMode, ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+    WI_SetFlag(si.OutputMode, ENABLE_PROCESSED_OUTPUT);
+    VERIFY_SUCCEEDED(si.SetViewportOrigin(true, COORD({ 0, 0 }), true));
+    cursor.SetPosition({ 0, 0 });
+
+    Log::Comment(L"Write an e with a combining acute accent, then an x.");
+    const std::wstring text{ L"e\x0301x" };
+    size_t cb = text.size() * sizeof(wchar_t);
+    VERIFY_SUCCESS_NTSTATUS(WriteCharsLegacy(si, text.data(), text.data(), text.data(), &cb, nullptr, cursor.GetPosition().X, 0, nullptr));
+    VERIFY_ARE_EQUAL(text.size() * sizeof(wchar_t), cb);
+
+    Log::Comment(L"The accent shares the e's cell, and the cursor is right after the x.");
+    const auto& charRow = tbi.GetRowByOffset(0).GetCharRow();
+    VERIFY_ARE_EQUAL(std::wstring_view{ L"e\x0301" }, std::wstring_view{ charRow.GlyphAt(0) });
+    VERIFY_ARE_EQUAL(std::wstring_view{ L"x" }, std::wstring_view{ charRow.GlyphAt(1) });
+    VERIFY_ARE_EQUAL(std::wstring_view{ L" " }, std::wstring_view{ charRow.GlyphAt(2) });
+
+    VERIFY_ARE_EQUAL(2, cursor.GetPosition().X);
+    VERIFY_ARE_EQUAL(0, cursor.GetPosition().Y);
+}
+
 void TextBufferTests::TestRepeatCharacter()
 {
     CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
@@ -1940,3 +2013,118 @@ void TextBufferTests::TestBurrito()
     _buffer->IncrementCursor();
     VERIFY_IS_FALSE(afterBurritoIter);
 }
+
+void TextBufferTests::TrimMemoryUsageTakesFromOldestRows()
+{
+    const COORD bufferSize{ 20, 10 };
+    TextBuffer buffer(bufferSize, TextAttribute{ 0x7f }, 12, _renderTarget);
+    const auto leastRowUsage = TextBuffer::s_GetLeastRowMemoryUsage(bufferSize.X);
+
+    // Walks the whole buffer, to check the count it keeps as it goes.
+    const auto measure = [&]() {
+        size_t walked = buffer.GetUnicodeStorage()._map.bucket_count() * sizeof(void*);
+        for (const auto& entry : buffer.GetUnicodeStorage()._map)
+        {
+            walked += UnicodeStorage::s_GetEntryMemoryUsage(entry.second);
+        }
+        for (SHORT y = 0; y < bufferSize.Y; ++y)
+        {
+            walked += buffer.GetRowByOffset(y).GetMemoryUsage();
+        }
+        return walked;
+    };
+
+    Log::Comment(L"Give every row but the second a different color in every cell, and the first a burrito and an accented e.");
+    for (SHORT y = 0; y < bufferSize.Y; ++y)
+    {
+        if (y == 1)
+        {
+            buffer.WriteLine(OutputCellIterator{ L"plain" }, { 0, y });
+            continue;
+        }
+
+        for (SHORT x = 0; x < bufferSize.X; ++x)
+        {
+            buffer.WriteLine(OutputCellIterator{ L"x", TextAttribute{ gsl::narrow_cast<WORD>(x % 16) } }, { x, y });
+        }
+    }
+    buffer.WriteLine(OutputCellIterator{ L"\xD83C\xDF2F" }, { 0, 0 });
+    buffer.WriteLine(OutputCellIterator{ L"e\x0301" }, { 2, 0 });
+
+    // Compact them all up front, so that stripping rows is the only way left
+    // to give memory back.
+    for (SHORT y = 0; y < bufferSize.Y; ++y)
+    {
+        buffer.GetRowByOffset(y).GetAttrRow().Compact();
+    }
+
+    const auto usage = buffer.GetMemoryUsage();
+    VERIFY_ARE_EQUAL(measure(), usage);
+    VERIFY_IS_GREATER_THAN(usage, leastRowUsage * bufferSize.Y);
+    VERIFY_ARE_EQUAL(leastRowUsage, buffer.GetRowByOffset(1).GetMemoryUsage());
+
+    Log::Comment(L"Going just over the limit strips the oldest row of its colors and stored glyphs, but keeps its text.");
+    const auto trimmed = buffer.TrimMemoryUsage(usage - 1, 5);
+    VERIFY_IS_LESS_THAN_OR_EQUAL(trimmed, usage - 1);
+    VERIFY_ARE_EQUAL(trimmed, buffer.GetMemoryUsage());
+    VERIFY_ARE_EQUAL(measure(), trimmed);
+    VERIFY_ARE_EQUAL(leastRowUsage, buffer.GetRowByOffset(0).GetMemoryUsage());
+    VERIFY_ARE_EQUAL(static_cast<size_t>(0), buffer.GetUnicodeStorage()._map.size());
+    const auto& strippedRow = buffer.GetRowByOffset(0).GetCharRow();
+    VERIFY_ARE_EQUAL(std::wstring_view{ L"\xFFFD" }, std::wstring_view{ strippedRow.GlyphAt(0) });
+    VERIFY_ARE_EQUAL(std::wstring_view{ L"e" }, std::wstring_view{ strippedRow.GlyphAt(2) });
+    VERIFY_ARE_EQUAL(std::wstring_view{ L"x" }, std::wstring_view{ strippedRow.GlyphAt(3) });
+    VERIFY_IS_GREATER_THAN(buffer.GetRowByOffset(2).GetMemoryUsage(), leastRowUsage);
+
+    Log::Comment(L"Rows that are already as small as they can be keep their text, and rows from the kept one down are left alone.");
+    buffer.TrimMemoryUsage(0, 5);
+    VERIFY_IS_TRUE(buffer.GetRowByOffset(1).GetText().substr(0, 5) == L"plain");
+    VERIFY_ARE_EQUAL(leastRowUsage, buffer.GetRowByOffset(4).GetMemoryUsage());
+    VERIFY_ARE_EQUAL(std::wstring_view{ L"x" }, std::wstring_view{ buffer.GetRowByOffset(4).GetCharRow().GlyphAt(0) });
+    VERIFY_IS_GREATER_THAN(buffer.GetRowByOffset(5).GetMemoryUsage(), leastRowUsage);
+    VERIFY_ARE_EQUAL(measure(), buffer.GetMemoryUsage());
+}
+
+void TextBufferTests::ClipboardRunsMergeColorsAndFormat()
+{
+    const COORD bufferSize{ 10, 3 };
+    TextBuffer buffer(bufferSize, TextAttribute{ 0x07 }, 12, _renderTarget);
+
+    // Attributes that only differ in their intensity come out the same color.
+    const std::function<COLORREF(TextAttribute&)> getForeground = [](TextAttribute& attr) { return RGB(attr.GetLegacyAttributes() & 0x07, 0, 0); };
+    const std::function<COLORREF(TextAttribute&)> getBackground = [](TextAttribute& attr) { return RGB(0, 0, (attr.GetLegacyAttributes() >> 4) & 0x07); };
+
+    buffer.WriteLine(OutputCellIterator{ L"a", TextAttribute{ 0x0C } }, { 0, 0 });
+    buffer.WriteLine(OutputCellIterator{ L"b", TextAttribute{ 0x04 } }, { 1, 0 });
+    buffer.WriteLine(OutputCellIterator{ L"c}", TextAttribute{ 0x12 } }, { 2, 0 });
+    buffer.WriteLine(OutputCellIterator{ L"x\\\x00e9" }, { 0, 1 });
+
+    const std::vector<SMALL_RECT> selectionRects{ { 0, 0, 9, 0 }, { 0, 1, 9, 1 } };
+    const auto rows = buffer.GetTextRunsForClipboard(false, true, selectionRects, getForeground, getBackground);
+
+    Log::Comment(L"Trailing spaces are trimmed, and runs with the same colors are merged.");
+    VERIFY_ARE_EQUAL(std::wstring_view{ L"abc}\r\nx\\\x00e9" }, std::wstring_view{ rows.text });
+    VERIFY_ARE_EQUAL(static_cast<size_t>(2), rows.rowEnds.size());
+    VERIFY_ARE_EQUAL(static_cast<size_t>(6), rows.rowEnds.at(0));
+    VERIFY_ARE_EQUAL(static_cast<size_t>(9), rows.rowEnds.at(1));
+    VERIFY_ARE_EQUAL(static_cast<size_t>(3), rows.runs.size());
+    VERIFY_ARE_EQUAL(static_cast<size_t>(2), rows.runs.at(0).length);
+    VERIFY_ARE_EQUAL(RGB(4, 0, 0), rows.runs.at(0).foreground);
+    VERIFY_ARE_EQUAL(static_cast<size_t>(2), rows.runs.at(1).length);
+    VERIFY_ARE_EQUAL(RGB(0, 0, 1), rows.runs.at(1).background);
+    VERIFY_ARE_EQUAL(static_cast<size_t>(3), rows.runs.at(2).length);
+
+    Log::Comment(L"HTML breaks rows with <BR>, and switches spans when the colors change.");
+    const auto html = TextBuffer::GenHTML(rows, 12, L"Consolas", "Windows Terminal");
+    VERIFY_ARE_NOT_EQUAL(std::string::npos, html.find(">ab</SPAN><SPAN"));
+    VERIFY_ARE_NOT_EQUAL(std::string::npos, html.find(">c}<BR></SPAN><SPAN"));
+    VERIFY_ARE_EQUAL(std::string::npos, html.find("\r\nx"));
+
+    Log::Comment(L"RTF escapes its control characters and anything outside of ASCII.");
+    const auto rtf = TextBuffer::GenRTF(rows, 12, L"Consolas");
+    VERIFY_ARE_EQUAL(static_cast<size_t>(0), rtf.find("{\\rtf1"));
+    VERIFY_ARE_NOT_EQUAL(std::string::npos, rtf.find("{\\colortbl ;\\red4\\green0\\blue0;"));
+    VERIFY_ARE_NOT_EQUAL(std::string::npos, rtf.find("\\fs24 "));
+    VERIFY_ARE_NOT_EQUAL(std::string::npos, rtf.find(" c\\}\\line "));
+    VERIFY_ARE_NOT_EQUAL(std::string::npos, rtf.find(" x\\\\\\u233?}"));
+}
@@ -11,6 +11,11 @@
 #include "../../renderer/vt/WinTelnetEngine.hpp"
 #include "../Settings.hpp"
 
+#include <chrono>
+#ifdef _DEBUG
+#include <crtdbg.h>
+#endif
+
 using namespace WEX::Common;
 using namespace WEX::Logging;
 using namespace WEX::TestExecution;
@@ -55,6 +60,30 @@ public:
 
 VtRenderTestColorProvider p;
 
+// Makes one single-column cluster for each character of the given text.
+static std::vector<Cluster> MakeClusters(const std::wstring_view text)
+{
+    std::vector<Cluster> clusters;
+    for (size_t i = 0; i < text.size(); i++)
+    {
+        clusters.emplace_back(text.substr(i, 1), static_cast<size_t>(1));
+    }
+    return clusters;
+}
+
+#ifdef _DEBUG
+// Counts the heap allocations made while it's installed as the CRT alloc hook.
+static size_t s_allocationCount = 0;
+static int __cdecl CountAllocationsHook(int allocType, void*, size_t, int, long, const unsigned char*, int)
+{
+    if (allocType == _HOOK_ALLOC || allocType == _HOOK_REALLOC)
+    {
+        s_allocationCount++;
+    }
+    return TRUE;
+}
+#endif
+
 class Microsoft::Console::Render::VtRendererTest
 {
     TEST_CLASS(VtRendererTest);
@@ -110,6 +139,18 @@ class Microsoft::Console::Render::VtRendererTest
 
     TEST_METHOD(TestResize);
 
+    TEST_METHOD(TestWriterBackpressure);
+
+    TEST_METHOD(TestPaintThroughput);
+
+    TEST_METHOD(XtermTestShadowBuffer);
+
+    TEST_METHOD(XtermTestScrollRegion);
+
+    TEST_METHOD(TestShadowBufferBytes);
+
+    TEST_METHOD(TestFrameByteBudget);
+
     void Test16Colors(VtEngine* engine);
 
     std::deque<std::string> qExpectedInput;
@@ -249,6 +290,9 @@ void VtRendererTest::VtSequenceHelperTests()
 
     qExpectedInput.push_back("\x1b[10C");
     VERIFY_SUCCEEDED(engine->_CursorForward(10));
+
+    qExpectedInput.push_back("\x1b[3b");
+    VERIFY_SUCCEEDED(engine->_RepeatCharacter(3));
 }
 
 void VtRendererTest::Xterm256TestInvalidate()
@@ -1191,3 +1235,545 @@ void VtRendererTest::TestResize()
         VERIFY_IS_FALSE(engine->_suppressResizeRepaint);
     });
 }
+
+void VtRendererTest::TestWriterBackpressure()
+{
+    wil::unique_hfile readPipe;
+    wil::unique_hfile writePipe;
+    VERIFY_WIN32_BOOL_SUCCEEDED(CreatePipe(readPipe.addressof(), writePipe.addressof(), nullptr, 0));
+
+    // Use a real pipe for this engine, so the writer thread actually runs.
+    auto engine = std::make_unique<Xterm256Engine>(std::move(writePipe), p, SetUpViewport(), g_ColorTable, static_cast<WORD>(COLOR_TABLE_SIZE));
+
+    wil::unique_event repaintRequested;
+    repaintRequested.create();
+    engine->SetRepaintCallback([&]() {
+        repaintRequested.SetEvent();
+    });
+
+    Log::Comment(NoThrowString().Format(
+        L"Write a frame that's much bigger than the pipe's buffer, without reading any of it."));
+    const std::string bigFrame(1024 * 1024, 'A');
+    VERIFY_ARE_EQUAL(S_OK, engine->StartPaint());
+    VERIFY_SUCCEEDED(engine->WriteTerminalUtf8(bigFrame));
+    VERIFY_SUCCEEDED(engine->EndPaint());
+
+    Log::Comment(NoThrowString().Format(
+        L"The writer is stuck on the pipe. The next frame should be skipped "
+        L"(rather than blocking), and the invalid region should be kept."));
+    VERIFY_SUCCEEDED(engine->InvalidateAll());
+    VERIFY_ARE_EQUAL(S_FALSE, engine->StartPaint());
+    VERIFY_IS_TRUE(engine->_fInvalidRectUsed);
+    VERIFY_IS_FALSE(repaintRequested.is_signaled());
+
+    Log::Comment(NoThrowString().Format(
+        L"Drain the pipe. Once the writer's done, it should ask for a repaint."));
+    const size_t expectedBytes = CLEAR_SCREEN.size() + bigFrame.size();
+    size_t totalRead = 0;
+    std::vector<char> readBuffer(64 * 1024);
+    while (totalRead < expectedBytes)
+    {
+        DWORD read = 0;
+        VERIFY_WIN32_BOOL_SUCCEEDED(ReadFile(readPipe.get(), readBuffer.data(), static_cast<DWORD>(readBuffer.size()), &read, nullptr));
+        totalRead += read;
+    }
+    VERIFY_ARE_EQUAL(expectedBytes, totalRead);
+    VERIFY_IS_TRUE(repaintRequested.wait(5000));
+
+    Log::Comment(NoThrowString().Format(
+        L"Now the skipped frame should get painted."));
+    VERIFY_ARE_EQUAL(S_OK, engine->StartPaint());
+    VERIFY_SUCCEEDED(engine->EndPaint());
+    VERIFY_IS_FALSE(engine->_fInvalidRectUsed);
+}
+
+void VtRendererTest::TestPaintThroughput()
+{
+    Log::Comment(NoThrowString().Format(
+        L"Microbenchmark: repaint a full 120x30 screen of colored text, and "
+        L"measure the bytes emitted per second and the allocations per frame."));
+
+    const auto view = Viewport::FromDimensions({ 0, 0 }, { 120, 30 });
+    wil::unique_hfile hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
+    auto engine = std::make_unique<Xterm256Engine>(std::move(hFile), p, view, g_ColorTable, static_cast<WORD>(COLOR_TABLE_SIZE));
+
+    size_t totalBytes = 0;
+    engine->SetTestCallback([&](const char* const, size_t const cch) {
+        totalBytes += cch;
+        return true;
+    });
+
+    // Each row is a mix of ASCII, non-ASCII BMP text, and trailing spaces,
+    //      and every few columns the colors change.
+    const std::wstring rowText = L"drwxr-xr-x 1 user group 4096 Oct 18 12:00 \x00e9t\x00e9 \x65e5\x672c\x8a9e src/renderer/vt/paint.cpp";
+    std::vector<Cluster> clusters;
+    for (size_t i = 0; i < static_cast<size_t>(view.Width()); i++)
+    {
+        const auto text = i < rowText.size() ? std::wstring_view{ &rowText[i], 1 } : std::wstring_view{ L" " };
+        clusters.emplace_back(text, 1);
+    }
+
+    const auto paintFrame = [&](const short frame) {
+        VERIFY_SUCCEEDED(engine->InvalidateAll());
+        VERIFY_SUCCEEDED(engine->StartPaint());
+        for (short row = 0; row < view.Height(); row++)
+        {
+            const auto fg = g_ColorTable[(row + frame) % 16];
+            const auto bg = g_ColorTable[(row + frame + 8) % 16];
+            VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(fg, bg, 0, row % 2 == 0, false));
+            VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, row }, false));
+        }
+        VERIFY_SUCCEEDED(engine->EndPaint());
+    };
+
+    // Warm up, so the engine's buffers have reached their steady-state size.
+    for (short frame = 0; frame < 10; frame++)
+    {
+        paintFrame(frame);
+    }
+    totalBytes = 0;
+
+    const short frames = 1000;
+#ifdef _DEBUG
+    s_allocationCount = 0;
+    const auto previousHook = _CrtSetAllocHook(CountAllocationsHook);
+#endif
+    const auto start = std::chrono::steady_clock::now();
+    for (short frame = 0; frame < frames; frame++)
+    {
+        paintFrame(frame);
+    }
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+#ifdef _DEBUG
+    _CrtSetAllocHook(previousHook);
+    Log::Comment(NoThrowString().Format(L"Allocations per frame: %f", static_cast<double>(s_allocationCount) / frames));
+#endif
+
+    Log::Comment(NoThrowString().Format(L"Frames: %d, bytes: %zu, seconds: %f", frames, totalBytes, elapsed));
+    Log::Comment(NoThrowString().Format(L"Bytes per frame: %zu", totalBytes / frames));
+    Log::Comment(NoThrowString().Format(L"Bytes per second: %f", elapsed > 0 ? totalBytes / elapsed : 0.0));
+    VERIFY_IS_GREATER_THAN(totalBytes, static_cast<size_t>(0));
+}
+
+void VtRendererTest::XtermTestShadowBuffer()
+{
+    wil::unique_hfile hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
+    std::unique_ptr<Xterm256Engine> engine = std::make_unique<Xterm256Engine>(std::move(hFile), p, SetUpViewport(), g_ColorTable, static_cast<WORD>(COLOR_TABLE_SIZE));
+    auto pfn = std::bind(&VtRendererTest::WriteCallback, this, std::placeholders::_1, std::placeholders::_2);
+    engine->SetTestCallback(pfn);
+
+    qExpectedInput.push_back("\x1b[2J");
+    TestPaint(*engine, [&]() {
+        VERIFY_IS_FALSE(engine->_firstPaint);
+    });
+
+    TestPaintXterm(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"The first time a line is painted, all of it is written."));
+        qExpectedInput.push_back("\x1b[H");
+        qExpectedInput.push_back("asdfghjkl");
+        const auto clusters = MakeClusters(L"asdfghjkl");
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, 0 }, false));
+    });
+
+    TestPaintXterm(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"Painting the same line again writes nothing."));
+        qExpectedInput.push_back(EMPTY_CALLBACK_SENTINEL);
+        const auto clusters = MakeClusters(L"asdfghjkl");
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, 0 }, false));
+        WriteCallback(EMPTY_CALLBACK_SENTINEL, 1);
+    });
+
+    TestPaintXterm(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"Only the character that changed is written."));
+        qExpectedInput.push_back("\x1b[1;5H");
+        qExpectedInput.push_back("X");
+        const auto clusters = MakeClusters(L"asdfXhjkl");
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, 0 }, false));
+    });
+
+    TestPaintXterm(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"Long unchanged gaps are skipped over with a cursor movement."));
+        qExpectedInput.push_back("\x1b[1;2H");
+        qExpectedInput.push_back("X");
+        qExpectedInput.push_back("\x1b[5C");
+        qExpectedInput.push_back("X");
+        const auto clusters = MakeClusters(L"aXdfXhjXl");
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, 0 }, false));
+    });
+
+    TestPaintXterm(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"Short unchanged gaps are written out again instead."));
+        qExpectedInput.push_back("\x1b[1;3H");
+        qExpectedInput.push_back("ZfZ");
+        const auto clusters = MakeClusters(L"aXZfZhjXl");
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, 0 }, false));
+    });
+
+    TestPaintXterm(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"Runs of the same character are written once, then repeated."));
+        qExpectedInput.push_back("\r\n");
+        qExpectedInput.push_back("-");
+        qExpectedInput.push_back("\x1b[19b");
+        const auto clusters = MakeClusters(std::wstring(20, L'-'));
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, 1 }, false));
+    });
+
+    TestPaintXterm(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"Trailing spaces are erased, and the cursor is moved past them at the end of the frame."));
+        qExpectedInput.push_back("\r");
+        qExpectedInput.push_back("\x1b[20X");
+        qExpectedInput.push_back("\x1b[20C");
+        const auto clusters = MakeClusters(std::wstring(20, L' '));
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, 1 }, false));
+    });
+
+    const COORD scrollDown = { 0, 1 };
+    VERIFY_SUCCEEDED(engine->InvalidateScroll(&scrollDown));
+    TestPaintXterm(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"After scrolling, the shadow buffer scrolled too, so painting a "
+            L"line at its new position writes nothing."));
+        qExpectedInput.push_back("\x1b[H");
+        qExpectedInput.push_back("\x1b[L");
+        VERIFY_SUCCEEDED(engine->ScrollFrame());
+
+        qExpectedInput.push_back(EMPTY_CALLBACK_SENTINEL);
+        const auto clusters = MakeClusters(L"aXZfZhjXl");
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, 1 }, false));
+        WriteCallback(EMPTY_CALLBACK_SENTINEL, 1);
+    });
+
+    qExpectedInput.push_back("\x1b]0;foo\x7");
+    VERIFY_SUCCEEDED(engine->WriteTerminalUtf8("\x1b]0;foo\x7"));
+    TestPaintXterm(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"After something was written straight to the terminal, everything is painted again."));
+        qExpectedInput.push_back("\r\n");
+        qExpectedInput.push_back("aXZfZhjXl");
+        const auto clusters = MakeClusters(L"aXZfZhjXl");
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, 1 }, false));
+    });
+}
+
+void VtRendererTest::TestShadowBufferBytes()
+{
+    Log::Comment(NoThrowString().Format(
+        L"Benchmark: count the bytes emitted for a few typical workloads, both "
+        L"when only the changed cells are written, and when every painted "
+        L"line is written in full."));
+
+    const auto view = Viewport::FromDimensions({ 0, 0 }, { 120, 30 });
+
+    // Each workload returns the text of a row for a given frame. Every row is
+    //      painted on every frame, as if everything had been invalidated.
+    struct Workload
+    {
+        const wchar_t* name;
+        bool scrolls;
+        std::function<std::wstring(const short row, const short frame)> getRow;
+    };
+
+    const auto pad = [&](std::wstring text) {
+        text.resize(view.Width(), L' ');
+        return text;
+    };
+
+    const Workload workloads[] = {
+        { L"process monitor", false, [&](const short row, const short frame) {
+             wchar_t text[128];
+             if (row == 0)
+             {
+                 swprintf_s(text, L"top - 12:%02d:%02d up 3 days, load average: 0.%02d, 0.%02d", frame / 60, frame % 60, frame % 100, (frame * 7) % 100);
+             }
+             else
+             {
+                 // Only a few processes are busy, so most rows don't change.
+                 const int cpu = (row % 5 == 0) ? (frame * row) % 100 : 0;
+                 swprintf_s(text, L"%5d user      20   0 %8d %6d S %5d.0 %4d.1   0:%02d.%02d process%d", 1000 + row, 4096 * row, 512 * row, cpu, row % 10, cpu / 10, cpu, row);
+             }
+             return pad(text);
+         } },
+        { L"text editor", false, [&](const short row, const short frame) {
+             wchar_t text[128];
+             if (row == view.Height() - 1)
+             {
+                 swprintf_s(text, L"-- INSERT --                                                   %d,%d          All", 12, frame % 80 + 1);
+             }
+             else if (row == 12)
+             {
+                 // The line being typed into.
+                 swprintf_s(text, L"    const auto value = %ls;", std::wstring(frame % 80, L'x').c_str());
+             }
+             else
+             {
+                 swprintf_s(text, L"    // line %d of some source file, which doesn't change while we type", row);
+             }
+             return pad(text);
+         } },
+        { L"log tail", true, [&](const short row, const short frame) {
+             // A new line is appended at the bottom of the screen every frame,
+             //      so every row's text moves up one row each frame.
+             wchar_t text[128];
+             swprintf_s(text, L"[12:00:%02d] INFO request %d served in %dms", (row + frame) % 60, row + frame, (row + frame) % 37);
+             return pad(text);
+         } },
+    };
+
+    for (const auto& workload : workloads)
+    {
+        size_t diffBytes = 0;
+        size_t fullBytes = 0;
+        for (const bool useShadow : { true, false })
+        {
+            wil::unique_hfile hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
+            auto engine = std::make_unique<Xterm256Engine>(std::move(hFile), p, view, g_ColorTable, static_cast<WORD>(COLOR_TABLE_SIZE));
+
+            size_t totalBytes = 0;
+            engine->SetTestCallback([&](const char* const, size_t const cch) {
+                totalBytes += cch;
+                return true;
+            });
+
+            const short frames = 200;
+            for (short frame = 0; frame < frames; frame++)
+            {
+                if (!useShadow)
+                {
+                    engine->_shadow.Invalidate();
+                }
+
+                if (workload.scrolls && frame > 0)
+                {
+                    const COORD scrollUp = { 0, -1 };
+                    VERIFY_SUCCEEDED(engine->InvalidateScroll(&scrollUp));
+                }
+                VERIFY_SUCCEEDED(engine->InvalidateAll());
+                VERIFY_SUCCEEDED(engine->StartPaint());
+                VERIFY_SUCCEEDED(engine->ScrollFrame());
+                for (short row = 0; row < view.Height(); row++)
+                {
+                    // Highlight the first row, like a header.
+                    const auto fg = row == 0 ? g_ColorTable[0] : p.GetDefaultForeground();
+                    const auto bg = row == 0 ? g_ColorTable[7] : p.GetDefaultBackground();
+                    VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(fg, bg, 0, false, false));
+
+                    const auto text = workload.getRow(row, frame);
+                    const auto clusters = MakeClusters(text);
+                    VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, row }, false));
+                }
+                VERIFY_SUCCEEDED(engine->EndPaint());
+            }
+
+            (useShadow ? diffBytes : fullBytes) = totalBytes / frames;
+        }
+
+        Log::Comment(NoThrowString().Format(L"%ls: %zu bytes per frame changed cells only, %zu bytes per frame full lines",
+                                            workload.name,
+                                            diffBytes,
+                                            fullBytes));
+        VERIFY_IS_LESS_THAN(diffBytes, fullBytes);
+    }
+}
+
+void VtRendererTest::TestFrameByteBudget()
+{
+    Log::Comment(NoThrowString().Format(
+        L"Make sure that a frame byte budget limits the size of a frame, that "
+        L"the cursor row is always painted, and that the rest of the frame "
+        L"is painted over the following frames."));
+
+    const auto view = Viewport::FromDimensions({ 0, 0 }, { 80, 10 });
+    wil::unique_hfile hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
+    auto engine = std::make_unique<Xterm256Engine>(std::move(hFile), p, view, g_ColorTable, static_cast<WORD>(COLOR_TABLE_SIZE));
+
+    std::string written;
+    engine->SetTestCallback([&](const char* const pch, size_t const cch) {
+        written.append(pch, cch);
+        return true;
+    });
+
+    const size_t budget = 300;
+    engine->SetFrameByteBudget(budget);
+
+    // Every row gets its own letter, so we can tell which rows were painted.
+    //      The digits keep the engine from compressing the row with REP.
+    const auto getRowText = [&](const short row) {
+        std::string text;
+        for (short col = 0; col < view.Width(); col++)
+        {
+            text.push_back(col % 2 ? static_cast<char>('0' + col % 10) : static_cast<char>('A' + row));
+        }
+        return text;
+    };
+    const auto getRow = [&](const short row) {
+        const auto text = getRowText(row);
+        return std::wstring(text.begin(), text.end());
+    };
+    const auto wasPainted = [&](const short row) {
+        return written.find(getRowText(row)) != std::string::npos;
+    };
+
+    const auto paintFrame = [&]() {
+        written.clear();
+        VERIFY_SUCCEEDED(engine->StartPaint());
+        const auto dirty = engine->GetDirtyRectInChars();
+        for (auto row = dirty.Top; row <= dirty.Bottom; row++)
+        {
+            const auto clusters = MakeClusters(getRow(row));
+            VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, row }, false));
+        }
+        VERIFY_SUCCEEDED(engine->EndPaint());
+    };
+
+    const short cursorRow = 7;
+    const COORD cursor = { 0, cursorRow };
+    VERIFY_SUCCEEDED(engine->InvalidateAll());
+    VERIFY_SUCCEEDED(engine->InvalidateCursor(&cursor));
+    paintFrame();
+
+    Log::Comment(NoThrowString().Format(L"First frame: %zu bytes, %zu cells deferred", written.size(), engine->GetDeferredCellCount()));
+    VERIFY_IS_TRUE(wasPainted(cursorRow));
+    VERIFY_IS_TRUE(wasPainted(0));
+    VERIFY_IS_FALSE(wasPainted(view.Height() - 1));
+    VERIFY_IS_GREATER_THAN(engine->GetDeferredCellCount(), 0u);
+    // The budget is only ever exceeded by the last row we started painting.
+    VERIFY_IS_LESS_THAN(written.size(), budget + view.Width() * 2);
+    VERIFY_IS_TRUE(engine->_fInvalidRectUsed);
+
+    Log::Comment(L"The deferred rows should be painted by the following frames.");
+    for (int frame = 0; frame < view.Height() && engine->_fInvalidRectUsed; frame++)
+    {
+        paintFrame();
+        VERIFY_IS_LESS_THAN(written.size(), budget + view.Width() * 2);
+    }
+    VERIFY_IS_FALSE(engine->_fInvalidRectUsed);
+    VERIFY_IS_TRUE(wasPainted(view.Height() - 1));
+
+    Log::Comment(L"Without a budget, nothing is deferred.");
+    engine->SetFrameByteBudget(0);
+    const auto deferredCells = engine->GetDeferredCellCount();
+    engine->_shadow.Invalidate();
+    VERIFY_SUCCEEDED(engine->InvalidateAll());
+    paintFrame();
+    for (short row = 0; row < view.Height(); row++)
+    {
+        VERIFY_IS_TRUE(wasPainted(row));
+    }
+    VERIFY_ARE_EQUAL(deferredCells, engine->GetDeferredCellCount());
+    VERIFY_IS_FALSE(engine->_fInvalidRectUsed);
+}
+
+void VtRendererTest::XtermTestScrollRegion()
+{
+    wil::unique_hfile hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
+    std::unique_ptr<Xterm256Engine> engine = std::make_unique<Xterm256Engine>(std::move(hFile), p, SetUpViewport(), g_ColorTable, static_cast<WORD>(COLOR_TABLE_SIZE));
+    auto pfn = std::bind(&VtRendererTest::WriteCallback, this, std::placeholders::_1, std::placeholders::_2);
+    engine->SetTestCallback(pfn);
+
+    qExpectedInput.push_back("\x1b[2J");
+    TestPaint(*engine, [&]() {
+        VERIFY_IS_FALSE(engine->_firstPaint);
+    });
+
+    Viewport view = SetUpViewport();
+
+    Log::Comment(NoThrowString().Format(
+        L"Until we're told the terminal supports scrolling margins, the "
+        L"region is repainted."));
+    SMALL_RECT region = view.ToExclusive();
+    region.Top = 1;
+    VERIFY_SUCCEEDED(engine->InvalidateScrollRegion(&region, -1));
+    VERIFY_ARE_EQUAL(0, engine->_scrollRegionDelta);
+    TestPaintXterm(*engine, [&]() {
+        VERIFY_ARE_EQUAL(region, engine->_invalidRect.ToExclusive());
+
+        qExpectedInput.push_back(EMPTY_CALLBACK_SENTINEL);
+        VERIFY_SUCCEEDED(engine->ScrollFrame());
+        WriteCallback(EMPTY_CALLBACK_SENTINEL, 1);
+    });
+
+    engine->SetScrollMarginsSupported(true);
+
+    Log::Comment(NoThrowString().Format(
+        L"Scroll everything but a status line at the top up by one. Only the "
+        L"bottom line should be invalid, and the region should be scrolled "
+        L"within the terminal's margins."));
+    VERIFY_SUCCEEDED(engine->InvalidateScrollRegion(&region, -1));
+    TestPaintXterm(*engine, [&]() {
+        SMALL_RECT invalid = view.ToExclusive();
+        invalid.Top = invalid.Bottom - 1;
+        VERIFY_ARE_EQUAL(invalid, engine->_invalidRect.ToExclusive());
+
+        qExpectedInput.push_back("\x1b[2;32r"); // Set the margins
+        qExpectedInput.push_back("\x1b[S"); // Scroll up once
+        qExpectedInput.push_back("\x1b[r"); // Reset the margins
+        VERIFY_SUCCEEDED(engine->ScrollFrame());
+        VERIFY_ARE_EQUAL(COORD({ 0, 0 }), engine->_lastText);
+    });
+
+    Log::Comment(NoThrowString().Format(
+        L"Scroll a region in the middle down twice. The scrolls should be "
+        L"combined, and the rows uncovered by the first scroll should move "
+        L"along with the second."));
+    region = view.ToExclusive();
+    region.Top = 5;
+    region.Bottom = 15;
+    VERIFY_SUCCEEDED(engine->InvalidateScrollRegion(&region, 2));
+    VERIFY_SUCCEEDED(engine->InvalidateScrollRegion(&region, 2));
+    TestPaintXterm(*engine, [&]() {
+        SMALL_RECT invalid = view.ToExclusive();
+        invalid.Top = 5;
+        invalid.Bottom = 9;
+        VERIFY_ARE_EQUAL(invalid, engine->_invalidRect.ToExclusive());
+
+        qExpectedInput.push_back("\x1b[6;15r"); // Set the margins
+        qExpectedInput.push_back("\x1b[4T"); // Scroll down 4 times
+        qExpectedInput.push_back("\x1b[r"); // Reset the margins
+        VERIFY_SUCCEEDED(engine->ScrollFrame());
+    });
+
+    Log::Comment(NoThrowString().Format(
+        L"Scroll the region, then the whole viewport. We can't do them in that "
+        L"order, so the whole region is repainted instead."));
+    VERIFY_SUCCEEDED(engine->InvalidateScrollRegion(&region, -1));
+    COORD scrollDelta = { 0, -1 };
+    VERIFY_SUCCEEDED(engine->InvalidateScroll(&scrollDelta));
+    VERIFY_ARE_EQUAL(0, engine->_scrollRegionDelta);
+    TestPaintXterm(*engine, [&]() {
+        SMALL_RECT invalid = view.ToExclusive();
+        invalid.Top = 4;
+        VERIFY_ARE_EQUAL(invalid, engine->_invalidRect.ToExclusive());
+
+        qExpectedInput.push_back("\x1b[32;1H"); // Bottom of buffer
+        qExpectedInput.push_back("\n"); // Scroll down once
+        VERIFY_SUCCEEDED(engine->ScrollFrame());
+    });
+
+    Log::Comment(NoThrowString().Format(
+        L"A region that scrolls further than its height is just repainted."));
+    VERIFY_SUCCEEDED(engine->InvalidateScrollRegion(&region, 10));
+    VERIFY_ARE_EQUAL(0, engine->_scrollRegionDelta);
+    TestPaintXterm(*engine, [&]() {
+        VERIFY_ARE_EQUAL(region, engine->_invalidRect.ToExclusive());
+
+        qExpectedInput.push_back(EMPTY_CALLBACK_SENTINEL);
+        VERIFY_SUCCEEDED(engine->ScrollFrame());
+        WriteCallback(EMPTY_CALLBACK_SENTINEL, 1);
+    });
+
+    Log::Comment(NoThrowString().Format(
+        L"The ASCII-only engine always repaints the region."));
+    hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
+    std::unique_ptr<XtermEngine> asciiEngine = std::make_unique<XtermEngine>(std::move(hFile), p, SetUpViewport(), g_ColorTable, static_cast<WORD>(COLOR_TABLE_SIZE), true);
+    asciiEngine->SetScrollMarginsSupported(true);
+    VERIFY_SUCCEEDED(asciiEngine->InvalidateScrollRegion(&region, -1));
+    VERIFY_ARE_EQUAL(0, asciiEngine->_scrollRegionDelta);
+    VERIFY_ARE_EQUAL(region, asciiEngine->_invalidRect.ToExclusive());
+}
@@ -250,8 +250,12 @@ bool SignalResizeWindow(const HANDLE hSignal,
     sa.bInheritHandle = FALSE;
     sa.lpSecurityDescriptor = nullptr;
 
+    // The output pipe is made big enough that the terminal can read a lot of
+    //      output at once, rather than a page at a time.
+    const DWORD outPipeSize = 64 * 1024;
+
     CreatePipe(&inPipeConhostSide, hInput, &sa, 0);
-    CreatePipe(hOutput, &outPipeConhostSide, &sa, 0);
+    CreatePipe(hOutput, &outPipeConhostSide, &sa, outPipeSize);
     CreatePipe(&signalPipeConhostSide, hSignal, &sa, 0);
 
     SetHandleInformation(inPipeConhostSide, HANDLE_FLAG_INHERIT, 1);
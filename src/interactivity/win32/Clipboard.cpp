@@ -107,8 +107,8 @@ void Clipboard::StringPaste(_In_reads_(cchData) const wchar_t* const pData,
 
     try
     {
-        std::deque<std::unique_ptr<IInputEvent>> inEvents = TextToKeyEvents(pData, cchData);
-        gci.pInputBuffer->Write(inEvents);
+        const auto records = TextToInputRecords(pData, cchData);
+        gci.pInputBuffer->Write(records);
     }
     catch (...)
     {
@@ -132,10 +132,29 @@ void Clipboard::StringPaste(_In_reads_(cchData) const wchar_t* const pData,
 // - will throw exception on error
 std::deque<std::unique_ptr<IInputEvent>> Clipboard::TextToKeyEvents(_In_reads_(cchData) const wchar_t* const pData,
                                                                     const size_t cchData)
+{
+    const auto records = TextToInputRecords(pData, cchData);
+    return IInputEvent::Create(records);
+}
+
+// Routine Description:
+// - converts a wchar_t* into a series of key event records as if it was
+// typed from the keyboard
+// Arguments:
+// - pData - the text to convert
+// - cchData - the size of pData, in wchars
+// Return Value:
+// - the key event records that represent the string passed in
+// Note:
+// - will throw exception on error
+std::vector<INPUT_RECORD> Clipboard::TextToInputRecords(_In_reads_(cchData) const wchar_t* const pData,
+                                                        const size_t cchData)
 {
     THROW_IF_NULL_ALLOC(pData);
 
-    std::deque<std::unique_ptr<IInputEvent>> keyEvents;
+    std::vector<INPUT_RECORD> records;
+    // Most characters are typed with a key down and a key up.
+    records.reserve(cchData * 2);
 
     for (size_t i = 0; i < cchData; ++i)
     {
@@ -174,14 +193,9 @@ std::deque<std::unique_ptr<IInputEvent>> Clipboard::TextToKeyEvents(_In_reads_(c
         }
 
         const UINT codepage = ServiceLocator::LocateGlobals().getConsoleInformation().OutputCP;
-        std::deque<std::unique_ptr<KeyEvent>> convertedEvents = CharToKeyEvents(currentChar, codepage);
-        while (!convertedEvents.empty())
-        {
-            keyEvents.push_back(std::move(convertedEvents.front()));
-            convertedEvents.pop_front();
-        }
+        CharToKeyEvents(currentChar, codepage, records);
     }
-    return keyEvents;
+    return records;
 }
 
 // Routine Description:
@@ -221,9 +235,9 @@ void Clipboard::StoreSelectionToClipboard(bool const fAlsoCopyHtml)
 // - screenInfo - what is rendered on the screen
 // - lineSelection - true if entire line is being selected. False otherwise (box selection)
 // - selectionRects - the selection regions from which the data will be extracted from the buffer
-TextBuffer::TextAndColor Clipboard::RetrieveTextFromBuffer(const SCREEN_INFORMATION& screenInfo,
-                                                           const bool lineSelection,
-                                                           const std::vector<SMALL_RECT>& selectionRects)
+TextBuffer::TextAndColorRuns Clipboard::RetrieveTextFromBuffer(const SCREEN_INFORMATION& screenInfo,
+                                                               const bool lineSelection,
+                                                               const std::vector<SMALL_RECT>& selectionRects)
 {
     const auto& buffer = screenInfo.GetTextBuffer();
     const bool trimTrailingWhitespace = !WI_IsFlagSet(GetKeyState(VK_SHIFT), KEY_PRESSED);
@@ -232,26 +246,21 @@ TextBuffer::TextAndColor Clipboard::RetrieveTextFromBuffer(const SCREEN_INFORMAT
     std::function<COLORREF(TextAttribute&)> GetForegroundColor = std::bind(&CONSOLE_INFORMATION::LookupForegroundColor, &gci, std::placeholders::_1);
     std::function<COLORREF(TextAttribute&)> GetBackgroundColor = std::bind(&CONSOLE_INFORMATION::LookupBackgroundColor, &gci, std::placeholders::_1);
 
-    return buffer.GetTextForClipboard(lineSelection,
-                                      trimTrailingWhitespace,
-                                      selectionRects,
-                                      GetForegroundColor,
-                                      GetBackgroundColor);
+    return buffer.GetTextRunsForClipboard(lineSelection,
+                                          trimTrailingWhitespace,
+                                          selectionRects,
+                                          GetForegroundColor,
+                                          GetBackgroundColor);
 }
 
 // Routine Description:
 // - Copies the text given onto the global system clipboard.
 // Arguments:
 // - rows - Rows of text data to copy
-void Clipboard::CopyTextToSystemClipboard(const TextBuffer::TextAndColor& rows, bool const fAlsoCopyHtml)
+void Clipboard::CopyTextToSystemClipboard(const TextBuffer::TextAndColorRuns& rows, bool const fAlsoCopyHtml)
 {
-    std::wstring finalString;
-
-    // Concatenate strings into one giant string to put onto the clipboard.
-    for (const auto& str : rows.text)
-    {
-        finalString += str;
-    }
+    // The rows are already one giant string, ready to put onto the clipboard.
+    const auto& finalString = rows.text;
 
     // allocate the final clipboard data
     const size_t cchNeeded = finalString.size() + 1;
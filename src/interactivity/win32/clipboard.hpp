@@ -37,15 +37,16 @@ namespace Microsoft::Console::Interactivity::Win32
     private:
         std::deque<std::unique_ptr<IInputEvent>> TextToKeyEvents(_In_reads_(cchData) const wchar_t* const pData,
                                                                  const size_t cchData);
+        std::vector<INPUT_RECORD> TextToInputRecords(_In_reads_(cchData) const wchar_t* const pData,
+                                                     const size_t cchData);
 
         void StoreSelectionToClipboard(_In_ bool const fAlsoCopyHtml);
 
-        TextBuffer::TextAndColor RetrieveTextFromBuffer(const SCREEN_INFORMATION& screenInfo,
-                                                        const bool lineSelection,
-                                                        const std::vector<SMALL_RECT>& selectionRects);
+        TextBuffer::TextAndColorRuns RetrieveTextFromBuffer(const SCREEN_INFORMATION& screenInfo,
+                                                            const bool lineSelection,
+                                                            const std::vector<SMALL_RECT>& selectionRects);
 
-        void CopyHTMLToClipboard(const TextBuffer::TextAndColor& rows);
-        void CopyTextToSystemClipboard(const TextBuffer::TextAndColor& rows, _In_ bool const fAlsoCopyHtml);
+        void CopyTextToSystemClipboard(const TextBuffer::TextAndColorRuns& rows, _In_ bool const fAlsoCopyHtml);
 
         bool FilterCharacterOnPaste(_Inout_ WCHAR* const pwch);
 
@@ -13,6 +13,21 @@ RenderEngineBase::RenderEngineBase() :
 {
 }
 
+// Routine Description:
+// - Notifies us that the rows of part of the viewport moved up or down. Most
+//      engines can't move part of their frame, so by default, the whole
+//      region is simply redrawn.
+// Arguments:
+// - psrRegion - the rows that moved, including the ones that were uncovered,
+//      relative to the viewport.
+// - delta - the number of rows they moved down by. Negative if they moved up.
+// Return Value:
+// - S_OK, else an appropriate HRESULT for failing to invalidate.
+HRESULT RenderEngineBase::InvalidateScrollRegion(const SMALL_RECT* const psrRegion, const short /*delta*/) noexcept
+{
+    return Invalidate(psrRegion);
+}
+
 HRESULT RenderEngineBase::InvalidateTitle(const std::wstring& proposedTitle) noexcept
 {
     if (proposedTitle != _lastFrameTitle)
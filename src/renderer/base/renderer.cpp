@@ -139,6 +139,20 @@ void Renderer::_NotifyPaintFrame()
     _pThread->NotifyPaint();
 }
 
+// Routine Description:
+// - Asks for another frame to be painted, without invalidating anything. An
+//      engine with work left over from the last frame will find it then.
+//   Unlike the Trigger methods, this doesn't touch the engines, so it's safe
+//      to call from any thread, without holding the console lock.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Renderer::NotifyPaintFrame()
+{
+    _NotifyPaintFrame();
+}
+
 // Routine Description:
 // - Called when the system has requested we redraw a portion of the console.
 // Arguments:
@@ -344,6 +358,39 @@ void Renderer::TriggerScroll(const COORD* const pcoordDelta)
     _NotifyPaintFrame();
 }
 
+// Routine Description:
+// - Called when the rows of part of the buffer were moved up or down, like
+//      when text scrolls inside of the scroll margins.
+// - Engines that can move part of their frame can save a lot of work that way.
+//      If the region doesn't span the whole width of the viewport, it's just
+//      redrawn instead.
+// Arguments:
+// - region - The rows that moved, including the ones that were uncovered, in
+//      buffer coordinates.
+// - delta - The number of rows they moved down by. Negative if they moved up.
+// Return Value:
+// - <none>
+void Renderer::TriggerScrollRegion(const Viewport& region, const short delta)
+{
+    const Viewport view = _pData->GetViewport();
+    SMALL_RECT srUpdateRegion = region.ToExclusive();
+
+    if (region.Left() > view.Left() ||
+        region.RightInclusive() < view.RightInclusive() ||
+        !view.TrimToViewport(&srUpdateRegion))
+    {
+        TriggerRedraw(region);
+        return;
+    }
+
+    view.ConvertToOrigin(&srUpdateRegion);
+    std::for_each(_rgpEngines.begin(), _rgpEngines.end(), [&](IRenderEngine* const pEngine) {
+        LOG_IF_FAILED(pEngine->InvalidateScrollRegion(&srUpdateRegion, delta));
+    });
+
+    _NotifyPaintFrame();
+}
+
 // Routine Description:
 // - Called when the text buffer is about to circle its backing buffer.
 //      A renderer might want to get painted before that happens.
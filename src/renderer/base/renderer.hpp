@@ -46,6 +46,7 @@ namespace Microsoft::Console::Render
         virtual ~Renderer() override;
 
         [[nodiscard]] HRESULT PaintFrame();
+        void NotifyPaintFrame() override;
 
         void TriggerSystemRedraw(const RECT* const prcDirtyClient) override;
         void TriggerRedraw(const Microsoft::Console::Types::Viewport& region) override;
@@ -57,6 +58,7 @@ namespace Microsoft::Console::Render
         void TriggerSelection() override;
         void TriggerScroll() override;
         void TriggerScroll(const COORD* const pcoordDelta) override;
+        void TriggerScrollRegion(const Microsoft::Console::Types::Viewport& region, const short delta) override;
 
         void TriggerCircling() override;
         void TriggerTitleChange() override;
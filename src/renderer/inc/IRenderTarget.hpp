@@ -35,6 +35,7 @@ namespace Microsoft::Console::Render
         virtual void TriggerSelection() = 0;
         virtual void TriggerScroll() = 0;
         virtual void TriggerScroll(const COORD* const pcoordDelta) = 0;
+        virtual void TriggerScrollRegion(const Microsoft::Console::Types::Viewport& region, const short delta) = 0;
         virtual void TriggerCircling() = 0;
         virtual void TriggerTitleChange() = 0;
     };
@@ -27,6 +27,7 @@ namespace Microsoft::Console::Render
         virtual ~IRenderer() = 0;
 
         [[nodiscard]] virtual HRESULT PaintFrame() = 0;
+        virtual void NotifyPaintFrame() = 0;
 
         virtual void TriggerSystemRedraw(const RECT* const prcDirtyClient) = 0;
 
@@ -27,6 +27,8 @@ namespace Microsoft::Console::Render
         RenderEngineBase();
         virtual ~RenderEngineBase() = 0;
 
+        [[nodiscard]] HRESULT InvalidateScrollRegion(const SMALL_RECT* const psrRegion, const short delta) noexcept override;
+
         [[nodiscard]] HRESULT InvalidateTitle(const std::wstring& proposedTitle) noexcept override;
 
         [[nodiscard]] HRESULT UpdateTitle(const std::wstring& newTitle) noexcept override;
@@ -0,0 +1,264 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "ShadowBuffer.hpp"
+#include "../../inc/unicode.hpp"
+
+#pragma hdrstop
+using namespace Microsoft::Console::Render;
+
+ShadowBuffer::ShadowBuffer(const COORD size) :
+    _size{ 0, 0 }
+{
+    Resize(size);
+}
+
+// Method Description:
+// - Gets the dimensions of the buffer, in characters.
+COORD ShadowBuffer::GetSize() const noexcept
+{
+    return _size;
+}
+
+// Method Description:
+// - Changes the dimensions of the buffer. We have no idea what the terminal
+//      did with its contents when it was resized (it may well have reflowed
+//      them), so every cell is unknown afterwards.
+// Arguments:
+// - size: the new dimensions of the buffer, in characters.
+// Return Value:
+// - <none>
+void ShadowBuffer::Resize(const COORD size)
+{
+    const auto width = static_cast<size_t>(std::max<short>(size.X, 0));
+    const auto height = static_cast<size_t>(std::max<short>(size.Y, 0));
+    _cells.resize(width * height);
+    _size = size;
+    Invalidate();
+}
+
+// Method Description:
+// - Forgets everything we knew about the terminal's contents. Used when
+//      something was written to the terminal behind our back.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void ShadowBuffer::Invalidate() noexcept
+{
+    for (auto& cell : _cells)
+    {
+        cell.length = 0;
+    }
+}
+
+// Method Description:
+// - Marks every cell as blank, as it will be after the terminal erased the
+//      whole display.
+// Arguments:
+// - attributes: the attributes that were active when the display was erased.
+// Return Value:
+// - <none>
+void ShadowBuffer::Clear(const Attributes& attributes) noexcept
+{
+    std::fill(_cells.begin(), _cells.end(), _BlankCell(attributes));
+}
+
+// Method Description:
+// - Moves the rows of the buffer up or down, the same way the terminal will
+//      when we make it scroll. Rows that are scrolled in are blank.
+// Arguments:
+// - delta: the number of rows to move the contents by. Negative moves them
+//      up, as when a newline is written at the bottom of the viewport.
+//      Positive moves them down, as when lines are inserted at the top.
+// - attributes: the attributes of the blank rows that are scrolled in.
+// Return Value:
+// - <none>
+void ShadowBuffer::ScrollRows(const short delta, const Attributes& attributes) noexcept
+{
+    ScrollRows(0, _size.Y, delta, attributes);
+}
+
+// Method Description:
+// - Moves some of the rows of the buffer up or down, the same way the
+//      terminal will when we make it scroll within its margins. Rows outside
+//      of the region are left alone.
+// Arguments:
+// - top: the first row of the region.
+// - bottom: the row following the last row of the region.
+// - delta: the number of rows to move the contents of the region by. Negative
+//      moves them up, positive moves them down.
+// - attributes: the attributes of the blank rows that are scrolled in.
+// Return Value:
+// - <none>
+void ShadowBuffer::ScrollRows(const short top, const short bottom, const short delta, const Attributes& attributes) noexcept
+{
+    const auto first = std::clamp<short>(top, 0, _size.Y);
+    const auto last = std::clamp<short>(bottom, first, _size.Y);
+    const auto begin = _cells.begin() + static_cast<size_t>(first) * _size.X;
+    const auto end = _cells.begin() + static_cast<size_t>(last) * _size.X;
+
+    const auto absDelta = static_cast<short>(abs(delta));
+    if (absDelta >= last - first)
+    {
+        std::fill(begin, end, _BlankCell(attributes));
+        return;
+    }
+
+    const auto shift = static_cast<size_t>(absDelta) * _size.X;
+    if (delta < 0)
+    {
+        std::move(begin + shift, end, begin);
+        std::fill(end - shift, end, _BlankCell(attributes));
+    }
+    else if (delta > 0)
+    {
+        std::move_backward(begin, end - shift, end);
+        std::fill(begin, begin + shift, _BlankCell(attributes));
+    }
+}
+
+// Method Description:
+// - Checks if the terminal is already displaying the given cluster, with the
+//      given attributes, at the given position.
+//  The foreground color and boldness of a space can't be seen, so those are
+//      ignored when comparing spaces.
+// Arguments:
+// - coord: the position of the cluster, relative to the viewport.
+// - cluster: the text and width of the cluster.
+// - attributes: the attributes the cluster should be drawn with.
+// Return Value:
+// - true if there's no need to draw the cluster again.
+bool ShadowBuffer::Matches(const COORD coord, const Cluster& cluster, const Attributes& attributes) const noexcept
+{
+    const auto cell = _GetCell(coord);
+    if (cell == nullptr || cell->length == 0)
+    {
+        return false;
+    }
+
+    const auto& text = cluster.GetText();
+    if (text.size() != cell->length ||
+        text.front() != cell->text[0] ||
+        (cell->length > 1 && text.at(1) != cell->text[1]))
+    {
+        return false;
+    }
+
+    if (cell->columns != cluster.GetColumns())
+    {
+        return false;
+    }
+
+    if (cell->columns == 2)
+    {
+        const auto trailing = _GetCell({ static_cast<short>(coord.X + 1), coord.Y });
+        if (trailing == nullptr || trailing->length == 0 || trailing->columns != 0)
+        {
+            return false;
+        }
+    }
+
+    const auto& existing = cell->attributes;
+    if (existing.background != attributes.background ||
+        existing.isUnderlined != attributes.isUnderlined)
+    {
+        return false;
+    }
+
+    return (text.front() == UNICODE_SPACE && cell->length == 1) ||
+           (existing.foreground == attributes.foreground && existing.isBold == attributes.isBold);
+}
+
+// Method Description:
+// - Records that the given cluster was drawn at the given position.
+// Arguments:
+// - coord: the position of the cluster, relative to the viewport.
+// - cluster: the text and width of the cluster.
+// - attributes: the attributes the cluster was drawn with.
+// Return Value:
+// - <none>
+void ShadowBuffer::Set(const COORD coord, const Cluster& cluster, const Attributes& attributes) noexcept
+{
+    const auto& text = cluster.GetText();
+    const auto columns = static_cast<BYTE>(std::clamp<size_t>(cluster.GetColumns(), 1, 2));
+
+    Cell cell{};
+    cell.columns = columns;
+    cell.attributes = attributes;
+    if (!text.empty() && text.size() <= ARRAYSIZE(cell.text))
+    {
+        std::copy(text.begin(), text.end(), cell.text);
+        cell.length = static_cast<BYTE>(text.size());
+    }
+    _Store(coord, cell);
+
+    if (columns == 2)
+    {
+        Cell trailing{};
+        trailing.length = cell.length;
+        trailing.columns = 0;
+        trailing.attributes = attributes;
+        _Store({ static_cast<short>(coord.X + 1), coord.Y }, trailing);
+    }
+}
+
+ShadowBuffer::Cell* ShadowBuffer::_GetCell(const COORD coord) noexcept
+{
+    if (coord.X < 0 || coord.Y < 0 || coord.X >= _size.X || coord.Y >= _size.Y)
+    {
+        return nullptr;
+    }
+    return &_cells.at(static_cast<size_t>(coord.Y) * _size.X + coord.X);
+}
+
+const ShadowBuffer::Cell* ShadowBuffer::_GetCell(const COORD coord) const noexcept
+{
+    return const_cast<ShadowBuffer*>(this)->_GetCell(coord);
+}
+
+void ShadowBuffer::_Forget(const COORD coord) noexcept
+{
+    if (const auto cell = _GetCell(coord))
+    {
+        cell->length = 0;
+    }
+}
+
+// Method Description:
+// - Overwrites a single cell. If that splits a double-wide glyph in two, the
+//      terminal will have erased (or mangled) the other half of it, so we
+//      forget what's in the neighboring cell.
+void ShadowBuffer::_Store(const COORD coord, const Cell& cell) noexcept
+{
+    const auto existing = _GetCell(coord);
+    if (existing == nullptr)
+    {
+        return;
+    }
+
+    if (existing->length != 0)
+    {
+        if (existing->columns == 0 && cell.columns != 0)
+        {
+            _Forget({ static_cast<short>(coord.X - 1), coord.Y });
+        }
+        else if (existing->columns == 2)
+        {
+            _Forget({ static_cast<short>(coord.X + 1), coord.Y });
+        }
+    }
+
+    *existing = cell;
+}
+
+ShadowBuffer::Cell ShadowBuffer::_BlankCell(const Attributes& attributes) noexcept
+{
+    Cell cell{};
+    cell.text[0] = UNICODE_SPACE;
+    cell.length = 1;
+    cell.columns = 1;
+    cell.attributes = attributes;
+    return cell;
+}
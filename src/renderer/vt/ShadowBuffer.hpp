@@ -0,0 +1,76 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- ShadowBuffer.hpp
+
+Abstract:
+- A copy of what the VT engine believes the terminal on the other end of the
+    pipe is currently displaying, cell by cell.
+- The xterm engines compare each line they're asked to paint against this
+    buffer, and only emit the cells that actually changed, so that repainting
+    a mostly-static screen doesn't resend the whole screen.
+- Cells the engine can't be sure about (before the first paint, after a
+    resize, after text was passed through straight to the terminal) are marked
+    unknown, and never compare equal to anything.
+--*/
+
+#pragma once
+
+#include "../inc/Cluster.hpp"
+
+namespace Microsoft::Console::Render
+{
+    class ShadowBuffer final
+    {
+    public:
+        // The subset of the text attributes that the xterm engines emit.
+        struct Attributes
+        {
+            COLORREF foreground;
+            COLORREF background;
+            bool isBold;
+            bool isUnderlined;
+        };
+
+        ShadowBuffer(const COORD size);
+
+        COORD GetSize() const noexcept;
+        void Resize(const COORD size);
+
+        void Invalidate() noexcept;
+        void Clear(const Attributes& attributes) noexcept;
+        void ScrollRows(const short delta, const Attributes& attributes) noexcept;
+        void ScrollRows(const short top, const short bottom, const short delta, const Attributes& attributes) noexcept;
+
+        bool Matches(const COORD coord, const Cluster& cluster, const Attributes& attributes) const noexcept;
+        void Set(const COORD coord, const Cluster& cluster, const Attributes& attributes) noexcept;
+
+    private:
+        struct Cell
+        {
+            // Clusters of up to a surrogate pair are stored inline. Anything
+            //      longer (combining marks, etc.) is stored as unknown, and
+            //      will simply be repainted every time.
+            wchar_t text[2];
+            // The number of wchar_ts in text. 0 if we don't know what the
+            //      terminal has in this cell.
+            BYTE length;
+            // 1 or 2 for the leading cell of a glyph, 0 for the trailing half
+            //      of a double-wide glyph.
+            BYTE columns;
+            Attributes attributes;
+        };
+
+        COORD _size;
+        std::vector<Cell> _cells;
+
+        Cell* _GetCell(const COORD coord) noexcept;
+        const Cell* _GetCell(const COORD coord) const noexcept;
+        void _Forget(const COORD coord) noexcept;
+        void _Store(const COORD coord, const Cell& cell) noexcept;
+
+        static Cell _BlankCell(const Attributes& attributes) noexcept;
+    };
+}
@@ -8,6 +8,81 @@
 #pragma hdrstop
 using namespace Microsoft::Console::Render;
 
+// Function Description:
+// - Writes the decimal representation of the given value to out.
+// Arguments:
+// - out: the buffer to write the digits to. Needs room for at least 11 chars.
+// - value: the value to format.
+// Return Value:
+// - A pointer to the char following the last digit written.
+static char* _FormatDecimal(char* out, const int value) noexcept
+{
+    unsigned int remaining = static_cast<unsigned int>(value);
+    if (value < 0)
+    {
+        *out++ = '-';
+        remaining = 0u - remaining;
+    }
+
+    // Fill the digits in backwards, then copy them out in the right order.
+    char digits[10];
+    size_t count = 0;
+    do
+    {
+        digits[count++] = static_cast<char>('0' + (remaining % 10));
+        remaining /= 10;
+    } while (remaining != 0);
+
+    while (count > 0)
+    {
+        *out++ = digits[--count];
+    }
+    return out;
+}
+
+// Method Description:
+// - Formats and writes a CSI sequence with the given numeric parameters. The
+//      sequence is formatted on the stack, so this never allocates. The size
+//      of the stack buffer is determined by the number of parameters at
+//      compile time.
+//   The resulting sequence is "ESC [ <prefix><p1>;<p2>;...<finalChar>"
+// Arguments:
+// - prefix: any fixed parameters that precede the numeric ones, including
+//      their trailing ';' (e.g. "38;2;" for an RGB foreground color)
+// - finalChar: the final character of the sequence.
+// - params: the numeric parameters of the sequence.
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+template<typename... Params>
+[[nodiscard]] HRESULT VtEngine::_WriteCsiSequence(const std::string_view prefix,
+                                                  const char finalChar,
+                                                  const Params... params) noexcept
+{
+    static_assert(sizeof...(Params) > 0, "Use _Write for sequences without parameters.");
+    static constexpr size_t maxPrefixLength = 8;
+    // ESC [, the prefix, up to 11 chars and a separator per param, and the final char.
+    std::array<char, 2 + maxPrefixLength + sizeof...(Params) * 12 + 1> seq;
+    RETURN_HR_IF(E_INVALIDARG, prefix.size() > maxPrefixLength);
+
+    char* out = seq.data();
+    *out++ = '\x1b';
+    *out++ = '[';
+    out = std::copy(prefix.cbegin(), prefix.cend(), out);
+
+    const int values[] = { static_cast<int>(params)... };
+    for (size_t i = 0; i < sizeof...(Params); i++)
+    {
+        if (i > 0)
+        {
+            *out++ = ';';
+        }
+        out = _FormatDecimal(out, values[i]);
+    }
+    *out++ = finalChar;
+
+    return _Write({ seq.data(), static_cast<size_t>(out - seq.data()) });
+}
+
 // Method Description:
 // - Formats and writes a sequence to stop the cursor from blinking.
 // Arguments:
@@ -81,9 +156,19 @@ using namespace Microsoft::Console::Render;
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
 [[nodiscard]] HRESULT VtEngine::_EraseCharacter(const short chars) noexcept
 {
-    static const std::string format = "\x1b[%dX";
+    return _WriteCsiSequence({}, 'X', chars);
+}
 
-    return _WriteFormattedString(&format, chars);
+// Method Description:
+// - Formats and writes a sequence to repeat the last graphic character that
+//      was written a number of times, as if it had been written out again.
+// Arguments:
+// - chars: the number of additional times to write the previous character.
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]] HRESULT VtEngine::_RepeatCharacter(const short chars) noexcept
+{
+    return _WriteCsiSequence({}, 'b', chars);
 }
 
 // Method Description:
@@ -94,9 +179,7 @@ using namespace Microsoft::Console::Render;
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
 [[nodiscard]] HRESULT VtEngine::_CursorForward(const short chars) noexcept
 {
-    static const std::string format = "\x1b[%dC";
-
-    return _WriteFormattedString(&format, chars);
+    return _WriteCsiSequence({}, 'C', chars);
 }
 
 // Method Description:
@@ -129,9 +212,7 @@ using namespace Microsoft::Console::Render;
     {
         return _Write(fInsertLine ? "\x1b[L" : "\x1b[M");
     }
-    const std::string format = fInsertLine ? "\x1b[%dL" : "\x1b[%dM";
-
-    return _WriteFormattedString(&format, sLines);
+    return _WriteCsiSequence({}, fInsertLine ? 'L' : 'M', sLines);
 }
 
 // Method Description:
@@ -158,6 +239,66 @@ using namespace Microsoft::Console::Render;
     return _InsertDeleteLine(sLines, true);
 }
 
+// Method Description:
+// - Formats and writes a sequence to scroll the contents of the scrolling
+//      region up by a number of lines. New blank lines appear at the bottom.
+// Arguments:
+// - sLines: a number of lines to scroll by
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]] HRESULT VtEngine::_ScrollUp(const short sLines) noexcept
+{
+    if (sLines == 1)
+    {
+        return _Write("\x1b[S");
+    }
+    return _WriteCsiSequence({}, 'S', sLines);
+}
+
+// Method Description:
+// - Formats and writes a sequence to scroll the contents of the scrolling
+//      region down by a number of lines. New blank lines appear at the top.
+// Arguments:
+// - sLines: a number of lines to scroll by
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]] HRESULT VtEngine::_ScrollDown(const short sLines) noexcept
+{
+    if (sLines == 1)
+    {
+        return _Write("\x1b[T");
+    }
+    return _WriteCsiSequence({}, 'T', sLines);
+}
+
+// Method Description:
+// - Formats and writes a sequence to set the top and bottom margins of the
+//      scrolling region (DECSTBM). Note that this also moves the cursor to
+//      the origin. The input rows should be in console coordinates, where
+//      origin=(0,0).
+// Arguments:
+// - sTop: the first row of the scrolling region.
+// - sBottom: the last row of the scrolling region (inclusive).
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]] HRESULT VtEngine::_SetScrollingRegion(const short sTop, const short sBottom) noexcept
+{
+    // VT coords start at 1,1
+    return _WriteCsiSequence({}, 'r', sTop + 1, sBottom + 1);
+}
+
+// Method Description:
+// - Formats and writes a sequence to reset the scrolling region to the whole
+//      screen. Like setting it, this moves the cursor to the origin.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]] HRESULT VtEngine::_ResetScrollingRegion() noexcept
+{
+    return _Write("\x1b[r");
+}
+
 // Method Description:
 // - Formats and writes a sequence to move the cursor to the specified
 //      coordinate position. The input coord should be in console coordinates,
@@ -168,14 +309,12 @@ using namespace Microsoft::Console::Render;
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
 [[nodiscard]] HRESULT VtEngine::_CursorPosition(const COORD coord) noexcept
 {
-    static const std::string cursorFormat = "\x1b[%d;%dH";
-
     // VT coords start at 1,1
     COORD coordVt = coord;
     coordVt.X++;
     coordVt.Y++;
 
-    return _WriteFormattedString(&cursorFormat, coordVt.Y, coordVt.X);
+    return _WriteCsiSequence({}, 'H', coordVt.Y, coordVt.X);
 }
 
 // Method Description:
@@ -197,8 +336,7 @@ using namespace Microsoft::Console::Render;
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
 [[nodiscard]] HRESULT VtEngine::_SetGraphicsBoldness(const bool isBold) noexcept
 {
-    const std::string fmt = isBold ? "\x1b[1m" : "\x1b[22m";
-    return _Write(fmt);
+    return _Write(isBold ? "\x1b[1m" : "\x1b[22m");
 }
 
 // Method Description:
@@ -222,8 +360,6 @@ using namespace Microsoft::Console::Render;
 [[nodiscard]] HRESULT VtEngine::_SetGraphicsRendition16Color(const WORD wAttr,
                                                              const bool fIsForeground) noexcept
 {
-    static const std::string fmt = "\x1b[%dm";
-
     // Always check using the foreground flags, because the bg flags constants
     //  are a higher byte
     // Foreground sequences are in [30,37] U [90,97]
@@ -243,7 +379,7 @@ using namespace Microsoft::Console::Render;
                         (WI_IsFlagSet(wAttr, FOREGROUND_GREEN) ? 2 : 0) +
                         (WI_IsFlagSet(wAttr, FOREGROUND_BLUE) ? 4 : 0);
 
-    return _WriteFormattedString(&fmt, vtIndex);
+    return _WriteCsiSequence({}, 'm', vtIndex);
 }
 
 // Method Description:
@@ -257,15 +393,11 @@ using namespace Microsoft::Console::Render;
 [[nodiscard]] HRESULT VtEngine::_SetGraphicsRenditionRGBColor(const COLORREF color,
                                                               const bool fIsForeground) noexcept
 {
-    const std::string fmt = fIsForeground ?
-                                "\x1b[38;2;%d;%d;%dm" :
-                                "\x1b[48;2;%d;%d;%dm";
-
     DWORD const r = GetRValue(color);
     DWORD const g = GetGValue(color);
     DWORD const b = GetBValue(color);
 
-    return _WriteFormattedString(&fmt, r, g, b);
+    return _WriteCsiSequence(fIsForeground ? "38;2;" : "48;2;", 'm', r, g, b);
 }
 
 // Method Description:
@@ -277,9 +409,7 @@ using namespace Microsoft::Console::Render;
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
 [[nodiscard]] HRESULT VtEngine::_SetGraphicsRenditionDefaultColor(const bool fIsForeground) noexcept
 {
-    const std::string fmt = fIsForeground ? ("\x1b[39m") : ("\x1b[49m");
-
-    return _Write(fmt);
+    return _Write(fIsForeground ? "\x1b[39m" : "\x1b[49m");
 }
 
 // Method Description:
@@ -291,13 +421,12 @@ using namespace Microsoft::Console::Render;
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
 [[nodiscard]] HRESULT VtEngine::_ResizeWindow(const short sWidth, const short sHeight) noexcept
 {
-    static const std::string resizeFormat = "\x1b[8;%d;%dt";
     if (sWidth < 0 || sHeight < 0)
     {
         return E_INVALIDARG;
     }
 
-    return _WriteFormattedString(&resizeFormat, sHeight, sWidth);
+    return _WriteCsiSequence("8;", 't', sHeight, sWidth);
 }
 
 // Method Description:
@@ -312,6 +441,18 @@ using namespace Microsoft::Console::Render;
     return _Write("\x1b[6n");
 }
 
+// Method Description:
+// - Formats and writes a sequence to ask the end terminal to wrap pasted text
+//      in ESC[200~ and ESC[201~ when it sends it to us on the vt input handle.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]] HRESULT VtEngine::_EnableBracketedPaste() noexcept
+{
+    return _Write("\x1b[?2004h");
+}
+
 // Method Description:
 // - Formats and writes a sequence to change the terminal's title string
 // Arguments:
@@ -3,6 +3,8 @@
 
 #include "precomp.h"
 #include "XtermEngine.hpp"
+#include "../../inc/conattrs.hpp"
+#include "../../inc/unicode.hpp"
 #include "../../types/inc/convert.hpp"
 #pragma hdrstop
 using namespace Microsoft::Console;
@@ -21,7 +23,11 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
     _fUseAsciiOnly(fUseAsciiOnly),
     _previousLineWrapped(false),
     _usingUnderLine(false),
-    _needToDisableCursor(false)
+    _needToDisableCursor(false),
+    _shadow(initialViewport.Dimensions()),
+    _scrollRegionTop(0),
+    _scrollRegionBottom(0),
+    _scrollRegionDelta(0)
 {
     // Set out initial cursor position to -1, -1. This will force our initial
     //      paint to manually move the cursor to 0, 0, not just ignore it.
@@ -42,8 +48,27 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
 {
     RETURN_IF_FAILED(VtEngine::StartPaint());
 
+    // If the terminal hasn't finished reading the last frame yet, hold off on
+    //      this one entirely. We'll be asked to paint again once it has.
+    if (_writerBackpressure)
+    {
+        return S_FALSE;
+    }
+
     _trace.TraceLastText(_lastText);
 
+    // If our viewport changed size, then so did the terminal, and we can't be
+    //      sure what it's displaying anymore.
+    const auto size = _lastViewport.Dimensions();
+    if (size.X != _shadow.GetSize().X || size.Y != _shadow.GetSize().Y)
+    {
+        try
+        {
+            _shadow.Resize(size);
+        }
+        CATCH_RETURN();
+    }
+
     if (_firstPaint)
     {
         // MSFT:17815688
@@ -53,6 +78,7 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
         //      terminal's state is consistent with what we'll be rendering.
         RETURN_IF_FAILED(_ClearScreen());
         _clearedAllThisFrame = true;
+        _shadow.Clear(_GetShadowAttributes());
         _firstPaint = false;
     }
     else
@@ -67,6 +93,7 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
             // solution, see that work item for a description why.
             RETURN_IF_FAILED(_ClearScreen());
             _clearedAllThisFrame = true;
+            _shadow.Clear(_GetShadowAttributes());
         }
     }
 
@@ -212,27 +239,23 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
             }
             else
             {
-                std::string seq = "\r\n";
-                hr = _Write(seq);
+                hr = _Write("\r\n");
             }
         }
         else if (coord.X == 0 && coord.Y == _lastText.Y)
         {
             // Start of this line
-            std::string seq = "\r";
-            hr = _Write(seq);
+            hr = _Write("\r");
         }
         else if (coord.X == _lastText.X && coord.Y == (_lastText.Y + 1))
         {
             // Down one line, same X position
-            std::string seq = "\n";
-            hr = _Write(seq);
+            hr = _Write("\n");
         }
         else if (coord.X == (_lastText.X - 1) && coord.Y == (_lastText.Y))
         {
             // Back one char, same Y position
-            std::string seq = "\b";
-            hr = _Write(seq);
+            hr = _Write("\b");
         }
         else if (coord.Y == _lastText.Y && coord.X > _lastText.X)
         {
@@ -272,6 +295,13 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
 [[nodiscard]] HRESULT XtermEngine::ScrollFrame() noexcept
 {
+    // A scroll region is only ever pending when the whole viewport isn't
+    //      scrolling too, see InvalidateScrollRegion.
+    if (_scrollRegionDelta != 0)
+    {
+        return _ScrollRegion();
+    }
+
     if (_scrollDelta.X != 0)
     {
         // No easy way to shift left-right. Everything needs repainting.
@@ -297,12 +327,15 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
         hr = _MoveCursor({ 0, bottom });
         if (SUCCEEDED(hr))
         {
-            std::string seq = std::string(absDy, '\n');
-            hr = _Write(seq);
+            hr = _WriteFill(absDy, '\n');
             // Mark that the bottom line is new, so we won't spend time with an
             // ECH on it.
             _newBottomLine = true;
         }
+        if (SUCCEEDED(hr))
+        {
+            _shadow.ScrollRows(dy, _GetShadowAttributes());
+        }
         // We don't need to _MoveCursor the cursor again, because it's still
         //      at the bottom of the viewport.
     }
@@ -315,6 +348,10 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
         {
             hr = _InsertLine(absDy);
         }
+        if (SUCCEEDED(hr))
+        {
+            _shadow.ScrollRows(dy, _GetShadowAttributes());
+        }
     }
 
     return hr;
@@ -336,6 +373,10 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
 
     if (dx != 0 || dy != 0)
     {
+        // The region scrolled before the viewport did, but ScrollFrame can
+        //      only move the viewport first, so give up on the region.
+        RETURN_IF_FAILED(_CancelScrollRegion());
+
         // Scroll the current offset
         RETURN_IF_FAILED(_InvalidOffset(pcoordDelta));
 
@@ -363,10 +404,141 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
     return S_OK;
 }
 
+// Routine Description:
+// - Notifies us that the rows of part of the viewport moved up or down, like
+//      when text scrolls within the margins an application set with DECSTBM.
+//  Rather than repainting the whole region, we'll set the terminal's margins
+//      to the region in ScrollFrame, and scroll it with SU or SD. Only the
+//      uncovered rows are added to the invalid area.
+//  We can only keep track of one region at a time, and it can't be combined
+//      with scrolling the whole viewport, so in those cases (and for the
+//      telnet client, which doesn't know about margins) the region is simply
+//      invalidated instead. The same goes for any terminal we haven't been
+//      told supports scrolling margins (see SetScrollMarginsSupported), since
+//      the shadow buffer would no longer match what it's showing if it
+//      ignored them.
+// Arguments:
+// - psrRegion - the rows that moved, including the ones that were uncovered,
+//      relative to the viewport.
+// - delta - the number of rows they moved down by. Negative if they moved up.
+// Return Value:
+// - S_OK, else an appropriate HRESULT for failing to allocate or safemath failure.
+[[nodiscard]] HRESULT XtermEngine::InvalidateScrollRegion(const SMALL_RECT* const psrRegion, const short delta) noexcept
+{
+    const auto region = Viewport::FromExclusive(*psrRegion);
+    if (delta == 0 || !region.IsValid())
+    {
+        return S_OK;
+    }
+
+    const bool samePendingRegion = _scrollRegionDelta == 0 ||
+                                   (region.Top() == _scrollRegionTop && region.BottomExclusive() == _scrollRegionBottom);
+    if (!_scrollMarginsSupported ||
+        _fUseAsciiOnly ||
+        _scrollDelta.X != 0 ||
+        _scrollDelta.Y != 0 ||
+        !samePendingRegion ||
+        region.Left() > 0 ||
+        region.RightExclusive() < _lastViewport.Width() ||
+        region.Top() < _virtualTop)
+    {
+        return Invalidate(psrRegion);
+    }
+
+    short newDelta;
+    RETURN_IF_FAILED(ShortAdd(_scrollRegionDelta, delta, &newDelta));
+    if (abs(newDelta) >= region.Height())
+    {
+        // Everything in the region has been replaced anyways.
+        _scrollRegionDelta = 0;
+        return Invalidate(psrRegion);
+    }
+
+    try
+    {
+        const auto width = _lastViewport.Width();
+
+        // Whatever was already invalid in the region moves along with it.
+        if (_fInvalidRectUsed)
+        {
+            const auto invalidInRegion = Viewport::Intersect(_invalidRect, region);
+            if (invalidInRegion.IsValid())
+            {
+                const auto moved = Viewport::Intersect(Viewport::Offset(invalidInRegion, { 0, delta }), region);
+                if (moved.IsValid())
+                {
+                    RETURN_IF_FAILED(_InvalidCombine(moved));
+                }
+            }
+        }
+
+        // Then add the rows that were uncovered.
+        const auto uncoveredTop = static_cast<short>(delta > 0 ? region.Top() : region.BottomExclusive() + delta);
+        RETURN_IF_FAILED(_InvalidCombine(Viewport::FromDimensions({ 0, uncoveredTop }, width, static_cast<short>(abs(delta)))));
+    }
+    CATCH_RETURN();
+
+    _scrollRegionTop = region.Top();
+    _scrollRegionBottom = region.BottomExclusive();
+    _scrollRegionDelta = newDelta;
+    return S_OK;
+}
+
+// Routine Description:
+// - Scrolls the pending scroll region of the terminal by the delta we've
+//      accumulated through InvalidateScrollRegion since the last frame. The
+//      margins are set to the region, and reset after scrolling it, which
+//      leaves the cursor at the origin.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]] HRESULT XtermEngine::_ScrollRegion() noexcept
+{
+    const short dy = _scrollRegionDelta;
+    const short absDy = static_cast<short>(abs(dy));
+    _scrollRegionDelta = 0;
+
+    _needToDisableCursor = true;
+    RETURN_IF_FAILED(_SetScrollingRegion(_scrollRegionTop, static_cast<short>(_scrollRegionBottom - 1)));
+    RETURN_IF_FAILED(dy < 0 ? _ScrollUp(absDy) : _ScrollDown(absDy));
+    RETURN_IF_FAILED(_ResetScrollingRegion());
+    _lastText = { 0, 0 };
+    _deferredCursorPos = INVALID_COORDS;
+
+    _shadow.ScrollRows(_scrollRegionTop, _scrollRegionBottom, dy, _GetShadowAttributes());
+    return S_OK;
+}
+
+// Routine Description:
+// - Forgets about the pending scroll region, and invalidates all of it
+//      instead, so it will be repainted the normal way.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK, else an appropriate HRESULT for failing to allocate.
+[[nodiscard]] HRESULT XtermEngine::_CancelScrollRegion() noexcept
+{
+    if (_scrollRegionDelta == 0)
+    {
+        return S_OK;
+    }
+
+    _scrollRegionDelta = 0;
+    SMALL_RECT region = _lastViewport.ToOrigin().ToExclusive();
+    region.Top = _scrollRegionTop;
+    region.Bottom = _scrollRegionBottom;
+    return Invalidate(&region);
+}
+
 // Routine Description:
 // - Draws one line of the buffer to the screen. Writes the characters to the
 //      pipe, encoded in UTF-8 or ASCII only, depending on the VtIoMode.
 //      (See descriptions of both implementations for details.)
+//  In UTF-8 mode, only the cells that differ from what the terminal is
+//      already displaying are written. The inbox telnet client (which uses
+//      xterm-ascii) doesn't understand the ECH and REP sequences that relies
+//      on, so the ASCII path always writes the whole line.
 // Arguments:
 // - clusters - text and column counts for each piece of text.
 // - coord - character coordinate target to render within viewport
@@ -379,20 +551,281 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
                                                    const COORD coord,
                                                    const bool /*trimLeft*/) noexcept
 {
-    return _fUseAsciiOnly ?
-               VtEngine::_PaintAsciiBufferLine(clusters, coord) :
-               VtEngine::_PaintUtf8BufferLine(clusters, coord);
+    if (_DeferBufferLine(clusters, coord))
+    {
+        return S_OK;
+    }
+
+    const auto bytesBefore = _frameBytes;
+    const auto hr = _fUseAsciiOnly ?
+                        VtEngine::_PaintAsciiBufferLine(clusters, coord) :
+                        _PaintChangedClusters(clusters, coord);
+    _AccountBufferLine(coord, bytesBefore);
+    return hr;
+}
+
+// Routine Description:
+// - Gets the number of bytes the given text will take up once it's been
+//      encoded as UTF-8.
+static size_t _Utf8Length(const std::wstring_view text) noexcept
+{
+    size_t length = 0;
+    for (const auto ch : text)
+    {
+        // Each half of a surrogate pair accounts for half of its 4 bytes.
+        length += ch < 0x80 ? 1 : (ch < 0x800 || IS_HIGH_SURROGATE(ch) || IS_LOW_SURROGATE(ch)) ? 2 : 3;
+    }
+    return length;
+}
+
+// Routine Description:
+// - Gets the number of bytes in a CSI sequence with a single parameter, like
+//      "\x1b[12C".
+static size_t _CsiSequenceLength(size_t parameter) noexcept
+{
+    size_t digits = 1;
+    while (parameter >= 10)
+    {
+        parameter /= 10;
+        digits++;
+    }
+    return 3 + digits;
+}
+
+// Routine Description:
+// - Gets the attributes that text written right now would be displayed with,
+//      for comparing against and recording in the shadow buffer.
+// Arguments:
+// - <none>
+// Return Value:
+// - the current attributes.
+ShadowBuffer::Attributes XtermEngine::_GetShadowAttributes() const noexcept
+{
+    // Until we've emitted any colors, the terminal is using its defaults.
+    const auto foreground = _LastFG == INVALID_COLOR ? _colorProvider.GetDefaultForeground() : _LastFG;
+    const auto background = _LastBG == INVALID_COLOR ? _colorProvider.GetDefaultBackground() : _LastBG;
+    return { foreground, background, _lastWasBold, _usingUnderLine };
+}
+
+// Routine Description:
+// - Draws one line of the buffer, skipping over the cells the terminal is
+//      already displaying (according to the shadow buffer). Unchanged cells
+//      between two changed ones are either skipped with a cursor movement,
+//      or written out again, whichever takes fewer bytes.
+// Arguments:
+// - clusters - text and column counts for each piece of text.
+// - coord - character coordinate target to render within viewport
+// Return Value:
+// - S_OK or suitable HRESULT error from writing pipe.
+[[nodiscard]] HRESULT XtermEngine::_PaintChangedClusters(std::basic_string_view<Cluster> const clusters,
+                                                         const COORD coord) noexcept
+{
+    if (coord.Y < _virtualTop)
+    {
+        return S_OK;
+    }
+
+    const auto attributes = _GetShadowAttributes();
+    const auto unchanged = [&](const size_t index, const short x) noexcept {
+        return _shadow.Matches({ x, coord.Y }, clusters.at(index), attributes);
+    };
+    const auto columns = [&](const size_t index) noexcept {
+        return static_cast<short>(clusters.at(index).GetColumns());
+    };
+
+    size_t index = 0;
+    short x = coord.X;
+    while (index < clusters.size())
+    {
+        // Skip over everything the terminal already has.
+        if (unchanged(index, x))
+        {
+            x += columns(index);
+            index++;
+            continue;
+        }
+
+        // Find the end of this run of changes. If there's another change
+        //      shortly after it, it's cheaper to write out the unchanged
+        //      clusters in between than to move the cursor over them with CUF.
+        const size_t spanStart = index;
+        const short spanX = x;
+        while (index < clusters.size())
+        {
+            if (!unchanged(index, x))
+            {
+                x += columns(index);
+                index++;
+                continue;
+            }
+
+            size_t gapEnd = index;
+            short gapX = x;
+            size_t gapBytes = 0;
+            while (gapEnd < clusters.size() && unchanged(gapEnd, gapX))
+            {
+                gapBytes += _Utf8Length(clusters.at(gapEnd).GetText());
+                gapX += columns(gapEnd);
+                gapEnd++;
+            }
+
+            if (gapEnd == clusters.size() || gapBytes > _CsiSequenceLength(gapX - x))
+            {
+                break;
+            }
+            index = gapEnd;
+            x = gapX;
+        }
+
+        RETURN_IF_FAILED(_PaintClusterSpan(clusters.substr(spanStart, index - spanStart), { spanX, coord.Y }));
+    }
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Writes out a span of clusters at the given position, and records them in
+//      the shadow buffer.
+//  A run of the same character is written once and then repeated with REP,
+//      when that's shorter. A run of spaces at the end of the span is erased
+//      with ECH instead, when that's shorter still.
+// Arguments:
+// - clusters - text and column counts for each piece of text.
+// - coord - character coordinate target to render within viewport
+// Return Value:
+// - S_OK or suitable HRESULT error from writing pipe.
+[[nodiscard]] HRESULT XtermEngine::_PaintClusterSpan(std::basic_string_view<Cluster> const clusters,
+                                                     const COORD coord) noexcept
+{
+    RETURN_IF_FAILED(_MoveCursor(coord));
+
+    const auto attributes = _GetShadowAttributes();
+
+    short totalWidth = 0;
+    for (const auto& cluster : clusters)
+    {
+        RETURN_IF_FAILED(ShortAdd(totalWidth, static_cast<short>(cluster.GetColumns()), &totalWidth));
+    }
+
+    // literalStart is the first cluster we haven't written yet. Everything
+    //      from there up to the current cluster is written in one go, when
+    //      we either reach a run worth compressing or the end of the span.
+    size_t literalStart = 0;
+    size_t index = 0;
+    short numErased = 0;
+    while (index < clusters.size())
+    {
+        const auto& text = clusters.at(index).GetText();
+
+        // Only single, narrow characters can be repeated with REP.
+        size_t run = 1;
+        if (text.size() == 1 && clusters.at(index).GetColumns() == 1)
+        {
+            while (index + run < clusters.size() &&
+                   clusters.at(index + run).GetText() == text &&
+                   clusters.at(index + run).GetColumns() == 1)
+            {
+                run++;
+            }
+        }
+
+        if (run == 1)
+        {
+            index++;
+            continue;
+        }
+
+        // ECH erases with the current background color, but it can't
+        //      underline anything, and it doesn't move the cursor, so it's
+        //      only of use at the very end of the span.
+        const bool canErase = text.front() == UNICODE_SPACE &&
+                              !attributes.isUnderlined &&
+                              index + run == clusters.size();
+        const size_t literalLength = run * _Utf8Length(text);
+        const size_t repeatLength = _Utf8Length(text) + _CsiSequenceLength(run - 1);
+        const size_t eraseLength = canErase ? _CsiSequenceLength(run) : SIZE_MAX;
+
+        short sRun;
+        try
+        {
+            sRun = gsl::narrow<short>(run);
+        }
+        CATCH_RETURN();
+
+        if (eraseLength < literalLength && eraseLength <= repeatLength)
+        {
+            if (index > literalStart)
+            {
+                RETURN_IF_FAILED(VtEngine::_WriteTerminalUtf8(clusters.substr(literalStart, index - literalStart)));
+            }
+            RETURN_IF_FAILED(_EraseCharacter(sRun));
+            numErased = sRun;
+            literalStart = index + run;
+        }
+        else if (repeatLength < literalLength)
+        {
+            RETURN_IF_FAILED(VtEngine::_WriteTerminalUtf8(clusters.substr(literalStart, index + 1 - literalStart)));
+            RETURN_IF_FAILED(_RepeatCharacter(sRun - 1));
+            literalStart = index + run;
+        }
+        index += run;
+    }
+    if (literalStart < clusters.size())
+    {
+        RETURN_IF_FAILED(VtEngine::_WriteTerminalUtf8(clusters.substr(literalStart)));
+    }
+
+    // Update our internal tracker of the cursor's position. As in
+    //      _PaintUtf8BufferLine, the cursor doesn't move past the rightmost
+    //      column when we write there (see MSFT:20266233).
+    if (_lastText.X < _lastViewport.RightInclusive())
+    {
+        _lastText.X += static_cast<short>(totalWidth - numErased);
+    }
+
+    // ECH doesn't move the cursor, but we think that it *should* be at the end
+    //      of the area we just erased. Stash that as our deferred position, so
+    //      it gets there if nothing else moves it before the end of the frame.
+    if (numErased > 0)
+    {
+        _deferredCursorPos = { static_cast<short>(_lastText.X + numErased), _lastText.Y };
+    }
+
+    short x = coord.X;
+    for (const auto& cluster : clusters)
+    {
+        _shadow.Set({ x, coord.Y }, cluster, attributes);
+        x += static_cast<short>(cluster.GetColumns());
+    }
+
+    return S_OK;
+}
+
+// Method Description:
+// - Wrapper for ITerminalOutputConnection. Writes the string straight to the
+//      terminal. We don't know what that does to the terminal's contents, so
+//      we forget everything we know about them.
+// Arguments:
+// - str - string of text to be written
+// Return Value:
+// - S_OK or suitable HRESULT error from writing pipe.
+[[nodiscard]] HRESULT XtermEngine::WriteTerminalUtf8(const std::string& str) noexcept
+{
+    _shadow.Invalidate();
+    return VtEngine::WriteTerminalUtf8(str);
 }
 
 // Method Description:
 // - Wrapper for ITerminalOutputConnection. Write either an ascii-only, or a
 //      proper utf-8 string, depending on our mode.
+//  Like WriteTerminalUtf8, this invalidates the shadow buffer.
 // Arguments:
 // - wstr - wstring of text to be written
 // Return Value:
 // - S_OK or suitable HRESULT error from either conversion or writing pipe.
 [[nodiscard]] HRESULT XtermEngine::WriteTerminalW(const std::wstring& wstr) noexcept
 {
+    _shadow.Invalidate();
     return _fUseAsciiOnly ?
                VtEngine::_WriteTerminalAscii(wstr) :
                VtEngine::_WriteTerminalUtf8(wstr);
@@ -21,6 +21,7 @@ Author(s):
 #pragma once
 
 #include "vtrenderer.hpp"
+#include "ShadowBuffer.hpp"
 
 namespace Microsoft::Console::Render
 {
@@ -50,7 +51,9 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT ScrollFrame() noexcept override;
 
         [[nodiscard]] HRESULT InvalidateScroll(const COORD* const pcoordDelta) noexcept override;
+        [[nodiscard]] HRESULT InvalidateScrollRegion(const SMALL_RECT* const psrRegion, const short delta) noexcept override;
 
+        [[nodiscard]] HRESULT WriteTerminalUtf8(const std::string& str) noexcept override;
         [[nodiscard]] HRESULT WriteTerminalW(_In_ const std::wstring& str) noexcept override;
 
     protected:
@@ -60,11 +63,27 @@ namespace Microsoft::Console::Render
         bool _previousLineWrapped;
         bool _usingUnderLine;
         bool _needToDisableCursor;
+        ShadowBuffer _shadow;
+
+        // The rows [top, bottom) of the viewport that are to be scrolled by
+        //      ScrollFrame within the terminal's margins, and by how much.
+        short _scrollRegionTop;
+        short _scrollRegionBottom;
+        short _scrollRegionDelta;
 
         [[nodiscard]] HRESULT _MoveCursor(const COORD coord) noexcept override;
 
         [[nodiscard]] HRESULT _UpdateUnderline(const WORD wLegacyAttrs) noexcept;
 
+        [[nodiscard]] HRESULT _ScrollRegion() noexcept;
+        [[nodiscard]] HRESULT _CancelScrollRegion() noexcept;
+
+        ShadowBuffer::Attributes _GetShadowAttributes() const noexcept;
+        [[nodiscard]] HRESULT _PaintChangedClusters(std::basic_string_view<Cluster> const clusters,
+                                                    const COORD coord) noexcept;
+        [[nodiscard]] HRESULT _PaintClusterSpan(std::basic_string_view<Cluster> const clusters,
+                                                const COORD coord) noexcept;
+
         [[nodiscard]] HRESULT _DoUpdateTitle(const std::wstring& newTitle) noexcept override;
 
 #ifdef UNIT_TESTING
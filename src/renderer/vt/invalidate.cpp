@@ -74,6 +74,7 @@ using namespace Microsoft::Console::Render;
     }
     _skipCursor = false;
 
+    _cursorRow = pcoordCursor->Y;
     _cursorMoved = true;
     return S_OK;
 }
@@ -114,6 +115,7 @@ using namespace Microsoft::Console::Render;
         // Keep track of the fact that we circled, we'll need to do some work on
         //      end paint to specifically handle this.
         _circled = true;
+        _forcePaint = true;
     }
 
     return S_OK;
@@ -130,6 +132,7 @@ using namespace Microsoft::Console::Render;
 [[nodiscard]] HRESULT VtEngine::PrepareForTeardown(_Out_ bool* const pForcePaint) noexcept
 {
     *pForcePaint = true;
+    _forcePaint = true;
     return S_OK;
 }
 
@@ -157,9 +160,28 @@ using namespace Microsoft::Console::Render;
     // Ensure invalid areas remain within bounds of window.
     RETURN_IF_FAILED(_InvalidRestrict());
 
+    _MarkRowsChanged(invalid);
+
     return S_OK;
 }
 
+// Routine Description:
+// - Remembers that the rows of the given region changed since the last frame
+//      started. The frame byte budget prefers painting recently changed rows.
+// Arguments:
+// - region - the character region that changed.
+// Return Value:
+// - <none>
+void VtEngine::_MarkRowsChanged(const Viewport& region) noexcept
+{
+    const auto top = std::max<ptrdiff_t>(region.Top(), 0);
+    const auto bottom = std::min<ptrdiff_t>(region.BottomExclusive(), static_cast<ptrdiff_t>(_rowChangedFrame.size()));
+    for (auto row = top; row < bottom; row++)
+    {
+        _rowChangedFrame.at(row) = _frameNumber;
+    }
+}
+
 // Routine Description:
 // - Helper to adjust the invalid region by the given offset such as when a
 //      scroll operation occurs.
@@ -31,9 +31,27 @@ using namespace Microsoft::Console::Types;
                          _cursorMoved ||
                          _titleChanged;
 
+    // If the writer is still busy writing the last frame to the pipe, don't
+    //      start another one. The invalid region keeps accumulating, and once
+    //      the writer is done it'll ask for a repaint, so the terminal gets
+    //      the latest state, rather than every frame in between.
+    // Forced frames still need to be painted, or their contents will be lost.
+    _writerBackpressure = somethingToDo && !_forcePaint && _SkipFrameIfWriterBusy();
+
+    // _SkipFrameIfWriterBusy might have found out that the pipe broke.
+    if (_pipeBroken || _writerBackpressure)
+    {
+        _quickReturn = true;
+        return S_FALSE;
+    }
+
     _quickReturn = !somethingToDo;
     _trace.TraceStartPaint(_quickReturn, _fInvalidRectUsed, _invalidRect, _lastViewport, _scrollDelta, _cursorMoved);
 
+    _frameNumber++;
+    _frameBytes = 0;
+    RETURN_IF_FAILED(_PlanFrameBudget());
+
     return _quickReturn ? S_FALSE : S_OK;
 }
 
@@ -58,6 +76,19 @@ using namespace Microsoft::Console::Types;
     _firstPaint = false;
     _skipCursor = false;
     _resized = false;
+    _forcePaint = false;
+
+    // Anything we deferred to stay within the byte budget still needs to be
+    //      painted. It doesn't go through _InvalidCombine, so that it keeps
+    //      its place in line, rather than looking like it just changed.
+    const bool deferredAny = _deferredRectUsed;
+    if (_deferredRectUsed)
+    {
+        _invalidRect = _deferredRect;
+        _fInvalidRectUsed = true;
+        _deferredRectUsed = false;
+    }
+
     // If we've circled the buffer this frame, move our virtual top upwards.
     // We do this at the END of the frame, so that during the paint, we still
     //      use the original virtual top.
@@ -79,6 +110,13 @@ using namespace Microsoft::Console::Types;
 
     RETURN_IF_FAILED(_Flush());
 
+    // Ask for another frame to paint what we deferred. If the terminal still
+    //      hasn't caught up by then, that frame will wait for the writer.
+    if (deferredAny && _pfnRepaint)
+    {
+        _pfnRepaint();
+    }
+
     return S_OK;
 }
 
@@ -121,7 +159,154 @@ using namespace Microsoft::Console::Types;
                                                 const COORD coord,
                                                 const bool /*trimLeft*/) noexcept
 {
-    return VtEngine::_PaintAsciiBufferLine(clusters, coord);
+    if (_DeferBufferLine(clusters, coord))
+    {
+        return S_OK;
+    }
+
+    const auto bytesBefore = _frameBytes;
+    const auto hr = VtEngine::_PaintAsciiBufferLine(clusters, coord);
+    _AccountBufferLine(coord, bytesBefore);
+    return hr;
+}
+
+// Routine Description:
+// - Decides which of the invalid rows will be painted this frame, when there's
+//      a frame byte budget.
+//  The cursor row is always painted, since that's where the user is
+//      interacting with the console. The other rows are painted most recently
+//      changed first, for as long as the bytes we expect them to take (what
+//      they took the last time they were painted) fit in the budget. The first
+//      of them is always painted, so we keep making progress even when a
+//      single row takes more than the whole budget.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK, else an appropriate HRESULT for failing to allocate.
+[[nodiscard]] HRESULT VtEngine::_PlanFrameBudget() noexcept
+{
+    if (_frameByteBudget == 0)
+    {
+        return S_OK;
+    }
+
+    try
+    {
+        const auto height = static_cast<size_t>(_lastViewport.Height());
+        if (_rowChangedFrame.size() != height)
+        {
+            _rowChangedFrame.assign(height, _frameNumber);
+            // Until we've painted a row, guess one byte per cell.
+            _rowCost.assign(height, static_cast<size_t>(_lastViewport.Width()));
+            _rowAllowed.assign(height, false);
+            _rowOrder.reserve(height);
+        }
+
+        std::fill(_rowAllowed.begin(), _rowAllowed.end(), false);
+        _guaranteedRow = -1;
+        _rowOrder.clear();
+        if (_fInvalidRectUsed)
+        {
+            const auto dirty = GetDirtyRectInChars();
+            const auto top = std::max<short>(dirty.Top, 0);
+            const auto bottom = std::min<short>(dirty.Bottom, static_cast<short>(height - 1));
+            for (auto row = top; row <= bottom; row++)
+            {
+                _rowOrder.push_back(row);
+            }
+        }
+
+        std::sort(_rowOrder.begin(), _rowOrder.end(), [this](const short a, const short b) {
+            if ((a == _cursorRow) != (b == _cursorRow))
+            {
+                return a == _cursorRow;
+            }
+            if (_rowChangedFrame.at(a) != _rowChangedFrame.at(b))
+            {
+                return _rowChangedFrame.at(a) > _rowChangedFrame.at(b);
+            }
+            return a < b;
+        });
+
+        size_t remaining = _frameByteBudget;
+        for (const auto row : _rowOrder)
+        {
+            auto& cost = _rowCost.at(row);
+            const bool isFirst = row != _cursorRow && _guaranteedRow == -1;
+            if (row == _cursorRow || isFirst || cost <= remaining)
+            {
+                if (isFirst)
+                {
+                    _guaranteedRow = row;
+                }
+                remaining -= std::min(cost, remaining);
+                _rowAllowed.at(row) = true;
+                // We'll measure the row again as it's painted.
+                cost = 0;
+            }
+        }
+    }
+    CATCH_RETURN();
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Checks if the given run of text should be deferred to a later frame to
+//      stay within the frame byte budget. That's the case for rows that didn't
+//      make the cut in _PlanFrameBudget, and for anything but the cursor row
+//      and the first row once the budget has been used up, which can happen
+//      when rows take more bytes than they did the last time.
+//  Deferred text is added to the region to invalidate again at the end of the
+//      frame.
+// Arguments:
+// - clusters - text and column counts for each piece of text.
+// - coord - character coordinate target to render within viewport
+// Return Value:
+// - true if the text shouldn't be painted this frame.
+bool VtEngine::_DeferBufferLine(std::basic_string_view<Cluster> const clusters, const COORD coord) noexcept
+{
+    if (_frameByteBudget == 0 ||
+        coord.Y == _cursorRow ||
+        coord.Y == _guaranteedRow ||
+        coord.Y < 0 ||
+        static_cast<size_t>(coord.Y) >= _rowAllowed.size())
+    {
+        return false;
+    }
+
+    if (_rowAllowed.at(coord.Y) && _frameBytes < _frameByteBudget)
+    {
+        return false;
+    }
+
+    short columns = 0;
+    for (const auto& cluster : clusters)
+    {
+        columns += static_cast<short>(cluster.GetColumns());
+    }
+    _deferredCells += columns;
+
+    const auto deferred = Viewport::FromDimensions(coord, columns, 1);
+    _deferredRect = _deferredRectUsed ? Viewport::Union(_deferredRect, deferred) : deferred;
+    _deferredRectUsed = true;
+    return true;
+}
+
+// Routine Description:
+// - Records the number of bytes painting some text took, as the cost of its
+//      row the next time _PlanFrameBudget needs to guess it.
+// Arguments:
+// - coord - character coordinate the text was rendered at
+// - bytesBefore - the number of bytes written this frame before painting it
+// Return Value:
+// - <none>
+void VtEngine::_AccountBufferLine(const COORD coord, const size_t bytesBefore) noexcept
+{
+    if (_frameByteBudget != 0 && coord.Y >= 0 && static_cast<size_t>(coord.Y) < _rowCost.size())
+    {
+        _rowCost.at(coord.Y) += _frameBytes - bytesBefore;
+    }
 }
 
 // Method Description:
@@ -378,40 +563,24 @@ using namespace Microsoft::Console::Types;
 
     RETURN_IF_FAILED(_MoveCursor(coord));
 
-    std::wstring unclusteredString;
-    unclusteredString.reserve(clusters.size());
     short totalWidth = 0;
     for (const auto& cluster : clusters)
     {
-        unclusteredString.append(cluster.GetText());
         RETURN_IF_FAILED(ShortAdd(totalWidth, static_cast<short>(cluster.GetColumns()), &totalWidth));
     }
-    const size_t cchLine = unclusteredString.size();
 
-    bool foundNonspace = false;
-    size_t lastNonSpace = 0;
-    for (size_t i = 0; i < cchLine; i++)
+    // Count the spaces at the end of the line. Walk backwards from the end
+    //      of the line, stopping at the first cluster that isn't a space.
+    // Examples:
+    // - "  ": numSpaces = 2
+    // - "A ": numSpaces = 1
+    // - "AA": numSpaces = 0
+    const size_t cchLine = clusters.size();
+    size_t numSpaces = 0;
+    while (numSpaces < cchLine && clusters.at(cchLine - numSpaces - 1).GetText() == L"\x20")
     {
-        if (unclusteredString.at(i) != L'\x20')
-        {
-            lastNonSpace = i;
-            foundNonspace = true;
-        }
+        numSpaces++;
     }
-    // Examples:
-    // - "  ":
-    //      cch = 2, lastNonSpace = 0, foundNonSpace = false
-    //      cch-lastNonSpace = 2 -> good
-    //      cch-lastNonSpace-(0) = 2 -> good
-    // - "A "
-    //      cch = 2, lastNonSpace = 0, foundNonSpace = true
-    //      cch-lastNonSpace = 2 -> bad
-    //      cch-lastNonSpace-(1) = 1 -> good
-    // - "AA"
-    //      cch = 2, lastNonSpace = 1, foundNonSpace = true
-    //      cch-lastNonSpace = 1 -> bad
-    //      cch-lastNonSpace-(1) = 0 -> good
-    const size_t numSpaces = cchLine - lastNonSpace - (foundNonspace ? 1 : 0);
 
     // Optimizations:
     // If there are lots of spaces at the end of the line, we can try to Erase
@@ -446,8 +615,7 @@ using namespace Microsoft::Console::Types;
                                      totalWidth;
 
     // Write the actual text string
-    std::wstring wstr = std::wstring(unclusteredString.data(), cchActual);
-    RETURN_IF_FAILED(VtEngine::_WriteTerminalUtf8(wstr));
+    RETURN_IF_FAILED(VtEngine::_WriteTerminalUtf8(clusters.substr(0, cchActual)));
 
     // Update our internal tracker of the cursor's position.
     // See MSFT:20266233
@@ -494,8 +662,7 @@ using namespace Microsoft::Console::Types;
         }
         else
         {
-            std::wstring spaces = std::wstring(numSpaces, L' ');
-            RETURN_IF_FAILED(VtEngine::_WriteTerminalUtf8(spaces));
+            RETURN_IF_FAILED(_WriteFill(numSpaces, ' '));
 
             _lastText.X += static_cast<short>(numSpaces);
         }
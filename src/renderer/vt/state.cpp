@@ -4,11 +4,9 @@
 #include "precomp.h"
 #include "vtrenderer.hpp"
 #include "../../inc/conattrs.hpp"
+#include "../../inc/unicode.hpp"
 #include "../../types/inc/convert.hpp"
-
-// For _vcprintf
-#include <conio.h>
-#include <stdarg.h>
+#include "../../types/inc/Utf8Transcoder.hpp"
 
 #pragma hdrstop
 
@@ -64,6 +62,28 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
     // member is only defined when UNIT_TESTING is.
     _usingTestCallback = false;
 #endif
+
+    // Only start the writer if there's actually a pipe for it to write to.
+    if (_hFile.get() != INVALID_HANDLE_VALUE)
+    {
+        _writerThread = std::thread([this]() { _WriterThreadProc(); });
+    }
+}
+
+// Routine Description:
+// - Destroys the engine. Waits for the writer thread to finish writing the
+//      last frame it was handed before the pipe is closed.
+VtEngine::~VtEngine()
+{
+    if (_writerThread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock{ _writerLock };
+            _writerExit = true;
+        }
+        _writerCV.notify_all();
+        _writerThread.join();
+    }
 }
 
 // Method Description:
@@ -77,6 +97,7 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
 [[nodiscard]] HRESULT VtEngine::_Write(std::string_view const str) noexcept
 {
     _trace.TraceString(str);
+    _frameBytes += str.size();
 #ifdef UNIT_TESTING
     if (_usingTestCallback)
     {
@@ -94,6 +115,62 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
     CATCH_RETURN();
 }
 
+// Method Description:
+// - Writes n copies of the given character, without needing to build a string
+//      of them first.
+// Arguments:
+// - n: The number of characters to write.
+// - ch: The character to write.
+// Return Value:
+// - S_OK or suitable HRESULT error from writing pipe.
+[[nodiscard]] HRESULT VtEngine::_WriteFill(const size_t n, const char ch) noexcept
+{
+    try
+    {
+        const size_t start = _buffer.size();
+        _buffer.append(n, ch);
+        return _WriteAppended(start);
+    }
+    CATCH_RETURN();
+}
+
+// Method Description:
+// - Finishes a write that was made by appending directly to the end of
+//      _buffer, starting at the given offset. If we're building the unit tests,
+//      the appended text is instead handed to the test callback, like _Write
+//      would have.
+// Arguments:
+// - start: The offset in _buffer of the start of the appended text.
+// Return Value:
+// - S_OK or suitable HRESULT error from writing pipe.
+[[nodiscard]] HRESULT VtEngine::_WriteAppended(const size_t start) noexcept
+{
+    const std::string_view appended{ _buffer.data() + start, _buffer.size() - start };
+    _trace.TraceString(appended);
+    _frameBytes += appended.size();
+#ifdef UNIT_TESTING
+    if (_usingTestCallback)
+    {
+        const bool succeeded = _pfnTestCallback(appended.data(), appended.size());
+        _buffer.resize(start);
+        RETURN_LAST_ERROR_IF(!succeeded);
+    }
+#endif
+    return S_OK;
+}
+
+// Method Description:
+// - Hands the contents of the frame we've composed to the writer thread. The
+//      two buffers are swapped, so the next frame can be composed while the
+//      writer is still draining this one to the pipe.
+//   StartPaint won't let a frame start while the writer is busy, so normally
+//      the writer is idle by the time we get here. Forced frames (circling,
+//      teardown) and flushes outside of a frame (RequestCursor) will instead
+//      wait for the writer to finish the previous frame.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK or suitable HRESULT error from writing pipe.
 [[nodiscard]] HRESULT VtEngine::_Flush() noexcept
 {
 #ifdef UNIT_TESTING
@@ -106,23 +183,140 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
 
     if (!_pipeBroken)
     {
-        bool fSuccess = !!WriteFile(_hFile.get(), _buffer.data(), static_cast<DWORD>(_buffer.size()), nullptr, nullptr);
-        _buffer.clear();
-        if (!fSuccess)
+        try
         {
-            _exitResult = HRESULT_FROM_WIN32(GetLastError());
-            _pipeBroken = true;
-            if (_terminalOwner)
+            std::unique_lock<std::mutex> lock{ _writerLock };
+            _writerCV.wait(lock, [this]() { return !_writerBusy; });
+
+            const HRESULT writerResult = _writerResult;
+            if (FAILED(writerResult))
+            {
+                lock.unlock();
+                _PipeBroken(writerResult);
+                return _exitResult;
+            }
+
+            if (!_buffer.empty())
             {
-                _terminalOwner->CloseOutput();
+                // The writer clears its buffer once it's written, but the
+                //      allocation is kept around for us to reuse.
+                _buffer.swap(_writerBuffer);
+                _writerBusy = true;
+                lock.unlock();
+                _writerCV.notify_all();
             }
-            return _exitResult;
         }
+        CATCH_RETURN();
     }
 
     return S_OK;
 }
 
+// Method Description:
+// - Returns true if the writer thread is still writing the last frame to the
+//      pipe. If it is, remember that we skipped a frame, so the writer can ask
+//      for a repaint once it's done.
+//   If the writer failed to write to the pipe, this will also take care of
+//      tearing down the connection.
+// Arguments:
+// - <none>
+// Return Value:
+// - true iff the writer hasn't finished writing the last frame yet.
+bool VtEngine::_SkipFrameIfWriterBusy() noexcept
+{
+    if (!_writerThread.joinable())
+    {
+        return false;
+    }
+
+    HRESULT writerResult = S_OK;
+    try
+    {
+        std::lock_guard<std::mutex> lock{ _writerLock };
+        writerResult = _writerResult;
+        if (_writerBusy && SUCCEEDED(writerResult))
+        {
+            _frameSkipped = true;
+            return true;
+        }
+    }
+    CATCH_LOG();
+
+    if (FAILED(writerResult))
+    {
+        _PipeBroken(writerResult);
+    }
+    return false;
+}
+
+// Method Description:
+// - Records that we failed to write to the pipe, and lets our owner know that
+//      the output connection is gone.
+// Arguments:
+// - hr: The error we got from writing to the pipe.
+// Return Value:
+// - <none>
+void VtEngine::_PipeBroken(const HRESULT hr) noexcept
+{
+    _buffer.clear();
+    _exitResult = hr;
+    _pipeBroken = true;
+    if (_terminalOwner)
+    {
+        _terminalOwner->CloseOutput();
+    }
+}
+
+// Method Description:
+// - The body of the writer thread. Waits for a frame to be handed to it by
+//      _Flush, and writes it to the pipe outside of the lock, so that a slow
+//      reader on the other end of the pipe only ever blocks this thread, and
+//      not the paint (and therefore the console lock).
+//   Once a frame is written, if the renderer skipped any frames while we were
+//      busy, ask for a repaint so the latest state makes it to the terminal.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void VtEngine::_WriterThreadProc() noexcept
+{
+    std::unique_lock<std::mutex> lock{ _writerLock };
+    while (true)
+    {
+        _writerCV.wait(lock, [this]() { return _writerBusy || _writerExit; });
+        if (!_writerBusy)
+        {
+            // We were asked to exit, and there's nothing left to write.
+            break;
+        }
+
+        lock.unlock();
+        const bool fSuccess = !!WriteFile(_hFile.get(), _writerBuffer.data(), static_cast<DWORD>(_writerBuffer.size()), nullptr, nullptr);
+        const HRESULT hr = fSuccess ? S_OK : HRESULT_FROM_WIN32(GetLastError());
+        _writerBuffer.clear();
+        lock.lock();
+
+        _writerResult = hr;
+        _writerBusy = false;
+        // If we failed, the paint thread needs to come through to notice the
+        //      broken pipe, so ask for a repaint in that case too.
+        const bool needsRepaint = std::exchange(_frameSkipped, false) || FAILED(hr);
+        lock.unlock();
+        _writerCV.notify_all();
+
+        if (needsRepaint && _pfnRepaint)
+        {
+            _pfnRepaint();
+        }
+
+        if (FAILED(hr))
+        {
+            break;
+        }
+        lock.lock();
+    }
+}
+
 // Method Description:
 // - Wrapper for ITerminalOutputConnection. See _Write.
 [[nodiscard]] HRESULT VtEngine::WriteTerminalUtf8(const std::string& str) noexcept
@@ -141,8 +335,43 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
 {
     try
     {
-        const auto converted = ConvertToA(CP_UTF8, wstr);
-        return _Write(converted);
+        const size_t start = _buffer.size();
+        Utf8::AppendAsUtf8(wstr, _buffer);
+        return _WriteAppended(start);
+    }
+    CATCH_RETURN();
+}
+
+// Method Description:
+// - Writes the text of the given clusters to the tty, encoded as utf-8. The
+//      text is encoded directly into our buffer, so unlike
+//      _WriteTerminalUtf8(wstring), this doesn't need to build any temporary
+//      strings.
+// Arguments:
+// - clusters - the clusters of text to be written
+// Return Value:
+// - S_OK or suitable HRESULT error from writing pipe.
+[[nodiscard]] HRESULT VtEngine::_WriteTerminalUtf8(std::basic_string_view<Cluster> const clusters) noexcept
+{
+    try
+    {
+        size_t cchText = 0;
+        for (const auto& cluster : clusters)
+        {
+            cchText += cluster.GetText().size();
+        }
+
+        const size_t start = _buffer.size();
+        _buffer.resize(start + Utf8::MaxUtf8Length(cchText));
+
+        char* out = _buffer.data() + start;
+        for (const auto& cluster : clusters)
+        {
+            out = Utf8::EncodeUtf8(cluster.GetText(), out);
+        }
+        _buffer.resize(out - _buffer.data());
+
+        return _WriteAppended(start);
     }
     CATCH_RETURN();
 }
@@ -173,40 +402,6 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
     return _Write(needed);
 }
 
-// Method Description:
-// - Helper for calling _Write with a string for formatting a sequence. Used
-//      extensively by VtSequences.cpp
-// Arguments:
-// - pFormat: the pointer to the string to write to the pipe.
-// - ...: a va_list of args to format the string with.
-// Return Value:
-// - S_OK, E_INVALIDARG for a invalid format string, or suitable HRESULT error
-//      from writing pipe.
-[[nodiscard]] HRESULT VtEngine::_WriteFormattedString(const std::string* const pFormat, ...) noexcept
-{
-    HRESULT hr = E_FAIL;
-    va_list argList;
-    va_start(argList, pFormat);
-
-    int cchNeeded = _scprintf(pFormat->c_str(), argList);
-    // -1 is the _scprintf error case https://msdn.microsoft.com/en-us/library/t32cf9tb.aspx
-    if (cchNeeded > -1)
-    {
-        wistd::unique_ptr<char[]> psz = wil::make_unique_nothrow<char[]>(cchNeeded + 1);
-        RETURN_IF_NULL_ALLOC(psz);
-
-        int cchWritten = _vsnprintf_s(psz.get(), cchNeeded + 1, cchNeeded, pFormat->c_str(), argList);
-        hr = _Write({ psz.get(), gsl::narrow<size_t>(cchWritten) });
-    }
-    else
-    {
-        hr = E_INVALIDARG;
-    }
-
-    va_end(argList);
-    return hr;
-}
-
 // Method Description:
 // - This method will update the active font on the current device context
 //      Does nothing for vt, the font is handed by the terminal.
@@ -404,6 +599,66 @@ void VtEngine::SetTerminalOwner(Microsoft::Console::ITerminalOwner* const termin
     _terminalOwner = terminalOwner;
 }
 
+// Method Description:
+// - Sets a callback to be called when the engine needs another frame painted,
+//      without anything in the buffer having changed. This happens when we
+//      skipped a frame because the writer was still busy with the last one.
+//   This is called on the writer thread, without the console lock, so it
+//      must be set before the engine starts painting, and it shouldn't do
+//      anything but wake up the render thread.
+// Arguments:
+// - pfn: the callback to trigger a new frame.
+// Return Value:
+// - <none>
+void VtEngine::SetRepaintCallback(std::function<void()> pfn)
+{
+    // The writer only reads the callback after it's been handed a frame
+    //      under this lock, so taking it here orders the two.
+    std::lock_guard<std::mutex> lock{ _writerLock };
+    _pfnRepaint = std::move(pfn);
+}
+
+// Method Description:
+// - Limits the number of bytes we'll try to write to the terminal in a single
+//      frame. Useful when the pipe is connected to a slow link, where sending
+//      whole frames would let a backlog build up. When a frame would go over
+//      the budget, only the rows that matter the most are painted, and the
+//      rest of the frame is deferred to the following frames.
+// Arguments:
+// - bytes: the budget in bytes, or 0 for no budget at all.
+// Return Value:
+// - <none>
+void VtEngine::SetFrameByteBudget(const size_t bytes) noexcept
+{
+    _frameByteBudget = bytes;
+}
+
+// Method Description:
+// - Tells us whether the terminal on the other end scrolls within the margins
+//      set by DECSTBM, when it's sent SU and SD. Not every terminal we could be
+//      attached to does, so unless we're told it does, regions that scroll
+//      within the viewport are repainted, rather than scrolled.
+// Arguments:
+// - supported: true if the terminal is known to support scrolling margins.
+// Return Value:
+// - <none>
+void VtEngine::SetScrollMarginsSupported(const bool supported) noexcept
+{
+    _scrollMarginsSupported = supported;
+}
+
+// Method Description:
+// - Gets the total number of cells whose painting has been deferred to a later
+//      frame because of the frame byte budget.
+// Arguments:
+// - <none>
+// Return Value:
+// - the number of deferred cells.
+size_t VtEngine::GetDeferredCellCount() const noexcept
+{
+    return _deferredCells;
+}
+
 // Method Description:
 // - sends a sequence to request the end terminal to tell us the
 //      cursor position. The terminal will reply back on the vt input handle.
@@ -419,6 +674,23 @@ HRESULT VtEngine::RequestCursor() noexcept
     return S_OK;
 }
 
+// Method Description:
+// - sends a sequence to ask the end terminal to send pastes to us as
+//      bracketed pastes. The input thread takes each of those in as one block
+//      of text, instead of parsing it as a stream of typed keys.
+//   Flushes the buffer as well, to make sure the request is sent before any
+//      paste could be.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+HRESULT VtEngine::RequestBracketedPaste() noexcept
+{
+    RETURN_IF_FAILED(_EnableBracketedPaste());
+    RETURN_IF_FAILED(_Flush());
+    return S_OK;
+}
+
 // Method Description:
 // - Tell the vt renderer to begin a resize operation. During a resize
 //   operation, the vt renderer should _not_ request to be repainted during a
@@ -21,8 +21,10 @@ Author(s):
 #include "../../inc/ITerminalOwner.hpp"
 #include "../../types/inc/Viewport.hpp"
 #include "tracing.hpp"
+#include <array>
 #include <string>
 #include <functional>
+#include <condition_variable>
 
 namespace Microsoft::Console::Render
 {
@@ -37,7 +39,7 @@ namespace Microsoft::Console::Render
                  const Microsoft::Console::IDefaultColorProvider& colorProvider,
                  const Microsoft::Console::Types::Viewport initialViewport);
 
-        virtual ~VtEngine() override = default;
+        virtual ~VtEngine() override;
 
         [[nodiscard]] HRESULT InvalidateSelection(const std::vector<SMALL_RECT>& rectangles) noexcept override;
         [[nodiscard]] virtual HRESULT InvalidateScroll(const COORD* const pcoordDelta) noexcept = 0;
@@ -87,6 +89,7 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT SuppressResizeRepaint() noexcept;
 
         [[nodiscard]] HRESULT RequestCursor() noexcept;
+        [[nodiscard]] HRESULT RequestBracketedPaste() noexcept;
         [[nodiscard]] HRESULT InheritCursor(const COORD coordCursor) noexcept;
 
         [[nodiscard]] HRESULT WriteTerminalUtf8(const std::string& str) noexcept;
@@ -94,6 +97,10 @@ namespace Microsoft::Console::Render
         [[nodiscard]] virtual HRESULT WriteTerminalW(const std::wstring& str) noexcept = 0;
 
         void SetTerminalOwner(Microsoft::Console::ITerminalOwner* const terminalOwner);
+        void SetRepaintCallback(std::function<void()> pfn);
+        void SetFrameByteBudget(const size_t bytes) noexcept;
+        void SetScrollMarginsSupported(const bool supported) noexcept;
+        size_t GetDeferredCellCount() const noexcept;
         void BeginResizeRequest();
         void EndResizeRequest();
 
@@ -135,15 +142,67 @@ namespace Microsoft::Console::Render
 
         Microsoft::Console::VirtualTerminal::RenderTracing _trace;
         bool _inResizeRequest{ false };
+        bool _forcePaint{ false };
+
+        // The pipe is written by a dedicated writer thread. Frames are composed
+        //      in _buffer, and swapped into _writerBuffer at the end of a
+        //      frame. While the writer is still draining a frame, new frames
+        //      are skipped (see StartPaint), and the invalid region keeps
+        //      accumulating until the writer catches up.
+        std::string _writerBuffer;
+        std::thread _writerThread;
+        std::mutex _writerLock;
+        std::condition_variable _writerCV;
+        bool _writerBusy{ false };
+        bool _writerExit{ false };
+        bool _frameSkipped{ false };
+        bool _writerBackpressure{ false };
+        HRESULT _writerResult{ S_OK };
+        std::function<void()> _pfnRepaint;
+
+        // If there's a byte budget, each frame only paints as many of the
+        //      invalid rows as are expected to fit in it, the cursor row and
+        //      the most recently changed rows first. The rest of the rows are
+        //      deferred to the following frames. (See _PlanFrameBudget)
+        size_t _frameByteBudget{ 0 };
+        size_t _frameBytes{ 0 };
+
+        // Whether the terminal on the other end is known to scroll within
+        //      the margins set by DECSTBM, with SU and SD. See
+        //      XtermEngine::InvalidateScrollRegion.
+        bool _scrollMarginsSupported{ false };
+        size_t _frameNumber{ 0 };
+        size_t _deferredCells{ 0 };
+        short _cursorRow{ 0 };
+        short _guaranteedRow{ -1 };
+        std::vector<size_t> _rowChangedFrame;
+        std::vector<size_t> _rowCost;
+        std::vector<bool> _rowAllowed;
+        std::vector<short> _rowOrder;
+        Microsoft::Console::Types::Viewport _deferredRect{ Microsoft::Console::Types::Viewport::Empty() };
+        bool _deferredRectUsed{ false };
 
         [[nodiscard]] HRESULT _Write(std::string_view const str) noexcept;
-        [[nodiscard]] HRESULT _WriteFormattedString(const std::string* const pFormat, ...) noexcept;
+        [[nodiscard]] HRESULT _WriteFill(const size_t n, const char ch) noexcept;
+        [[nodiscard]] HRESULT _WriteAppended(const size_t start) noexcept;
+        template<typename... Params>
+        [[nodiscard]] HRESULT _WriteCsiSequence(const std::string_view prefix,
+                                                const char finalChar,
+                                                const Params... params) noexcept;
         [[nodiscard]] HRESULT _Flush() noexcept;
+        bool _SkipFrameIfWriterBusy() noexcept;
+        void _PipeBroken(const HRESULT hr) noexcept;
+        void _WriterThreadProc() noexcept;
 
         void _OrRect(_Inout_ SMALL_RECT* const pRectExisting, const SMALL_RECT* const pRectToOr) const;
         [[nodiscard]] HRESULT _InvalidCombine(const Microsoft::Console::Types::Viewport invalid) noexcept;
         [[nodiscard]] HRESULT _InvalidOffset(const COORD* const ppt) noexcept;
         [[nodiscard]] HRESULT _InvalidRestrict() noexcept;
+        void _MarkRowsChanged(const Microsoft::Console::Types::Viewport& region) noexcept;
+
+        [[nodiscard]] HRESULT _PlanFrameBudget() noexcept;
+        bool _DeferBufferLine(std::basic_string_view<Cluster> const clusters, const COORD coord) noexcept;
+        void _AccountBufferLine(const COORD coord, const size_t bytesBefore) noexcept;
         bool _AllIsInvalid() const;
 
         [[nodiscard]] HRESULT _StopCursorBlinking() noexcept;
@@ -154,8 +213,13 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT _InsertDeleteLine(const short sLines, const bool fInsertLine) noexcept;
         [[nodiscard]] HRESULT _DeleteLine(const short sLines) noexcept;
         [[nodiscard]] HRESULT _InsertLine(const short sLines) noexcept;
+        [[nodiscard]] HRESULT _ScrollUp(const short sLines) noexcept;
+        [[nodiscard]] HRESULT _ScrollDown(const short sLines) noexcept;
+        [[nodiscard]] HRESULT _SetScrollingRegion(const short sTop, const short sBottom) noexcept;
+        [[nodiscard]] HRESULT _ResetScrollingRegion() noexcept;
         [[nodiscard]] HRESULT _CursorForward(const short chars) noexcept;
         [[nodiscard]] HRESULT _EraseCharacter(const short chars) noexcept;
+        [[nodiscard]] HRESULT _RepeatCharacter(const short chars) noexcept;
         [[nodiscard]] HRESULT _CursorPosition(const COORD coord) noexcept;
         [[nodiscard]] HRESULT _CursorHome() noexcept;
         [[nodiscard]] HRESULT _ClearScreen() noexcept;
@@ -177,6 +241,7 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT _EndUnderline() noexcept;
 
         [[nodiscard]] HRESULT _RequestCursor() noexcept;
+        [[nodiscard]] HRESULT _EnableBracketedPaste() noexcept;
 
         [[nodiscard]] virtual HRESULT _MoveCursor(const COORD coord) noexcept = 0;
         [[nodiscard]] HRESULT _RgbUpdateDrawingBrushes(const COLORREF colorForeground,
@@ -199,6 +264,7 @@ namespace Microsoft::Console::Render
                                                     const COORD coord) noexcept;
 
         [[nodiscard]] HRESULT _WriteTerminalUtf8(const std::wstring& str) noexcept;
+        [[nodiscard]] HRESULT _WriteTerminalUtf8(std::basic_string_view<Cluster> const clusters) noexcept;
         [[nodiscard]] HRESULT _WriteTerminalAscii(const std::wstring& str) noexcept;
 
         [[nodiscard]] virtual HRESULT _DoUpdateTitle(const std::wstring& newTitle) noexcept override;
@@ -25,7 +25,7 @@ namespace Microsoft::Console::VirtualTerminal
     public:
         virtual ~IInteractDispatch() = default;
 
-        virtual bool WriteInput(_In_ std::deque<std::unique_ptr<IInputEvent>>& inputEvents) = 0;
+        virtual bool WriteInput(const gsl::span<const INPUT_RECORD> inputRecords) = 0;
 
         virtual bool WriteCtrlC() = 0;
 
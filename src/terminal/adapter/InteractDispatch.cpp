@@ -26,13 +26,13 @@ InteractDispatch::InteractDispatch(ConGetSet* const pConApi) :
 //      interrupt in the client, but instead write a Ctrl+C to the input buffer
 //      to be read by the client.
 // Arguments:
-// - inputEvents: a collection of IInputEvents
+// - inputRecords: a collection of INPUT_RECORDs
 // Return Value:
 // True if handled successfully. False otherwise.
-bool InteractDispatch::WriteInput(_In_ std::deque<std::unique_ptr<IInputEvent>>& inputEvents)
+bool InteractDispatch::WriteInput(const gsl::span<const INPUT_RECORD> inputRecords)
 {
     size_t dwWritten = 0;
-    return !!_pConApi->PrivateWriteConsoleInputW(inputEvents, dwWritten);
+    return !!_pConApi->PrivateWriteConsoleInputW(inputRecords, dwWritten);
 }
 
 // Method Description:
@@ -69,18 +69,14 @@ bool InteractDispatch::WriteString(_In_reads_(cch) const wchar_t* const pws,
     bool fSuccess = !!_pConApi->GetConsoleOutputCP(&codepage);
     if (fSuccess)
     {
-        std::deque<std::unique_ptr<IInputEvent>> keyEvents;
+        std::vector<INPUT_RECORD> keyRecords;
 
         for (size_t i = 0; i < cch; ++i)
         {
-            std::deque<std::unique_ptr<KeyEvent>> convertedEvents = CharToKeyEvents(pws[i], codepage);
-
-            std::move(convertedEvents.begin(),
-                      convertedEvents.end(),
-                      std::back_inserter(keyEvents));
+            CharToKeyEvents(pws[i], codepage, keyRecords);
         }
 
-        fSuccess = WriteInput(keyEvents);
+        fSuccess = WriteInput(keyRecords);
     }
     return fSuccess;
 }
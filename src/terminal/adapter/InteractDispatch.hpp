@@ -27,7 +27,7 @@ namespace Microsoft::Console::VirtualTerminal
 
         ~InteractDispatch() = default;
 
-        bool WriteInput(_In_ std::deque<std::unique_ptr<IInputEvent>>& inputEvents) override;
+        bool WriteInput(const gsl::span<const INPUT_RECORD> inputRecords) override;
         bool WriteCtrlC() override;
         bool WriteString(_In_reads_(cch) const wchar_t* const pws, const size_t cch) override;
         bool WindowManipulation(const DispatchTypes::WindowManipulationType uiFunction,
@@ -53,7 +53,7 @@ namespace Microsoft::Console::VirtualTerminal
         virtual BOOL SetConsoleRGBTextAttribute(const COLORREF rgbColor, const bool fIsForeground) = 0;
         virtual BOOL PrivateBoldText(const bool bolded) = 0;
 
-        virtual BOOL PrivateWriteConsoleInputW(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& events,
+        virtual BOOL PrivateWriteConsoleInputW(const gsl::span<const INPUT_RECORD> records,
                                                _Out_ size_t& eventsWritten) = 0;
         virtual BOOL ScrollConsoleScreenBufferW(const SMALL_RECT* pScrollRectangle,
                                                 _In_opt_ const SMALL_RECT* pClipRectangle,
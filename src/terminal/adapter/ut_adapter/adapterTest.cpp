@@ -345,18 +345,17 @@ public:
         return !!_fPrivateBoldTextResult;
     }
 
-    BOOL PrivateWriteConsoleInputW(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& events,
+    BOOL PrivateWriteConsoleInputW(const gsl::span<const INPUT_RECORD> records,
                                    _Out_ size_t& eventsWritten) override
     {
         Log::Comment(L"PrivateWriteConsoleInputW MOCK called...");
 
         if (_fPrivateWriteConsoleInputWResult)
         {
-            // move all the input events we were given into local storage so we can test against them
-            Log::Comment(NoThrowString().Format(L"Moving %zu input events into local storage...", events.size()));
+            // copy all the input records we were given into local storage so we can test against them
+            Log::Comment(NoThrowString().Format(L"Copying %td input records into local storage...", records.size()));
 
-            _events.clear();
-            _events.swap(events);
+            _events = IInputEvent::Create(records);
             eventsWritten = _events.size();
         }
 
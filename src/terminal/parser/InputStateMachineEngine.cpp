@@ -82,7 +82,9 @@ InputStateMachineEngine::InputStateMachineEngine(IInteractDispatch* const pDispa
 
 InputStateMachineEngine::InputStateMachineEngine(IInteractDispatch* const pDispatch, const bool lookingForDSR) :
     _pDispatch(THROW_IF_NULL_ALLOC(pDispatch)),
-    _lookingForDSR(lookingForDSR)
+    _lookingForDSR(lookingForDSR),
+    _inBracketedPaste(false),
+    _pastedText{}
 {
 }
 
@@ -95,6 +97,17 @@ InputStateMachineEngine::InputStateMachineEngine(IInteractDispatch* const pDispa
 // - true iff we successfully dispatched the sequence.
 bool InputStateMachineEngine::ActionExecute(const wchar_t wch)
 {
+    if (_inBracketedPaste)
+    {
+        // Control characters that were pasted are text, like any other.
+        // Like the console's own paste, drop the LF of a CRLF, so a
+        //      line break is pressed as a single Enter.
+        if (!(wch == UNICODE_LINEFEED && !_pastedText.empty() && _pastedText.back() == UNICODE_CARRIAGERETURN))
+        {
+            return _CollectPastedText({ &wch, 1 });
+        }
+        return true;
+    }
     return _DoControlCharacter(wch, false);
 }
 
@@ -187,6 +200,7 @@ bool InputStateMachineEngine::_DoControlCharacter(const wchar_t wch, const bool
 // - true iff we successfully dispatched the sequence.
 bool InputStateMachineEngine::ActionExecuteFromEscape(const wchar_t wch)
 {
+    _WritePastedText();
     return _DoControlCharacter(wch, true);
 }
 
@@ -199,6 +213,11 @@ bool InputStateMachineEngine::ActionExecuteFromEscape(const wchar_t wch)
 // - true iff we successfully dispatched the sequence.
 bool InputStateMachineEngine::ActionPrint(const wchar_t wch)
 {
+    if (_inBracketedPaste)
+    {
+        return _CollectPastedText({ &wch, 1 });
+    }
+
     short vkey = 0;
     DWORD dwModifierState = 0;
     bool fSuccess = _GenerateKeyFromChar(wch, &vkey, &dwModifierState);
@@ -224,6 +243,10 @@ bool InputStateMachineEngine::ActionPrintString(const wchar_t* const rgwch,
     {
         return true;
     }
+    if (_inBracketedPaste)
+    {
+        return _CollectPastedText({ rgwch, cch });
+    }
     return _pDispatch->WriteString(rgwch, cch);
 }
 
@@ -255,6 +278,8 @@ bool InputStateMachineEngine::ActionEscDispatch(const wchar_t wch,
                                                 const unsigned short /*cIntermediate*/,
                                                 const wchar_t /*wchIntermediate*/)
 {
+    _WritePastedText();
+
     bool fSuccess = false;
 
     // 0x7f is DEL, which we treat effectively the same as a ctrl character.
@@ -307,6 +332,27 @@ bool InputStateMachineEngine::ActionCsiDispatch(const wchar_t wch,
     const unsigned short* const rgusRemainingArgs = (cParams > 1) ? rgusParams + 1 : rgusParams;
     const unsigned short cRemainingArgs = (cParams >= 1) ? cParams - 1 : 0;
 
+    // The start and end of a bracketed paste aren't keys. Everything between
+    //      them is collected, and written to the input as one block.
+    if (wch == CsiActionCodes::Generic && cParams == 1)
+    {
+        if (rgusParams[0] == GenericKeyIdentifiers::BracketedPasteStart)
+        {
+            _WritePastedText();
+            _inBracketedPaste = true;
+            return true;
+        }
+        else if (rgusParams[0] == GenericKeyIdentifiers::BracketedPasteEnd)
+        {
+            _inBracketedPaste = false;
+            return _WritePastedText();
+        }
+    }
+
+    // Anything else that arrives in the middle of a paste goes in after the
+    //      text that came before it.
+    _WritePastedText();
+
     bool fSuccess = false;
     switch (wch)
     {
@@ -411,6 +457,8 @@ bool InputStateMachineEngine::ActionSs3Dispatch(const wchar_t wch,
                                                 _In_reads_(_Param_(3)) const unsigned short* const /*rgusParams*/,
                                                 const unsigned short /*cParams*/)
 {
+    _WritePastedText();
+
     // Ss3 sequence keys aren't modified.
     // When F1-F4 *are* modified, they're sent as CSI sequences, not SS3's.
     DWORD dwModifierState = 0;
@@ -655,9 +703,7 @@ bool InputStateMachineEngine::_WriteSingleKey(const wchar_t wch, const short vke
     INPUT_RECORD rgInput[WRAPPED_SEQUENCE_MAX_LENGTH];
     size_t cInput = _GenerateWrappedSequence(wch, vkey, dwModifierState, rgInput, WRAPPED_SEQUENCE_MAX_LENGTH);
 
-    std::deque<std::unique_ptr<IInputEvent>> inputEvents = IInputEvent::Create(gsl::make_span(rgInput, cInput));
-
-    return _pDispatch->WriteInput(inputEvents);
+    return _pDispatch->WriteInput(gsl::make_span(rgInput, cInput));
 }
 
 // Method Description:
@@ -865,9 +911,50 @@ bool InputStateMachineEngine::_GenerateKeyFromChar(const wchar_t wch,
 // - True iff we should manually dispatch on the last character of a string.
 bool InputStateMachineEngine::FlushAtEndOfString() const
 {
+    // A paste can be split anywhere between reads, including in the middle
+    //      of the sequence that ends it. Hold on to partial sequences until
+    //      the rest of them arrives.
+    return !_inBracketedPaste;
+}
+
+// Method Description:
+// - Collects text from a bracketed paste, to be written to the input when the
+//      paste ends. If the end never arrives, the text can't be held on to
+//      forever: once there's s_cchMaxPastedText of it, what's been collected
+//      so far is written to the input, and collecting starts again.
+// Arguments:
+// - text - the text that was pasted
+// Return Value:
+// - true iff the text was collected, or written if it had to be.
+bool InputStateMachineEngine::_CollectPastedText(const std::wstring_view text)
+{
+    _pastedText.append(text);
+    if (_pastedText.size() >= s_cchMaxPastedText)
+    {
+        return _WritePastedText();
+    }
     return true;
 }
 
+// Method Description:
+// - Writes the text collected from a bracketed paste so far to the input, all
+//      in one go, and clears it. Does nothing if there isn't any.
+// Arguments:
+// - <none>
+// Return Value:
+// - true iff we successfully wrote the text.
+bool InputStateMachineEngine::_WritePastedText()
+{
+    if (_pastedText.empty())
+    {
+        return true;
+    }
+
+    const bool fSuccess = _pDispatch->WriteString(_pastedText.data(), _pastedText.size());
+    _pastedText.clear();
+    return fSuccess;
+}
+
 // Routine Description:
 // - Returns true if the engine should dispatch control characters in the Escape
 //      state. Typically, control characters are immediately executed in the
@@ -30,6 +30,10 @@ namespace Microsoft::Console::VirtualTerminal
         InputStateMachineEngine(IInteractDispatch* const pDispatch,
                                 const bool lookingForDSR);
 
+        // The most text held on to from a bracketed paste before it's written
+        //      to the input, in case the end of the paste never arrives.
+        static constexpr size_t s_cchMaxPastedText = 0x10000;
+
         bool ActionExecute(const wchar_t wch) override;
         bool ActionExecuteFromEscape(const wchar_t wch) override;
 
@@ -71,6 +75,8 @@ namespace Microsoft::Console::VirtualTerminal
     private:
         const std::unique_ptr<IInteractDispatch> _pDispatch;
         bool _lookingForDSR;
+        bool _inBracketedPaste;
+        std::wstring _pastedText;
 
         enum CsiActionCodes : wchar_t
         {
@@ -123,6 +129,9 @@ namespace Microsoft::Console::VirtualTerminal
             F10 = 21,
             F11 = 23,
             F12 = 24,
+            // Not keys, but the start and end of a bracketed paste.
+            BracketedPasteStart = 200,
+            BracketedPasteEnd = 201,
         };
 
         struct CSI_TO_VKEY
@@ -189,5 +198,7 @@ namespace Microsoft::Console::VirtualTerminal
                             _Out_ unsigned int* const puiColumn) const;
 
         bool _DoControlCharacter(const wchar_t wch, const bool writeAlt);
+        bool _CollectPastedText(const std::wstring_view text);
+        bool _WritePastedText();
     };
 }
@@ -230,6 +230,9 @@ class Microsoft::Console::VirtualTerminal::InputEngineTest
     TEST_METHOD(AltBackspaceTest);
     TEST_METHOD(AltCtrlDTest);
     TEST_METHOD(AltIntermediateTest);
+    TEST_METHOD(BracketedPasteTest);
+    TEST_METHOD(BracketedPasteSplitAcrossStringsTest);
+    TEST_METHOD(BracketedPasteUnterminatedTest);
 
     friend class TestInteractDispatch;
 };
@@ -239,7 +242,7 @@ class Microsoft::Console::VirtualTerminal::TestInteractDispatch final : public I
 public:
     TestInteractDispatch(_In_ std::function<void(std::deque<std::unique_ptr<IInputEvent>>&)> pfn,
                          _In_ TestState* testState);
-    virtual bool WriteInput(_In_ std::deque<std::unique_ptr<IInputEvent>>& inputEvents) override;
+    virtual bool WriteInput(const gsl::span<const INPUT_RECORD> inputRecords) override;
     virtual bool WriteCtrlC() override;
     virtual bool WindowManipulation(const DispatchTypes::WindowManipulationType uiFunction,
                                     _In_reads_(cParams) const unsigned short* const rgusParams,
@@ -262,8 +265,9 @@ TestInteractDispatch::TestInteractDispatch(_In_ std::function<void(std::deque<st
 {
 }
 
-bool TestInteractDispatch::WriteInput(_In_ std::deque<std::unique_ptr<IInputEvent>>& inputEvents)
+bool TestInteractDispatch::WriteInput(const gsl::span<const INPUT_RECORD> inputRecords)
 {
+    std::deque<std::unique_ptr<IInputEvent>> inputEvents = IInputEvent::Create(inputRecords);
     _pfnWriteInputCallback(inputEvents);
     return true;
 }
@@ -272,9 +276,8 @@ bool TestInteractDispatch::WriteCtrlC()
 {
     VERIFY_IS_TRUE(_testState->_expectSendCtrlC);
     KeyEvent key = KeyEvent(true, 1, 'C', 0, UNICODE_ETX, LEFT_CTRL_PRESSED);
-    std::deque<std::unique_ptr<IInputEvent>> inputEvents;
-    inputEvents.push_back(std::make_unique<KeyEvent>(key));
-    return WriteInput(inputEvents);
+    const INPUT_RECORD record = key.ToInputRecord();
+    return WriteInput(gsl::make_span(&record, 1));
 }
 
 bool TestInteractDispatch::WindowManipulation(const DispatchTypes::WindowManipulationType uiFunction,
@@ -293,20 +296,17 @@ bool TestInteractDispatch::WindowManipulation(const DispatchTypes::WindowManipul
 bool TestInteractDispatch::WriteString(_In_reads_(cch) const wchar_t* const pws,
                                        const size_t cch)
 {
-    std::deque<std::unique_ptr<IInputEvent>> keyEvents;
+    std::vector<INPUT_RECORD> keyRecords;
 
     for (size_t i = 0; i < cch; ++i)
     {
         const wchar_t wch = pws[i];
         // We're forcing the translation to CP_USA, so that it'll be constant
         //  regardless of the CP the test is running in
-        std::deque<std::unique_ptr<KeyEvent>> convertedEvents = CharToKeyEvents(wch, CP_USA);
-        std::move(convertedEvents.begin(),
-                  convertedEvents.end(),
-                  std::back_inserter(keyEvents));
+        CharToKeyEvents(wch, CP_USA, keyRecords);
     }
 
-    return WriteInput(keyEvents);
+    return WriteInput(keyRecords);
 }
 
 bool TestInteractDispatch::MoveCursor(const unsigned int row,
@@ -826,3 +826,128 @@ void InputEngineTest::AltIntermediateTest()
     Log::Comment(NoThrowString().Format(L"Processing \"\\x05\""));
     stateMachine->ProcessString(seq);
 }
+
+void InputEngineTest::BracketedPasteTest()
+{
+    // A bracketed paste should be written to the input as one block of text,
+    // with the CRLFs in it pressed as a single Enter.
+    TestState testState;
+
+    size_t writes = 0;
+    std::wstring written{};
+    auto pfn = [&](std::deque<std::unique_ptr<IInputEvent>>& inEvents) {
+        ++writes;
+        for (auto& ev : inEvents)
+        {
+            VERIFY_ARE_EQUAL(InputEventType::KeyEvent, ev->EventType());
+            auto& k = static_cast<KeyEvent&>(*ev);
+            if (k.IsKeyDown())
+            {
+                written += k.GetCharData();
+            }
+        }
+    };
+
+    auto inputEngine = std::make_unique<InputStateMachineEngine>(new TestInteractDispatch(pfn, &testState));
+    auto stateMachine = std::make_unique<StateMachine>(inputEngine.release());
+    VERIFY_IS_NOT_NULL(stateMachine);
+    testState._stateMachine = stateMachine.get();
+
+    const std::wstring seq = L"\x1b[200~echo a\r\necho\tb\x1b[201~";
+    Log::Comment(NoThrowString().Format(L"Processing \"\\x1b[200~echo a\\r\\necho\\tb\\x1b[201~\""));
+    stateMachine->ProcessString(seq);
+
+    VERIFY_ARE_EQUAL((size_t)1, writes);
+    VERIFY_ARE_EQUAL(std::wstring(L"echo a\recho\tb"), written);
+
+    Log::Comment(L"Input after the end of the paste should be handled as keys again");
+    writes = 0;
+    written.clear();
+    stateMachine->ProcessString(L"\x1b[A");
+    VERIFY_ARE_EQUAL((size_t)1, writes);
+    VERIFY_ARE_EQUAL(std::wstring(L"\0", 1), written);
+}
+
+void InputEngineTest::BracketedPasteSplitAcrossStringsTest()
+{
+    // A paste can arrive over several reads of the input pipe, and a read can
+    // end in the middle of the sequence that ends the paste. None of the
+    // pasted text should be written until the whole paste has arrived.
+    TestState testState;
+
+    size_t writes = 0;
+    std::wstring written{};
+    auto pfn = [&](std::deque<std::unique_ptr<IInputEvent>>& inEvents) {
+        ++writes;
+        for (auto& ev : inEvents)
+        {
+            auto& k = static_cast<KeyEvent&>(*ev);
+            if (k.IsKeyDown())
+            {
+                written += k.GetCharData();
+            }
+        }
+    };
+
+    auto inputEngine = std::make_unique<InputStateMachineEngine>(new TestInteractDispatch(pfn, &testState));
+    auto stateMachine = std::make_unique<StateMachine>(inputEngine.release());
+    VERIFY_IS_NOT_NULL(stateMachine);
+    testState._stateMachine = stateMachine.get();
+
+    stateMachine->ProcessString(L"\x1b[200~hello");
+    stateMachine->ProcessString(L" world\x1b[20");
+    VERIFY_ARE_EQUAL((size_t)0, writes);
+
+    stateMachine->ProcessString(L"1~");
+    VERIFY_ARE_EQUAL((size_t)1, writes);
+    VERIFY_ARE_EQUAL(std::wstring(L"hello world"), written);
+}
+
+void InputEngineTest::BracketedPasteUnterminatedTest()
+{
+    // If the end of a paste never arrives, the text collected from it can't
+    // keep growing. Once there's too much of it, it should be written to the
+    // input as it is.
+    TestState testState;
+
+    size_t writes = 0;
+    std::wstring written{};
+    auto pfn = [&](std::deque<std::unique_ptr<IInputEvent>>& inEvents) {
+        ++writes;
+        for (auto& ev : inEvents)
+        {
+            auto& k = static_cast<KeyEvent&>(*ev);
+            if (k.IsKeyDown())
+            {
+                written += k.GetCharData();
+            }
+        }
+    };
+
+    auto inputEngine = std::make_unique<InputStateMachineEngine>(new TestInteractDispatch(pfn, &testState));
+    auto stateMachine = std::make_unique<StateMachine>(inputEngine.release());
+    VERIFY_IS_NOT_NULL(stateMachine);
+    testState._stateMachine = stateMachine.get();
+
+    const std::wstring chunk(InputStateMachineEngine::s_cchMaxPastedText / 4, L'x');
+    stateMachine->ProcessString(L"\x1b[200~");
+    for (size_t i = 0; i < 3; ++i)
+    {
+        stateMachine->ProcessString(chunk);
+    }
+    VERIFY_ARE_EQUAL((size_t)0, writes);
+
+    Log::Comment(L"Reaching the limit writes everything collected so far.");
+    stateMachine->ProcessString(chunk);
+    VERIFY_ARE_EQUAL((size_t)1, writes);
+    VERIFY_ARE_EQUAL(InputStateMachineEngine::s_cchMaxPastedText, written.size());
+
+    Log::Comment(L"The paste carries on being collected until it ends.");
+    writes = 0;
+    written.clear();
+    stateMachine->ProcessString(L"tail");
+    VERIFY_ARE_EQUAL((size_t)0, writes);
+    stateMachine->ProcessString(L"\x1b[201~");
+    VERIFY_ARE_EQUAL((size_t)1, writes);
+    VERIFY_ARE_EQUAL(std::wstring(L"tail"), written);
+}
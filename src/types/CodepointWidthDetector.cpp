@@ -14,11 +14,6 @@ namespace
         CodepointWidth width;
     };
 
-    static bool operator<(const UnicodeRange& range, const unsigned int searchTerm)
-    {
-        return range.upperBound < searchTerm;
-    }
-
     static constexpr std::array<UnicodeRange, 285> s_wideAndAmbiguousTable{
         // generated from http://www.unicode.org/Public/UCD/latest/ucd/EastAsianWidth.txt
         // anything not present here is presumed to be Narrow.
@@ -308,6 +303,142 @@ namespace
         UnicodeRange{ 0xf0000, 0xffffd, CodepointWidth::Ambiguous },
         UnicodeRange{ 0x100000, 0x10fffd, CodepointWidth::Ambiguous }
     };
+
+    // The table above is expanded, the first time it's needed, into a
+    // two-stage lookup table covering all of Unicode, so that finding the
+    // width of a codepoint is just two array accesses:
+    // - The codepoints are split into blocks of s_blockSize. The first stage
+    //   maps each block to the index of its widths in the second stage.
+    // - Blocks that only contain a single width all share one of the first
+    //   three entries of the second stage. Only the blocks that contain a
+    //   boundary of one of the ranges in the table get their own entry.
+    // It isn't built at compile time, since that takes far more constexpr
+    // evaluation steps than compilers allow by default.
+    static constexpr unsigned int s_maxCodepoint = 0x10ffff;
+    static constexpr unsigned int s_blockShift = 7;
+    static constexpr unsigned int s_blockSize = 1u << s_blockShift;
+    static constexpr unsigned int s_blockCount = (s_maxCodepoint + 1) >> s_blockShift;
+    static constexpr size_t s_uniformBlockCount = 3; // Narrow, Wide, Ambiguous
+    // The first stage stores block indices in a byte.
+    static constexpr size_t s_maxWidthBlockCount = 256;
+
+    // Returns the index of the first range that doesn't end before codepoint.
+    static constexpr size_t _findRange(const unsigned int codepoint) noexcept
+    {
+        size_t first = 0;
+        size_t count = s_wideAndAmbiguousTable.size();
+        while (count > 0)
+        {
+            const size_t step = count / 2;
+            if (s_wideAndAmbiguousTable[first + step].upperBound < codepoint)
+            {
+                first += step + 1;
+                count -= step + 1;
+            }
+            else
+            {
+                count = step;
+            }
+        }
+        return first;
+    }
+
+    static constexpr CodepointWidth _searchRanges(const unsigned int codepoint) noexcept
+    {
+        const auto i = _findRange(codepoint);
+        if (i < s_wideAndAmbiguousTable.size() && s_wideAndAmbiguousTable[i].lowerBound <= codepoint)
+        {
+            return s_wideAndAmbiguousTable[i].width;
+        }
+        return CodepointWidth::Narrow;
+    }
+
+    // Returns the width shared by every codepoint in the block, or Invalid if
+    // the block contains more than one width.
+    static constexpr CodepointWidth _uniformBlockWidth(const unsigned int block) noexcept
+    {
+        const unsigned int first = block << s_blockShift;
+        const unsigned int last = first + s_blockSize - 1;
+        const auto i = _findRange(first);
+        if (i == s_wideAndAmbiguousTable.size() || s_wideAndAmbiguousTable[i].lowerBound > last)
+        {
+            return CodepointWidth::Narrow;
+        }
+        if (s_wideAndAmbiguousTable[i].lowerBound <= first && s_wideAndAmbiguousTable[i].upperBound >= last)
+        {
+            return s_wideAndAmbiguousTable[i].width;
+        }
+        return CodepointWidth::Invalid;
+    }
+
+    struct WidthTable final
+    {
+        std::array<BYTE, s_blockCount> blockIndex;
+        std::array<std::array<CodepointWidth, s_blockSize>, s_maxWidthBlockCount> blocks;
+    };
+
+    static void _buildWidthTable(WidthTable& table) noexcept
+    {
+        table.blocks[0].fill(CodepointWidth::Narrow);
+        table.blocks[1].fill(CodepointWidth::Wide);
+        table.blocks[2].fill(CodepointWidth::Ambiguous);
+
+        size_t nextBlock = s_uniformBlockCount;
+        for (unsigned int block = 0; block < s_blockCount; block++)
+        {
+            switch (_uniformBlockWidth(block))
+            {
+            case CodepointWidth::Narrow:
+                table.blockIndex[block] = 0;
+                break;
+            case CodepointWidth::Wide:
+                table.blockIndex[block] = 1;
+                break;
+            case CodepointWidth::Ambiguous:
+                table.blockIndex[block] = 2;
+                break;
+            default:
+                FAIL_FAST_IF(nextBlock >= s_maxWidthBlockCount);
+                for (unsigned int i = 0; i < s_blockSize; i++)
+                {
+                    table.blocks[nextBlock][i] = _searchRanges((block << s_blockShift) + i);
+                }
+                table.blockIndex[block] = static_cast<BYTE>(nextBlock);
+                nextBlock++;
+                break;
+            }
+        }
+    }
+
+    static const WidthTable& _widthTable() noexcept
+    {
+        static const WidthTable table = [] {
+            WidthTable built{};
+            _buildWidthTable(built);
+            return built;
+        }();
+        return table;
+    }
+
+    // Grapheme clusters that contain U+FE0F VARIATION SELECTOR-16 ask for
+    // their base character to be displayed as a (wide) emoji. Pairs of
+    // regional indicators are displayed as a (wide) flag.
+    static constexpr wchar_t s_emojiPresentationSelector = 0xfe0f;
+    static constexpr unsigned int s_regionalIndicatorFirst = 0x1f1e6;
+    static constexpr unsigned int s_regionalIndicatorLast = 0x1f1ff;
+
+    // The fallback cache is a small open addressing hash table, keyed by
+    // codepoint. This is the key of the empty slots.
+    static constexpr unsigned int s_emptyCacheKey = 0xffffffff;
+    static constexpr size_t s_initialCacheCapacity = 64;
+
+    static constexpr size_t _cacheSlot(const unsigned int codepoint, const size_t capacity) noexcept
+    {
+        // Multiplying by an odd constant scrambles the codepoints, while
+        // keeping runs of consecutive codepoints (typical for text in a
+        // single script) in distinct slots.
+        return static_cast<size_t>(codepoint * 0x9e3779b1u) & (capacity - 1);
+    }
 }
 
 // Routine Description:
@@ -323,17 +454,33 @@ CodepointWidth CodepointWidthDetector::GetWidth(const std::wstring_view glyph) c
         return CodepointWidth::Invalid;
     }
 
-    const auto codepoint = _extractCodepoint(glyph);
-    const auto it = std::lower_bound(s_wideAndAmbiguousTable.begin(), s_wideAndAmbiguousTable.end(), codepoint);
+    // _extractCodepoint can't return anything past s_maxCodepoint, so this
+    // is always in bounds.
+    return _lookupWidth(_extractCodepoint(glyph));
+}
 
-    // For characters that are not _in_ the table, lower_bound will return the nearest item that is.
-    // We must check its bounds to make sure that our hit was a true hit.
-    if (it != s_wideAndAmbiguousTable.end() && codepoint >= it->lowerBound && codepoint <= it->upperBound)
-    {
-        return it->width;
-    }
+// Routine Description:
+// - looks up the width of a codepoint in the two-stage table
+// Arguments:
+// - codepoint - the codepoint to look up, no greater than U+10FFFF
+// Return Value:
+// - the width type of the codepoint
+CodepointWidth CodepointWidthDetector::_lookupWidth(const unsigned int codepoint) noexcept
+{
+    const auto& table = _widthTable();
+    return table.blocks[table.blockIndex[codepoint >> s_blockShift]][codepoint & (s_blockSize - 1)];
+}
 
-    return CodepointWidth::Narrow;
+// Routine Description:
+// - finds the width of a codepoint by searching the range table itself,
+//   which the two-stage table is built from
+// Arguments:
+// - codepoint - the codepoint to search for
+// Return Value:
+// - the width type of the codepoint
+CodepointWidth CodepointWidthDetector::_searchWidth(const unsigned int codepoint) noexcept
+{
+    return _searchRanges(codepoint);
 }
 
 // Routine Description:
@@ -355,14 +502,28 @@ bool CodepointWidthDetector::IsWide(const wchar_t wch) const noexcept
 
 // Routine Description:
 // - checks if codepoint is wide. will attempt to fallback as much possible until an answer is determined
+// - a grapheme cluster made of several codepoints is as wide as its first
+//   one, unless it asks for emoji presentation or is a regional indicator flag.
 // Arguments:
-// - glyph - the utf16 encoded codepoint to check width of
+// - glyph - the utf16 encoded codepoint or grapheme cluster to check width of
 // Return Value:
 // - true if codepoint is wide
 bool CodepointWidthDetector::IsWide(const std::wstring_view glyph) const
 {
     THROW_HR_IF(E_INVALIDARG, glyph.empty());
-    if (glyph.size() == 1)
+    const size_t baseLength = (glyph.size() >= 2 && IS_HIGH_SURROGATE(glyph.at(0)) && IS_LOW_SURROGATE(glyph.at(1))) ? 2 : 1;
+    if (glyph.size() > baseLength)
+    {
+        const auto base = glyph.substr(0, baseLength);
+        const auto codepoint = _extractCodepoint(base);
+        if (glyph.find(s_emojiPresentationSelector) != std::wstring_view::npos ||
+            (codepoint >= s_regionalIndicatorFirst && codepoint <= s_regionalIndicatorLast))
+        {
+            return true;
+        }
+        return IsWide(base);
+    }
+    else if (glyph.size() == 1)
     {
         // We first attempt to look at our custom quick lookup table of char width preferences.
         const auto width = GetQuickCharWidth(glyph.front());
@@ -397,6 +558,43 @@ bool CodepointWidthDetector::IsWide(const std::wstring_view glyph) const
     }
 }
 
+// Routine Description:
+// - classifies every codepoint of a UTF-16 run at once. This is the same as
+//   calling IsWide on each of them, including asking the fallback method
+//   about ambiguous ones, but skips most of the work for narrow text.
+// Arguments:
+// - run - the utf16 encoded text to classify
+// - widths - receives one entry for each wchar_t of the run: Wide or Narrow
+//   for the first (or only) wchar_t of a codepoint, and Invalid for the
+//   trailing half of a surrogate pair. Must be at least as long as the run.
+// Return Value:
+// - <none>
+void CodepointWidthDetector::GetWidths(const std::wstring_view run, const gsl::span<CodepointWidth> widths) const
+{
+    THROW_HR_IF(E_INVALIDARG, static_cast<size_t>(widths.size()) < run.size());
+
+    auto out = widths.begin();
+    for (size_t i = 0; i < run.size(); i++)
+    {
+        const auto wch = run[i];
+        if (wch >= 0x20 && wch <= 0x7e)
+        {
+            // ASCII is always narrow, no need to ask anybody.
+            *out++ = CodepointWidth::Narrow;
+        }
+        else if (IS_HIGH_SURROGATE(wch) && i + 1 < run.size() && IS_LOW_SURROGATE(run[i + 1]))
+        {
+            *out++ = IsWide(run.substr(i, 2)) ? CodepointWidth::Wide : CodepointWidth::Narrow;
+            *out++ = CodepointWidth::Invalid;
+            i++;
+        }
+        else
+        {
+            *out++ = IsWide({ &run[i], 1 }) ? CodepointWidth::Wide : CodepointWidth::Narrow;
+        }
+    }
+}
+
 // Routine Description:
 // - checks if codepoint is wide using fallback methods.
 // Arguments:
@@ -435,25 +633,100 @@ bool CodepointWidthDetector::_lookupIsWide(const std::wstring_view glyph) const
 // - Checks the fallback function but caches the results until the font changes
 //   because the lookup function is usually very expensive and will return the same results
 //   for the same inputs.
+// - Only glyphs made of a single codepoint are cached. Anything longer is rare
+//   enough that we always ask the fallback function.
 // Arguments:
 // - glyph - the utf16 encoded codepoint to check width of
 // - true if codepoint is wide or false if it is narrow
 bool CodepointWidthDetector::_checkFallbackViaCache(const std::wstring_view glyph) const
 {
-    const std::wstring findMe{ glyph };
+    const bool isSingleCodepoint = glyph.size() == 1 ||
+                                   (glyph.size() == 2 && IS_HIGH_SURROGATE(glyph.at(0)) && IS_LOW_SURROGATE(glyph.at(1)));
+    if (!isSingleCodepoint)
+    {
+        return _pfnFallbackMethod(glyph);
+    }
 
-    // TODO: Cache needs to be emptied when font changes.
-    auto it = _fallbackCache.find(findMe);
-    if (it == _fallbackCache.end())
+    const auto codepoint = _extractCodepoint(glyph);
+    bool isWide = false;
+    if (!_tryGetCachedFallback(codepoint, isWide))
     {
-        auto result = _pfnFallbackMethod(glyph);
-        _fallbackCache.insert_or_assign(findMe, result);
-        return result;
+        isWide = _pfnFallbackMethod(glyph);
+        _cacheFallback(codepoint, isWide);
     }
-    else
+    return isWide;
+}
+
+// Routine Description:
+// - Looks up the answer the fallback function gave for a codepoint.
+// Arguments:
+// - codepoint - the codepoint to look up
+// - isWide - receives the cached answer, if there is one
+// Return Value:
+// - true if the codepoint was in the cache
+bool CodepointWidthDetector::_tryGetCachedFallback(const unsigned int codepoint, bool& isWide) const noexcept
+{
+    const auto capacity = _fallbackCache.size();
+    if (capacity == 0)
+    {
+        return false;
+    }
+
+    for (auto slot = _cacheSlot(codepoint, capacity);; slot = (slot + 1) & (capacity - 1))
+    {
+        const auto& entry = _fallbackCache[slot];
+        if (entry.codepoint == codepoint)
+        {
+            isWide = entry.isWide;
+            return true;
+        }
+        if (entry.codepoint == s_emptyCacheKey)
+        {
+            return false;
+        }
+    }
+}
+
+// Routine Description:
+// - Remembers the answer the fallback function gave for a codepoint. The
+//   cache is kept at most half full, so that lookups stay short.
+// Arguments:
+// - codepoint - the codepoint that was looked up
+// - isWide - the answer of the fallback function
+// Return Value:
+// - <none>
+void CodepointWidthDetector::_cacheFallback(const unsigned int codepoint, const bool isWide) const
+{
+    if ((_fallbackCacheSize + 1) * 2 > _fallbackCache.size())
+    {
+        const auto capacity = std::max(s_initialCacheCapacity, _fallbackCache.size() * 2);
+        std::vector<FallbackCacheEntry> grown(capacity, FallbackCacheEntry{ s_emptyCacheKey, false });
+        for (const auto& entry : _fallbackCache)
+        {
+            if (entry.codepoint != s_emptyCacheKey)
+            {
+                auto slot = _cacheSlot(entry.codepoint, capacity);
+                while (grown[slot].codepoint != s_emptyCacheKey)
+                {
+                    slot = (slot + 1) & (capacity - 1);
+                }
+                grown[slot] = entry;
+            }
+        }
+        _fallbackCache.swap(grown);
+    }
+
+    const auto capacity = _fallbackCache.size();
+    auto slot = _cacheSlot(codepoint, capacity);
+    while (_fallbackCache[slot].codepoint != s_emptyCacheKey && _fallbackCache[slot].codepoint != codepoint)
+    {
+        slot = (slot + 1) & (capacity - 1);
+    }
+    if (_fallbackCache[slot].codepoint == s_emptyCacheKey)
     {
-        return it->second;
+        _fallbackCacheSize++;
     }
+    _fallbackCache[slot] = FallbackCacheEntry{ codepoint, isWide };
 }
 
 // Routine Description:
@@ -464,7 +737,7 @@ bool CodepointWidthDetector::_checkFallbackViaCache(const std::wstring_view glyp
 // - the codepoint being stored
 unsigned int CodepointWidthDetector::_extractCodepoint(const std::wstring_view glyph) noexcept
 {
-    if (glyph.size() == 1)
+    if (glyph.size() == 1 || !IS_HIGH_SURROGATE(glyph.at(0)) || !IS_LOW_SURROGATE(glyph.at(1)))
     {
         return static_cast<unsigned int>(glyph.front());
     }
@@ -506,5 +779,7 @@ void CodepointWidthDetector::SetFallbackMethod(std::function<bool(const std::wst
 // - <none>
 void CodepointWidthDetector::NotifyFontChanged() const noexcept
 {
-    _fallbackCache.clear();
+    // Keep the memory around, the new font will need about as much of it.
+    std::fill(_fallbackCache.begin(), _fallbackCache.end(), FallbackCacheEntry{ s_emptyCacheKey, false });
+    _fallbackCacheSize = 0;
 }
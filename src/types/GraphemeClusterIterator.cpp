@@ -0,0 +1,926 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "inc/GraphemeClusterIterator.hpp"
+#include "unicode.hpp"
+
+namespace
+{
+    // The Grapheme_Cluster_Break property values from UAX #29, along with the
+    // Extended_Pictographic property from UTS #51 that rule GB11 relies on.
+    enum class GraphemeBreakProperty : BYTE
+    {
+        Any,
+        CR,
+        LF,
+        Control,
+        Extend,
+        ZWJ,
+        RegionalIndicator,
+        Prepend,
+        SpacingMark,
+        L,
+        V,
+        T,
+        LV,
+        LVT,
+        ExtendedPictographic
+    };
+
+    struct GraphemeRange final
+    {
+        unsigned int lowerBound;
+        unsigned int upperBound;
+        GraphemeBreakProperty property;
+    };
+
+    static constexpr std::array<GraphemeRange, 656> s_graphemeBreakTable{
+        // generated from http://www.unicode.org/Public/UCD/latest/ucd/auxiliary/GraphemeBreakProperty.txt
+        // and the Extended_Pictographic entries of http://www.unicode.org/Public/UCD/latest/ucd/emoji/emoji-data.txt
+        // anything not present here is Any. The precomposed Hangul syllables
+        // (LV and LVT) are left out, since they follow a simple pattern.
+        GraphemeRange{ 0x0, 0x9, GraphemeBreakProperty::Control },
+        GraphemeRange{ 0xa, 0xa, GraphemeBreakProperty::LF },
+        GraphemeRange{ 0xb, 0xc, GraphemeBreakProperty::Control },
+        GraphemeRange{ 0xd, 0xd, GraphemeBreakProperty::CR },
+        GraphemeRange{ 0xe, 0x1f, GraphemeBreakProperty::Control },
+        GraphemeRange{ 0x7f, 0x9f, GraphemeBreakProperty::Control },
+        GraphemeRange{ 0xa9, 0xa9, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0xad, 0xad, GraphemeBreakProperty::Control },
+        GraphemeRange{ 0xae, 0xae, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x300, 0x36f, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x483, 0x489, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x591, 0x5bd, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x5bf, 0x5bf, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x5c1, 0x5c2, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x5c4, 0x5c5, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x5c7, 0x5c7, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x600, 0x605, GraphemeBreakProperty::Prepend },
+        GraphemeRange{ 0x610, 0x61a, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x61c, 0x61c, GraphemeBreakProperty::Control },
+        GraphemeRange{ 0x64b, 0x65f, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x670, 0x670, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x6d6, 0x6dc, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x6dd, 0x6dd, GraphemeBreakProperty::Prepend },
+        GraphemeRange{ 0x6df, 0x6e4, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x6e7, 0x6e8, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x6ea, 0x6ed, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x70f, 0x70f, GraphemeBreakProperty::Prepend },
+        GraphemeRange{ 0x711, 0x711, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x730, 0x74a, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x7a6, 0x7b0, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x7eb, 0x7f3, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x7fd, 0x7fd, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x816, 0x819, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x81b, 0x823, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x825, 0x827, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x829, 0x82d, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x859, 0x85b, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x890, 0x891, GraphemeBreakProperty::Prepend },
+        GraphemeRange{ 0x897, 0x89f, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x8ca, 0x8e1, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x8e2, 0x8e2, GraphemeBreakProperty::Prepend },
+        GraphemeRange{ 0x8e3, 0x902, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x903, 0x903, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x93a, 0x93a, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x93b, 0x93b, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x93c, 0x93c, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x93e, 0x940, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x941, 0x948, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x949, 0x94c, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x94d, 0x94d, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x94e, 0x94f, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x951, 0x957, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x962, 0x963, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x981, 0x981, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x982, 0x983, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x9bc, 0x9bc, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x9be, 0x9be, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x9bf, 0x9c0, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x9c1, 0x9c4, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x9c7, 0x9c8, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x9cb, 0x9cc, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x9cd, 0x9cd, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x9d7, 0x9d7, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x9e2, 0x9e3, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x9fe, 0x9fe, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xa01, 0xa02, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xa03, 0xa03, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xa3c, 0xa3c, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xa3e, 0xa40, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xa41, 0xa42, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xa47, 0xa48, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xa4b, 0xa4d, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xa51, 0xa51, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xa70, 0xa71, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xa75, 0xa75, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xa81, 0xa82, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xa83, 0xa83, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xabc, 0xabc, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xabe, 0xac0, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xac1, 0xac5, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xac7, 0xac8, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xac9, 0xac9, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xacb, 0xacc, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xacd, 0xacd, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xae2, 0xae3, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xafa, 0xaff, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xb01, 0xb01, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xb02, 0xb03, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xb3c, 0xb3c, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xb3e, 0xb3f, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xb40, 0xb40, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xb41, 0xb44, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xb47, 0xb48, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xb4b, 0xb4c, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xb4d, 0xb4d, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xb55, 0xb57, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xb62, 0xb63, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xb82, 0xb82, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xbbe, 0xbbe, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xbbf, 0xbbf, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xbc0, 0xbc0, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xbc1, 0xbc2, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xbc6, 0xbc8, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xbca, 0xbcc, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xbcd, 0xbcd, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xbd7, 0xbd7, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xc00, 0xc00, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xc01, 0xc03, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xc04, 0xc04, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xc3c, 0xc3c, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xc3e, 0xc40, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xc41, 0xc44, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xc46, 0xc48, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xc4a, 0xc4d, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xc55, 0xc56, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xc62, 0xc63, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xc81, 0xc81, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xc82, 0xc83, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xcbc, 0xcbc, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xcbe, 0xcbe, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xcbf, 0xcc0, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xcc1, 0xcc1, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xcc2, 0xcc2, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xcc3, 0xcc4, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xcc6, 0xcc8, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xcca, 0xccd, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xcd5, 0xcd6, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xce2, 0xce3, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xcf3, 0xcf3, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xd00, 0xd01, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xd02, 0xd03, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xd3b, 0xd3c, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xd3e, 0xd3e, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xd3f, 0xd40, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xd41, 0xd44, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xd46, 0xd48, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xd4a, 0xd4c, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xd4d, 0xd4d, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xd4e, 0xd4e, GraphemeBreakProperty::Prepend },
+        GraphemeRange{ 0xd57, 0xd57, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xd62, 0xd63, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xd81, 0xd81, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xd82, 0xd83, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xdca, 0xdca, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xdcf, 0xdcf, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xdd0, 0xdd1, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xdd2, 0xdd4, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xdd6, 0xdd6, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xdd8, 0xdde, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xddf, 0xddf, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xdf2, 0xdf3, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xe31, 0xe31, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xe33, 0xe33, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xe34, 0xe3a, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xe47, 0xe4e, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xeb1, 0xeb1, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xeb3, 0xeb3, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xeb4, 0xebc, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xec8, 0xece, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xf18, 0xf19, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xf35, 0xf35, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xf37, 0xf37, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xf39, 0xf39, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xf3e, 0xf3f, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xf71, 0xf7e, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xf7f, 0xf7f, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xf80, 0xf84, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xf86, 0xf87, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xf8d, 0xf97, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xf99, 0xfbc, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xfc6, 0xfc6, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x102d, 0x1030, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1031, 0x1031, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x1032, 0x1037, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1039, 0x103a, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x103b, 0x103c, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x103d, 0x103e, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1056, 0x1057, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x1058, 0x1059, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x105e, 0x1060, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1071, 0x1074, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1082, 0x1082, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1084, 0x1084, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x1085, 0x1086, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x108d, 0x108d, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x109d, 0x109d, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1100, 0x115f, GraphemeBreakProperty::L },
+        GraphemeRange{ 0x1160, 0x11a7, GraphemeBreakProperty::V },
+        GraphemeRange{ 0x11a8, 0x11ff, GraphemeBreakProperty::T },
+        GraphemeRange{ 0x135d, 0x135f, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1712, 0x1715, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1732, 0x1734, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1752, 0x1753, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1772, 0x1773, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x17b4, 0x17b5, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x17b6, 0x17b6, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x17b7, 0x17bd, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x17be, 0x17c5, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x17c6, 0x17c6, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x17c7, 0x17c8, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x17c9, 0x17d3, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x17dd, 0x17dd, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x180b, 0x180d, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x180e, 0x180e, GraphemeBreakProperty::Control },
+        GraphemeRange{ 0x180f, 0x180f, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1885, 0x1886, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x18a9, 0x18a9, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1920, 0x1922, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1923, 0x1926, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x1927, 0x1928, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1929, 0x192b, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x1930, 0x1931, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x1932, 0x1932, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1933, 0x1938, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x1939, 0x193b, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1a17, 0x1a18, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1a19, 0x1a1a, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x1a1b, 0x1a1b, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1a55, 0x1a55, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x1a56, 0x1a56, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1a57, 0x1a57, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x1a58, 0x1a5e, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1a60, 0x1a60, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1a62, 0x1a62, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1a65, 0x1a6c, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1a6d, 0x1a72, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x1a73, 0x1a7c, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1a7f, 0x1a7f, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1ab0, 0x1ace, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1b00, 0x1b03, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1b04, 0x1b04, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x1b34, 0x1b3d, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1b3e, 0x1b41, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x1b42, 0x1b44, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1b6b, 0x1b73, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1b80, 0x1b81, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1b82, 0x1b82, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x1ba1, 0x1ba1, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x1ba2, 0x1ba5, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1ba6, 0x1ba7, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x1ba8, 0x1bad, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1be6, 0x1be6, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1be7, 0x1be7, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x1be8, 0x1be9, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1bea, 0x1bec, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x1bed, 0x1bed, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1bee, 0x1bee, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x1bef, 0x1bf3, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1c24, 0x1c2b, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x1c2c, 0x1c33, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1c34, 0x1c35, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x1c36, 0x1c37, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1cd0, 0x1cd2, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1cd4, 0x1ce0, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1ce1, 0x1ce1, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x1ce2, 0x1ce8, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1ced, 0x1ced, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1cf4, 0x1cf4, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1cf7, 0x1cf7, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x1cf8, 0x1cf9, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1dc0, 0x1dff, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x200b, 0x200b, GraphemeBreakProperty::Control },
+        GraphemeRange{ 0x200c, 0x200c, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x200d, 0x200d, GraphemeBreakProperty::ZWJ },
+        GraphemeRange{ 0x200e, 0x200f, GraphemeBreakProperty::Control },
+        GraphemeRange{ 0x2028, 0x202e, GraphemeBreakProperty::Control },
+        GraphemeRange{ 0x203c, 0x203c, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x2049, 0x2049, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x2060, 0x206f, GraphemeBreakProperty::Control },
+        GraphemeRange{ 0x20d0, 0x20f0, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x2122, 0x2122, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x2139, 0x2139, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x2194, 0x2199, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x21a9, 0x21aa, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x231a, 0x231b, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x2328, 0x2328, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x2388, 0x2388, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x23cf, 0x23cf, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x23e9, 0x23f3, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x23f8, 0x23fa, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x24c2, 0x24c2, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x25aa, 0x25ab, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x25b6, 0x25b6, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x25c0, 0x25c0, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x25fb, 0x25fe, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x2600, 0x2605, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x2607, 0x2612, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x2614, 0x2685, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x2690, 0x2705, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x2708, 0x2712, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x2714, 0x2714, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x2716, 0x2716, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x271d, 0x271d, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x2721, 0x2721, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x2728, 0x2728, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x2733, 0x2734, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x2744, 0x2744, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x2747, 0x2747, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x274c, 0x274c, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x274e, 0x274e, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x2753, 0x2755, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x2757, 0x2757, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x2763, 0x2767, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x2795, 0x2797, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x27a1, 0x27a1, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x27b0, 0x27b0, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x27bf, 0x27bf, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x2934, 0x2935, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x2b05, 0x2b07, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x2b1b, 0x2b1c, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x2b50, 0x2b50, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x2b55, 0x2b55, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x2cef, 0x2cf1, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x2d7f, 0x2d7f, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x2de0, 0x2dff, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x302a, 0x302f, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x3030, 0x3030, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x303d, 0x303d, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x3099, 0x309a, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x3297, 0x3297, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x3299, 0x3299, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0xa66f, 0xa672, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xa674, 0xa67d, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xa69e, 0xa69f, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xa6f0, 0xa6f1, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xa802, 0xa802, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xa806, 0xa806, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xa80b, 0xa80b, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xa823, 0xa824, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xa825, 0xa826, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xa827, 0xa827, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xa82c, 0xa82c, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xa880, 0xa881, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xa8b4, 0xa8c3, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xa8c4, 0xa8c5, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xa8e0, 0xa8f1, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xa8ff, 0xa8ff, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xa926, 0xa92d, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xa947, 0xa951, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xa952, 0xa952, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xa953, 0xa953, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xa960, 0xa97c, GraphemeBreakProperty::L },
+        GraphemeRange{ 0xa980, 0xa982, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xa983, 0xa983, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xa9b3, 0xa9b3, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xa9b4, 0xa9b5, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xa9b6, 0xa9b9, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xa9ba, 0xa9bb, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xa9bc, 0xa9bd, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xa9be, 0xa9bf, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xa9c0, 0xa9c0, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xa9e5, 0xa9e5, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xaa29, 0xaa2e, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xaa2f, 0xaa30, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xaa31, 0xaa32, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xaa33, 0xaa34, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xaa35, 0xaa36, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xaa43, 0xaa43, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xaa4c, 0xaa4c, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xaa4d, 0xaa4d, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xaa7c, 0xaa7c, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xaab0, 0xaab0, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xaab2, 0xaab4, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xaab7, 0xaab8, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xaabe, 0xaabf, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xaac1, 0xaac1, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xaaeb, 0xaaeb, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xaaec, 0xaaed, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xaaee, 0xaaef, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xaaf5, 0xaaf5, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xaaf6, 0xaaf6, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xabe3, 0xabe4, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xabe5, 0xabe5, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xabe6, 0xabe7, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xabe8, 0xabe8, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xabe9, 0xabea, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xabec, 0xabec, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0xabed, 0xabed, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xd7b0, 0xd7c6, GraphemeBreakProperty::V },
+        GraphemeRange{ 0xd7cb, 0xd7fb, GraphemeBreakProperty::T },
+        GraphemeRange{ 0xfb1e, 0xfb1e, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xfe00, 0xfe0f, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xfe20, 0xfe2f, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xfeff, 0xfeff, GraphemeBreakProperty::Control },
+        GraphemeRange{ 0xff9e, 0xff9f, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xfff0, 0xfffb, GraphemeBreakProperty::Control },
+        GraphemeRange{ 0x101fd, 0x101fd, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x102e0, 0x102e0, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x10376, 0x1037a, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x10a01, 0x10a03, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x10a05, 0x10a06, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x10a0c, 0x10a0f, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x10a38, 0x10a3a, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x10a3f, 0x10a3f, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x10ae5, 0x10ae6, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x10d24, 0x10d27, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x10d69, 0x10d6d, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x10eab, 0x10eac, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x10efc, 0x10eff, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x10f46, 0x10f50, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x10f82, 0x10f85, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11000, 0x11000, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x11001, 0x11001, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11002, 0x11002, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x11038, 0x11046, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11070, 0x11070, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11073, 0x11074, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1107f, 0x11081, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11082, 0x11082, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x110b0, 0x110b2, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x110b3, 0x110b6, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x110b7, 0x110b8, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x110b9, 0x110ba, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x110bd, 0x110bd, GraphemeBreakProperty::Prepend },
+        GraphemeRange{ 0x110c2, 0x110c2, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x110cd, 0x110cd, GraphemeBreakProperty::Prepend },
+        GraphemeRange{ 0x11100, 0x11102, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11127, 0x1112b, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1112c, 0x1112c, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x1112d, 0x11134, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11145, 0x11146, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x11173, 0x11173, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11180, 0x11181, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11182, 0x11182, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x111b3, 0x111b5, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x111b6, 0x111be, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x111bf, 0x111bf, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x111c0, 0x111c0, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x111c2, 0x111c3, GraphemeBreakProperty::Prepend },
+        GraphemeRange{ 0x111c9, 0x111cc, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x111ce, 0x111ce, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x111cf, 0x111cf, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1122c, 0x1122e, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x1122f, 0x11231, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11232, 0x11233, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x11234, 0x11237, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1123e, 0x1123e, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11241, 0x11241, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x112df, 0x112df, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x112e0, 0x112e2, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x112e3, 0x112ea, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11300, 0x11301, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11302, 0x11303, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x1133b, 0x1133c, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1133e, 0x1133e, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1133f, 0x1133f, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x11340, 0x11340, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11341, 0x11344, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x11347, 0x11348, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x1134b, 0x1134c, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x1134d, 0x1134d, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11357, 0x11357, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11362, 0x11363, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x11366, 0x1136c, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11370, 0x11374, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x113b8, 0x113b8, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x113b9, 0x113ba, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x113bb, 0x113c0, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x113c2, 0x113c2, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x113c5, 0x113c5, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x113c7, 0x113c9, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x113ca, 0x113ca, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x113cc, 0x113cd, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x113ce, 0x113d0, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x113d1, 0x113d1, GraphemeBreakProperty::Prepend },
+        GraphemeRange{ 0x113d2, 0x113d2, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x113e1, 0x113e2, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11435, 0x11437, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x11438, 0x1143f, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11440, 0x11441, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x11442, 0x11444, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11445, 0x11445, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x11446, 0x11446, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1145e, 0x1145e, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x114b0, 0x114b0, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x114b1, 0x114b2, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x114b3, 0x114b8, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x114b9, 0x114b9, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x114ba, 0x114ba, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x114bb, 0x114bc, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x114bd, 0x114bd, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x114be, 0x114be, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x114bf, 0x114c0, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x114c1, 0x114c1, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x114c2, 0x114c3, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x115af, 0x115af, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x115b0, 0x115b1, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x115b2, 0x115b5, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x115b8, 0x115bb, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x115bc, 0x115bd, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x115be, 0x115be, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x115bf, 0x115c0, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x115dc, 0x115dd, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11630, 0x11632, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x11633, 0x1163a, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1163b, 0x1163c, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x1163d, 0x1163d, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1163e, 0x1163e, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x1163f, 0x11640, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x116ab, 0x116ab, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x116ac, 0x116ac, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x116ad, 0x116ad, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x116ae, 0x116af, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x116b0, 0x116b7, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1171d, 0x1171d, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1171e, 0x1171e, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x1171f, 0x1171f, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11722, 0x11725, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11726, 0x11726, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x11727, 0x1172b, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1182c, 0x1182e, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x1182f, 0x11837, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11838, 0x11838, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x11839, 0x1183a, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11930, 0x11930, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11931, 0x11935, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x11937, 0x11938, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x1193b, 0x1193e, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1193f, 0x1193f, GraphemeBreakProperty::Prepend },
+        GraphemeRange{ 0x11940, 0x11940, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x11941, 0x11941, GraphemeBreakProperty::Prepend },
+        GraphemeRange{ 0x11942, 0x11942, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x11943, 0x11943, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x119d1, 0x119d3, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x119d4, 0x119d7, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x119da, 0x119db, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x119dc, 0x119df, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x119e0, 0x119e0, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x119e4, 0x119e4, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x11a01, 0x11a0a, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11a33, 0x11a38, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11a39, 0x11a39, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x11a3a, 0x11a3a, GraphemeBreakProperty::Prepend },
+        GraphemeRange{ 0x11a3b, 0x11a3e, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11a47, 0x11a47, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11a51, 0x11a56, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11a57, 0x11a58, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x11a59, 0x11a5b, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11a84, 0x11a89, GraphemeBreakProperty::Prepend },
+        GraphemeRange{ 0x11a8a, 0x11a96, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11a97, 0x11a97, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x11a98, 0x11a99, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11c2f, 0x11c2f, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x11c30, 0x11c36, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11c38, 0x11c3d, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11c3e, 0x11c3e, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x11c3f, 0x11c3f, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11c92, 0x11ca7, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11ca9, 0x11ca9, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x11caa, 0x11cb0, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11cb1, 0x11cb1, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x11cb2, 0x11cb3, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11cb4, 0x11cb4, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x11cb5, 0x11cb6, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11d31, 0x11d36, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11d3a, 0x11d3a, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11d3c, 0x11d3d, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11d3f, 0x11d45, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11d46, 0x11d46, GraphemeBreakProperty::Prepend },
+        GraphemeRange{ 0x11d47, 0x11d47, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11d8a, 0x11d8e, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x11d90, 0x11d91, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11d93, 0x11d94, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x11d95, 0x11d95, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11d96, 0x11d96, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x11d97, 0x11d97, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11ef3, 0x11ef4, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11ef5, 0x11ef6, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x11f00, 0x11f01, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11f02, 0x11f02, GraphemeBreakProperty::Prepend },
+        GraphemeRange{ 0x11f03, 0x11f03, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x11f34, 0x11f35, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x11f36, 0x11f3a, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11f3e, 0x11f3f, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x11f40, 0x11f42, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x11f5a, 0x11f5a, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x13430, 0x1343f, GraphemeBreakProperty::Control },
+        GraphemeRange{ 0x13440, 0x13440, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x13447, 0x13455, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1611e, 0x16129, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1612a, 0x1612c, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x1612d, 0x1612f, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x16af0, 0x16af4, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x16b30, 0x16b36, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x16d63, 0x16d63, GraphemeBreakProperty::V },
+        GraphemeRange{ 0x16d67, 0x16d6a, GraphemeBreakProperty::V },
+        GraphemeRange{ 0x16f4f, 0x16f4f, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x16f51, 0x16f87, GraphemeBreakProperty::SpacingMark },
+        GraphemeRange{ 0x16f8f, 0x16f92, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x16fe4, 0x16fe4, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x16ff0, 0x16ff1, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1bc9d, 0x1bc9e, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1bca0, 0x1bca3, GraphemeBreakProperty::Control },
+        GraphemeRange{ 0x1cf00, 0x1cf2d, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1cf30, 0x1cf46, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1d165, 0x1d169, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1d16d, 0x1d172, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1d173, 0x1d17a, GraphemeBreakProperty::Control },
+        GraphemeRange{ 0x1d17b, 0x1d182, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1d185, 0x1d18b, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1d1aa, 0x1d1ad, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1d242, 0x1d244, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1da00, 0x1da36, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1da3b, 0x1da6c, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1da75, 0x1da75, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1da84, 0x1da84, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1da9b, 0x1da9f, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1daa1, 0x1daaf, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1e000, 0x1e006, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1e008, 0x1e018, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1e01b, 0x1e021, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1e023, 0x1e024, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1e026, 0x1e02a, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1e08f, 0x1e08f, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1e130, 0x1e136, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1e2ae, 0x1e2ae, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1e2ec, 0x1e2ef, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1e4ec, 0x1e4ef, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1e5ee, 0x1e5ef, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1e8d0, 0x1e8d6, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1e944, 0x1e94a, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1f000, 0x1f0ff, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x1f10d, 0x1f10f, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x1f12f, 0x1f12f, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x1f16c, 0x1f171, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x1f17e, 0x1f17f, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x1f18e, 0x1f18e, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x1f191, 0x1f19a, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x1f1ad, 0x1f1e5, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x1f1e6, 0x1f1ff, GraphemeBreakProperty::RegionalIndicator },
+        GraphemeRange{ 0x1f201, 0x1f20f, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x1f21a, 0x1f21a, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x1f22f, 0x1f22f, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x1f232, 0x1f23a, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x1f23c, 0x1f23f, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x1f249, 0x1f3fa, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x1f3fb, 0x1f3ff, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0x1f400, 0x1f53d, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x1f546, 0x1f64f, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x1f680, 0x1f6ff, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x1f774, 0x1f77f, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x1f7d5, 0x1f7ff, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x1f80c, 0x1f80f, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x1f848, 0x1f84f, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x1f85a, 0x1f85f, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x1f888, 0x1f88f, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x1f8ae, 0x1f8ff, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x1f90c, 0x1f93a, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x1f93c, 0x1f945, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x1f947, 0x1faff, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0x1fc00, 0x1fffd, GraphemeBreakProperty::ExtendedPictographic },
+        GraphemeRange{ 0xe0000, 0xe001f, GraphemeBreakProperty::Control },
+        GraphemeRange{ 0xe0020, 0xe007f, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xe0080, 0xe00ff, GraphemeBreakProperty::Control },
+        GraphemeRange{ 0xe0100, 0xe01ef, GraphemeBreakProperty::Extend },
+        GraphemeRange{ 0xe01f0, 0xe0fff, GraphemeBreakProperty::Control },
+    };
+
+    static constexpr unsigned int s_hangulSyllableFirst = 0xac00;
+    static constexpr unsigned int s_hangulSyllableLast = 0xd7a3;
+    static constexpr unsigned int s_hangulTrailingCount = 28;
+
+    // Routine Description:
+    // - looks up the grapheme break property of a codepoint
+    // Arguments:
+    // - codepoint - the codepoint to look up
+    // Return Value:
+    // - the property of the codepoint
+    GraphemeBreakProperty GetProperty(const unsigned int codepoint) noexcept
+    {
+        if (codepoint >= 0x20 && codepoint < 0x7f)
+        {
+            return GraphemeBreakProperty::Any;
+        }
+
+        if (codepoint >= s_hangulSyllableFirst && codepoint <= s_hangulSyllableLast)
+        {
+            // Every syllable that has no trailing consonant is LV, the rest are LVT.
+            return (codepoint - s_hangulSyllableFirst) % s_hangulTrailingCount == 0 ? GraphemeBreakProperty::LV : GraphemeBreakProperty::LVT;
+        }
+
+        const auto it = std::upper_bound(s_graphemeBreakTable.begin(),
+                                         s_graphemeBreakTable.end(),
+                                         codepoint,
+                                         [](const unsigned int cp, const GraphemeRange& range) noexcept {
+                                             return cp < range.lowerBound;
+                                         });
+        if (it == s_graphemeBreakTable.begin())
+        {
+            return GraphemeBreakProperty::Any;
+        }
+
+        const auto& range = *(it - 1);
+        return codepoint <= range.upperBound ? range.property : GraphemeBreakProperty::Any;
+    }
+
+    // Routine Description:
+    // - decodes the codepoint at the given position and looks up its property.
+    //   An unpaired surrogate is treated like a control character, so that it
+    //   always ends up in a cluster of its own.
+    // Arguments:
+    // - text - the utf16 encoded text
+    // - pos - the position of the codepoint. Moved past it on return.
+    // Return Value:
+    // - the property of the codepoint
+    GraphemeBreakProperty ReadProperty(const std::wstring_view text, size_t& pos) noexcept
+    {
+        const auto wch = text[pos++];
+        if (IS_HIGH_SURROGATE(wch))
+        {
+            if (pos < text.size() && IS_LOW_SURROGATE(text[pos]))
+            {
+                const auto codepoint = 0x10000 + ((static_cast<unsigned int>(wch) & 0x3ff) << 10) + (static_cast<unsigned int>(text[pos]) & 0x3ff);
+                pos++;
+                return GetProperty(codepoint);
+            }
+            return GraphemeBreakProperty::Control;
+        }
+        else if (IS_LOW_SURROGATE(wch))
+        {
+            return GraphemeBreakProperty::Control;
+        }
+        return GetProperty(wch);
+    }
+
+    // Routine Description:
+    // - decides whether two adjacent codepoints belong to the same cluster,
+    //   following the rules of UAX #29.
+    // Arguments:
+    // - prev - the property of the codepoint before the possible break
+    // - next - the property of the codepoint after the possible break
+    // - pictographicZwj - true if the cluster so far ends in an
+    //   Extended_Pictographic Extend* ZWJ sequence
+    // - regionalIndicators - the number of regional indicators the cluster
+    //   so far ends with
+    // Return Value:
+    // - true if there's no break between the two
+    bool IsJoined(const GraphemeBreakProperty prev,
+                  const GraphemeBreakProperty next,
+                  const bool pictographicZwj,
+                  const size_t regionalIndicators) noexcept
+    {
+        using P = GraphemeBreakProperty;
+
+        // GB3: CR x LF
+        if (prev == P::CR && next == P::LF)
+        {
+            return true;
+        }
+        // GB4, GB5: break around all other controls.
+        if (prev == P::CR || prev == P::LF || prev == P::Control ||
+            next == P::CR || next == P::LF || next == P::Control)
+        {
+            return false;
+        }
+        // GB6-GB8: don't break up Hangul syllables.
+        if (prev == P::L && (next == P::L || next == P::V || next == P::LV || next == P::LVT))
+        {
+            return true;
+        }
+        if ((prev == P::LV || prev == P::V) && (next == P::V || next == P::T))
+        {
+            return true;
+        }
+        if ((prev == P::LVT || prev == P::T) && next == P::T)
+        {
+            return true;
+        }
+        // GB9, GB9a: x (Extend | ZWJ | SpacingMark)
+        if (next == P::Extend || next == P::ZWJ || next == P::SpacingMark)
+        {
+            return true;
+        }
+        // GB9b: Prepend x
+        if (prev == P::Prepend)
+        {
+            return true;
+        }
+        // GB11: ExtPict Extend* ZWJ x ExtPict
+        if (pictographicZwj && next == P::ExtendedPictographic)
+        {
+            return true;
+        }
+        // GB12, GB13: regional indicators pair up into flags.
+        if (prev == P::RegionalIndicator && next == P::RegionalIndicator)
+        {
+            return regionalIndicators % 2 == 1;
+        }
+        // GB999: break everywhere else.
+        return false;
+    }
+}
+
+GraphemeClusterIterator::GraphemeClusterIterator(const std::wstring_view text) noexcept :
+    _text{ text },
+    _cluster{ NextCluster(text) }
+{
+}
+
+// Routine Description:
+// - checks if there is a cluster at the current position
+// Return Value:
+// - true until the iterator has moved past the end of the text
+GraphemeClusterIterator::operator bool() const noexcept
+{
+    return !_cluster.empty();
+}
+
+// Routine Description:
+// - gets the current cluster
+// Return Value:
+// - a view of the text of the current cluster
+std::wstring_view GraphemeClusterIterator::operator*() const noexcept
+{
+    return _cluster;
+}
+
+// Routine Description:
+// - moves on to the next cluster
+// Return Value:
+// - reference to this iterator
+GraphemeClusterIterator& GraphemeClusterIterator::operator++() noexcept
+{
+    _text = _text.substr(_cluster.size());
+    _cluster = NextCluster(_text);
+    return *this;
+}
+
+// Routine Description:
+// - gets the text that hasn't been moved past yet
+// Return Value:
+// - a view of the text from the start of the current cluster to the end
+std::wstring_view GraphemeClusterIterator::Remaining() const noexcept
+{
+    return _text;
+}
+
+// Routine Description:
+// - finds the first grapheme cluster of the given text.
+// Arguments:
+// - text - the utf16 encoded text
+// Return Value:
+// - a view of the start of the text, as long as the first cluster. Empty only
+//   if the text is empty.
+std::wstring_view GraphemeClusterIterator::NextCluster(const std::wstring_view text) noexcept
+{
+    if (text.empty())
+    {
+        return {};
+    }
+
+    // Below U+0300, the only two codepoints that join together are CR + LF.
+    // That covers most text we ever see, so skip the table lookups for it.
+    if (text.size() == 1 || (text[0] < 0x300 && text[1] < 0x300 && text[0] != UNICODE_CARRIAGERETURN))
+    {
+        return text.substr(0, 1);
+    }
+
+    size_t pos = 0;
+    auto prev = ReadProperty(text, pos);
+    auto pictographic = prev == GraphemeBreakProperty::ExtendedPictographic;
+    auto pictographicZwj = false;
+    size_t regionalIndicators = prev == GraphemeBreakProperty::RegionalIndicator ? 1 : 0;
+
+    while (pos < text.size())
+    {
+        auto nextPos = pos;
+        const auto next = ReadProperty(text, nextPos);
+        if (!IsJoined(prev, next, pictographicZwj, regionalIndicators))
+        {
+            break;
+        }
+
+        pictographicZwj = pictographic && next == GraphemeBreakProperty::ZWJ;
+        pictographic = next == GraphemeBreakProperty::ExtendedPictographic ||
+                       (pictographic && next == GraphemeBreakProperty::Extend);
+        regionalIndicators = next == GraphemeBreakProperty::RegionalIndicator ? regionalIndicators + 1 : 0;
+
+        prev = next;
+        pos = nextPos;
+    }
+
+    return text.substr(0, pos);
+}
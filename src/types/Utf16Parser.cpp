@@ -52,40 +52,3 @@ std::wstring_view Utf16Parser::ParseNext(std::wstring_view wstr)
     // If we get all the way through and there's nothing valid, then this is just a replacement character as it was broken/garbage.
     return std::wstring_view{ &UNICODE_REPLACEMENT, 1 };
 }
-
-// Routine Description:
-// - formats a utf16 encoded wstring and splits the codepoints into individual collections.
-// - will drop badly formatted leading/trailing char sequences.
-// - does not validate utf16 input beyond proper leading/trailing char sequences.
-// Arguments:
-// - wstr - the string to parse
-// Return Value:
-// - a vector of utf16 codepoints. glyphs that require surrogate pairs will be grouped
-// together in a vector and codepoints that use only one wchar will be in a vector by themselves.
-std::vector<std::vector<wchar_t>> Utf16Parser::Parse(std::wstring_view wstr)
-{
-    std::vector<std::vector<wchar_t>> result;
-    std::vector<wchar_t> sequence;
-    for (const auto wch : wstr)
-    {
-        if (IsLeadingSurrogate(wch))
-        {
-            sequence.clear();
-            sequence.push_back(wch);
-        }
-        else if (IsTrailingSurrogate(wch))
-        {
-            if (!sequence.empty())
-            {
-                sequence.push_back(wch);
-                result.push_back(sequence);
-                sequence.clear();
-            }
-        }
-        else
-        {
-            result.push_back({ wch });
-        }
-    }
-    return result;
-}
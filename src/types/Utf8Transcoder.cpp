@@ -0,0 +1,518 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "inc/Utf8Transcoder.hpp"
+
+#include "../inc/unicode.hpp"
+
+#if defined(_M_IX86) || defined(_M_X64)
+#include <emmintrin.h>
+#define UTF8_TRANSCODER_SSE2
+#endif
+
+using namespace Microsoft::Console;
+
+namespace
+{
+    // Routine Description:
+    // - copies the run of ASCII at the start of the input to the output,
+    //   widening each byte to a wchar_t.
+    // Arguments:
+    // - in - the start of the input
+    // - end - the end of the input
+    // - out - the output. Moved past the copied text on return.
+    // Return Value:
+    // - a pointer to the first non-ASCII byte, or end.
+    const unsigned char* DecodeAscii(const unsigned char* in, const unsigned char* const end, wchar_t*& out) noexcept
+    {
+#ifdef UTF8_TRANSCODER_SSE2
+        const auto zero = _mm_setzero_si128();
+
+        // Blocks of 32 characters, as long as they're all ASCII...
+        while (end - in >= 32)
+        {
+            const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+            const auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 16));
+            if (_mm_movemask_epi8(_mm_or_si128(a, b)) != 0)
+            {
+                break;
+            }
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi8(a, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8), _mm_unpackhi_epi8(a, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), _mm_unpacklo_epi8(b, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 24), _mm_unpackhi_epi8(b, zero));
+            in += 32;
+            out += 32;
+        }
+
+        // ...then blocks of 16, until we find the block the ASCII ends in.
+        while (end - in >= 16)
+        {
+            const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+            const auto mask = _mm_movemask_epi8(a);
+            if (mask != 0)
+            {
+                unsigned long index;
+                _BitScanForward(&index, mask);
+                for (unsigned long i = 0; i < index; i++)
+                {
+                    *out++ = in[i];
+                }
+                return in + index;
+            }
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi8(a, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8), _mm_unpackhi_epi8(a, zero));
+            in += 16;
+            out += 16;
+        }
+#else
+        // Without SSE2, we can still check 8 bytes at a time.
+        while (end - in >= 8)
+        {
+            uint64_t block;
+            memcpy(&block, in, sizeof(block));
+            if ((block & 0x8080808080808080) != 0)
+            {
+                break;
+            }
+
+            for (size_t i = 0; i < 8; i++)
+            {
+                *out++ = in[i];
+            }
+            in += 8;
+        }
+#endif
+
+        while (in < end && *in < 0x80)
+        {
+            *out++ = *in++;
+        }
+        return in;
+    }
+
+    // Routine Description:
+    // - finds the length of the sequence that starts with the given byte.
+    //   The first continuation byte has a narrower range for some lead bytes,
+    //   to rule out overlong encodings, surrogates and anything past U+10FFFF.
+    // Arguments:
+    // - lead - the first byte of the sequence
+    // - lower - receives the lowest valid value of the second byte
+    // - upper - receives the highest valid value of the second byte
+    // Return Value:
+    // - the length of the sequence, or 0 if the byte can't start a sequence
+    //   (including ASCII, which is never part of one).
+    size_t GetSequenceLength(const unsigned char lead, unsigned char& lower, unsigned char& upper) noexcept
+    {
+        lower = 0x80;
+        upper = 0xbf;
+        if (lead >= 0xc2 && lead <= 0xdf)
+        {
+            return 2;
+        }
+        else if (lead >= 0xe0 && lead <= 0xef)
+        {
+            lower = lead == 0xe0 ? 0xa0 : lower;
+            upper = lead == 0xed ? 0x9f : upper;
+            return 3;
+        }
+        else if (lead >= 0xf0 && lead <= 0xf4)
+        {
+            lower = lead == 0xf0 ? 0x90 : lower;
+            upper = lead == 0xf4 ? 0x8f : upper;
+            return 4;
+        }
+        return 0;
+    }
+
+    // Routine Description:
+    // - decodes the (possibly ill-formed) UTF-8 sequence at the start of the
+    //   input. Ill-formed sequences become a single U+FFFD, and only consume
+    //   the bytes that could have been the start of a valid sequence, so that
+    //   a following valid sequence isn't swallowed. (This is the "maximal
+    //   subpart" practice from chapter 3 of the Unicode standard.)
+    // Arguments:
+    // - in - the start of the sequence. Must be a non-ASCII byte.
+    // - end - the end of the input
+    // - out - the output. Moved past the decoded text on return.
+    // Return Value:
+    // - a pointer to the byte following the sequence.
+    const unsigned char* DecodeSequence(const unsigned char* const in, const unsigned char* const end, wchar_t*& out) noexcept
+    {
+        unsigned char lower;
+        unsigned char upper;
+        const auto length = GetSequenceLength(*in, lower, upper);
+        if (length == 0)
+        {
+            *out++ = UNICODE_REPLACEMENT;
+            return in + 1;
+        }
+
+        // The lead byte holds 7 - length bits of the codepoint.
+        unsigned int codepoint = *in & (0x7f >> length);
+
+        for (size_t i = 1; i < length; i++)
+        {
+            if (in + i == end || in[i] < lower || in[i] > upper)
+            {
+                *out++ = UNICODE_REPLACEMENT;
+                return in + i;
+            }
+            codepoint = (codepoint << 6) | (in[i] & 0x3f);
+            lower = 0x80;
+            upper = 0xbf;
+        }
+
+        if (codepoint < 0x10000)
+        {
+            *out++ = static_cast<wchar_t>(codepoint);
+        }
+        else
+        {
+            codepoint -= 0x10000;
+            *out++ = static_cast<wchar_t>(0xd800 + (codepoint >> 10));
+            *out++ = static_cast<wchar_t>(0xdc00 + (codepoint & 0x3ff));
+        }
+        return in + length;
+    }
+
+    // Routine Description:
+    // - finds how many bytes at the end of the input are the start of a
+    //   sequence that isn't complete yet, but could still turn out valid.
+    // Arguments:
+    // - data - the input
+    // - size - the length of the input
+    // Return Value:
+    // - the length of the incomplete sequence (at most 3), or 0 if the input
+    //   doesn't end in one.
+    size_t GetIncompleteSuffixLength(const unsigned char* const data, const size_t size) noexcept
+    {
+        for (size_t length = 1; length <= 3 && length <= size; length++)
+        {
+            const auto lead = data[size - length];
+            if (lead >= 0x80 && lead <= 0xbf)
+            {
+                // A continuation byte, keep looking for the lead byte.
+                continue;
+            }
+
+            unsigned char lower;
+            unsigned char upper;
+            if (GetSequenceLength(lead, lower, upper) <= length)
+            {
+                return 0;
+            }
+
+            for (size_t i = 1; i < length; i++)
+            {
+                const auto trail = data[size - length + i];
+                if (trail < lower || trail > upper)
+                {
+                    return 0;
+                }
+                lower = 0x80;
+                upper = 0xbf;
+            }
+            return length;
+        }
+        return 0;
+    }
+
+    // Routine Description:
+    // - copies the run of ASCII at the start of the input to the output,
+    //   narrowing each wchar_t to a byte.
+    // Arguments:
+    // - in - the start of the input
+    // - end - the end of the input
+    // - out - the output. Moved past the copied text on return.
+    // Return Value:
+    // - a pointer to the first non-ASCII wchar_t, or end.
+    const wchar_t* EncodeAscii(const wchar_t* in, const wchar_t* const end, char*& out) noexcept
+    {
+#ifdef UTF8_TRANSCODER_SSE2
+        const auto nonAscii = _mm_set1_epi16(static_cast<short>(0xff80));
+        const auto zero = _mm_setzero_si128();
+
+        // Blocks of 16 characters, as long as they're all ASCII...
+        while (end - in >= 16)
+        {
+            const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+            const auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 8));
+            const auto high = _mm_and_si128(_mm_or_si128(a, b), nonAscii);
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(high, zero)) != 0xffff)
+            {
+                break;
+            }
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(a, b));
+            in += 16;
+            out += 16;
+        }
+
+        // ...then blocks of 8.
+        while (end - in >= 8)
+        {
+            const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+            const auto high = _mm_and_si128(a, nonAscii);
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(high, zero)) != 0xffff)
+            {
+                break;
+            }
+
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(a, a));
+            in += 8;
+            out += 8;
+        }
+#else
+        // Without SSE2, we can still check 4 characters at a time.
+        while (end - in >= 4)
+        {
+            uint64_t block;
+            memcpy(&block, in, sizeof(block));
+            if ((block & 0xff80ff80ff80ff80) != 0)
+            {
+                break;
+            }
+
+            for (size_t i = 0; i < 4; i++)
+            {
+                *out++ = static_cast<char>(in[i]);
+            }
+            in += 4;
+        }
+#endif
+
+        while (in < end && *in < 0x80)
+        {
+            *out++ = static_cast<char>(*in++);
+        }
+        return in;
+    }
+
+    // Routine Description:
+    // - encodes the (non-ASCII) codepoint at the start of the input.
+    //   Unpaired surrogates are encoded as U+FFFD.
+    // Arguments:
+    // - in - the start of the codepoint. Must not be ASCII.
+    // - end - the end of the input
+    // - out - the output. Moved past the encoded text on return.
+    // Return Value:
+    // - a pointer to the wchar_t following the codepoint.
+    const wchar_t* EncodeCodepoint(const wchar_t* in, const wchar_t* const end, char*& out) noexcept
+    {
+        unsigned int codepoint = *in++;
+        if (IS_HIGH_SURROGATE(codepoint) && in < end && IS_LOW_SURROGATE(*in))
+        {
+            codepoint = 0x10000 + ((codepoint - 0xd800) << 10) + (*in++ - 0xdc00);
+        }
+        else if (IS_HIGH_SURROGATE(codepoint) || IS_LOW_SURROGATE(codepoint))
+        {
+            codepoint = UNICODE_REPLACEMENT;
+        }
+
+        if (codepoint < 0x800)
+        {
+            *out++ = static_cast<char>(0xc0 | (codepoint >> 6));
+        }
+        else if (codepoint < 0x10000)
+        {
+            *out++ = static_cast<char>(0xe0 | (codepoint >> 12));
+            *out++ = static_cast<char>(0x80 | ((codepoint >> 6) & 0x3f));
+        }
+        else
+        {
+            *out++ = static_cast<char>(0xf0 | (codepoint >> 18));
+            *out++ = static_cast<char>(0x80 | ((codepoint >> 12) & 0x3f));
+            *out++ = static_cast<char>(0x80 | ((codepoint >> 6) & 0x3f));
+        }
+        *out++ = static_cast<char>(0x80 | (codepoint & 0x3f));
+        return in;
+    }
+}
+
+// Routine Description:
+// - decodes UTF-8 text as UTF-16.
+// Arguments:
+// - source - the UTF-8 text
+// - out - where to write the UTF-16 text. Must have room for
+//   MaxUtf16Length(source.size()) wchar_ts.
+// Return Value:
+// - a pointer to the wchar_t following the last one written.
+wchar_t* Utf8::DecodeUtf8(const std::string_view source, wchar_t* out) noexcept
+{
+    auto in = reinterpret_cast<const unsigned char*>(source.data());
+    const auto end = in + source.size();
+    while (in < end)
+    {
+        in = DecodeAscii(in, end, out);
+        if (in < end)
+        {
+            in = DecodeSequence(in, end, out);
+        }
+    }
+    return out;
+}
+
+// Routine Description:
+// - encodes UTF-16 text as UTF-8.
+// Arguments:
+// - source - the UTF-16 text
+// - out - where to write the UTF-8 text. Must have room for
+//   MaxUtf8Length(source.size()) chars.
+// Return Value:
+// - a pointer to the char following the last one written.
+char* Utf8::EncodeUtf8(const std::wstring_view source, char* out) noexcept
+{
+    auto in = source.data();
+    const auto end = in + source.size();
+    while (in < end)
+    {
+        in = EncodeAscii(in, end, out);
+        if (in < end)
+        {
+            in = EncodeCodepoint(in, end, out);
+        }
+    }
+    return out;
+}
+
+// Routine Description:
+// - decodes UTF-8 text, and appends it to the end of the given string.
+//   Reusing the same string for many conversions avoids allocating a new
+//   one every time.
+// Arguments:
+// - source - the UTF-8 text
+// - dest - the string to append the UTF-16 text to
+// Return Value:
+// - <none>
+// - NOTE: Throws if the string can't be grown.
+void Utf8::AppendAsUtf16(const std::string_view source, std::wstring& dest)
+{
+    const auto start = dest.size();
+    dest.resize(start + MaxUtf16Length(source.size()));
+    const auto end = DecodeUtf8(source, dest.data() + start);
+    dest.resize(end - dest.data());
+}
+
+// Routine Description:
+// - encodes UTF-16 text, and appends it to the end of the given string.
+//   Reusing the same string for many conversions avoids allocating a new
+//   one every time.
+// Arguments:
+// - source - the UTF-16 text
+// - dest - the string to append the UTF-8 text to
+// Return Value:
+// - <none>
+// - NOTE: Throws if the string can't be grown.
+void Utf8::AppendAsUtf8(const std::wstring_view source, std::string& dest)
+{
+    const auto start = dest.size();
+    dest.resize(start + MaxUtf8Length(source.size()));
+    const auto end = EncodeUtf8(source, dest.data() + start);
+    dest.resize(end - dest.data());
+}
+
+// Routine Description:
+// - counts the bytes that the given UTF-16 text takes when encoded as UTF-8.
+// Arguments:
+// - source - the UTF-16 text
+// Return Value:
+// - the length of the text in UTF-8, in bytes.
+size_t Utf8::GetUtf8Length(const std::wstring_view source) noexcept
+{
+    size_t length = 0;
+    for (size_t i = 0; i < source.size(); i++)
+    {
+        const auto wch = source[i];
+        if (wch < 0x80)
+        {
+            length += 1;
+        }
+        else if (wch < 0x800)
+        {
+            length += 2;
+        }
+        else if (IS_HIGH_SURROGATE(wch) && i + 1 < source.size() && IS_LOW_SURROGATE(source[i + 1]))
+        {
+            length += 4;
+            i++;
+        }
+        else
+        {
+            // Everything else, including unpaired surrogates (which become
+            // U+FFFD), takes 3 bytes.
+            length += 3;
+        }
+    }
+    return length;
+}
+
+// Routine Description:
+// - decodes the next piece of a UTF-8 stream. If the piece ends in the middle
+//   of a sequence, the start of that sequence is held back until the next call.
+// Arguments:
+// - source - the next piece of the stream
+// - dest - where to write the UTF-16 text. Must have room for
+//   MaxOutputLength(source.size()) wchar_ts.
+// Return Value:
+// - the number of wchar_ts written.
+// - NOTE: Throws E_INVALIDARG if dest is too small.
+size_t Utf8::StreamDecoder::Decode(const std::string_view source, const gsl::span<wchar_t> dest)
+{
+    THROW_HR_IF(E_INVALIDARG, static_cast<size_t>(dest.size()) < MaxOutputLength(source.size()));
+
+    auto out = dest.data();
+    auto in = reinterpret_cast<const unsigned char*>(source.data());
+    auto remaining = source.size();
+
+    if (_pendingLength != 0)
+    {
+        // Finish the sequence that was split at the end of the previous piece.
+        unsigned char sequence[4];
+        std::copy_n(_pending, _pendingLength, sequence);
+        const auto added = std::min(remaining, ARRAYSIZE(sequence) - _pendingLength);
+        std::copy_n(in, added, sequence + _pendingLength);
+        const auto length = _pendingLength + added;
+
+        if (GetIncompleteSuffixLength(sequence, length) == length)
+        {
+            // Still not complete, which means we've used up all of the input.
+            std::copy_n(sequence, length, _pending);
+            _pendingLength = length;
+            return 0;
+        }
+
+        // The held back bytes were a valid start of a sequence, so at the
+        // very least all of them are consumed here.
+        const auto consumed = static_cast<size_t>(DecodeSequence(sequence, sequence + length, out) - sequence);
+        in += consumed - _pendingLength;
+        remaining -= consumed - _pendingLength;
+        _pendingLength = 0;
+    }
+
+    const auto suffix = GetIncompleteSuffixLength(in, remaining);
+    out = DecodeUtf8({ reinterpret_cast<const char*>(in), remaining - suffix }, out);
+    std::copy_n(in + remaining - suffix, suffix, _pending);
+    _pendingLength = suffix;
+
+    return out - dest.data();
+}
+
+// Routine Description:
+// - forgets about any sequence that's being held back, like when the stream
+//   is interrupted or its encoding changes.
+void Utf8::StreamDecoder::Reset() noexcept
+{
+    _pendingLength = 0;
+}
+
+// Routine Description:
+// - gets the number of bytes being held back until the rest of their
+//   sequence arrives.
+size_t Utf8::StreamDecoder::GetPendingLength() const noexcept
+{
+    return _pendingLength;
+}
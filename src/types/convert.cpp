@@ -3,6 +3,7 @@
 
 #include "precomp.h"
 #include "inc/convert.hpp"
+#include "inc/Utf8Transcoder.hpp"
 
 #include "../inc/unicode.hpp"
 
@@ -34,6 +35,14 @@ static const WORD leftShiftScanCode = 0x2A;
         return {};
     }
 
+    // UTF-8 is by far the most common, and we can convert it ourselves in a single pass.
+    if (codePage == CP_UTF8)
+    {
+        std::wstring result;
+        Microsoft::Console::Utf8::AppendAsUtf16(source, result);
+        return result;
+    }
+
     int iSource; // convert to int because Mb2Wc requires it.
     THROW_IF_FAILED(SizeTToInt(source.size(), &iSource));
 
@@ -72,6 +81,14 @@ static const WORD leftShiftScanCode = 0x2A;
         return {};
     }
 
+    // UTF-8 is by far the most common, and we can convert it ourselves in a single pass.
+    if (codepage == CP_UTF8)
+    {
+        std::string result;
+        Microsoft::Console::Utf8::AppendAsUtf8(source, result);
+        return result;
+    }
+
     int iSource; // convert to int because Wc2Mb requires it.
     THROW_IF_FAILED(SizeTToInt(source.size(), &iSource));
 
@@ -115,6 +132,11 @@ static const WORD leftShiftScanCode = 0x2A;
         return 0;
     }
 
+    if (codepage == CP_UTF8)
+    {
+        return Microsoft::Console::Utf8::GetUtf8Length(source);
+    }
+
     int iSource; // convert to int because Wc2Mb requires it
     THROW_IF_FAILED(SizeTToInt(source.size(), &iSource));
 
@@ -132,8 +154,47 @@ static const WORD leftShiftScanCode = 0x2A;
     return cchTarget;
 }
 
+// Routine Description:
+// - wraps a series of key event records up as KeyEvents
+// Arguments:
+// - records - the records to wrap
+// Return Value:
+// - deque of KeyEvents with the same contents as the records
+// Note:
+// - will throw exception on error
+static std::deque<std::unique_ptr<KeyEvent>> _ToKeyEvents(const std::vector<INPUT_RECORD>& records)
+{
+    std::deque<std::unique_ptr<KeyEvent>> keyEvents;
+    for (const auto& record : records)
+    {
+        keyEvents.push_back(std::make_unique<KeyEvent>(record.Event.KeyEvent));
+    }
+    return keyEvents;
+}
+
 std::deque<std::unique_ptr<KeyEvent>> CharToKeyEvents(const wchar_t wch,
                                                       const unsigned int codepage)
+{
+    std::vector<INPUT_RECORD> records;
+    CharToKeyEvents(wch, codepage, records);
+    return _ToKeyEvents(records);
+}
+
+// Routine Description:
+// - converts a wchar_t into a series of key event records as if it was
+// typed, and appends them to the given records. This avoids allocating a
+// KeyEvent for each of them when converting a lot of text.
+// Arguments:
+// - wch - the wchar_t to convert
+// - codepage - the codepage used if the char has to be input through the numpad
+// - records - where to append the key event records
+// Return Value:
+// - <none>
+// Note:
+// - will throw exception on error
+void CharToKeyEvents(const wchar_t wch,
+                     const unsigned int codepage,
+                     _Inout_ std::vector<INPUT_RECORD>& records)
 {
     const short invalidKey = -1;
     short keyState = VkKeyScanW(wch);
@@ -152,19 +213,16 @@ std::deque<std::unique_ptr<KeyEvent>> CharToKeyEvents(const wchar_t wch,
         }
     }
 
-    std::deque<std::unique_ptr<KeyEvent>> convertedEvents;
     if (keyState == invalidKey)
     {
         // if VkKeyScanW fails (char is not in kbd layout), we must
         // emulate the key being input through the numpad
-        convertedEvents = SynthesizeNumpadEvents(wch, codepage);
+        SynthesizeNumpadEvents(wch, codepage, records);
     }
     else
     {
-        convertedEvents = SynthesizeKeyboardEvents(wch, keyState);
+        SynthesizeKeyboardEvents(wch, keyState, records);
     }
-
-    return convertedEvents;
 }
 
 // Routine Description:
@@ -177,33 +235,54 @@ std::deque<std::unique_ptr<KeyEvent>> CharToKeyEvents(const wchar_t wch,
 // Note:
 // - will throw exception on error
 std::deque<std::unique_ptr<KeyEvent>> SynthesizeKeyboardEvents(const wchar_t wch, const short keyState)
+{
+    std::vector<INPUT_RECORD> records;
+    SynthesizeKeyboardEvents(wch, keyState, records);
+    return _ToKeyEvents(records);
+}
+
+// Routine Description:
+// - converts a wchar_t into a series of key event records as if it was
+// typed using the keyboard, and appends them to the given records
+// Arguments:
+// - wch - the wchar_t to convert
+// - keyState - the result of VkKeyScanW for wch
+// - records - where to append the key event records
+// Return Value:
+// - <none>
+// Note:
+// - will throw exception on error
+void SynthesizeKeyboardEvents(const wchar_t wch,
+                              const short keyState,
+                              _Inout_ std::vector<INPUT_RECORD>& records)
 {
     const byte modifierState = HIBYTE(keyState);
 
     bool altGrSet = false;
     bool shiftSet = false;
-    std::deque<std::unique_ptr<KeyEvent>> keyEvents;
 
     // add modifier key event if necessary
     if (WI_AreAllFlagsSet(modifierState, VkKeyScanModState::CtrlAndAltPressed))
     {
         altGrSet = true;
-        keyEvents.push_back(std::make_unique<KeyEvent>(true,
-                                                       1ui16,
-                                                       static_cast<WORD>(VK_MENU),
-                                                       altScanCode,
-                                                       UNICODE_NULL,
-                                                       (ENHANCED_KEY | LEFT_CTRL_PRESSED | RIGHT_ALT_PRESSED)));
+        records.push_back(KeyEvent{ true,
+                                    1ui16,
+                                    static_cast<WORD>(VK_MENU),
+                                    altScanCode,
+                                    UNICODE_NULL,
+                                    (ENHANCED_KEY | LEFT_CTRL_PRESSED | RIGHT_ALT_PRESSED) }
+                              .ToInputRecord());
     }
     else if (WI_IsFlagSet(modifierState, VkKeyScanModState::ShiftPressed))
     {
         shiftSet = true;
-        keyEvents.push_back(std::make_unique<KeyEvent>(true,
-                                                       1ui16,
-                                                       static_cast<WORD>(VK_SHIFT),
-                                                       leftShiftScanCode,
-                                                       UNICODE_NULL,
-                                                       SHIFT_PRESSED));
+        records.push_back(KeyEvent{ true,
+                                    1ui16,
+                                    static_cast<WORD>(VK_SHIFT),
+                                    leftShiftScanCode,
+                                    UNICODE_NULL,
+                                    SHIFT_PRESSED }
+                              .ToInputRecord());
     }
 
     const WORD virtualScanCode = gsl::narrow<WORD>(MapVirtualKeyW(wch, MAPVK_VK_TO_VSC));
@@ -224,31 +303,31 @@ std::deque<std::unique_ptr<KeyEvent>> SynthesizeKeyboardEvents(const wchar_t wch
     }
 
     // add key event down and up
-    keyEvents.push_back(std::make_unique<KeyEvent>(keyEvent));
+    records.push_back(keyEvent.ToInputRecord());
     keyEvent.SetKeyDown(false);
-    keyEvents.push_back(std::make_unique<KeyEvent>(keyEvent));
+    records.push_back(keyEvent.ToInputRecord());
 
     // add modifier key up event
     if (altGrSet)
     {
-        keyEvents.push_back(std::make_unique<KeyEvent>(false,
-                                                       1ui16,
-                                                       static_cast<WORD>(VK_MENU),
-                                                       altScanCode,
-                                                       UNICODE_NULL,
-                                                       ENHANCED_KEY));
+        records.push_back(KeyEvent{ false,
+                                    1ui16,
+                                    static_cast<WORD>(VK_MENU),
+                                    altScanCode,
+                                    UNICODE_NULL,
+                                    ENHANCED_KEY }
+                              .ToInputRecord());
     }
     else if (shiftSet)
     {
-        keyEvents.push_back(std::make_unique<KeyEvent>(false,
-                                                       1ui16,
-                                                       static_cast<WORD>(VK_SHIFT),
-                                                       leftShiftScanCode,
-                                                       UNICODE_NULL,
-                                                       0));
+        records.push_back(KeyEvent{ false,
+                                    1ui16,
+                                    static_cast<WORD>(VK_SHIFT),
+                                    leftShiftScanCode,
+                                    UNICODE_NULL,
+                                    0 }
+                              .ToInputRecord());
     }
-
-    return keyEvents;
 }
 
 // Routine Description:
@@ -263,15 +342,34 @@ std::deque<std::unique_ptr<KeyEvent>> SynthesizeKeyboardEvents(const wchar_t wch
 // - will throw exception on error
 std::deque<std::unique_ptr<KeyEvent>> SynthesizeNumpadEvents(const wchar_t wch, const unsigned int codepage)
 {
-    std::deque<std::unique_ptr<KeyEvent>> keyEvents;
+    std::vector<INPUT_RECORD> records;
+    SynthesizeNumpadEvents(wch, codepage, records);
+    return _ToKeyEvents(records);
+}
 
+// Routine Description:
+// - converts a wchar_t into a series of key event records as if it was
+// typed using Alt + numpad, and appends them to the given records
+// Arguments:
+// - wch - the wchar_t to convert
+// - codepage - the codepage to find the numpad code of wch in
+// - records - where to append the key event records
+// Return Value:
+// - <none>
+// Note:
+// - will throw exception on error
+void SynthesizeNumpadEvents(const wchar_t wch,
+                            const unsigned int codepage,
+                            _Inout_ std::vector<INPUT_RECORD>& records)
+{
     //alt keydown
-    keyEvents.push_back(std::make_unique<KeyEvent>(true,
-                                                   1ui16,
-                                                   static_cast<WORD>(VK_MENU),
-                                                   altScanCode,
-                                                   UNICODE_NULL,
-                                                   LEFT_ALT_PRESSED));
+    records.push_back(KeyEvent{ true,
+                                1ui16,
+                                static_cast<WORD>(VK_MENU),
+                                altScanCode,
+                                UNICODE_NULL,
+                                LEFT_ALT_PRESSED }
+                          .ToInputRecord());
 
     const int radix = 10;
     std::wstring wstr{ wch };
@@ -299,29 +397,31 @@ std::deque<std::unique_ptr<KeyEvent>> SynthesizeNumpadEvents(const wchar_t wch,
             const WORD virtualKey = ch - '0' + VK_NUMPAD0;
             const WORD virtualScanCode = gsl::narrow<WORD>(MapVirtualKeyW(virtualKey, MAPVK_VK_TO_VSC));
 
-            keyEvents.push_back(std::make_unique<KeyEvent>(true,
-                                                           1ui16,
-                                                           virtualKey,
-                                                           virtualScanCode,
-                                                           UNICODE_NULL,
-                                                           LEFT_ALT_PRESSED));
-            keyEvents.push_back(std::make_unique<KeyEvent>(false,
-                                                           1ui16,
-                                                           virtualKey,
-                                                           virtualScanCode,
-                                                           UNICODE_NULL,
-                                                           LEFT_ALT_PRESSED));
+            records.push_back(KeyEvent{ true,
+                                        1ui16,
+                                        virtualKey,
+                                        virtualScanCode,
+                                        UNICODE_NULL,
+                                        LEFT_ALT_PRESSED }
+                                  .ToInputRecord());
+            records.push_back(KeyEvent{ false,
+                                        1ui16,
+                                        virtualKey,
+                                        virtualScanCode,
+                                        UNICODE_NULL,
+                                        LEFT_ALT_PRESSED }
+                                  .ToInputRecord());
         }
     }
 
     // alt keyup
-    keyEvents.push_back(std::make_unique<KeyEvent>(false,
-                                                   1ui16,
-                                                   static_cast<WORD>(VK_MENU),
-                                                   altScanCode,
-                                                   wch,
-                                                   0));
-    return keyEvents;
+    records.push_back(KeyEvent{ false,
+                                1ui16,
+                                static_cast<WORD>(VK_MENU),
+                                altScanCode,
+                                wch,
+                                0 }
+                          .ToInputRecord());
 }
 
 // Routine Description:
@@ -32,6 +32,7 @@ public:
     CodepointWidth GetWidth(const std::wstring_view glyph) const noexcept;
     bool IsWide(const std::wstring_view glyph) const;
     bool IsWide(const wchar_t wch) const noexcept;
+    void GetWidths(const std::wstring_view run, const gsl::span<CodepointWidth> widths) const;
     void SetFallbackMethod(std::function<bool(const std::wstring_view)> pfnFallback);
     void NotifyFontChanged() const noexcept;
 
@@ -42,8 +43,20 @@ public:
 private:
     bool _lookupIsWide(const std::wstring_view glyph) const noexcept;
     bool _checkFallbackViaCache(const std::wstring_view glyph) const;
+    bool _tryGetCachedFallback(const unsigned int codepoint, bool& isWide) const noexcept;
+    void _cacheFallback(const unsigned int codepoint, const bool isWide) const;
     static unsigned int _extractCodepoint(const std::wstring_view glyph) noexcept;
-
-    mutable std::map<std::wstring, bool> _fallbackCache;
+    static CodepointWidth _lookupWidth(const unsigned int codepoint) noexcept;
+    static CodepointWidth _searchWidth(const unsigned int codepoint) noexcept;
+
+    struct FallbackCacheEntry
+    {
+        unsigned int codepoint;
+        bool isWide;
+    };
+
+    // Answers of the fallback method, by codepoint. See _cacheFallback.
+    mutable std::vector<FallbackCacheEntry> _fallbackCache;
+    mutable size_t _fallbackCacheSize{ 0 };
     std::function<bool(std::wstring_view)> _pfnFallbackMethod;
 };
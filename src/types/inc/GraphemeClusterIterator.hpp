@@ -0,0 +1,38 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- GraphemeClusterIterator.hpp
+
+Abstract:
+- Splits a string of UTF-16 text into grapheme clusters, the units of text
+    that a user thinks of as a single character and that occupy a single
+    cell (or a pair of cells) in the buffer.
+- Follows the extended grapheme cluster rules of UAX #29: combining marks,
+    ZWJ emoji sequences, regional indicator flags and Hangul syllables are
+    all kept together, and surrogate pairs are never split.
+- The iterator only hands out views into the string it was given, so walking
+    text with it doesn't allocate anything.
+--*/
+
+#pragma once
+
+class GraphemeClusterIterator final
+{
+public:
+    GraphemeClusterIterator(const std::wstring_view text) noexcept;
+
+    explicit operator bool() const noexcept;
+    std::wstring_view operator*() const noexcept;
+    GraphemeClusterIterator& operator++() noexcept;
+
+    std::wstring_view Remaining() const noexcept;
+
+    static std::wstring_view NextCluster(const std::wstring_view text) noexcept;
+
+private:
+    // The text from the start of the current cluster onwards.
+    std::wstring_view _text;
+    std::wstring_view _cluster;
+};
@@ -6,8 +6,11 @@ Module Name:
 - UTF8OutPipeReader.hpp
 
 Abstract:
-- This reads a UTF-8 stream and gives back a buffer that contains complete code points only
-- Partial UTF-8 code points at the end of the buffer read are cached and prepended to the next chunk read
+- This reads a UTF-8 stream and gives back the text decoded as UTF-16
+- Partial UTF-8 code points at the end of the buffer read are held back by the
+  decoder and completed with the next chunk read
+- Reads are up to 64KB at a time, so that a lot of output costs a few reads
+  (and a few events for whoever's listening) rather than one every page
 
 Author(s):
 - Steffen Illhardt (german-one) 12-July-2019
@@ -22,47 +25,24 @@ Author(s):
 #include <windows.h>
 #include <wil\common.h>
 #include <wil\resource.h>
+#include <memory>
 #include <string_view>
 
+#include "Utf8Transcoder.hpp"
+
 class UTF8OutPipeReader final
 {
 public:
+    static constexpr size_t BufferSize{ 64 * 1024 };
+
     UTF8OutPipeReader(HANDLE outPipe);
-    [[nodiscard]] HRESULT Read(_Out_ std::string_view& strView);
+    [[nodiscard]] HRESULT Read(_Out_ std::wstring_view& wstrView);
 
 private:
-    enum _Utf8BitMasks : BYTE
-    {
-        IsAsciiByte = 0b0'0000000, // Any byte representing an ASCII character has the MSB set to 0
-        MaskAsciiByte = 0b1'0000000, // Bit mask to be used in a bitwise AND operation to find out whether or not a byte match the IsAsciiByte pattern
-        IsContinuationByte = 0b10'000000, // Continuation bytes of any UTF-8 non-ASCII character have the MSB set to 1 and the adjacent bit set to 0
-        MaskContinuationByte = 0b11'000000, // Bit mask to be used in a bitwise AND operation to find out whether or not a byte match the IsContinuationByte pattern
-        IsLeadByteTwoByteSequence = 0b110'00000, // A lead byte that indicates a UTF-8 non-ASCII character consisting of two bytes has the two highest bits set to 1 and the adjacent bit set to 0
-        MaskLeadByteTwoByteSequence = 0b111'00000, // Bit mask to be used in a bitwise AND operation to find out whether or not a lead byte match the IsLeadByteTwoByteSequence pattern
-        IsLeadByteThreeByteSequence = 0b1110'0000, // A lead byte that indicates a UTF-8 non-ASCII character consisting of three bytes has the three highest bits set to 1 and the adjacent bit set to 0
-        MaskLeadByteThreeByteSequence = 0b1111'0000, // Bit mask to be used in a bitwise AND operation to find out whether or not a lead byte match the IsLeadByteThreeByteSequence pattern
-        IsLeadByteFourByteSequence = 0b11110'000, // A lead byte that indicates a UTF-8 non-ASCII character consisting of four bytes has the four highest bits set to 1 and the adjacent bit set to 0
-        MaskLeadByteFourByteSequence = 0b11111'000 // Bit mask to be used in a bitwise AND operation to find out whether or not a lead byte match the IsLeadByteFourByteSequence pattern
-    };
-
-    // array of bitmasks
-    constexpr const static BYTE _cmpMasks[]{
-        0, // unused
-        _Utf8BitMasks::MaskContinuationByte,
-        _Utf8BitMasks::MaskLeadByteTwoByteSequence,
-        _Utf8BitMasks::MaskLeadByteThreeByteSequence,
-    };
-
-    // array of values for the comparisons
-    constexpr const static BYTE _cmpOperands[]{
-        0, // unused
-        _Utf8BitMasks::IsAsciiByte, // intentionally conflicts with MaskContinuationByte
-        _Utf8BitMasks::IsLeadByteTwoByteSequence,
-        _Utf8BitMasks::IsLeadByteThreeByteSequence,
-    };
+    static constexpr size_t _decodedSize{ Microsoft::Console::Utf8::StreamDecoder::MaxOutputLength(BufferSize) };
 
     HANDLE _outPipe; // non-owning reference to a pipe.
-    BYTE _buffer[4096]{ 0 }; // buffer for the chunk read
-    BYTE _utf8Partials[4]{ 0 }; // buffer for code units of a partial UTF-8 code point that have to be cached
-    DWORD _dwPartialsLen{}; // number of cached UTF-8 code units
+    std::unique_ptr<char[]> _buffer; // buffer for the chunk read. Too big for the reading thread's stack.
+    std::unique_ptr<wchar_t[]> _decoded; // buffer for the decoded chunk
+    Microsoft::Console::Utf8::StreamDecoder _decoder;
 };
@@ -27,7 +27,6 @@ private:
     static constexpr std::bitset<IndicatorBitCount> TrailingSurrogateMask = { 55 }; // 110 111 indicates a trailing surrogate
 
 public:
-    static std::vector<std::vector<wchar_t>> Parse(std::wstring_view wstr);
     static std::wstring_view ParseNext(std::wstring_view wstr);
 
     // Routine Description:
@@ -0,0 +1,72 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- Utf8Transcoder.hpp
+
+Abstract:
+- Converts text between UTF-8 and UTF-16, without going through
+    MultiByteToWideChar/WideCharToMultiByte and without allocating a new
+    string for every conversion.
+- Runs of ASCII, which make up the bulk of what goes through a terminal, are
+    converted a block of 16 or 32 characters at a time.
+- StreamDecoder decodes UTF-8 that arrives in pieces, carrying sequences
+    that are split between pieces over to the next one.
+- Invalid input is never rejected: ill-formed UTF-8 is decoded as U+FFFD (one
+    per maximal ill-formed subpart, as recommended by the Unicode standard),
+    and unpaired surrogates are encoded as U+FFFD, the same as the Windows
+    conversion functions do.
+--*/
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace Microsoft::Console::Utf8
+{
+    // The most UTF-16 code units that the given number of UTF-8 bytes can
+    // decode to. Every byte becomes at most one code unit.
+    constexpr size_t MaxUtf16Length(const size_t utf8Length) noexcept
+    {
+        return utf8Length;
+    }
+
+    // The most UTF-8 bytes that the given number of UTF-16 code units can
+    // encode to. Every code unit becomes at most three bytes.
+    constexpr size_t MaxUtf8Length(const size_t utf16Length) noexcept
+    {
+        return utf16Length * 3;
+    }
+
+    wchar_t* DecodeUtf8(const std::string_view source, wchar_t* out) noexcept;
+    char* EncodeUtf8(const std::wstring_view source, char* out) noexcept;
+
+    void AppendAsUtf16(const std::string_view source, std::wstring& dest);
+    void AppendAsUtf8(const std::wstring_view source, std::string& dest);
+
+    size_t GetUtf8Length(const std::wstring_view source) noexcept;
+
+    // Decodes UTF-8 that arrives in pieces, like reads from a pipe. A
+    // sequence that's split between two pieces is held back (at most three
+    // bytes of it) until the rest of it arrives.
+    class StreamDecoder final
+    {
+    public:
+        // The most UTF-16 code units that Decode can write for the given
+        // number of bytes: the held back sequence can add one more.
+        static constexpr size_t MaxOutputLength(const size_t utf8Length) noexcept
+        {
+            return utf8Length + 1;
+        }
+
+        size_t Decode(const std::string_view source, const gsl::span<wchar_t> dest);
+        void Reset() noexcept;
+        size_t GetPendingLength() const noexcept;
+
+    private:
+        char _pending[3]{};
+        size_t _pendingLength{ 0 };
+    };
+}
@@ -18,6 +18,7 @@ Author:
 #include <string>
 #include <string_view>
 #include <memory>
+#include <vector>
 #include "IInputEvent.hpp"
 
 enum class CodepointWidth : BYTE
@@ -38,11 +39,16 @@ enum class CodepointWidth : BYTE
                                      const std::wstring_view source);
 
 std::deque<std::unique_ptr<KeyEvent>> CharToKeyEvents(const wchar_t wch, const unsigned int codepage);
+void CharToKeyEvents(const wchar_t wch, const unsigned int codepage, _Inout_ std::vector<INPUT_RECORD>& records);
 
 std::deque<std::unique_ptr<KeyEvent>> SynthesizeKeyboardEvents(const wchar_t wch,
                                                                const short keyState);
+void SynthesizeKeyboardEvents(const wchar_t wch,
+                              const short keyState,
+                              _Inout_ std::vector<INPUT_RECORD>& records);
 
 std::deque<std::unique_ptr<KeyEvent>> SynthesizeNumpadEvents(const wchar_t wch, const unsigned int codepage);
+void SynthesizeNumpadEvents(const wchar_t wch, const unsigned int codepage, _Inout_ std::vector<INPUT_RECORD>& records);
 
 CodepointWidth GetQuickCharWidth(const wchar_t wch) noexcept;
 
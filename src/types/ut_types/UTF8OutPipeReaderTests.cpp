@@ -25,8 +25,8 @@ class UTF8OutPipeReaderTests
         //   1    2    3    4
         // 0xF0 0x90 0x8D 0x88
         //
-        // For the test a std::string is filled with 4104 '.' characters to make sure it exceeds the
-        //  buffer size of 4096 bytes in UTF8OutPipeReader.
+        // For the test a std::string is filled with '.' characters to make sure it exceeds the
+        //  buffer size of UTF8OutPipeReader by 8 bytes.
         //
         // This figure shows how the string is getting changed for the 7 sub-tests. The digits 1 to 4
         //  represent the four bytes of the 'Hwair' letter. The vertical bar represents the buffer boundary.
@@ -44,12 +44,12 @@ class UTF8OutPipeReaderTests
         //  second chunk.
         //
         // At the beginning of a test the whole string is converted into a winrt::hstring for reference.
-        // During the test a second hstring is concatenated out of the chunks that we get from
-        //  UTF8OutPipeReader::Read. Each chunk is separately converted to hstring in order to make
-        //  sure it would be corrupted if we get UTF-8 partials.
+        // During the test a second hstring is concatenated out of the decoded chunks that we get from
+        //  UTF8OutPipeReader::Read. The chunks would contain replacement characters if the reader
+        //  decoded UTF-8 partials on their own.
         // The test is positive if both hstrings are equal.
 
-        const size_t bufferSize{ 4096 }; // NOTE: This has to match the buffer size in UTF8OutPipeReader!
+        const size_t bufferSize{ UTF8OutPipeReader::BufferSize };
         std::string utf8TestString(bufferSize + 8, '.'); // create a test string with the required size
 
         // Test 1:
@@ -109,7 +109,7 @@ class UTF8OutPipeReaderTests
     // Performs the sub-tests.
     HRESULT RunTest(std::string& utf8TestString)
     {
-        std::string_view strView{}; // contains the chunk that we get from UTF8OutPipeReader::Read
+        std::wstring_view wstrView{}; // contains the chunk that we get from UTF8OutPipeReader::Read
         const winrt::hstring utf16Expected{ winrt::to_hstring(utf8TestString) }; // contains the whole string converted to UTF-16
         winrt::hstring utf16Actual{}; // will be concatenated from the converted chunks
 
@@ -117,7 +117,7 @@ class UTF8OutPipeReaderTests
         wil::unique_hfile inPipe{};
 
         SECURITY_ATTRIBUTES sa{ sizeof(SECURITY_ATTRIBUTES) };
-        CreatePipe(&outPipe, &inPipe, &sa, 0); // create the pipe handles
+        CreatePipe(&outPipe, &inPipe, &sa, static_cast<DWORD>(UTF8OutPipeReader::BufferSize)); // create the pipe handles, big enough for a whole buffer
 
         UTF8OutPipeReader reader{ outPipe.get() };
 
@@ -129,17 +129,17 @@ class UTF8OutPipeReaderTests
         // process the chunks that we get from UTF8OutPipeReader::Read
         while (true)
         {
-            // get a chunk of UTF-8 data
-            THROW_IF_FAILED(reader.Read(strView));
+            // get a chunk of decoded data
+            THROW_IF_FAILED(reader.Read(wstrView));
 
-            if (strView.empty())
+            if (wstrView.empty())
             {
                 // this is okay, no data left in the pipe
                 break;
             }
 
-            // convert the chunk to hstring and append it to the resulting hstring
-            utf16Actual = utf16Actual + winrt::to_hstring(strView);
+            // append the chunk to the resulting hstring
+            utf16Actual = utf16Actual + winrt::hstring{ wstrView };
         }
 
         WaitForSingleObject(threadHandle.get(), 2000);
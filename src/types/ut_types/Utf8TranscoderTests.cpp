@@ -0,0 +1,259 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "..\..\inc\consoletaeftemplates.hpp"
+
+#include "..\inc\Utf8Transcoder.hpp"
+
+#include <chrono>
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+using namespace Microsoft::Console;
+
+class Utf8TranscoderTests
+{
+    TEST_CLASS(Utf8TranscoderTests);
+
+    TEST_METHOD(DecodesValidText);
+    TEST_METHOD(EncodesValidText);
+    TEST_METHOD(HandlesEveryBlockBoundary);
+    TEST_METHOD(ReplacesIllFormedUtf8);
+    TEST_METHOD(ReplacesUnpairedSurrogates);
+    TEST_METHOD(AppendsToExistingText);
+    TEST_METHOD(StreamDecodesEverySplit);
+    TEST_METHOD(StreamHoldsIncompleteSequences);
+    TEST_METHOD(BenchmarkCorpora);
+
+    static std::wstring Decode(const std::string_view utf8)
+    {
+        std::wstring result;
+        Utf8::AppendAsUtf16(utf8, result);
+        return result;
+    }
+
+    static std::string Encode(const std::wstring_view utf16)
+    {
+        std::string result;
+        Utf8::AppendAsUtf8(utf16, result);
+        VERIFY_ARE_EQUAL(result.size(), Utf8::GetUtf8Length(utf16));
+        return result;
+    }
+
+    static std::wstring WindowsDecode(const std::string_view utf8)
+    {
+        std::wstring result(utf8.size(), L'\0');
+        const auto written = MultiByteToWideChar(CP_UTF8, 0, utf8.data(), gsl::narrow<int>(utf8.size()), result.data(), gsl::narrow<int>(result.size()));
+        result.resize(written);
+        return result;
+    }
+
+    static std::wstring StreamDecode(Utf8::StreamDecoder& decoder, const std::string_view utf8)
+    {
+        std::wstring result(Utf8::StreamDecoder::MaxOutputLength(utf8.size()), L'\0');
+        result.resize(decoder.Decode(utf8, { result.data(), gsl::narrow<ptrdiff_t>(result.size()) }));
+        return result;
+    }
+
+    static std::string WindowsEncode(const std::wstring_view utf16)
+    {
+        std::string result(utf16.size() * 3, '\0');
+        const auto written = WideCharToMultiByte(CP_UTF8, 0, utf16.data(), gsl::narrow<int>(utf16.size()), result.data(), gsl::narrow<int>(result.size()), nullptr, nullptr);
+        result.resize(written);
+        return result;
+    }
+
+    // A line of text from each of the corpora the benchmark uses.
+    static constexpr std::wstring_view s_ascii = L"drwxr-xr-x 1 user group 4096 Oct 18 12:00 src/renderer/vt/paint.cpp\r\n";
+    static constexpr std::wstring_view s_latin1 = L"D\x00e9j\x00e0 vu: \x00e9t\x00e9, na\x00efve fa\x00e7" L"ade, se\x00f1or, \x00fc" L"ber, sm\x00f6rg\x00e5sbord\r\n";
+    static constexpr std::wstring_view s_cjk = L"\x65e5\x672c\x8a9e\x306e\x30c6\x30ad\x30b9\x30c8\x3001\x4e2d\x6587\x6587\x672c\x3001\xd55c\xad6d\xc5b4\r\n";
+    static constexpr std::wstring_view s_emoji = L"\xD83D\xDE00 \xD83D\xDC4D\xD83C\xDFFD \xD83D\xDC68\x200D\xD83D\xDC69\x200D\xD83D\xDC67 \xD83C\xDDFA\xD83C\xDDF8 ok\r\n";
+};
+
+void Utf8TranscoderTests::DecodesValidText()
+{
+    for (const auto line : { s_ascii, s_latin1, s_cjk, s_emoji })
+    {
+        const auto utf8 = WindowsEncode(line);
+        VERIFY_ARE_EQUAL(std::wstring{ line }, Decode(utf8));
+    }
+}
+
+void Utf8TranscoderTests::EncodesValidText()
+{
+    for (const auto line : { s_ascii, s_latin1, s_cjk, s_emoji })
+    {
+        VERIFY_ARE_EQUAL(WindowsEncode(line), Encode(line));
+    }
+}
+
+void Utf8TranscoderTests::HandlesEveryBlockBoundary()
+{
+    Log::Comment(L"Put a non-ASCII character at every position of runs of ASCII "
+                 L"long enough to cover both the 32 and 16 character blocks.");
+
+    for (size_t length = 1; length <= 80; length++)
+    {
+        for (size_t position = 0; position < length; position++)
+        {
+            std::wstring utf16(length, L'x');
+            utf16[position] = L'\x00e9';
+
+            const auto utf8 = Encode(utf16);
+            VERIFY_ARE_EQUAL(WindowsEncode(utf16), utf8);
+            VERIFY_ARE_EQUAL(utf16, Decode(utf8));
+        }
+    }
+}
+
+void Utf8TranscoderTests::ReplacesIllFormedUtf8()
+{
+    // Each maximal ill-formed subpart becomes one U+FFFD, and the bytes after
+    // it are decoded as usual.
+    VERIFY_ARE_EQUAL(std::wstring{ L"a\xFFFD" L"b" }, Decode("a\x80" "b")); // lone continuation byte
+    VERIFY_ARE_EQUAL(std::wstring{ L"a\xFFFD\xFFFD" L"b" }, Decode("a\xC0\xAF" "b")); // overlong, C0 is never valid
+    VERIFY_ARE_EQUAL(std::wstring{ L"a\xFFFD\xFFFD\xFFFD" L"b" }, Decode("a\xED\xA0\x80" "b")); // encoded surrogate
+    VERIFY_ARE_EQUAL(std::wstring{ L"a\xFFFD\xFFFD\xFFFD\xFFFD" L"b" }, Decode("a\xF4\x90\x80\x80" "b")); // past U+10FFFF
+    VERIFY_ARE_EQUAL(std::wstring{ L"a\xFFFD" L"b" }, Decode("a\xE6\x97" "b")); // truncated sequence
+    VERIFY_ARE_EQUAL(std::wstring{ L"a\xFFFD" }, Decode("a\xF0\x9F\x98")); // truncated at the end
+    VERIFY_ARE_EQUAL(std::wstring{ L"\xFFFD\xFFFD" }, Decode("\xFE\xFF"));
+}
+
+void Utf8TranscoderTests::ReplacesUnpairedSurrogates()
+{
+    VERIFY_ARE_EQUAL(std::string{ "a\xEF\xBF\xBD" "b" }, Encode(L"a\xD83D" L"b"));
+    VERIFY_ARE_EQUAL(std::string{ "a\xEF\xBF\xBD" "b" }, Encode(L"a\xDE00" L"b"));
+    VERIFY_ARE_EQUAL(std::string{ "\xEF\xBF\xBD\xF0\x9F\x98\x80" }, Encode(L"\xD83D\xD83D\xDE00"));
+    VERIFY_ARE_EQUAL(std::string{ "a\xEF\xBF\xBD" }, Encode(L"a\xD83D"));
+}
+
+void Utf8TranscoderTests::AppendsToExistingText()
+{
+    std::wstring utf16{ L"prefix " };
+    Utf8::AppendAsUtf16("\xE6\x97\xA5\xE6\x9C\xAC", utf16);
+    VERIFY_ARE_EQUAL(std::wstring{ L"prefix \x65e5\x672c" }, utf16);
+
+    std::string utf8{ "prefix " };
+    Utf8::AppendAsUtf8(L"\x65e5\x672c", utf8);
+    VERIFY_ARE_EQUAL(std::string{ "prefix \xE6\x97\xA5\xE6\x9C\xAC" }, utf8);
+}
+
+void Utf8TranscoderTests::StreamDecodesEverySplit()
+{
+    Log::Comment(L"Split text with 1 to 4 byte sequences and ill-formed bytes in "
+                 L"two at every offset, and check that decoding the two halves "
+                 L"gives the same text as decoding it all at once.");
+
+    const std::string_view utf8{ "a\xC3\xA9" "b\xE6\x97\xA5" "c\xF0\x9F\x98\x80" "d\x80" "e\xE6\x97" "f\xF0\x9F" "g\xED\xA0\x80" "h" };
+    const auto expected = Decode(utf8);
+
+    for (size_t split = 0; split <= utf8.size(); split++)
+    {
+        Utf8::StreamDecoder decoder;
+        auto actual = StreamDecode(decoder, utf8.substr(0, split));
+        actual += StreamDecode(decoder, utf8.substr(split));
+        VERIFY_ARE_EQUAL(expected, actual, NoThrowString().Format(L"split at %zu", split));
+        VERIFY_ARE_EQUAL(0u, decoder.GetPendingLength());
+    }
+
+    Log::Comment(L"Feed the same text in one byte at a time.");
+    Utf8::StreamDecoder decoder;
+    std::wstring actual;
+    for (const auto ch : utf8)
+    {
+        actual += StreamDecode(decoder, { &ch, 1 });
+    }
+    VERIFY_ARE_EQUAL(expected, actual);
+}
+
+void Utf8TranscoderTests::StreamHoldsIncompleteSequences()
+{
+    Utf8::StreamDecoder decoder;
+
+    Log::Comment(L"The start of a sequence at the end of a read is held onto until the rest arrives.");
+    VERIFY_ARE_EQUAL(std::wstring{ L"ab" }, StreamDecode(decoder, "ab\xF0\x9F"));
+    VERIFY_ARE_EQUAL(2u, decoder.GetPendingLength());
+    VERIFY_ARE_EQUAL(std::wstring{}, StreamDecode(decoder, "\x98"));
+    VERIFY_ARE_EQUAL(3u, decoder.GetPendingLength());
+    VERIFY_ARE_EQUAL(std::wstring{ L"\xD83D\xDE00" }, StreamDecode(decoder, "\x80"));
+    VERIFY_ARE_EQUAL(0u, decoder.GetPendingLength());
+
+    Log::Comment(L"Bytes that can't start a sequence aren't held onto.");
+    VERIFY_ARE_EQUAL(std::wstring{ L"a\xFFFD" }, StreamDecode(decoder, "a\x80"));
+    VERIFY_ARE_EQUAL(std::wstring{ L"a\xFFFD" }, StreamDecode(decoder, "a\xF5"));
+    VERIFY_ARE_EQUAL(0u, decoder.GetPendingLength());
+
+    Log::Comment(L"Reset drops a held sequence.");
+    VERIFY_ARE_EQUAL(std::wstring{}, StreamDecode(decoder, "\xE6\x97"));
+    decoder.Reset();
+    VERIFY_ARE_EQUAL(0u, decoder.GetPendingLength());
+    VERIFY_ARE_EQUAL(std::wstring{ L"\xFFFD" L"b" }, StreamDecode(decoder, "\xA5" "b"));
+
+    Log::Comment(L"The destination has to be able to hold the worst case.");
+    wchar_t small[2];
+    VERIFY_THROWS_SPECIFIC(decoder.Decode("abc", { small, 2 }),
+                           wil::ResultException,
+                           [](wil::ResultException& e) { return e.GetErrorCode() == E_INVALIDARG; });
+}
+
+void Utf8TranscoderTests::BenchmarkCorpora()
+{
+    Log::Comment(L"Benchmark: convert ~1MB of ASCII, Latin-1-heavy, CJK and emoji "
+                 L"text in both directions, and compare against the Windows "
+                 L"conversion functions.");
+
+    const auto measure = [](auto&& func) {
+        const size_t iterations = 20;
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; i++)
+        {
+            func();
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / iterations;
+    };
+
+    const std::pair<const wchar_t*, std::wstring_view> corpora[]{
+        { L"ASCII", s_ascii },
+        { L"Latin-1", s_latin1 },
+        { L"CJK", s_cjk },
+        { L"Emoji", s_emoji },
+    };
+    for (const auto& [name, line] : corpora)
+    {
+        std::wstring utf16;
+        while (utf16.size() < 512 * 1024)
+        {
+            utf16.append(line);
+        }
+        const auto utf8 = WindowsEncode(utf16);
+
+        // The buffers are reused, like the hot paths do.
+        std::wstring decoded;
+        std::string encoded;
+        const auto decode = measure([&]() {
+            decoded.clear();
+            Utf8::AppendAsUtf16(utf8, decoded);
+        });
+        const auto windowsDecode = measure([&]() { WindowsDecode(utf8); });
+        const auto encode = measure([&]() {
+            encoded.clear();
+            Utf8::AppendAsUtf8(utf16, encoded);
+        });
+        const auto windowsEncode = measure([&]() { WindowsEncode(utf16); });
+
+        VERIFY_ARE_EQUAL(utf16, decoded);
+        VERIFY_ARE_EQUAL(utf8, encoded);
+
+        const auto megabytes = utf8.size() / (1024.0 * 1024.0);
+        Log::Comment(NoThrowString().Format(L"%s: decode %.0f MB/s (Windows: %.0f MB/s), encode %.0f MB/s (Windows: %.0f MB/s)",
+                                            name,
+                                            megabytes / decode,
+                                            megabytes / windowsDecode,
+                                            megabytes / encode,
+                                            megabytes / windowsEncode));
+    }
+}